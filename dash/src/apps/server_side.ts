@@ -272,52 +272,36 @@ export class ServerSideApp implements App {
                     if (!first) {
                         first = true;
                         
-                        // Stop the player until we receive the decision for piece (index + 1)
+                        // Stop the player until we receive the decision for piece (index + 1),
+                        // as the answer of its long polling request or over the control channel
                         let controller = context.scheduleController;
-                        let request    = this.requestController.getPieceRequest(index + 1); 
                         
-                        if (request) {
-                            // The request is undefined after we pass all the pieces.
+                        if (this.requestController.requested(index + 1)) {
+                            // The piece is not requested after we pass all the pieces.
                             logger.log("Scheduling", index + 1);
-                            let ended: boolean = false;
-                            if (request.request !== undefined) {
-                                ended = (<any>request.request)._ended;
-                            }
+                            let decision = this.requestController.getDecision(index + 1);
 
-                            // If the request did not end.
-                            if (!ended) {
-                                // Keep pooling the controller until the request has ended
+                            // If the decision did not arrive.
+                            if (decision === undefined) {
+                                // Keep pooling the controller until the decision has arrived
                                 // and when it did restart the controller.
-                                let startAfterEnded = () => {
-                                    let ended: boolean = false;
-                                    if (request.request !== undefined) {
-                                        ended = (<any>request.request)._ended;
-                                    }
+                                let startAfterDecision = () => {
+                                    let decision = this.requestController.getDecision(index + 1);
 
-                                    if (!ended) {
-                                        setTimeout(startAfterEnded, 10);
+                                    if (decision === undefined) {
+                                        setTimeout(startAfterDecision, 10);
                                     } else {
                                         controller.start();
                                         logger.log("SchedulingController started.")
-                                        if (request.request === undefined) {
-                                            throw new TypeError(`missing request for ${request}`);
-                                        } else {
-                                            onPieceSuccess(
-                                                index + 1, (<any>request.request).response.body
-                                            );
-                                        }
+                                        onPieceSuccess(index + 1, decision);
                                     }
                                 };
                                 
                                 logger.log("SchedulingController stopped.")
                                 controller.stop();
-                                startAfterEnded(); 
+                                startAfterDecision(); 
                             } else {
-                                if (request.request === undefined) {
-                                    throw new TypeError(`missing request for ${request}`);
-                                } else {
-                                    onPieceSuccess(index + 1, (<any>request.request).response.body);
-                                }
+                                onPieceSuccess(index + 1, decision);
                             }
                         }
                     }
@@ -371,7 +355,7 @@ export class ServerSideApp implements App {
                     .send();
             }
 
-            // Send metrics to the backend.
+            // Send metrics to the backend, over the control channel once it is open.
             this.shim
                 .metricsRequest()
                 .addStats(allMetrics.serialize())
@@ -65,4 +65,13 @@ export class ArgsParser {
         }
         return null;
     }
+
+    get controlPort(): string | null {
+        for (let arg of this.args) {
+            if (arg.includes('control-port')) {
+                return arg.split('=')[1];
+            }
+        }
+        return null;
+    }
 }
@@ -3,9 +3,13 @@ import { JsonDict, Json } from '../types';
 import * as request from 'request';
 import * as retryrequest from 'requestretry';
 import { logging } from '../common/logger'; 
+import { ControlChannel } from './control';
 
 const logger = logging('BackendShim');
 
+// header of the `/request` responses naming the player session
+const SESSION_HEADER = 'abrcc-session';
+
 type RequestFunction = (
     url: string | Json, 
     content: Json, 
@@ -228,6 +232,8 @@ export abstract class Request {
 
 /**
  * Metrics POST via the node `request` library.
+ *
+ * The metrics go over the shim's control channel once it is open; the first response opens it.
  */
 export class MetricsRequest extends Request {
     _json: JsonDict; 
@@ -244,6 +250,18 @@ export class MetricsRequest extends Request {
     }
 
     send() {
+        if (this.shim.control !== undefined) {
+            let control: ControlChannel = this.shim.control;
+            if (control.sendMetrics(this._json['stats'])) {
+                return this;
+            }
+
+            let onResponse = this._onResponse;
+            this._onResponse = (res) => {
+                control.open((<any>res).headers[SESSION_HEADER]);
+                onResponse(res);
+            };
+        }
         return this._request(request.post, this.shim.path, "", {
             json : this._json,
         });
@@ -363,12 +381,18 @@ export class PieceRequest extends Request {
 
 /**
  * *Backend* GET via the node `request` library asking to abort the request for an `index`. 
+ *
+ * The abort goes over the shim's control channel if it is open.
  */
 export class AbortRequest extends PieceRequest {
     send(): Request {
         if (this.index === undefined) {
             throw new TypeError(`PieceRequest made without index: ${this}`); 
         }
+        let control = this.shim.control;
+        if (control !== undefined && control.sendAbort(this.index)) {
+            return this;
+        }
         return this._request(request.get, this.shim.abortPath, "/" + this.index, {});
     }
 }
@@ -436,7 +460,9 @@ export class ResourceRequest extends Request {
  *  - PieceRequest
  *  - ResourceRequest
  *  - AbortRequest
- *  
+ *
+ * Given a `control_port`, the shim also keeps the player session's control channel, over which 
+ * the metrics, aborts and decisions go once it is open.
  */
 export class BackendShim {
     _base_path: string;
@@ -444,16 +470,29 @@ export class BackendShim {
     _abort: string;
     _resource_path: string;
     _experiment_path: string;
+    _control: ControlChannel | undefined;
     
-    constructor(site: string, metrics_port: number, quic_port: number) {
-        // the base path refers to the backend server
-        this._base_path = `https://${site}:${quic_port}`;
-        this._path = `https://${site}:${quic_port}/request`;
-        this._abort = `https://${site}:${quic_port}/abort`;
-        this._resource_path = `https://${site}:${quic_port}/piece`;    
+    constructor(
+        site: string, 
+        metrics_port: number, 
+        quic_port: number, 
+        title_path: string = "", 
+        control_port: string | null = null,
+    ) {
+        // the base path refers to the backend server, and to the title served under
+        // `title_path` when the server serves several titles
+        this._base_path = `https://${site}:${quic_port}${title_path}`;
+        this._path = `${this._base_path}/request`;
+        this._abort = `${this._base_path}/abort`;
+        this._resource_path = `${this._base_path}/piece`;    
 
         // the experiment path is used as a logging and control service
         this._experiment_path = `https://${site}:${metrics_port}`;
+
+        // the control channel is bound to the title by the path of the player's page
+        if (control_port !== null) {
+            this._control = new ControlChannel(site, control_port, window.location.pathname);
+        }
     }
 
     headerRequest(): HeaderRequest {
@@ -507,4 +546,8 @@ export class BackendShim {
     get experimentPath(): string {
         return this._experiment_path;
     }   
+
+    get control(): ControlChannel | undefined {
+        return this._control;
+    }
 }
@@ -0,0 +1,172 @@
+import { Json, JsonDict, ExternalDependency } from '../types';
+
+import { logging } from '../common/logger';
+
+const logger = logging('ControlChannel');
+
+// the messages of a control stream are separated by newlines
+const DELIMITER = '\n';
+
+type DecisionCallback = (body: string) => void;
+type CloseCallback = () => void;
+
+
+/**
+ * Persistent control channel of a player session: a QuicTransport(WebTransport over QUIC)
+ * bidirectional stream to the backend's control server, carrying the metrics and aborts up and
+ * the decisions down, one JSON object per line, in place of a metrics POST per tick and a long
+ * poll per decision.
+ *
+ * The channel is bound to the player session named by the `abrcc-session` header of the
+ * backend's `/request` responses, hence it is opened after the first metrics POST. Until it is
+ * open, or once it closed, the HTTP endpoints are used.
+ *
+ * The metrics stay on the stream rather than going as datagrams: each update only carries the
+ * metrics fresher than the previous one, so a lost update would not be superseded by the next.
+ */
+export class ControlChannel {
+    _url: string;
+    _path: string;
+    _transport: ExternalDependency;
+    _writer: ExternalDependency;
+    _encoder: ExternalDependency;
+    _decoder: ExternalDependency;
+    _started: boolean;
+    _open: boolean;
+    _closed: boolean;
+
+    _onDecision: DecisionCallback;
+    _onClose: CloseCallback;
+
+    constructor(site: string, control_port: string, path: string) {
+        this._url = `quic-transport://${site}:${control_port}/`;
+        this._path = path;
+        this._started = false;
+        this._open = false;
+        this._closed = false;
+
+        this._onDecision = (body) => {};
+        this._onClose = () => {};
+    }
+
+    /**
+     * Opens the channel for the player session `session`, unless it was already opened or the
+     * browser does not support QuicTransport.
+     */
+    open(session: string | undefined): ControlChannel {
+        if (this._started || session === undefined) {
+            return this;
+        }
+        this._started = true;
+
+        const QuicTransport = (<any>window).QuicTransport;
+        if (QuicTransport === undefined) {
+            logger.log('QuicTransport not supported, keeping the HTTP endpoints');
+            return this;
+        }
+        this._encoder = new (<any>window).TextEncoder();
+        this._decoder = new (<any>window).TextDecoder();
+
+        let transport = new QuicTransport(this._url);
+        this._transport = transport;
+        transport.ready
+            .then(() => transport.createBidirectionalStream())
+            .then((stream) => {
+                // the first message binds the stream to the player session
+                this._writer = stream.writable.getWriter();
+                this._write({
+                    'path': this._path,
+                    'session': session,
+                });
+                this._open = true;
+                logger.log('Control channel open', this._url, session);
+
+                this._read(stream.readable.getReader(), '');
+            })
+            .catch((error) => this._close(error));
+        transport.closed
+            .then(() => this._close('transport closed'), (error) => this._close(error));
+        return this;
+    }
+
+    /**
+     * Sends the metrics of a tick; returns false if the channel is not open.
+     */
+    sendMetrics(stats: Json): boolean {
+        return this._write({
+            'stats': stats,
+        });
+    }
+
+    /**
+     * Sends the abort of the segment `index`; returns false if the channel is not open.
+     */
+    sendAbort(index: number): boolean {
+        return this._write({
+            'abort': index,
+        });
+    }
+
+    _write(message: JsonDict): boolean {
+        if (this._writer === undefined || this._closed) {
+            return false;
+        }
+        let bytes = this._encoder.encode(JSON.stringify(message) + DELIMITER);
+        this._writer.write(bytes).catch((error) => this._close(error));
+        return true;
+    }
+
+    _read(reader: ExternalDependency, buffer: string): void {
+        reader.read().then((result) => {
+            if (result.done) {
+                this._close('stream finished');
+                return;
+            }
+
+            buffer += this._decoder.decode(result.value, { 'stream': true });
+            let messages = buffer.split(DELIMITER);
+            buffer = <string>messages.pop();
+            for (let message of messages) {
+                if (message.length > 0) {
+                    this._onDecision(message);
+                }
+            }
+            this._read(reader, buffer);
+        }).catch((error) => this._close(error));
+    }
+
+    _close(reason: ExternalDependency): void {
+        if (this._closed) {
+            return;
+        }
+        this._closed = true;
+        this._open = false;
+        this._writer = undefined;
+        logger.log('Control channel closed', reason);
+
+        try {
+            this._transport.close();
+        } catch (error) {
+            // already closed
+        }
+        this._onClose();
+    }
+
+    // Builder pattern methods below
+    // -----------------------------
+    onDecision(callback: DecisionCallback): ControlChannel {
+        this._onDecision = callback;
+        return this;
+    }
+
+    onClose(callback: CloseCallback): ControlChannel {
+        this._onClose = callback;
+        return this;
+    }
+
+    // Getters below
+    // -------------
+    get isOpen(): boolean {
+        return this._open;
+    }
+}
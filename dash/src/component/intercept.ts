@@ -42,7 +42,9 @@ class UrlProcessor {
 
     get quality(): number | undefined {
         try {
-            return parseInt(this.url.split('/')[1].split('video')[1]);
+            // the segment path ends the url, which can be under a title's path
+            let parts = this.url.split('/');
+            return parseInt(parts[parts.length - 2].split('video')[1]);
         } catch(err) {
             return undefined;
         }
@@ -50,7 +52,8 @@ class UrlProcessor {
 
     get index(): number | undefined {
         try {
-            return parseInt(this.url.split('/')[2].split('.')[0]);
+            let parts = this.url.split('/');
+            return parseInt(parts[parts.length - 1].split('.')[0]);
         } catch(err) {
             return undefined;
         }
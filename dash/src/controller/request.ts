@@ -21,6 +21,10 @@ type PieceSuccessCallback = (index: number, body: Body) => void;
  * It contains 2 pools of requests(symetric to each other):
  *   - a pull of piece requests: high level-HTTP requests with JSON content
  *   - a pull of resource requests: XMLHttp native requests
+ *
+ * While the shim's control channel is open, the decisions come over it rather than 
+ * as the answers of piece requests; if it closes, the pieces still waiting for a 
+ * decision are requested again.
  */
 export class RequestController {
     _current: number;
@@ -37,6 +41,7 @@ export class RequestController {
     _pieceSuccess: PieceSuccessCallback; 
     _pieceRequests: Dict<number, Request>; 
     _resourceRequests: Dict<number, Request>;
+    _decisions: Dict<number, Body>;
 
     constructor(videoInfo: VideoInfo, shim: BackendShim, pool: number) {
         this._current = 0;
@@ -51,7 +56,23 @@ export class RequestController {
 
         this._pieceRequests = {};
         this._resourceRequests = {};
+        this._decisions = {};
         this._max_index = videoInfo.info[videoInfo.bitrateArray[0]].length;
+
+        if (shim.control !== undefined) {
+            shim.control
+                .onDecision((body: string) => {
+                    this._decision(JSON.parse(body).index, <any>body);
+                })
+                .onClose(() => {
+                    for (let index = 1; index <= this._index; index++) {
+                        if (this._decisions[index] === undefined 
+                            && this._pieceRequests[index] === undefined) {
+                            this._pieceRequest(index);
+                        }
+                    }
+                });
+        }
     }
 
     /**
@@ -68,12 +89,36 @@ export class RequestController {
         return this._resourceRequests[index];
     }
 
+    /**
+     * Getter for the decision of a piece, undefined until it was received.
+     */
+    getDecision(index: number): Body | undefined {
+        return this._decisions[index];
+    }
+
+    /**
+     * Whether the decision for a piece was asked for.
+     */
+    requested(index: number): boolean {
+        return index <= this._index;
+    }
+
+    _decision(index: number, body: Body): void {
+        this._decisions[index] = body;
+        this._pieceSuccess(index, body);
+    }
+
     _pieceRequest(index: number): void {
+        let control = this._shim.control;
+        if (control !== undefined && control.isOpen) {
+            // the decision will come over the control channel
+            return;
+        }
         this._pieceRequests[index] = this._shim
             .pieceRequest()
             .addIndex(index)
             .onSuccess((body) => {
-                this._pieceSuccess(index, body);
+                this._decision(index, body);
             }).onFail(() => {
                 throw new Error(`Piece request ${index} failed`)
             }).send();
@@ -88,16 +88,28 @@ function startPlayer(app, player, video, url, parser, shim) {
     player.play();
 }
 
+// The path of the title the page was loaded from: a server serving several titles
+// serves the title <name> and its player under "/<name>/".
+function titlePath() {
+    let path = window.location.pathname;
+    return path.substring(0, path.lastIndexOf('/'));
+}
+
 function init() {
     let parser = new ArgsParser(config.args);
     let video_info = new VideoInfo(video_config);
 
-    let url = `https://${parser.site}:${parser.quicPort}/manifest.mpd`;
+    let title_path = titlePath();
+    let url = `https://${parser.site}:${parser.quicPort}${title_path}/manifest.mpd`;
     let player = MediaPlayer().create();
     let video = document.querySelector('#videoPlayer'); 
     let app;
 
-    let shim = new BackendShim(parser.site, parser.metricsPort, parser.quicPort);
+    // only the server-side ABRs take their decisions over the control channel
+    let control_port = parser.serverSide ? parser.controlPort : null;
+    let shim = new BackendShim(
+        parser.site, parser.metricsPort, parser.quicPort, title_path, control_port
+    );
     if (parser.serverSide) {
         app = new ServerSideApp(
             player, parser.recordMetrics, shim, video_info
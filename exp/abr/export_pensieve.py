@@ -0,0 +1,62 @@
+from argparse import ArgumentParser
+from pathlib import Path
+
+import numpy as np
+import tensorflow as tf
+import os
+
+from abr import a3c
+
+
+S_INFO = 6
+S_LEN = 8
+ACTOR_LR_RATE = 0.0001
+CRITIC_LR_RATE = 0.001
+A_DIM = 6
+
+NN_MODEL = 'results/pretrain_linear_reward.ckpt'
+NN_WEIGHTS = 'results/pretrain_linear_reward.txt'
+
+
+def export(model: str, output: str, adim: int) -> None:
+    """
+    Exports the actor weights of a pretrained Pensieve model in the text format read by
+    the server-side PensieveAbr(`quic/chromium/src/net/abrcc/abr/abr_pensieve.cc`): the
+    number of tensors, followed by each tensor's name, number of dimensions, dimensions
+    and values. The 1D convolution kernels are stored as [filter, in_channels, out_channels].
+    """
+    sess = tf.Session()
+    actor = a3c.ActorNetwork(sess,
+        state_dim=[S_INFO, S_LEN], action_dim=adim,
+        learning_rate=ACTOR_LR_RATE)
+    critic = a3c.CriticNetwork(sess,
+        state_dim=[S_INFO, S_LEN],
+        learning_rate=CRITIC_LR_RATE)
+
+    saver = tf.train.Saver()
+    saver.restore(sess, model)
+
+    params = actor.get_network_params()
+    with open(output, 'w') as out:
+        out.write(f"{len(params)}\n")
+        for var, value in zip(actor.network_params, params):
+            value = np.asarray(value, dtype=np.float32)
+            if value.ndim == 4:
+                # conv_1d kernels are stored as [filter, 1, in_channels, out_channels]
+                value = value.reshape(value.shape[0], value.shape[2], value.shape[3])
+            name = var.name.replace(':0', '')
+            dims = ' '.join(str(dim) for dim in value.shape)
+            out.write(f"{name} {value.ndim} {dims}\n")
+            out.write(' '.join(repr(float(x)) for x in value.flatten()) + '\n')
+    print(f"[export] > {len(params)} tensors written to {output}")
+
+
+if __name__ == "__main__":
+    directory = Path(os.path.dirname(os.path.realpath(__file__)))
+
+    parser = ArgumentParser(description='Export the Pensieve actor weights for the server-side ABR.')
+    parser.add_argument('--model', type=str, default=str(directory / NN_MODEL), help='Checkpoint path.')
+    parser.add_argument('--output', type=str, default=str(directory / NN_WEIGHTS), help='Output weights path.')
+    parser.add_argument('--adim', type=int, default=A_DIM, help='Number of video qualities.')
+    args = parser.parse_args()
+    export(args.model, args.output, args.adim)
@@ -0,0 +1,96 @@
+from argparse import ArgumentParser
+from contextlib import redirect_stdout
+from typing import Dict, List, Tuple
+
+import asyncio
+import csv
+import io
+import sys
+
+
+# server-side ABRs mirroring a Python baseline
+BASELINES = ['robustmpc', 'pensieve']
+
+Run = Tuple[str, str, str, str]
+
+
+def load_runs(path: str) -> Dict[Run, List[Dict[str, str]]]:
+    """
+    Groups the rows of a decision log written by `abrcc_simulator_benchmark --decision_log`
+    by run(trace, CC, ABR and seed), keeping the runs of the ABRs with a Python baseline.
+    """
+    runs: Dict[Run, List[Dict[str, str]]] = {}
+    with open(path, 'r') as log:
+        for row in csv.DictReader(log):
+            if row['abr'] not in BASELINES:
+                continue
+            run = (row['trace'], row['cc'], row['abr'], row['seed'])
+            runs.setdefault(run, []).append(row)
+    return runs
+
+
+def baseline(abr: str, video: str):
+    # imported lazily, as Pensieve depends on TensorFlow
+    if abr == 'robustmpc':
+        from abr.robust_mpc import RobustMpc
+        return RobustMpc(video)
+    from abr.pensieve import Pensieve
+    return Pensieve(video)
+
+
+async def replay(abr: str, video: str, rows: List[Dict[str, str]]) -> List[Tuple[int, int, int]]:
+    """
+    Feeds the getters' values logged before every decision to a fresh instance of the
+    baseline, as the front-end would, and returns the decisions that differ as
+    (index, server-side quality, baseline quality).
+    """
+    with redirect_stdout(io.StringIO()):
+        component = baseline(abr, video)
+
+    mismatches = []
+    for row in rows:
+        request = {
+            'index': int(row['index']),
+            'buffer': float(row['buffer_ms']),
+            'bandwidth': float(row['bandwidth_kbps']),
+            'last_fetch_time': float(row['last_fetch_time_ms']),
+            # only used by the baselines' rewards, not by their decisions
+            'rebuffer': 0,
+        }
+        with redirect_stdout(io.StringIO()):
+            response = await component.process(request)
+        decision = int(response['decision'])
+        if decision != int(row['quality']):
+            mismatches.append((int(row['index']), int(row['quality']), decision))
+    return mismatches
+
+
+async def check(path: str, video: str) -> bool:
+    runs = load_runs(path)
+    if len(runs) == 0:
+        print(f"[parity] > no decisions of {', '.join(BASELINES)} in {path}")
+        return False
+
+    identical = True
+    for run, rows in runs.items():
+        trace, cc, abr, seed = run
+        mismatches = await replay(abr, video, rows)
+        print(f"[parity] > {abr} on {trace}, {cc}, seed {seed}: "
+              f"{len(rows) - len(mismatches)}/{len(rows)} identical decisions")
+        for index, quality, expected in mismatches:
+            print(f"[parity] >   segment {index}: {quality}, baseline {expected}")
+        identical = identical and len(mismatches) == 0
+    return identical
+
+
+if __name__ == "__main__":
+    parser = ArgumentParser(description=
+        'Check the decisions of the server-side RobustMpc and Pensieve against the '
+        'Python baselines, on the decision log of the simulator benchmark.')
+    parser.add_argument('decision_log', type=str, help='Decision log(--decision_log).')
+    parser.add_argument('--video', type=str, required=True,
+        help='Title of the benchmark\'s video config, as found in quic/sites.')
+    args = parser.parse_args()
+
+    identical = asyncio.get_event_loop().run_until_complete(check(args.decision_log, args.video))
+    sys.exit(0 if identical else 1)
@@ -37,6 +37,8 @@ class Pensieve(Component):
         super().__init__()
         
         sess = tf.Session()
+        # the actions are sampled from seeded draws, as by the server-side PensieveAbr
+        np.random.seed(RANDOM_SEED)
 
         # save video name
         self.video = video
@@ -72,6 +72,7 @@ class Controller(LogAccessMixin):
         leader_port: Optional[int] = None,
         video: Optional[str] = None,
         headless: bool = False,
+        coupled_cc: bool = False,
     ) -> None:
         LogAccessMixin.__init__(self)
 
@@ -94,7 +95,8 @@ class Controller(LogAccessMixin):
                 ['--site', site, '--profile', name, '--cc', cc] + 
                 (['--certs'] if not leader_port else []) +
                 (['--abr', abr] if abr else []) + 
-                (['--video', video] if video else []),
+                (['--video', video] if video else []) +
+                (['--coupled-cc'] if coupled_cc else []),
             path=path,
             name=name,
             frontend=self.chrome,
@@ -14,8 +14,8 @@ from scripts.network import Network
 
 
 ABR_ALGORITHMS = ['bola', 'dynamic', 'bb', 'festive', 'rb', 'robustMpc', 'pensieve', 'minerva', 'minervann']
-SERVER_ABR_ALGORITHMS = ['bb', 'random', 'worthed', 'target', 'target2', 'target3', 'gap', 'remote', 'minerva', 'minervann']
-CC_ALGORITHMS = ['bbr', 'bbr2', 'pcc', 'reno', 'cubic', 'abbr', 'xbbr', 'target', 'gap', 'minerva']
+SERVER_ABR_ALGORITHMS = ['bb', 'random', 'worthed', 'target', 'target2', 'target3', 'gap', 'remote', 'minerva', 'minervann', 'robustmpc', 'pensieve']
+CC_ALGORITHMS = ['bbr', 'bbr2', 'pcc', 'reno', 'cubic', 'abbr', 'xbbr', 'target', 'gap', 'bbr2target', 'bbr2gap', 'minerva']
 PYTHON_ABR_ALGORITHMS = ['robustMpc', 'pensieve', 'minerva', 'minervann']
 
 
@@ -77,6 +77,7 @@ def run(args: Namespace) -> None:
         leader_port = args.leader_port,
         video = args.video,
         headless = getattr(args, 'headless', False),
+        coupled_cc = getattr(args, 'coupled_cc', False),
     )
        
     # Handle controller communication and metrics
@@ -133,6 +134,7 @@ if __name__ == "__main__":
     parser.add_argument('--algo', choices=ABR_ALGORITHMS, help='Choose abr algorithm.') 
     parser.add_argument('--server-algo', choices=SERVER_ABR_ALGORITHMS, help='Choose server abr algorithm.')
     parser.add_argument('--cc', choices=CC_ALGORITHMS, default='bbr', help='Choose cc algorithm.') 
+    parser.add_argument('--coupled-cc', dest='coupled_cc', action='store_true', help='Couple the cc with the other coupled instances\' connections to the same client subnet.')
     parser.add_argument('--training', action='store_true', help='Enable traning statistics for learning algorithms.')
     parser.add_argument('--headless', action='store_true', help='Allow Chrome and plot components to run headless.')
     parser.add_argument('--traffic', action='store_true', help='Enable TCP generated traffic.')
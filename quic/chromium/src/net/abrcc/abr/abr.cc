@@ -4,49 +4,144 @@
 #include "net/abrcc/abr/abr_gap.h"
 #include "net/abrcc/abr/abr_minerva.h"
 #include "net/abrcc/abr/abr_remote.h"
+#include "net/abrcc/abr/abr_robust_mpc.h"
+#include "net/abrcc/abr/abr_pensieve.h"
 
 #include "net/abrcc/abr/abr.h"
+#include "net/abrcc/logging/log.h"
 
 
+namespace {
+  // ABR interfaces of a connection: ConnectionInterfaces' target, gap, adapter
+  // and minerva
+  enum Family { NONE, TARGET, GAP, ADAPTER, MINERVA };
+
+  // interfaces fed by the senders
+  Family senderFamily(quic::CongestionControlType cc_type) {
+    switch (cc_type) {
+      case quic::kAbbr:
+        return ADAPTER;
+      case quic::kTarget:
+      case quic::kBbr2Target:
+      case quic::kPCC:
+        return TARGET;
+      case quic::kGap:
+      case quic::kBbr2Gap:
+        return GAP;
+      case quic::kMinervaBytes:
+        return MINERVA;
+      default:
+        return NONE;
+    }
+  }
+
+  // interfaces read by the ABRs; the Gap ABR also reads the target interface,
+  // which the Gap senders do not feed
+  Family abrFamily(const std::string& abr_type) {
+    if (abr_type == "target" || abr_type == "worthed") {
+      return ADAPTER;
+    } else if (abr_type == "target2" || abr_type == "target3" || abr_type == "remote") {
+      return TARGET;
+    } else if (abr_type == "gap") {
+      return GAP;
+    } else if (abr_type == "minerva" || abr_type == "minervann") {
+      return MINERVA;
+    }
+    return NONE;
+  }
+
+  // ABR of each family
+  std::string familyAbr(Family family) {
+    switch (family) {
+      case ADAPTER:
+        return "target";
+      case TARGET:
+        return "target2";
+      case GAP:
+        return "gap";
+      case MINERVA:
+        return "minerva";
+      default:
+        return "bb";
+    }
+  }
+}
+
 namespace quic {
 
 AbrInterface* getAbr(
   const std::string& abr_type, 
   const std::shared_ptr<DashBackendConfig>& config,
-  const std::string& minerva_config_path_ // only used by Minerva
+  const std::string& minerva_config_path_, // only used by Minerva
+  const std::string& pensieve_model_path_ // only used by Pensieve
 ) {
   if (abr_type == "bb") {
-    QUIC_LOG(WARNING) << "BB abr selected";
+    ABRCC_LOG(WARNING) << "BB abr selected";
     return new BBAbr(config);
   } else if (abr_type == "random") {
-    QUIC_LOG(WARNING) << "Random abr selected";
+    ABRCC_LOG(WARNING) << "Random abr selected";
     return new RandomAbr(config);
   } else if (abr_type == "worthed") {
-    QUIC_LOG(WARNING) << "Worthed abr selected";
+    ABRCC_LOG(WARNING) << "Worthed abr selected";
     return new WorthedAbr(config);
   } else if (abr_type == "target") {
-    QUIC_LOG(WARNING) << "Target abr selected";
+    ABRCC_LOG(WARNING) << "Target abr selected";
     return new TargetAbr(config);
   } else if (abr_type == "target2") {
-    QUIC_LOG(WARNING) << "Target2 abr selected";
+    ABRCC_LOG(WARNING) << "Target2 abr selected";
     return new TargetAbr2(config);
   } else if (abr_type == "target3") {
-    QUIC_LOG(WARNING) << "Target3 abr selected";
+    ABRCC_LOG(WARNING) << "Target3 abr selected";
     return new TargetAbr3(config);
   } else if (abr_type == "gap") {
-    QUIC_LOG(WARNING) << "Gap abr selected";
+    ABRCC_LOG(WARNING) << "Gap abr selected";
     return new GapAbr(config);
   } else if (abr_type == "remote") {
-    QUIC_LOG(WARNING) << "Remote abr selected";
+    ABRCC_LOG(WARNING) << "Remote abr selected";
     return new RemoteAbr(config);
   } else if (abr_type == "minerva") {
-    QUIC_LOG(WARNING) << "Minerva abr selected";
+    ABRCC_LOG(WARNING) << "Minerva abr selected";
     return new MinervaAbr(config, minerva_config_path_, true);
   } else if (abr_type == "minervann") {
     return new MinervaAbr(config, minerva_config_path_, false);
+  } else if (abr_type == "robustmpc") {
+    ABRCC_LOG(WARNING) << "RobustMpc abr selected";
+    return new RobustMpcAbr(config);
+  } else if (abr_type == "pensieve") {
+    ABRCC_LOG(WARNING) << "Pensieve abr selected";
+    return new PensieveAbr(config, pensieve_model_path_);
   }
-  QUIC_LOG(WARNING) << "Defaulting to BB abr";
+  ABRCC_LOG(WARNING) << "Defaulting to BB abr";
   return new BBAbr(config);
 }
 
+std::string getSessionAbrType(
+  const std::string& abr_type,
+  CongestionControlType cc_type,
+  const std::string& minerva_config_path_ // only used by Minerva
+) {
+  Family sender = senderFamily(cc_type);
+  Family abr = abrFamily(abr_type);
+  if (sender == abr) {
+    return abr_type;
+  }
+  if (abr != NONE && sender == NONE) {
+    ABRCC_LOG(WARNING) << "[ABR] " << abr_type << " abr over CC " << cc_type
+                       << ", which feeds none of its interfaces";
+    return abr_type;
+  }
+  if (abr == NONE) {
+    // the ABR steers no sender, which runs with its defaults
+    return abr_type;
+  }
+  if (sender == MINERVA && minerva_config_path_.empty()) {
+    ABRCC_LOG(WARNING) << "[ABR] no Minerva configuration for CC " << cc_type
+                       << ", keeping " << abr_type << " abr";
+    return abr_type;
+  }
+  ABRCC_LOG(WARNING) << "[ABR] CC " << cc_type << " does not feed " << abr_type
+                     << " abr, using " << familyAbr(sender) << " abr";
+  return familyAbr(sender);
+}
+
 }
@@ -3,11 +3,27 @@
 
 #include "net/abrcc/dash_config.h"
 
+#include <string>
+
+#include "net/third_party/quiche/src/quic/core/quic_types.h"
+
 namespace quic {
 
 AbrInterface* getAbr(
   const std::string& abr_type, 
   const std::shared_ptr<DashBackendConfig>& config,
+  const std::string& minerva_config_path_, // only used by Minerva
+  const std::string& pensieve_model_path_ // only used by Pensieve
+);
+
+// ABR type serving a connection whose sender is of `cc_type`. A client can
+// request the sender through a connection option, so the sender may feed the
+// interfaces of another family of ABRs than `abr_type`'s(e.g. kACGP under
+// Target); the family's ABR is then used instead, as no sender would feed the
+// interfaces `abr_type` reads.
+std::string getSessionAbrType(
+  const std::string& abr_type,
+  CongestionControlType cc_type,
   const std::string& minerva_config_path_ // only used by Minerva
 );
 
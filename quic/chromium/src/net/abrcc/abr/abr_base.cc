@@ -1,4 +1,5 @@
 #include "net/abrcc/abr/abr_base.h"
+#include "net/abrcc/logging/log.h"
 
 
 const int SECOND = 1000; 
@@ -11,14 +12,14 @@ const int CUSHION = 10 * SECOND;
 static void log_segment(abr_schema::Segment &segment) {
   switch (segment.state) {
     case abr_schema::Segment::PROGRESS:
-      QUIC_LOG(WARNING) << "segment " << segment.index 
-                        << " [progress] " << 1.0 * segment.loaded / segment.total;
+      ABRCC_LOG_EVERY_MS(WARNING, 1000) << "segment " << segment.index 
+                                        << " [progress] " << 1.0 * segment.loaded / segment.total;
       break;
     case abr_schema::Segment::DOWNLOADED:
-      QUIC_LOG(WARNING) << "segment " << segment.index << " [downloaded]";
+      ABRCC_LOG(WARNING) << "segment " << segment.index << " [downloaded]";
       break;
     case abr_schema::Segment::LOADING:
-      QUIC_LOG(WARNING) << "segment " << segment.index << " [loading]";
+      ABRCC_LOG(WARNING) << "segment " << segment.index << " [loading]";
       break;
   }
 }
@@ -27,64 +28,56 @@ static void log_segment(abr_schema::Segment &segment) {
 namespace quic {
 
 SegmentProgressAbr::SegmentProgressAbr(const std::shared_ptr<DashBackendConfig>& config) : 
-  config(config), decision_index(1), last_timestamp(0) {
-
-  // compute segments
-  segments = std::vector< std::vector<VideoInfo> >();
-  for (int i = 0; i < int(config->video_configs.size()); ++i) {
-    for (auto &video_config : config->video_configs) {
-      std::string resource = "/video" + std::to_string(i);
-      if (resource == video_config->resource) {
-        std::vector<VideoInfo> info;
-        for (auto &x : video_config->video_info) {
-          info.push_back(VideoInfo(
-            x->start_time,
-            x->vmaf,
-            x->size
-          ));  
-        }
-        segments.push_back(info);
-      }
-    }
+  config(config)
+  , last_segment(SegmentProgressConstants::history)
+  , decisions(SegmentProgressConstants::history)
+  , aborted(SegmentProgressConstants::history)
+  , deliveries(SegmentProgressConstants::history)
+  , interfaces(new ConnectionInterfaces())
+  , decision_index(1)
+  , last_timestamp(0)
+  , catalog(VideoCatalog::ForConfig(config.get()))
+  // the configuration's catalog outlives the snapshots replacing `catalog`
+  , bitrate_array(catalog->bitrates())
+  , predictor(SegmentPredictor::ForConfig(config.get())) {
+  if (predictor != nullptr) {
+    catalog = predictor->Snapshot();
   }
-
-  // compute bitrate array
-  bitrate_array = std::vector<int>();
-  for (auto &video_config : config->video_configs) {
-    bitrate_array.push_back(video_config->quality);
-  }
-  sort(bitrate_array.begin(), bitrate_array.end());
 }
 SegmentProgressAbr::~SegmentProgressAbr() {}
 
 void SegmentProgressAbr::update_segment(abr_schema::Segment segment) {
   last_segment[segment.index] = segment;
   
-  QUIC_LOG(WARNING) << "[segment update @ " << segment.index << "]";
+  ABRCC_LOG(INFO) << "[segment update @ " << segment.index << "]";
   log_segment(segment);
 }
 
 void SegmentProgressAbr::registerAbort(const int index) {
-  aborted.insert(index);  
+  aborted[index] = true;  
 }
 
 void SegmentProgressAbr::registerMetrics(const abr_schema::Metrics &metrics) {
   for (const auto& segment : metrics.segments) {
     last_timestamp = std::max(last_timestamp, segment->timestamp);
+    if (segment->index <= decision_index - SegmentProgressConstants::history) {
+      // the segment's slot may already hold a newer segment
+      continue;
+    }
 
+    const abr_schema::Segment* previous = last_segment.find(segment->index);
     switch(segment->state) {
       case abr_schema::Segment::LOADING:
         break;
       case abr_schema::Segment::DOWNLOADED:
-        if (last_segment.find(segment->index) == last_segment.end() ||
-            last_segment[segment->index].state == abr_schema::Segment::PROGRESS) {
+        if (previous == nullptr || previous->state == abr_schema::Segment::PROGRESS) {
           update_segment(*segment);
         }
         break;
       case abr_schema::Segment::PROGRESS:
-        if (last_segment.find(segment->index) == last_segment.end() || (
-              last_segment[segment->index].state == abr_schema::Segment::PROGRESS &&
-              last_segment[segment->index].timestamp < segment->timestamp)) {
+        if (previous == nullptr || (
+              previous->state == abr_schema::Segment::PROGRESS &&
+              previous->timestamp < segment->timestamp)) {
           update_segment(*segment);
         }
         break;  
@@ -92,28 +85,63 @@ void SegmentProgressAbr::registerMetrics(const abr_schema::Metrics &metrics) {
   }
 }
 
+void SegmentProgressAbr::registerDelivery(const abr_schema::Delivery &delivery) {
+  if (delivery.index <= decision_index - SegmentProgressConstants::history) {
+    return;
+  }
+  deliveries[delivery.index] = delivery;
+}
+
+void SegmentProgressAbr::registerSession(const abr_schema::Session &session) {
+  this->session = session;
+  if (session.interfaces != nullptr) {
+    interfaces = session.interfaces;
+    bindInterfaces();
+  }
+}
+
+void SegmentProgressAbr::bindInterfaces() {}
+
+int SegmentProgressAbr::startQuality() const {
+  int quality = 0;
+  double budget = SegmentProgressConstants::start_bandwidth_share * session.bandwidth;
+  for (int i = 0; i < int(bitrate_array.size()); ++i) {
+    if (bitrate_array[i] <= budget) {
+      quality = i;
+    }
+  }
+  return quality;
+}
+
 bool SegmentProgressAbr::should_send(int index) {
   if (index == 1) {
     return true;
   }
 
-  if (last_segment.find(index - 1) == last_segment.end()) {
+  const abr_schema::Delivery* delivery = deliveries.find(index - 1);
+  if (delivery != nullptr && (delivery->state == abr_schema::Delivery::DOWNLOADED
+                              || 1.0 * delivery->acked / delivery->total >= 0.8)) {
+    // the ACKs show the segment more than 80% delivered before the front-end does
+    return true;
+  }
+
+  const abr_schema::Segment* segment = last_segment.find(index - 1);
+  if (segment == nullptr) {
     // no stats from previous segment
     return false;
   }
 
-  auto segment = last_segment[index - 1];
-  if (segment.state != abr_schema::Segment::PROGRESS) {
+  if (segment->state != abr_schema::Segment::PROGRESS) {
     // segment has already been downloaded or loaded
     return true;
   }
 
-  if (1.0 * segment.loaded / segment.total >= 0.8) {
+  if (1.0 * segment->loaded / segment->total >= 0.8) {
     // segment has been downloaded more than 80%
     return true;
   }
 
-  if (aborted.find(index - 1) != aborted.end()) {
+  if (aborted.contains(index - 1)) {
     return true;
   }
 
@@ -122,7 +150,12 @@ bool SegmentProgressAbr::should_send(int index) {
 
 abr_schema::Decision SegmentProgressAbr::decide() { 
   int to_decide = decision_index;
-  if (decisions.find(to_decide) == decisions.end() && should_send(to_decide)) {
+  if (!decisions.contains(to_decide) && should_send(to_decide)) {
+    if (predictor != nullptr) {
+      // plan with the segments learned since the last decision
+      catalog = predictor->Snapshot();
+    }
+
     // decisions should be idempotent
     decisions[to_decide] = abr_schema::Decision(
       to_decide, 
@@ -131,7 +164,7 @@ abr_schema::Decision SegmentProgressAbr::decide() {
     );
     decision_index += 1;
 
-    QUIC_LOG(WARNING) << "[SegmentProgressAbr] new decision: [index] " << decisions[to_decide].index
+    ABRCC_LOG(WARNING) << "[SegmentProgressAbr] new decision: [index] " << decisions[to_decide].index
                       << " [quality] " << decisions[to_decide].quality;
     return decisions[to_decide];
   } else {
@@ -145,9 +178,9 @@ RandomAbr::RandomAbr(const std::shared_ptr<DashBackendConfig>& config)
 RandomAbr::~RandomAbr() {}
 
 int RandomAbr::decideQuality(int index) {
-  int random_quality = rand() % segments.size();
+  int random_quality = rand() % catalog->qualities();
   if (index == 1) {
-    random_quality = 0;
+    random_quality = startQuality();
   }
   return random_quality;
 }
@@ -180,25 +213,37 @@ int BBAbr::decideQuality(int index) {
   int n = bitrate_array.size();
   
   if (index == 1) {
-    return 0;
+    return startQuality();
   }
  
   int buffer_level = last_buffer_level.value; 
-  if (last_segment[index - 1].state == abr_schema::Segment::PROGRESS) { 
+  const abr_schema::Delivery* delivery = deliveries.find(index - 1);
+  if (delivery != nullptr) {
+    if (delivery->state == abr_schema::Delivery::PROGRESS && delivery->acked > 0) {
+      // the rest of the segment at the rate its ACKs came so far
+      double proportion = 1.0 * delivery->acked / delivery->total;
+      int download_time = 1.0 * delivery->elapsedMs() * (1 - proportion) / proportion;
+
+      if (index < catalog->segments()) {
+        last_segment_time_length = catalog->durationMs(0, index);
+      }
+      buffer_level += last_segment_time_length - download_time;
+    }
+  } else if (last_segment[index - 1].state == abr_schema::Segment::PROGRESS) { 
     int start_time = index > 2 ? last_segment[index - 2].timestamp : 0;
     int current_time = last_segment[index - 1].timestamp;
 
     double proportion = 1.0 * last_segment[index - 1].loaded / last_segment[index - 1].total;
     int download_time = 1.0 * (current_time - start_time) * (1 - proportion) / proportion;
     
-    if (index < int(segments[0].size())) {
-      last_segment_time_length = int(SECOND * (segments[0][index + 1].start_time - segments[0][index].start_time));
+    if (index < catalog->segments()) {
+      last_segment_time_length = catalog->durationMs(0, index);
     }
     int bonus = last_segment_time_length - download_time; 
   
     buffer_level += bonus;  
   } 
-  QUIC_LOG(WARNING) << " [last buffer level] " << buffer_level;
+  ABRCC_LOG(WARNING) << " [last buffer level] " << buffer_level;
 
   if (buffer_level <= RESERVOIR) {
     bitrate = bitrate_array[0];
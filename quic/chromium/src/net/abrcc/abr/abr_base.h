@@ -6,37 +6,65 @@
 
 // data structure deps
 #include "net/abrcc/dash_config.h"
+#include "net/abrcc/segment_predictor.h"
+#include "net/abrcc/structs/index_window.h"
+#include "net/abrcc/video_catalog.h"
 
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 // interfaces
 #include "net/abrcc/abr/interface.h"
 #include "net/abrcc/cc/bbr_adapter.h"
+#include "net/abrcc/cc/connection_interfaces.h"
 
 
 namespace quic {
 
+namespace SegmentProgressConstants {
+  // segments of per-session state kept around the decision index: the policies
+  // only look a couple of segments back, and metrics of older segments are dropped
+  const int history = 8;
+
+  // share of a resumed connection's bandwidth estimate that the first segment's
+  // bitrate may take, as the estimate is the previous connection's
+  const double start_bandwidth_share = 0.7;
+}
+
 // SegmentProgressAbr is a class that downloads the segments one after the other 
 // and makes the decision for the next segment when the download of a segments is at 80\%,
-// allowing for continous streaming.
+// allowing for continous streaming. The download progress is the server's ACKs' when
+// measured, and the front-end's otherwise.
 //
 // To use the SegmentProcessAbr class, only the `decideQuality` function needs to be 
 // implemented: it asks for the quality for segment `decision_index`.
 // 
 // The protected members can be used by class that inherit from SegmentProgressAbr:
-//   - last_segment: map that contains the lastest timestamped segment information for each 
+//   - last_segment: window that contains the lastest timestamped segment information for each 
 //                   downloaded(or started download) segment
-//   - decisions: map of previous Decisions
-//   - aborted: mpa of previous aborted segments 
+//   - decisions: window of previous Decisions
+//   - aborted: window of previous aborted segments 
+//   - deliveries: window of the lastest server-side delivery state of each segment
+//   - session: the player's latest connection, resumed or not
+//   The windows hold the last SegmentProgressConstants::history segments, so the
+//   per-session state does not grow with the length of the stream.
 //   
 //   - decision_index: current segment that needs a Decision
 //   - last_timestamp: the highest timestamp for any received Segment 
 //   - last_segment_time_length: the previous segment's time length in milliseconds
 // 
-//   - segments: metadata structure for the whole video(a vector of VideoInfo per track)
+//   - catalog: metadata structure for the whole video, shared by all sessions; if the
+//              configuration does not describe all the segments(e.g. live streams),
+//              it is the predictor's latest snapshot before each decision
 //   - bitrate_array: the list of qualities(in kbps) in increasing order
+//
+// Policies that can not pick the first segments' quality from the session's own
+// measurements start with `startQuality()`: the lowest quality for connections that
+// started cold, and the highest one fitting the previous connection's estimate for
+// resumed connections.
+//
+// Policies steering the congestion control resolve their CC interface from
+// `interfaces` in `bindInterfaces()`. Until the first session is registered the
+// interfaces are attached to no connection.
 class SegmentProgressAbr : public AbrInterface {
  public:
   SegmentProgressAbr(const std::shared_ptr<DashBackendConfig>& config);
@@ -44,21 +72,31 @@ class SegmentProgressAbr : public AbrInterface {
 
   void registerMetrics(const abr_schema::Metrics &) override;
   void registerAbort(const int) override;
+  void registerDelivery(const abr_schema::Delivery &) override;
+  void registerSession(const abr_schema::Session &) override;
   abr_schema::Decision decide() override;
 
   virtual int decideQuality(int index) = 0; 
  protected:
   const std::shared_ptr<DashBackendConfig>& config;
-  std::unordered_map<int, abr_schema::Segment> last_segment;  
-  std::unordered_map<int, abr_schema::Decision> decisions; 
-  std::unordered_set<int> aborted;
+  structs::IndexWindow<abr_schema::Segment> last_segment;  
+  structs::IndexWindow<abr_schema::Decision> decisions; 
+  structs::IndexWindow<bool> aborted;
+  structs::IndexWindow<abr_schema::Delivery> deliveries;
+  abr_schema::Session session;
+  std::shared_ptr<ConnectionInterfaces> interfaces;
 
   int decision_index;
   int last_timestamp;
   int last_segment_time_length;
 
-  std::vector< std::vector<VideoInfo> > segments;
-  std::vector<int> bitrate_array;
+  std::shared_ptr<const VideoCatalog> catalog;
+  const std::vector<int>& bitrate_array;
+  std::shared_ptr<SegmentPredictor> predictor;
+
+  int startQuality() const;
+  // called once `interfaces` is replaced by a registered session's
+  virtual void bindInterfaces();
  private:
   void update_segment(abr_schema::Segment segment);
   bool should_send(int index);
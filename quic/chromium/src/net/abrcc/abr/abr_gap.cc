@@ -4,7 +4,7 @@
 #include "net/abrcc/dash_config.h"
 #include "net/abrcc/abr/interface.h"
 #include "net/abrcc/service/schema.h"
-#include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
 
 // data struct dependecies
 #include "net/abrcc/structs/estimators.h" // LineFitEstimator
@@ -53,27 +53,16 @@ namespace quic {
 
 GapAbr::GapAbr(const std::shared_ptr<DashBackendConfig>& config) 
   : TargetAbr2(config)
-  , gap_interface(BbrGap::BbrInterface::GetInstance()) {} 
+  , gap_interface(interfaces->gap()) {} 
 
 GapAbr::~GapAbr() {}
 
-
-static int get_segment_length_ms(
-  const std::vector< std::vector<VideoInfo> >& segments,
-  const int current_index,
-  const int chunk_quality
-) {
-  int ref_index = current_index + 1;
-  while (ref_index + 1 >= int(segments[chunk_quality].size())) {
-    ref_index--;
-  }
-  int segment_length_ms = int(double(::SECOND) * 
-    (segments[chunk_quality][ref_index + 1].start_time 
-    - segments[chunk_quality][ref_index].start_time)
-  );
-  return segment_length_ms;
+void GapAbr::bindInterfaces() {
+  TargetAbr2::bindInterfaces();
+  gap_interface = interfaces->gap();
 }
 
+
 void GapAbr::registerMetrics(const abr_schema::Metrics &metrics) {
   SegmentProgressAbr::registerMetrics(metrics);
 
@@ -98,12 +87,12 @@ void GapAbr::registerMetrics(const abr_schema::Metrics &metrics) {
   // Get the bandwidth estiamte as the maximum delivery rate 
   // encountered from the last metrics registeration: i.e. 100ms
   // [GapAbr] we want to use estimates from both interfaces since we don't
-  // know which one will be used
+  // know which one will be used; the app-limited samples are left out
   int best_bw_estimate = 0;
-  for (auto &delivery_rate : interface->popDeliveryRates()) {
+  for (auto &delivery_rate : interface->popBurstDeliveryRates()) {
     best_bw_estimate = std::max(best_bw_estimate, delivery_rate);
   }
-  for (auto &delivery_rate : gap_interface->popDeliveryRates()) {
+  for (auto &delivery_rate : gap_interface->popBurstDeliveryRates()) {
     best_bw_estimate = std::max(best_bw_estimate, delivery_rate);
   }
 
@@ -117,24 +106,31 @@ void GapAbr::registerMetrics(const abr_schema::Metrics &metrics) {
     bw_estimator->sample(bw_value);
   }
  
-  // [StateTracker] update rtt estiamte
+  // [StateTracker] update rtt estiamte; as for the bandwidth, the CC is
+  // attached to either of the interfaces
   auto rtt = interface->RttEstimate();
+  if (rtt == base::nullopt) {
+    rtt = gap_interface->RttEstimate();
+  }
   if (rtt != base::nullopt) {
     last_rtt = abr_schema::Value(rtt.value(), last_timestamp);
   }
 
   if (last_bandwidth != base::nullopt) {
-    QUIC_LOG(WARNING) << " [last bw] " << last_bandwidth.value().value;
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << " [last bw] " << last_bandwidth.value().value;
   }
   if (!average_bandwidth->empty()) {
-    QUIC_LOG(WARNING) << " [bw avg] " << average_bandwidth->value();
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << " [bw avg] " << average_bandwidth->value();
   }
 
   adjustCC();
 } 
 
 int GapAbr::decideQuality(int index) {
-  if (index <= 1 || index > int(segments[0].size())) {
+  if (index <= 1) {
+    return startQuality();
+  }
+  if (index > catalog->segments()) {
     return 0; 
   }
 
@@ -150,15 +146,15 @@ int GapAbr::decideQuality(int index) {
 
   // if we are not looking at biggest quality
   double final_qoe_percentile = GapAbrConstants::qoe_percentile;
-  if (current_quality < int(segments.size()) - 1 && 
-      last_index < int(segments[0].size()) - GapAbrConstants::horizon_adjustment) {
+  if (current_quality < catalog->qualities() - 1 && 
+      last_index < catalog->segments() - GapAbrConstants::horizon_adjustment) {
     // find the index for the smallest index difference
     int index_lowest_difference = last_index + 1;
     int current_difference = 
-      segments[current_quality + 1][last_index + 1].vmaf - 
-      segments[current_quality][last_index + 1].vmaf; 
+      catalog->vmaf(current_quality + 1, last_index + 1) - 
+      catalog->vmaf(current_quality, last_index + 1); 
     for (int i = last_index + 2; i <= last_index + GapAbrConstants::horizon_adjustment; ++i) {
-      int vmaf_diff = segments[current_quality + 1][i].vmaf - segments[current_quality][i].vmaf;
+      int vmaf_diff = catalog->vmaf(current_quality + 1, i) - catalog->vmaf(current_quality, i);
       if (vmaf_diff < current_difference) {
         current_difference = vmaf_diff;
         index_lowest_difference = i;
@@ -170,9 +166,9 @@ int GapAbr::decideQuality(int index) {
     int total_length = 0;
     for (int i = index_lowest_difference; 
              i < index_lowest_difference + GapAbrConstants::horizon_adjustment && 
-             i < int(segments[0].size()); ++i) {
-      total_size += segments[current_quality + 1][i].size; 
-      total_length += get_segment_length_ms(segments, i, current_quality + 1);
+             i < catalog->segments(); ++i) {
+      total_size += catalog->size(current_quality + 1, i); 
+      total_length += catalog->durationMs(current_quality + 1, i + 1);
     }
     int avg_needed_bw = 8 * total_size / total_length;
   
@@ -202,8 +198,8 @@ int GapAbr::decideQuality(int index) {
         }
       }
 
-      QUIC_LOG(WARNING) << "[GapAbr] gain: "  << gain;
-      QUIC_LOG(WARNING) << "[GapAbr] percentile: "  << final_qoe_percentile;
+      ABRCC_LOG(WARNING) << "[GapAbr] gain: "  << gain;
+      ABRCC_LOG(WARNING) << "[GapAbr] percentile: "  << final_qoe_percentile;
     }
   }
 
@@ -219,9 +215,9 @@ int GapAbr::decideQuality(int index) {
     bandwidth_target -= step;
   }
 
-  QUIC_LOG(WARNING) << "[GapAbr] bandwidth interval: [" << min_bw << ", " << max_bw << "]";
-  QUIC_LOG(WARNING) << "[GapAbr] bandwidth current: " << bandwidth;
-  QUIC_LOG(WARNING) << "[GapAbr] bandwidth target: " << bandwidth_target;
+  ABRCC_LOG(WARNING) << "[GapAbr] bandwidth interval: [" << min_bw << ", " << max_bw << "]";
+  ABRCC_LOG(WARNING) << "[GapAbr] bandwidth current: " << bandwidth;
+  ABRCC_LOG(WARNING) << "[GapAbr] bandwidth target: " << bandwidth_target;
 
   // Adjust target rate -- if the bandwidth estimate decreases, don't force further decrease,
   // that is, use std::max(bandwidth, bandwidth_target)
@@ -230,7 +226,7 @@ int GapAbr::decideQuality(int index) {
 
   // End game
   double safe_downscale = GapAbrConstants::safe_downscale;
-  if (last_index > int(segments[0].size()) - GapAbrConstants::horizon_adjustment) {
+  if (last_index > catalog->segments() - GapAbrConstants::horizon_adjustment) {
     safe_downscale = GapAbrConstants::endgame_safe_downscale;
   }
   // Congestion detection
@@ -49,6 +49,8 @@ class GapAbr : public TargetAbr2 {
   int decideQuality(int index) override;  
  
  private:
+  void bindInterfaces() override;
+
   // We use both BbrTarget::BbrInterface and BbrGap::gap_interface since we want
   // to allow both CC operation modes.
   BbrGap::BbrInterface* gap_interface; 
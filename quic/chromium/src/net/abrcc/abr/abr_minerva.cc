@@ -1,4 +1,5 @@
 #include "net/abrcc/abr/abr_minerva.h"
+#include "net/abrcc/logging/log.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wunused-function"
@@ -41,6 +42,8 @@ namespace MinervaConstants {
   const double rebufPenalty = 4.3;
   const double smoothPenalty = 1;
   const int horizon = 5;
+  // loading segments whose quality is kept
+  const int history = 4;
 
   const double beta = 2.5; 
   const double gamma = 100.; 
@@ -56,7 +59,12 @@ MinervaAbr::MinervaAbr(
     const std::shared_ptr<DashBackendConfig>& config,
     const std::string& minerva_config_path_,
     const bool normalize_)
-  : interface(MinervaInterface::GetInstance())
+  : catalog(VideoCatalog::ForConfig(config.get()))
+  // the configuration's catalog outlives the snapshots replacing `catalog`
+  , bitrate_array(catalog->bitrates())
+  , predictor(SegmentPredictor::ForConfig(config.get()))
+  , interfaces(new ConnectionInterfaces())
+  , interface(interfaces->minerva())
   , timestamp_(high_resolution_clock::now()) 
   , update_interval_(base::nullopt) 
   , started_rate_update(false)
@@ -64,79 +72,49 @@ MinervaAbr::MinervaAbr(
   , norm()
   , past_rates()
   , moving_average_rate(MinervaConstants::initMovingAverageRate) 
+  , segment_quality(MinervaConstants::history)
   , last_index(-1)
   , last_timestamp(0)
   , last_quality(-1) 
   , last_buffer(0, 0) {
+  if (predictor != nullptr) {
+    catalog = predictor->Snapshot();
+  }
 
   // compute normalization map
   computeNormalizationMap(minerva_config_path_);
-
-  // compute segments
-  segments = std::vector< std::vector<VideoInfo> >();
-  for (int i = 0; i < int(config->video_configs.size()); ++i) {
-    for (auto &video_config : config->video_configs) {
-      std::string resource = "/video" + std::to_string(i);
-      if (resource == video_config->resource) {
-        std::vector<VideoInfo> info;
-        for (auto &x : video_config->video_info) {
-          info.push_back(VideoInfo(
-            x->start_time,
-            x->vmaf,
-            x->size
-          ));  
-        }
-        segments.push_back(info);
-      }
-    }
-  }
-
-  // compute bitrate array
-  bitrate_array = std::vector<int>();
-  for (auto &video_config : config->video_configs) {
-    bitrate_array.push_back(video_config->quality);
-  }
-  sort(bitrate_array.begin(), bitrate_array.end());
 }
 MinervaAbr::~MinervaAbr() {}
 
 static double get_segment_length_sec(
-  const std::vector< std::vector<VideoInfo> >& segments,
+  const VideoCatalog& catalog,
   const int current_index,
   const int chunk_quality
 ) {
-  int ref_index = current_index;
-  while (ref_index + 1 >= int(segments[chunk_quality].size())) {
-    ref_index--;
-  }
-  int segment_length_ms = int(double(::SECOND) * 
-    (segments[chunk_quality][ref_index + 1].start_time 
-    - segments[chunk_quality][ref_index].start_time)
-  );
-  return segment_length_ms / ::SECOND;
+  return catalog.durationMs(chunk_quality, current_index) / ::SECOND;
 }
 
-static std::vector<double> get_scale(const std::vector< std::vector<VideoInfo> >& segments) {
+static std::vector<double> get_scale(const VideoCatalog& catalog) {
   std::vector<double> pqs;
   for (int rate = MinervaConstants::kbitmin; 
            rate <= MinervaConstants::kbitmax; 
            rate += MinervaConstants::kbitstep) {
     std::vector<double> segment_pqs;
-    for (int index = 0; index < int(segments[0].size()); ++index) {
+    for (int index = 0; index < catalog.segments(); ++index) {
       std::vector<double> rates;
-      for (int quality = 0; quality < int(segments.size()); ++quality) {
-        double time_s = get_segment_length_sec(segments, index, quality);
-        double size_kb = 8. * segments[quality][index].size / 1000.;
+      for (int quality = 0; quality < catalog.qualities(); ++quality) {
+        double time_s = get_segment_length_sec(catalog, index, quality);
+        double size_kb = catalog.kbits(quality, index);
         
         rates.push_back(size_kb / time_s);
       }
 
       double pq = 0;
       double downscaled_rate = MinervaConstants::downScale * rate;
-      for (int quality = 0; quality < int(segments.size()); ++quality) {
+      for (int quality = 0; quality < catalog.qualities(); ++quality) {
         if (rates[quality] <= downscaled_rate && (int(rates.size()) == quality + 1 || 
                                                   downscaled_rate <= rates[quality + 1])) {
-          pq = segments[quality][index].vmaf;
+          pq = catalog.vmaf(quality, index);
           break;
         }
       }
@@ -166,7 +144,7 @@ void MinervaAbr::computeNormalizationMap(const std::string& conf_path_) {
     if (file_name.find("json") != std::string::npos) {
       // paths list all configurations
       std::string config_path = conf_path_ + "/" + en->d_name;
-      QUIC_LOG(WARNING) << config_path;
+      ABRCC_LOG(WARNING) << config_path;
     
       // load the configuration json
       std::ifstream stream(config_path);
@@ -180,27 +158,8 @@ void MinervaAbr::computeNormalizationMap(const std::string& conf_path_) {
       base::JSONValueConverter<DashBackendConfig> converter;
       converter.Convert(*value, config.get()); 
       
-      // compute segments
-      std::vector<std::vector<VideoInfo> > segments = std::vector< std::vector<VideoInfo> >();
-      for (int i = 0; i < int(config->video_configs.size()); ++i) {
-        for (auto &video_config : config->video_configs) {
-          std::string resource = "/video" + std::to_string(i);
-          if (resource == video_config->resource) {
-            std::vector<VideoInfo> info;
-            for (auto &x : video_config->video_info) {
-              info.push_back(VideoInfo(
-                x->start_time,
-                x->vmaf,
-                x->size
-              ));  
-            }
-            segments.push_back(info);
-          }
-        }
-      }
-      
       // compute bitmap scale      
-      std::vector<double> scale = get_scale(segments); 
+      std::vector<double> scale = get_scale(*VideoCatalog::Build(*config)); 
       scales.push_back(scale);
     }
   }
@@ -240,6 +199,14 @@ double MinervaAbr::normalize(const double pq) const {
 
 
 void MinervaAbr::registerAbort(const int index) {}
+
+void MinervaAbr::registerSession(const abr_schema::Session &session) {
+  if (session.interfaces != nullptr) {
+    interfaces = session.interfaces;
+    interface = interfaces->minerva();
+  }
+}
+
 void MinervaAbr::registerMetrics(const abr_schema::Metrics &metrics) {
   // Update last buffer
   for (const auto& buffer : metrics.bufferLevel) {
@@ -252,8 +219,9 @@ void MinervaAbr::registerMetrics(const abr_schema::Metrics &metrics) {
   // Register loading segments
   for (const auto& segment : metrics.segments) {
     last_timestamp = std::max(last_timestamp, segment->timestamp);
-    if (segment->state == abr_schema::Segment::LOADING) {
-      last_segment[segment->index] = *segment;
+    if (segment->state == abr_schema::Segment::LOADING &&
+        segment->index > last_index - MinervaConstants::history) {
+      segment_quality[segment->index] = segment->quality;
       if (segment->index > last_index) {
         last_index = segment->index;
         last_quality = segment->quality;
@@ -340,8 +308,8 @@ void MinervaAbr::onWeightUpdate() {
   if (utility != MinervaConstants::initUtility) {
     double link_weight = 1. * moving_average_rate / utility;
 
-    QUIC_LOG(WARNING) << "[Minerva] Current moving average rate: " << moving_average_rate;
-    QUIC_LOG(WARNING) << "[Minerva] Weight updated: " << link_weight;
+    ABRCC_LOG(WARNING) << "[Minerva] Current moving average rate: " << moving_average_rate;
+    ABRCC_LOG(WARNING) << "[Minerva] Weight updated: " << link_weight;
 
     interface->setLinkWeight(link_weight);
   }
@@ -387,24 +355,24 @@ static std::vector<std::vector<int>> cartesian(int depth, int max) {
 }
 
 static double get_qoe(
-  std::vector<std::vector<VideoInfo> > &segments,
+  const VideoCatalog& catalog,
   int index,
   int quality, 
   int last_quality,
   int rebuffer
 ) {
   double qoe = 0;
-  qoe += segments[quality][index].vmaf;
+  qoe += catalog.vmaf(quality, index);
   if (last_quality != -1) {
-    qoe -= MinervaConstants::beta * std::abs(segments[quality][index].vmaf - segments[last_quality][index - 1].vmaf);
+    qoe -= MinervaConstants::beta * std::abs(catalog.vmaf(quality, index) - catalog.vmaf(last_quality, index - 1));
   }
   qoe -= MinervaConstants::gamma * rebuffer;
   return qoe;
 }
 
 static const std::tuple<int, double, double> get_best_rate(
-  std::vector<int> bitrates,
-  std::vector<std::vector<VideoInfo> > segments, 
+  const std::vector<int>& bitrates,
+  const VideoCatalog& catalog, 
   int index,
   int last_quality, 
   double buffer,
@@ -413,7 +381,7 @@ static const std::tuple<int, double, double> get_best_rate(
   // max reward
   double start_buffer = buffer;
   double max_reward = 0, best_rate = 0, rebuffer = 0, expected_qoe = 0; 
-  for (auto &combo : cartesian(MinervaConstants::horizon, segments.size())) {
+  for (auto &combo : cartesian(MinervaConstants::horizon, catalog.qualities())) {
     double current_rebuffer = 0;
     double current_buffer = start_buffer;
     double bitrate_sum = 0;
@@ -426,11 +394,11 @@ static const std::tuple<int, double, double> get_best_rate(
       int chunk_quality = combo[position];
       int current_index = index + position;
     
-      if (current_index >= int(segments[0].size())) {
+      if (current_index >= catalog.segments()) {
         break;
       }
 
-      double size = 8 * segments[chunk_quality][current_index].size / 1000. / 1000.; // in mb
+      double size = catalog.kbits(chunk_quality, current_index) / 1000.; // in mb
       double download_time = size / download_rate; // in s
 
       // simulate future buffer
@@ -440,11 +408,11 @@ static const std::tuple<int, double, double> get_best_rate(
       } else {
         current_buffer -= download_time;
       }
-      current_buffer += current_index + 1 < int(segments.size()) 
-        ?   segments[chunk_quality][current_index + 1].start_time 
-          - segments[chunk_quality][current_index].start_time
-        :   segments[chunk_quality][current_index].start_time
-          - segments[chunk_quality][current_index - 1].start_time;
+      current_buffer += current_index + 1 < catalog.qualities() 
+        ?   catalog.startTime(chunk_quality, current_index + 1) 
+          - catalog.startTime(chunk_quality, current_index)
+        :   catalog.startTime(chunk_quality, current_index)
+          - catalog.startTime(chunk_quality, current_index - 1);
       
       // liner reward for the buffer
       bitrate_sum += bitrates[chunk_quality];
@@ -452,7 +420,7 @@ static const std::tuple<int, double, double> get_best_rate(
       
       // update current expected qoe
       current_expected_qoe += get_qoe(
-        segments, current_index, chunk_quality, last_quality_, current_rebuffer
+        catalog, current_index, chunk_quality, last_quality_, current_rebuffer
       ); 
       
       // update last quality after the expected qoe was updated
@@ -480,6 +448,9 @@ double MinervaAbr::computeUtility() {
   if (last_index <= 1) {
     return MinervaConstants::initUtility;
   }
+  if (predictor != nullptr) {
+    catalog = predictor->Snapshot();
+  }
  
   // setting local variables
   int index = last_index;
@@ -490,27 +461,27 @@ double MinervaAbr::computeUtility() {
   const double phi2 = 1.;
  
   // computing past qoe
-  int last_segment_quality = last_segment[index].quality;
-  int prev_segment_quality = last_segment.find(index - 1) == last_segment.end() 
-    ? -1 : last_segment[index - 1].quality;
-  double past_qoe = get_qoe(segments, index, last_segment_quality, prev_segment_quality, 0);
-  QUIC_LOG(WARNING) << "Past qoe: " << past_qoe;
+  int last_segment_quality = segment_quality[index];
+  const int* prev_quality = segment_quality.find(index - 1);
+  int prev_segment_quality = prev_quality == nullptr ? -1 : *prev_quality;
+  double past_qoe = get_qoe(*catalog, index, last_segment_quality, prev_segment_quality, 0);
+  ABRCC_LOG(WARNING) << "Past qoe: " << past_qoe;
 
   // computing current qoe and vh
   auto &[cur_segment_quality, rebuffer, vh] = get_best_rate(
-    bitrate_array, segments, index + 1, last_quality, last_buffer.value, rate
+    bitrate_array, *catalog, index + 1, last_quality, last_buffer.value, rate
   );
-  QUIC_LOG(WARNING) << "Vh: " << vh;
-  double current_qoe = get_qoe(segments, index + 1, cur_segment_quality, last_segment_quality, rebuffer);
-  QUIC_LOG(WARNING) << "Curr qoe: " << current_qoe;
+  ABRCC_LOG(WARNING) << "Vh: " << vh;
+  double current_qoe = get_qoe(*catalog, index + 1, cur_segment_quality, last_segment_quality, rebuffer);
+  ABRCC_LOG(WARNING) << "Curr qoe: " << current_qoe;
 
   // compute utility
   double utility = (phi1 * past_qoe + phi2 * current_qoe + vh) / (1. + phi1 + phi2);
-  QUIC_LOG(WARNING) << "Utility: " << utility;
+  ABRCC_LOG(WARNING) << "Utility: " << utility;
 
   if (should_normalize) {
     utility = normalize(utility);
-    QUIC_LOG(WARNING) << "Normalized utility: " << utility;
+    ABRCC_LOG(WARNING) << "Normalized utility: " << utility;
   }
 
   return utility;
@@ -6,9 +6,13 @@
 
 // data structure deps
 #include "net/abrcc/dash_config.h"
+#include "net/abrcc/segment_predictor.h"
+#include "net/abrcc/structs/index_window.h"
+#include "net/abrcc/video_catalog.h"
 
 // interfaces
 #include "net/abrcc/abr/interface.h"
+#include "net/abrcc/cc/connection_interfaces.h"
 #include "net/abrcc/cc/minerva.h"
 
 // timestamps
@@ -16,8 +20,6 @@
 
 // utilities
 #include <deque>
-#include <unordered_map>
-#include <unordered_set>
 #include <vector>
 
 
@@ -36,11 +38,16 @@ class MinervaAbr : public AbrInterface {
 
   void registerMetrics(const abr_schema::Metrics &) override;
   void registerAbort(const int) override;
+  // Binds the Minerva interface of the session's connection.
+  void registerSession(const abr_schema::Session &) override;
   abr_schema::Decision decide() override;
  
-  std::vector< std::vector<VideoInfo> > segments;
-  std::vector<int> bitrate_array;
+  // the predictor's latest snapshot, if the title is longer than its configuration
+  std::shared_ptr<const VideoCatalog> catalog;
+  const std::vector<int>& bitrate_array;
  private:
+  std::shared_ptr<SegmentPredictor> predictor;
+
   // Compute normalization map when Minerva is initialized. The normalization map 
   // is a bitarte-perceptual quality mapping computed based on a set of configuration 
   // files located at the `conf_path_`. The mapping is computed by the avearge perceptual 
@@ -84,6 +91,8 @@ class MinervaAbr : public AbrInterface {
   void onStartRateUpdate();
   void onWeightUpdate();
   
+  // interfaces attached to no connection until the first session is registered
+  std::shared_ptr<ConnectionInterfaces> interfaces;
   MinervaInterface* interface; 
 
   std::chrono::high_resolution_clock::time_point timestamp_;
@@ -103,8 +112,9 @@ class MinervaAbr : public AbrInterface {
   std::deque<int> past_rates;
   double moving_average_rate;
 
-  // front-end state
-  std::unordered_map<int, abr_schema::Segment> last_segment;  
+  // front-end state: the quality of the last loading segments, as the past QoE
+  // only looks at the last 2 of them
+  structs::IndexWindow<int> segment_quality;
   int last_index;
   int last_timestamp;
   int last_quality;
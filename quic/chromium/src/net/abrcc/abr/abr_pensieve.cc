@@ -0,0 +1,291 @@
+#include "net/abrcc/abr/abr_pensieve.h"
+
+// interface dependencies
+#include "net/abrcc/dash_config.h"
+#include "net/abrcc/abr/interface.h"
+#include "net/abrcc/service/schema.h"
+#include "net/abrcc/logging/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <fstream>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-const-variable"
+
+namespace {
+  const double M_IN_K = 1000.0;
+}
+
+namespace quic {
+
+namespace PensieveConstants {
+  const int s_info = 6;
+  const int s_len = 8;
+  const int a_dim = 6; // width of the chunk sizes convolution input
+  const int hidden = 128;
+  const int filter_size = 4;
+  const int filter_tap = 1; // tap aligned with the input for `SAME` padding
+
+  const double buffer_norm_factor = 10.0;
+  const double chunk_til_video_end_cap = 48.0;
+  const double min_bw_est_mbps = 0.1;
+
+  const int default_quality = 0;
+  const int random_seed = 42;
+  const int rand_range = 1000;
+}
+
+namespace {
+  // Tensor order and shapes of the actor network: for each layer the
+  // weights are followed by the biases.
+  enum ActorParam {
+    SPLIT_0_W, SPLIT_0_B,
+    SPLIT_1_W, SPLIT_1_B,
+    SPLIT_2_W, SPLIT_2_B,
+    SPLIT_3_W, SPLIT_3_B,
+    SPLIT_4_W, SPLIT_4_B,
+    SPLIT_5_W, SPLIT_5_B,
+    DENSE_W, DENSE_B,
+    OUT_W, OUT_B,
+    ACTOR_PARAMS,
+  };
+
+  std::vector< std::vector<int> > actor_shapes(const int action_dim) {
+    const int hidden = PensieveConstants::hidden;
+    const int filter = PensieveConstants::filter_size;
+    return {
+      {1, hidden}, {hidden},
+      {1, hidden}, {hidden},
+      {filter, PensieveConstants::s_len, hidden}, {hidden},
+      {filter, PensieveConstants::s_len, hidden}, {hidden},
+      {filter, PensieveConstants::a_dim, hidden}, {hidden},
+      {1, hidden}, {hidden},
+      {6 * hidden, hidden}, {hidden},
+      {hidden, action_dim}, {action_dim},
+    };
+  }
+
+  inline float relu(const float x) {
+    return x > 0 ? x : 0;
+  }
+
+  // Draws from [low, high) as numpy's legacy `np.random.randint` does: masked
+  // rejection sampling over the 32-bit outputs of MT19937. A generator seeded as
+  // `np.random.seed` hence replays the baseline's draws.
+  int randint(std::mt19937& generator, const int low, const int high) {
+    uint32_t range = high - low - 1;
+    uint32_t mask = range;
+    for (int shift = 1; shift < 32; shift <<= 1) {
+      mask |= mask >> shift;
+    }
+    uint32_t value;
+    do {
+      value = generator() & mask;
+    } while (value > range);
+    return low + int(value);
+  }
+}
+
+
+PensieveAbr::PensieveAbr(
+  const std::shared_ptr<DashBackendConfig>& config,
+  const std::string& model_path_
+) : SegmentProgressAbr(config)
+  , PlayerTracker()
+  , model_loaded(false)
+  , state(PensieveConstants::s_info, std::vector<double>(PensieveConstants::s_len, 0))
+  , video_chunk_count(0)
+  , last_quality(PensieveConstants::default_quality)
+  , generator(PensieveConstants::random_seed) {
+  model_loaded = loadModel(model_path_);
+  if (!model_loaded) {
+    ABRCC_LOG(WARNING) << "[PensieveAbr] could not load model from " << model_path_
+                      << "; defaulting to quality " << PensieveConstants::default_quality;
+  }
+}
+PensieveAbr::~PensieveAbr() {}
+
+bool PensieveAbr::loadModel(const std::string& model_path_) {
+  std::ifstream stream(model_path_);
+  if (!stream.is_open()) {
+    return false;
+  }
+
+  int num_tensors = 0;
+  stream >> num_tensors;
+  if (num_tensors != ACTOR_PARAMS) {
+    return false;
+  }
+
+  auto shapes = actor_shapes(bitrate_array.size());
+  params = std::vector<Tensor>(num_tensors);
+  for (int i = 0; i < num_tensors; ++i) {
+    Tensor& tensor = params[i];
+
+    int ndims = 0, size = 1;
+    stream >> tensor.name >> ndims;
+    tensor.shape = std::vector<int>(std::max(ndims, 0));
+    for (auto& dim : tensor.shape) {
+      stream >> dim;
+      size *= dim;
+    }
+    if (!stream || tensor.shape != shapes[i]) {
+      ABRCC_LOG(WARNING) << "[PensieveAbr] unexpected shape for tensor " << tensor.name;
+      return false;
+    }
+
+    tensor.values = std::vector<float>(size);
+    for (auto& value : tensor.values) {
+      stream >> value;
+    }
+    if (!stream) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void PensieveAbr::registerMetrics(const abr_schema::Metrics &metrics) {
+  SegmentProgressAbr::registerMetrics(metrics);
+  PlayerTracker::registerMetrics(metrics);
+}
+
+void PensieveAbr::updateState() {
+  const int last = PensieveConstants::s_len - 1;
+  int chunks = catalog->segments();
+
+  // compute bandwidth measurement
+  double bandwidth = std::max(
+    lastThroughput(*catalog, predictor.get()), PensieveConstants::min_bw_est_mbps * M_IN_K);
+  double chunk_fetch_time = lastFetchTime();
+
+  // compute number of video chunks left
+  int video_chunk_remain = chunks - video_chunk_count;
+  video_chunk_count += 1;
+
+  // dequeue history record
+  for (auto& row : state) {
+    std::rotate(row.begin(), row.begin() + 1, row.end());
+  }
+
+  double total_buffer = bufferLevel();
+  state[0][last] = 1. * bitrate_array[last_quality] / bitrate_array.back();
+  state[1][last] = total_buffer / M_IN_K / PensieveConstants::buffer_norm_factor;
+  state[2][last] = bandwidth / M_IN_K / 8;
+  state[3][last] = chunk_fetch_time / M_IN_K / PensieveConstants::buffer_norm_factor;
+  int qualities = std::min(int(bitrate_array.size()), PensieveConstants::s_len);
+  for (int quality = 0; quality < qualities; ++quality) {
+    double size = video_chunk_count > chunks ? 0 :
+      catalog->size(quality, video_chunk_count - 1);
+    state[4][quality] = size / M_IN_K / M_IN_K;
+  }
+  state[5][last] = std::min(1. * video_chunk_remain, PensieveConstants::chunk_til_video_end_cap)
+                   / PensieveConstants::chunk_til_video_end_cap;
+}
+
+std::vector<float> PensieveAbr::predict() const {
+  const int hidden = PensieveConstants::hidden;
+  const int last = PensieveConstants::s_len - 1;
+
+  // the network is evaluated in single precision, as in TensorFlow
+  std::vector< std::vector<float> > input(state.size());
+  for (int i = 0; i < int(state.size()); ++i) {
+    input[i] = std::vector<float>(state[i].begin(), state[i].end());
+  }
+
+  auto fully_connected_scalar = [&](const int w, const int b, const float x, float* out) {
+    for (int o = 0; o < hidden; ++o) {
+      out[o] = relu(x * params[w].values[o] + params[b].values[o]);
+    }
+  };
+  auto conv_1d = [&](const int w, const int b, const std::vector<float>& x,
+                     const int channels, float* out) {
+    const float* kernel = params[w].values.data()
+      + PensieveConstants::filter_tap * channels * hidden;
+    for (int o = 0; o < hidden; ++o) {
+      float sum = 0;
+      for (int c = 0; c < channels; ++c) {
+        sum += x[c] * kernel[c * hidden + o];
+      }
+      out[o] = relu(sum + params[b].values[o]);
+    }
+  };
+
+  // merged features
+  std::vector<float> merge(6 * hidden);
+  fully_connected_scalar(SPLIT_0_W, SPLIT_0_B, input[0][last], merge.data());
+  fully_connected_scalar(SPLIT_1_W, SPLIT_1_B, input[1][last], merge.data() + hidden);
+  conv_1d(SPLIT_2_W, SPLIT_2_B, input[2], PensieveConstants::s_len, merge.data() + 2 * hidden);
+  conv_1d(SPLIT_3_W, SPLIT_3_B, input[3], PensieveConstants::s_len, merge.data() + 3 * hidden);
+  conv_1d(SPLIT_4_W, SPLIT_4_B, input[4], PensieveConstants::a_dim, merge.data() + 4 * hidden);
+  fully_connected_scalar(SPLIT_5_W, SPLIT_5_B, input[4][last], merge.data() + 5 * hidden);
+
+  // dense layer
+  std::vector<float> dense(params[DENSE_B].values);
+  for (int i = 0; i < int(merge.size()); ++i) {
+    const float* row = params[DENSE_W].values.data() + i * hidden;
+    for (int o = 0; o < hidden; ++o) {
+      dense[o] += merge[i] * row[o];
+    }
+  }
+  for (auto& value : dense) {
+    value = relu(value);
+  }
+
+  // softmax output
+  int action_dim = params[OUT_B].values.size();
+  std::vector<float> out(params[OUT_B].values);
+  for (int i = 0; i < hidden; ++i) {
+    const float* row = params[OUT_W].values.data() + i * action_dim;
+    for (int a = 0; a < action_dim; ++a) {
+      out[a] += dense[i] * row[a];
+    }
+  }
+  float max_logit = *std::max_element(out.begin(), out.end());
+  float sum = 0;
+  for (auto& value : out) {
+    value = expf(value - max_logit);
+    sum += value;
+  }
+  for (auto& value : out) {
+    value /= sum;
+  }
+  return out;
+}
+
+int PensieveAbr::decideQuality(int index) {
+  updateState();
+  if (!model_loaded) {
+    last_quality = PensieveConstants::default_quality;
+    return last_quality;
+  }
+
+  // sample the action from the cumulative distribution
+  std::vector<float> action_prob = predict();
+  int draw = randint(generator, 1, PensieveConstants::rand_range);
+  double threshold = 1. * draw / PensieveConstants::rand_range;
+
+  int quality = 0;
+  float cumsum = 0;
+  for (int a = 0; a < int(action_prob.size()); ++a) {
+    cumsum += action_prob[a];
+    if (cumsum > threshold) {
+      quality = a;
+      break;
+    }
+  }
+
+  ABRCC_LOG(WARNING) << "[PensieveAbr] bit rate " << quality;
+  last_quality = quality;
+  return quality;
+}
+
+}
+
+#pragma GCC diagnostic pop
+#pragma GCC diagnostic pop
@@ -0,0 +1,80 @@
+#ifndef ABRCC_ABR_ABR_PENSIEVE_H_
+#define ABRCC_ABR_ABR_PENSIEVE_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+// dependencies on other abr algorithms
+#include "net/abrcc/abr/abr_base.h" // SegmentProgressAbr
+#include "net/abrcc/abr/abr_robust_mpc.h" // PlayerTracker
+
+// data structure deps
+#include "net/abrcc/dash_config.h"
+
+// interfaces
+#include "net/abrcc/abr/interface.h"
+
+// utilities
+#include <random>
+#include <string>
+#include <vector>
+
+
+namespace quic {
+
+// Pensieve implementation based on the paper:
+//   http://web.mit.edu/pensieve/content/pensieve-sigcomm17.pdf
+//
+// The actor network is evaluated natively using the weights of the pretrained
+// TensorFlow model from `exp/abr/results`, exported by `exp/abr/export_pensieve.py`.
+// The state tracking and the network mirror the Python baseline `exp/abr/pensieve.py`,
+// and the actions are sampled from the same seeded draws, such that the decisions
+// match the baseline's up to the float rounding of the probabilities(see
+// `exp/abr/parity.py`).
+class PensieveAbr : public SegmentProgressAbr, public PlayerTracker {
+ public:
+  PensieveAbr(
+    const std::shared_ptr<DashBackendConfig>& config,
+    const std::string& model_path_
+  );
+  ~PensieveAbr() override;
+
+  void registerMetrics(const abr_schema::Metrics &) override;
+  int decideQuality(int index) override;
+ private:
+  // Dense tensor of network parameters in row-major order.
+  struct Tensor {
+    std::string name;
+    std::vector<int> shape;
+    std::vector<float> values;
+  };
+
+  // Loads the actor weights exported by `exp/abr/export_pensieve.py`. The file
+  // contains the number of tensors, followed by each tensor's name, number of
+  // dimensions, dimensions and values, in the order in which they were created
+  // by the actor network. Returns false if the file does not match the network.
+  bool loadModel(const std::string& model_path_);
+
+  // Computes the action probabilities for the current `state`. The 1D convolutions
+  // are applied on inputs of length 1 with `SAME` padding, so only the kernel tap
+  // aligned with the input contributes to the output.
+  std::vector<float> predict() const;
+
+  // Rolls the state history and appends the current observation.
+  void updateState();
+
+  std::vector<Tensor> params;
+  bool model_loaded;
+
+  std::vector< std::vector<double> > state;
+  int video_chunk_count;
+  int last_quality;
+
+  std::mt19937 generator;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
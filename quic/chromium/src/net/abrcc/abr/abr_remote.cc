@@ -4,7 +4,7 @@
 #include "net/abrcc/dash_config.h"
 #include "net/abrcc/abr/interface.h"
 #include "net/abrcc/service/schema.h"
-#include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
 
 // data struct dependecies
 #include "net/abrcc/structs/estimators.h" // LineFitEstimator
@@ -63,14 +63,20 @@ namespace quic {
 
 RemoteAbr::RemoteAbr(const std::shared_ptr<DashBackendConfig>& config) 
   : TargetAbr2(config)
-  , gap_interface(BbrGap::BbrInterface::GetInstance()) {
+  , gap_interface(interfaces->gap()) {
+  bindInterfaces();
+} 
+
+RemoteAbr::~RemoteAbr() {}
+
+void RemoteAbr::bindInterfaces() {
+  TargetAbr2::bindInterfaces();
+  gap_interface = interfaces->gap();
   interface->setPacingGainCycle(
     // Use normal pacing gain cycle so that the remote algorithm has full control
     std::vector<float>{1., 1., 1., 1., 1., 1., 1., 1.}
   );
-} 
-
-RemoteAbr::~RemoteAbr() {}
+}
 
 void RemoteAbr::registerMetrics(const abr_schema::Metrics &metrics) {
   SegmentProgressAbr::registerMetrics(metrics);
@@ -97,12 +103,12 @@ void RemoteAbr::registerMetrics(const abr_schema::Metrics &metrics) {
   // Get the bandwidth estiamte as the maximum delivery rate 
   // encountered from the last metrics registeration: i.e. 100ms
   // [RemoteAbr] we want to use estimates from both interfaces since we don't
-  // know which one will be used
+  // know which one will be used; the app-limited samples are left out
   int best_bw_estimate = 0;
-  for (auto &delivery_rate : interface->popDeliveryRates()) {
+  for (auto &delivery_rate : interface->popBurstDeliveryRates()) {
     best_bw_estimate = std::max(best_bw_estimate, delivery_rate);
   }
-  for (auto &delivery_rate : gap_interface->popDeliveryRates()) {
+  for (auto &delivery_rate : gap_interface->popBurstDeliveryRates()) {
     best_bw_estimate = std::max(best_bw_estimate, delivery_rate);
   }
 
@@ -116,17 +122,21 @@ void RemoteAbr::registerMetrics(const abr_schema::Metrics &metrics) {
     bw_estimator->sample(bw_value);
   }
  
-  // [StateTracker] update rtt estiamte
+  // [StateTracker] update rtt estiamte; as for the bandwidth, the CC is
+  // attached to either of the interfaces
   auto rtt = interface->RttEstimate();
+  if (rtt == base::nullopt) {
+    rtt = gap_interface->RttEstimate();
+  }
   if (rtt != base::nullopt) {
     last_rtt = abr_schema::Value(rtt.value(), last_timestamp);
   }
 
   if (last_bandwidth != base::nullopt) {
-    QUIC_LOG(WARNING) << " [last bw] " << last_bandwidth.value().value;
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << " [last bw] " << last_bandwidth.value().value;
   }
   if (!average_bandwidth->empty()) {
-    QUIC_LOG(WARNING) << " [bw avg] " << average_bandwidth->value();
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << " [bw avg] " << average_bandwidth->value();
   }
 
   adjustCC();
@@ -159,7 +169,7 @@ int RemoteAbr::getTargetDecision(
   struct hostent *host = gethostbyname("127.0.0.1");
 
   if (host == NULL || host->h_addr == NULL) {
-    QUIC_LOG(WARNING) << "Error retrieving DNS information!";
+    ABRCC_LOG(WARNING) << "Error retrieving DNS information!";
     return 0;  
   }
 
@@ -170,13 +180,13 @@ int RemoteAbr::getTargetDecision(
 
   sock = socket(AF_INET, SOCK_STREAM, 0);
   if (sock < 0) {
-      QUIC_LOG(WARNING) << "Error creating socket!";
+      ABRCC_LOG(WARNING) << "Error creating socket!";
       return 0;
   }
 
   if (connect(sock, (struct sockaddr *)&client, sizeof(client)) < 0) {
       close(sock);
-      QUIC_LOG(WARNING) << "Could not connect!";
+      ABRCC_LOG(WARNING) << "Could not connect!";
       return 0;
   }
 
@@ -187,8 +197,8 @@ int RemoteAbr::getTargetDecision(
   for (auto &x : sizes) sizes_.push_back(to_string<int>(x));
 
   if (vmafs.size() < RemoteAbrConstants::horizon_adjustment) {
-    QUIC_LOG(WARNING) << "Ignore end of video!";
-    QUIC_LOG(WARNING) << to_string<std::string>(vmafs_);
+    ABRCC_LOG(WARNING) << "Ignore end of video!";
+    ABRCC_LOG(WARNING) << to_string<std::string>(vmafs_);
     return 0;
   }
 
@@ -207,10 +217,10 @@ int RemoteAbr::getTargetDecision(
      << "Accept: application/json\r\n"
      << "\r\n\r\n";
   std::string request = ss.str();
-  QUIC_LOG(WARNING) << "Request: " << request;
+  ABRCC_LOG(WARNING) << "Request: " << request;
 
   if (send(sock, request.c_str(), request.length(), 0) != (int)request.length()) {
-      QUIC_LOG(WARNING) << "Error sending request!";
+      ABRCC_LOG(WARNING) << "Error sending request!";
       return 0;
   }
 
@@ -224,16 +234,19 @@ int RemoteAbr::getTargetDecision(
 
   if (std::regex_match(lines.back(), std::regex("[(-|+)|][0-9]+"))) {
     int decision = std::stoi(lines.back());
-    QUIC_LOG(WARNING) << "Remote target bandwidth: " << decision; 
+    ABRCC_LOG(WARNING) << "Remote target bandwidth: " << decision; 
     return decision;
   } else { 
-    QUIC_LOG(WARNING) << "Remote target bandwidth wrongly formatted!";
+    ABRCC_LOG(WARNING) << "Remote target bandwidth wrongly formatted!";
     return 0;
   }
 }
 
 int RemoteAbr::decideQuality(int index) {
-  if (index <= 1 || index > int(segments[0].size())) {
+  if (index <= 1) {
+    return startQuality();
+  }
+  if (index > catalog->segments()) {
     return 0; 
   }
 
@@ -252,15 +265,15 @@ int RemoteAbr::decideQuality(int index) {
   std::vector< std::vector<int> > sizes;
   
   for (int i = last_index; i < last_index + RemoteAbrConstants::horizon_adjustment; ++i) {
-    if (i >= int(segments[0].size())) {
+    if (i >= catalog->segments()) {
       continue;
     }
 
     std::vector<int> curr_vmaf;
     std::vector<int> curr_size;
-    for (int j = 0; j < int(segments.size()); ++j) { 
-      curr_vmaf.push_back((int)segments[j][i].vmaf);
-      curr_size.push_back(segments[j][i].size);
+    for (int j = 0; j < catalog->qualities(); ++j) { 
+      curr_vmaf.push_back((int)catalog->vmaf(j, i));
+      curr_size.push_back(catalog->size(j, i));
     }
 
     vmafs.push_back(curr_vmaf);
@@ -286,7 +299,7 @@ int RemoteAbr::decideQuality(int index) {
 
   // End game
   double safe_downscale = RemoteAbrConstants::safe_downscale;
-  if (last_index > int(segments[0].size()) - RemoteAbrConstants::horizon_adjustment) {
+  if (last_index > catalog->segments() - RemoteAbrConstants::horizon_adjustment) {
     safe_downscale = RemoteAbrConstants::endgame_safe_downscale;
   }
   // Congestion detection
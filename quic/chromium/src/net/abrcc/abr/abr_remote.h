@@ -30,6 +30,10 @@ class RemoteAbr : public TargetAbr2 {
   void registerMetrics(const abr_schema::Metrics &metrics) override;
   int decideQuality(int index) override;  
  private:
+  // Also resets the target's pacing gain cycle, such that the remote algorithm has
+  // full control.
+  void bindInterfaces() override;
+
   // Given the current state of the ABR:
   //   - avg_bandwidth: average bandwidth computed using a Wilder Moving Average 
   //   - currnet_bandwidth: the latest bandwidth as measured by BBR
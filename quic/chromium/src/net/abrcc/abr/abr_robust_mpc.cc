@@ -0,0 +1,262 @@
+#include "net/abrcc/abr/abr_robust_mpc.h"
+
+// interface dependencies
+#include "net/abrcc/dash_config.h"
+#include "net/abrcc/abr/interface.h"
+#include "net/abrcc/service/schema.h"
+#include "net/abrcc/logging/log.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-const-variable"
+
+namespace {
+  const double M_IN_K = 1000.0;
+}
+
+namespace quic {
+
+namespace PlayerTrackerConstants {
+  // segments tracked behind the last one; the getters only look 1 segment back
+  const int history = 4;
+}
+
+namespace RobustMpcConstants {
+  const double rebuf_penalty = 4.3;
+  const int horizon = 5;
+  const double min_bw_est_mbps = 0.1;
+}
+
+
+PlayerTracker::PlayerTracker()
+  : start_timestamp(PlayerTrackerConstants::history)
+  , quality(PlayerTrackerConstants::history)
+  , last_index(0)
+  , last_timestamp(0)
+  , last_buffer_level(abr_schema::Value(0, 0)) {
+  // the front-end considers the first segment to be requested at timestamp 0
+  start_timestamp[1] = 0;
+}
+PlayerTracker::~PlayerTracker() {}
+
+void PlayerTracker::registerMetrics(const abr_schema::Metrics &metrics) {
+  for (const auto& segment : metrics.segments) {
+    last_timestamp = std::max(last_timestamp, segment->timestamp);
+    if (segment->index <= last_index - PlayerTrackerConstants::history) {
+      continue;
+    }
+    if (!start_timestamp.contains(segment->index)) {
+      start_timestamp[segment->index] = segment->timestamp;
+    }
+    quality[segment->index] = segment->quality;
+    last_index = std::max(last_index, segment->index);
+  }
+
+  for (const auto& buffer_level : metrics.bufferLevel) {
+    if (buffer_level->timestamp > last_buffer_level.timestamp) {
+      last_buffer_level = *buffer_level;
+    }
+    last_timestamp = std::max(last_timestamp, buffer_level->timestamp);
+  }
+}
+
+int PlayerTracker::lastFetchTime() const {
+  if (last_index < 2) {
+    return 0;
+  }
+
+  const int* current = start_timestamp.find(last_index);
+  const int* previous = start_timestamp.find(last_index - 1);
+  if (current == nullptr || previous == nullptr) {
+    return 0;
+  }
+  return *current - *previous;
+}
+
+double PlayerTracker::lastThroughput(
+  const VideoCatalog& catalog, const SegmentPredictor* predictor
+) const {
+  int time = lastFetchTime();
+  if (time == 0) {
+    return 0;
+  }
+
+  // size of the previous segment, as downloaded by the front-end
+  const int* previous = quality.find(last_index - 1);
+  if (previous == nullptr || *previous < 0 ||
+      *previous >= catalog.qualities() ||
+      last_index - 2 >= catalog.segments()) {
+    return 0;
+  }
+  int bytes = predictor != nullptr
+    ? predictor->Size(*previous, last_index - 2)
+    : catalog.size(*previous, last_index - 2);
+  double size = 8. * bytes;
+  return size / time;
+}
+
+int PlayerTracker::bufferLevel() const {
+  int consumed = last_timestamp - last_buffer_level.timestamp;
+  return std::max(last_buffer_level.value - consumed, 0);
+}
+
+
+RobustMpcAbr::RobustMpcAbr(const std::shared_ptr<DashBackendConfig>& config)
+  : SegmentProgressAbr(config)
+  , PlayerTracker()
+  , last_quality(0)
+  , max_reward(0)
+  , best_quality(0) {}
+RobustMpcAbr::~RobustMpcAbr() {}
+
+void RobustMpcAbr::registerMetrics(const abr_schema::Metrics &metrics) {
+  SegmentProgressAbr::registerMetrics(metrics);
+  PlayerTracker::registerMetrics(metrics);
+}
+
+// Catalog position of the 1-based `index`; as `info[index - 1]` in Python, index 0
+// wraps to the last segment.
+static int catalogPosition(const int index, const int chunks) {
+  return index == 0 ? chunks - 1 : index - 1;
+}
+
+double RobustMpcAbr::chunkSizeMb(const int quality, const int index) const {
+  int chunks = catalog->segments();
+  if (index > chunks || index < 0) {
+    return 0;
+  }
+  return 8. * catalog->size(quality, catalogPosition(index, chunks)) / (M_IN_K * M_IN_K);
+}
+
+double RobustMpcAbr::chunkTime(const int quality, const int index) const {
+  int chunks = catalog->segments();
+  if (index > chunks || index < 0) {
+    return 0;
+  }
+
+  auto start_time = [&](const int idx) -> double {
+    if (idx > chunks || idx < 0) {
+      return 0;
+    }
+    return catalog->startTime(quality, catalogPosition(idx, chunks));
+  };
+  int ref_index = index == chunks ? index - 1 : index;
+  return start_time(ref_index + 1) - start_time(ref_index);
+}
+
+void RobustMpcAbr::search(
+  const int position,
+  const int depth,
+  const double buffer,
+  const double rebuffer,
+  const int bitrate_sum,
+  const int smoothness,
+  const int last_quality,
+  const int first_quality
+) {
+  if (position == depth) {
+    double reward = bitrate_sum / M_IN_K
+      - RobustMpcConstants::rebuf_penalty * rebuffer
+      - smoothness / M_IN_K;
+    if (reward > max_reward) {
+      max_reward = reward;
+      best_quality = first_quality;
+    }
+    return;
+  }
+
+  for (int quality = 0; quality < int(bitrate_array.size()); ++quality) {
+    double next_buffer = buffer;
+    double next_rebuffer = rebuffer;
+
+    // simulate future buffer
+    double download = download_time[position][quality];
+    if (next_buffer < download) {
+      next_rebuffer += download - next_buffer;
+      next_buffer = 0;
+    } else {
+      next_buffer -= download;
+    }
+    next_buffer += chunk_time[position][quality];
+
+    search(
+      position + 1,
+      depth,
+      next_buffer,
+      next_rebuffer,
+      bitrate_sum + bitrate_array[quality],
+      smoothness + abs(bitrate_array[quality] - bitrate_array[last_quality]),
+      quality,
+      position == 0 ? quality : first_quality
+    );
+  }
+}
+
+int RobustMpcAbr::decideQuality(int index) {
+  const int horizon = RobustMpcConstants::horizon;
+  const double min_bw = RobustMpcConstants::min_bw_est_mbps;
+
+  // compute bandwidth measurement
+  double bandwidth = std::max(lastThroughput(*catalog, predictor.get()) / M_IN_K, min_bw);
+  bandwidths.push_back(bandwidth);
+  if (int(bandwidths.size()) > horizon) {
+    bandwidths.pop_front();
+  }
+
+  // past error
+  if (past_bandwidth_ests.empty()) {
+    past_errors.push_back(0);
+  } else {
+    past_errors.push_back(fabs(past_bandwidth_ests.back() - bandwidth) / bandwidth);
+  }
+  if (int(past_errors.size()) > horizon) {
+    past_errors.pop_front();
+  }
+
+  // harmonic mean of past bandwidths
+  double inverse_sum = 0;
+  for (auto const& value : bandwidths) {
+    inverse_sum += 1. / value;
+  }
+  double harmonic_bandwidth = bandwidths.size() / inverse_sum;
+  double max_error = *std::max_element(past_errors.begin(), past_errors.end());
+
+  double future_bandwidth = std::max(harmonic_bandwidth / (1 + max_error), min_bw);
+  past_bandwidth_ests.clear();
+  past_bandwidth_ests.push_back(harmonic_bandwidth);
+  ABRCC_LOG(WARNING) << "[RobustMpcAbr] future bandwidth " << future_bandwidth;
+
+  // precompute per-position download and chunk times
+  int depth = std::min(catalog->segments() - index, horizon);
+  download_time.assign(std::max(depth, 0), std::vector<double>(bitrate_array.size()));
+  chunk_time.assign(std::max(depth, 0), std::vector<double>(bitrate_array.size()));
+  for (int position = 0; position < depth; ++position) {
+    for (int quality = 0; quality < int(bitrate_array.size()); ++quality) {
+      download_time[position][quality] =
+        chunkSizeMb(quality, index + position) / future_bandwidth;
+      chunk_time[position][quality] = chunkTime(quality, index + position);
+    }
+  }
+
+  // max reward
+  double start_buffer = bufferLevel() / M_IN_K;
+  max_reward = 0;
+  best_quality = 0;
+  if (depth > 0) {
+    search(0, depth, start_buffer, 0, 0, 0, last_quality, 0);
+  }
+
+  last_quality = best_quality;
+  return best_quality;
+}
+
+}
+
+#pragma GCC diagnostic pop
+#pragma GCC diagnostic pop
@@ -0,0 +1,111 @@
+#ifndef ABRCC_ABR_ABR_ROBUST_MPC_H_
+#define ABRCC_ABR_ABR_ROBUST_MPC_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+// dependencies on other abr algorithms
+#include "net/abrcc/abr/abr_base.h" // SegmentProgressAbr
+
+// data structure deps
+#include "net/abrcc/dash_config.h"
+#include "net/abrcc/segment_predictor.h"
+#include "net/abrcc/structs/index_window.h"
+#include "net/abrcc/video_catalog.h"
+
+// interfaces
+#include "net/abrcc/abr/interface.h"
+
+// utilities
+#include <deque>
+#include <vector>
+
+
+namespace quic {
+
+// Tracker that mirrors the front-end getters used as inputs by the Python
+// baselines in `exp/abr`(see `dash/src/algo/getters.ts`):
+//   - lastFetchTime: the difference between the download start timestamps of
+//                    the last 2 segments(LastFetchTimeGetter)
+//   - lastThroughput: the size of the previous segment over the last fetch
+//                     time in kbps(LastThrpGetter); given a predictor, the size is
+//                     the observed or predicted one rather than the snapshot's
+//                     upper bound, which would inflate the throughput
+//   - bufferLevel: the latest buffer level(ms) drained until the latest seen
+//                  timestamp(BufferLevelGetter)
+class PlayerTracker {
+ public:
+  PlayerTracker();
+  virtual ~PlayerTracker();
+
+  void registerMetrics(const abr_schema::Metrics &);
+
+  int lastFetchTime() const;
+  double lastThroughput(
+    const VideoCatalog& catalog, const SegmentPredictor* predictor = nullptr) const;
+  int bufferLevel() const;
+ private:
+  // start timestamps and qualities of the last segments
+  structs::IndexWindow<int> start_timestamp;
+  structs::IndexWindow<int> quality;
+  int last_index;
+  int last_timestamp;
+
+  abr_schema::Value last_buffer_level;
+};
+
+// RobustMpc implementation based on the paper:
+//   https://users.ece.cmu.edu/~vsekar/papers/sigcomm15_mpcdash.pdf
+//
+// The implementation follows the Python baseline found in `exp/abr/robust_mpc.py`:
+// the future bandwidth is the harmonic mean of the last `horizon` throughputs
+// discounted by the maximum relative error of the past estimates, while the plan
+// maximizes the linear QoE over the next `horizon` segments. Given the same inputs,
+// its decisions are the baseline's, which `exp/abr/parity.py` checks on the
+// decisions logged by the simulator benchmark; they differ once the catalog holds
+// predicted segments.
+class RobustMpcAbr : public SegmentProgressAbr, public PlayerTracker {
+ public:
+  RobustMpcAbr(const std::shared_ptr<DashBackendConfig>& config);
+  ~RobustMpcAbr() override;
+
+  void registerMetrics(const abr_schema::Metrics &) override;
+  int decideQuality(int index) override;
+ private:
+  // Chunk size in megabits and chunk length in seconds, using the same 1-based
+  // indexing as `exp/abr/video.py`, index 0 included.
+  double chunkSizeMb(const int quality, const int index) const;
+  double chunkTime(const int quality, const int index) const;
+
+  // Exhaustive search over all quality plans of length `depth`. Plans are explored
+  // depth-first in lexicographic order, sharing the simulated prefix between plans;
+  // this visits plans in the same order as Python's `itertools.product`, so the
+  // first plan with a strictly better reward wins in both implementations.
+  void search(
+    const int position,
+    const int depth,
+    const double buffer,
+    const double rebuffer,
+    const int bitrate_sum,
+    const int smoothness,
+    const int last_quality,
+    const int first_quality
+  );
+
+  std::deque<double> bandwidths;
+  std::deque<double> past_errors;
+  std::deque<double> past_bandwidth_ests;
+  int last_quality;
+
+  // per-decision search state
+  std::vector< std::vector<double> > download_time;
+  std::vector< std::vector<double> > chunk_time;
+  double max_reward;
+  int best_quality;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -4,7 +4,7 @@
 #include "net/abrcc/dash_config.h"
 #include "net/abrcc/abr/interface.h"
 #include "net/abrcc/service/schema.h"
-#include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
 
 // data struct dependecies
 #include "net/abrcc/structs/estimators.h" // LineFitEstimator
@@ -61,7 +61,7 @@ namespace TargetAbrConstants {
 
 TargetAbr::TargetAbr(const std::shared_ptr<DashBackendConfig>& config) 
   : SegmentProgressAbr(config) 
-  , StateTracker(bitrate_array)
+  , StateTracker(bitrate_array, interfaces->adapter())
   , bw_estimator(new structs::LineFitEstimator<double>(
       TargetAbrConstants::bandwidth_window,
       TargetAbrConstants::time_delta,
@@ -72,8 +72,12 @@ TargetAbr::TargetAbr(const std::shared_ptr<DashBackendConfig>& config)
 
 TargetAbr::~TargetAbr() {}
 
+void TargetAbr::bindInterfaces() {
+  interface = interfaces->adapter();
+}
+
 int TargetAbr::vmaf(const int quality, const int index) {
-  return segments[quality][index].vmaf;
+  return catalog->vmaf(quality, index);
 }
 
 namespace {
@@ -145,23 +149,6 @@ namespace {
   }
 }
 
-static int get_segment_length_ms(
-  const std::vector< std::vector<VideoInfo> >& segments,
-  const int current_index,
-  const int chunk_quality
-) {
-  // [TODO] should we use current_index or current_index + 1?
-  int ref_index = current_index + 1;
-  while (ref_index + 1 >= int(segments[chunk_quality].size())) {
-    ref_index--;
-  }
-  int segment_length_ms = int(double(::SECOND) * 
-    (segments[chunk_quality][ref_index + 1].start_time 
-    - segments[chunk_quality][ref_index].start_time)
-  );
-  return segment_length_ms;
-}
-
 double TargetAbr::localQoe(int current_vmaf, int last_vmaf, int rebuffer, int buffer) {
   return 1. * TargetAbrConstants::alpha * current_vmaf
     - 1. * TargetAbrConstants::beta * fabs(current_vmaf - last_vmaf)
@@ -207,19 +194,19 @@ std::pair<double, int> TargetAbr::qoe(const double bandwidth) {
  
   int max_segment = 0;
   for (int current_index = last_index; current_index < start_index + TargetAbrConstants::horizon; ++current_index) {
-    if (current_index + 2 >= int(segments[0].size())) {
+    if (current_index + 2 >= catalog->segments()) {
       continue;  
     }
 
     std::unordered_set<state_t, std::function<size_t (const state_t&)> > next_states(0, hash);
     for (auto &from : curr_states) {
-      int max_quality = std::min(int(segments.size()) - 1, from.quality + 1);
+      int max_quality = std::min(catalog->qualities() - 1, from.quality + 1);
       int min_quality = std::max(0, from.quality - 2);
       for (int chunk_quality = min_quality; chunk_quality <= max_quality; ++chunk_quality) {
         double current_buffer = from.buffer * buffer_unit;
         double rebuffer = 0;
         
-        double size_kb = 8. * segments[chunk_quality][current_index + 1].size / ::SECOND;
+        double size_kb = catalog->kbits(chunk_quality, current_index + 1);
         double download_time_ms = size_kb / bandwidth * ::SECOND;
 
         // simulate buffer changes
@@ -230,7 +217,7 @@ std::pair<double, int> TargetAbr::qoe(const double bandwidth) {
           current_buffer -= download_time_ms;
         }
 
-        int segment_length_ms = get_segment_length_ms(segments, current_index, chunk_quality);
+        int segment_length_ms = catalog->durationMs(chunk_quality, current_index + 1);
         current_buffer += segment_length_ms;
         current_buffer = std::min(current_buffer, 1. * max_buffer * buffer_unit);
 
@@ -260,7 +247,7 @@ std::pair<double, int> TargetAbr::qoe(const double bandwidth) {
   // find best series of segments
   state_t best = null_state;
   for (int buffer = 0; buffer <= max_buffer; ++buffer) {
-    for (int chunk_quality = 0; chunk_quality < int(segments.size()); ++chunk_quality) {
+    for (int chunk_quality = 0; chunk_quality < catalog->qualities(); ++chunk_quality) {
       state_t cand(max_segment, buffer, chunk_quality);
       if (dp.find(cand) != dp.end() && (best == null_state || dp[cand].qoe >= dp[best].qoe)) { 
         best = cand;
@@ -269,7 +256,7 @@ std::pair<double, int> TargetAbr::qoe(const double bandwidth) {
   }
  
   if (best == null_state) {
-    QUIC_LOG(WARNING) << "[TargetAbr] keeping quality"; 
+    ABRCC_LOG(WARNING) << "[TargetAbr] keeping quality"; 
     return std::make_pair(0, current_quality);
   }
 
@@ -283,12 +270,14 @@ std::pair<double, int> TargetAbr::qoe(const double bandwidth) {
   std::reverse(states.begin(), states.end());
   state_t first = states.size() > 1 ? states[1] : states[0];
  
+  // qoe is evaluated for every candidate bandwidth target, so the path is only
+  // logged in debug builds
   for (auto state : states) {
-    QUIC_LOG(WARNING) << state;
+    ABRCC_LOG(INFO) << state;
   }
 
-  QUIC_LOG(WARNING) << "[TargetAbr] first: " << first << ' ' << dp[first];
-  QUIC_LOG(WARNING) << "[TargetAbr] best: " << best << ' ' << dp[best];
+  ABRCC_LOG(INFO) << "[TargetAbr] first: " << first << ' ' << dp[first];
+  ABRCC_LOG(INFO) << "[TargetAbr] best: " << best << ' ' << dp[best];
   return std::make_pair(dp[best].qoe, first.quality);
 }
 
@@ -308,12 +297,15 @@ void TargetAbr::registerMetrics(const abr_schema::Metrics &metrics) {
 } 
 
 int TargetAbr::decideQuality(int index) {
-  if (index <= 1 || index > int(segments[0].size())) {
+  if (index <= 1) {
+    return startQuality();
+  }
+  if (index > catalog->segments()) {
     return 0; 
   }
 
   int bandwidth = (int)average_bandwidth->value_or(bitrate_array[0]);
-  QUIC_LOG(WARNING) << bandwidth << '\n';
+  ABRCC_LOG(INFO) << bandwidth << '\n';
 
   // Get search range for bandwidth target
   int estimator = (int)bw_estimator->value_or(bandwidth);
@@ -322,7 +314,7 @@ int TargetAbr::decideQuality(int index) {
     estimator = bandwidth;
   }
 
-  QUIC_LOG(WARNING) << estimator << '\n';
+  ABRCC_LOG(INFO) << estimator << '\n';
   int min_bw = int(fmin(estimator, bandwidth) * (1. - TargetAbrConstants::qoe_delta));
   int max_bw = int(estimator * (1. + TargetAbrConstants::qoe_delta));
   
@@ -339,10 +331,10 @@ int TargetAbr::decideQuality(int index) {
     bandwidth_target -= step;
   }
 
-  QUIC_LOG(WARNING) << "[TargetAbr] bandwidth interval: [" << min_bw << ", " << max_bw << "]";
-  QUIC_LOG(WARNING) << "[TargetAbr] bandwidth current: " << bandwidth;
-  QUIC_LOG(WARNING) << "[TargetAbr] bandwidth estimator: " << estimator;
-  QUIC_LOG(WARNING) << "[TargetAbr] bandwidth target: " << bandwidth_target;
+  ABRCC_LOG(WARNING) << "[TargetAbr] bandwidth interval: [" << min_bw << ", " << max_bw << "]";
+  ABRCC_LOG(WARNING) << "[TargetAbr] bandwidth current: " << bandwidth;
+  ABRCC_LOG(WARNING) << "[TargetAbr] bandwidth estimator: " << estimator;
+  ABRCC_LOG(WARNING) << "[TargetAbr] bandwidth target: " << bandwidth_target;
 
   // Return next quality
   return qoe(TargetAbrConstants::safe_downscale * bandwidth).second;
@@ -357,7 +349,7 @@ void TargetAbr::adjustCC() {
   int bandwidth = last_bandwidth.value().value;
   if (bandwidth != last_adjustment_bandwidth) {
     double proportion = 1. * bandwidth / bandwidth_target;
-    QUIC_LOG(WARNING) << "[TargetAbr] " << bandwidth << ' ' << proportion << '\n';
+    ABRCC_LOG(WARNING) << "[TargetAbr] " << bandwidth << ' ' << proportion << '\n';
     if (proportion >= 1.3) {
       interface->proposePacingGainCycle(std::vector<float>{1, 0.8, 1, 0.8, 1, 1, 1, 1});
     } else if (proportion >= 0.9) {
@@ -387,7 +379,7 @@ TargetAbr2::TargetAbr2(const std::shared_ptr<DashBackendConfig>& config)
       TargetAbrConstants::projection_window
     ))
   , bandwidth_target(bitrate_array[0]) 
-  , interface(BbrTarget::BbrInterface::GetInstance()) 
+  , interface(interfaces->target()) 
   , last_player_time(abr_schema::Value(0, 0)) 
   , last_buffer_level(abr_schema::Value(0, 0)) 
   , average_bandwidth(new structs::WilderEMA<double>(StateTrackerConstants::bandwidth_window))
@@ -397,8 +389,12 @@ TargetAbr2::TargetAbr2(const std::shared_ptr<DashBackendConfig>& config)
 
 TargetAbr2::~TargetAbr2() {}
 
+void TargetAbr2::bindInterfaces() {
+  interface = interfaces->target();
+}
+
 int TargetAbr2::vmaf(const int quality, const int index) {
-  return segments[quality][index].vmaf;
+  return catalog->vmaf(quality, index);
 }
 
 double TargetAbr2::localQoe(int current_vmaf, int last_vmaf, int rebuffer, int buffer) {
@@ -435,19 +431,19 @@ std::pair<double, int> TargetAbr2::qoe(const double bandwidth) {
 
   int max_segment = 0;
   for (int current_index = last_index; current_index < start_index + TargetAbrConstants::horizon; ++current_index) {
-    if (current_index + 2 >= int(segments[0].size())) {
+    if (current_index + 2 >= catalog->segments()) {
       continue;  
     }
 
     std::unordered_set<state_t, std::function<size_t (const state_t&)> > next_states(0, hash);
     for (auto &from : curr_states) {
-      int max_quality = std::min(int(segments.size()) - 1, from.quality + 1);
+      int max_quality = std::min(catalog->qualities() - 1, from.quality + 1);
       int min_quality = std::max(0, from.quality - 2);
       for (int chunk_quality = min_quality; chunk_quality <= max_quality; ++chunk_quality) {
         double current_buffer = from.buffer * buffer_unit;
         double rebuffer = 0;
         
-        double size_kb = 8. * segments[chunk_quality][current_index + 1].size / ::SECOND;
+        double size_kb = catalog->kbits(chunk_quality, current_index + 1);
         double download_time_ms = size_kb / bandwidth * ::SECOND;
 
         // simulate buffer changes
@@ -458,7 +454,7 @@ std::pair<double, int> TargetAbr2::qoe(const double bandwidth) {
           current_buffer -= download_time_ms;
         }
 
-        int segment_length_ms = get_segment_length_ms(segments, current_index, chunk_quality);
+        int segment_length_ms = catalog->durationMs(chunk_quality, current_index + 1);
         current_buffer += segment_length_ms;
         current_buffer = std::min(current_buffer, 1. * max_buffer * buffer_unit);
 
@@ -487,7 +483,7 @@ std::pair<double, int> TargetAbr2::qoe(const double bandwidth) {
   // find best series of segments
   state_t best = null_state;
   for (int buffer = 0; buffer <= max_buffer; ++buffer) {
-    for (int chunk_quality = 0; chunk_quality < int(segments.size()); ++chunk_quality) {
+    for (int chunk_quality = 0; chunk_quality < catalog->qualities(); ++chunk_quality) {
       state_t cand(max_segment, buffer, chunk_quality);
       if (dp.find(cand) != dp.end() && (best == null_state || dp[cand].qoe >= dp[best].qoe)) { 
         best = cand;
@@ -496,7 +492,7 @@ std::pair<double, int> TargetAbr2::qoe(const double bandwidth) {
   }
  
   if (best == null_state) {
-    QUIC_LOG(WARNING) << "[TargetAbr2] keeping quality"; 
+    ABRCC_LOG(WARNING) << "[TargetAbr2] keeping quality"; 
     return std::make_pair(0, current_quality);
   }
 
@@ -510,8 +506,8 @@ std::pair<double, int> TargetAbr2::qoe(const double bandwidth) {
   std::reverse(states.begin(), states.end());
   state_t first = states.size() > 1 ? states[1] : states[0];
  
-  QUIC_LOG(WARNING) << "[TargetAbr2] first: " << first << ' ' << dp[first];
-  QUIC_LOG(WARNING) << "[TargetAbr2] best: " << best << ' ' << dp[best];
+  ABRCC_LOG(INFO) << "[TargetAbr2] first: " << first << ' ' << dp[first];
+  ABRCC_LOG(INFO) << "[TargetAbr2] best: " << best << ' ' << dp[best];
   return std::make_pair(dp[best].qoe, first.quality);
 }
 
@@ -538,9 +534,10 @@ void TargetAbr2::registerMetrics(const abr_schema::Metrics &metrics) {
  
   // [StateTracker] Update Bandwidth estimate
   // Get the bandwidth estiamte as the maximum delivery rate 
-  // encountered from the last metrics registeration: i.e. 100ms
+  // encountered from the last metrics registeration: i.e. 100ms; the app-limited
+  // samples, e.g. taken while waiting between segments, are left out
   int best_bw_estimate = 0;
-  for (auto &delivery_rate : interface->popDeliveryRates()) {
+  for (auto &delivery_rate : interface->popBurstDeliveryRates()) {
     best_bw_estimate = std::max(best_bw_estimate, delivery_rate);
   }
 
@@ -561,17 +558,20 @@ void TargetAbr2::registerMetrics(const abr_schema::Metrics &metrics) {
   }
 
   if (last_bandwidth != base::nullopt) {
-    QUIC_LOG(WARNING) << " [last bw] " << last_bandwidth.value().value;
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << " [last bw] " << last_bandwidth.value().value;
   }
   if (!average_bandwidth->empty()) {
-    QUIC_LOG(WARNING) << " [bw avg] " << average_bandwidth->value();
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << " [bw avg] " << average_bandwidth->value();
   }
 
   adjustCC();
 } 
 
 int TargetAbr2::decideQuality(int index) {
-  if (index <= 1 || index > int(segments[0].size())) {
+  if (index <= 1) {
+    return startQuality();
+  }
+  if (index > catalog->segments()) {
     return 0; 
   }
 
@@ -598,10 +598,10 @@ int TargetAbr2::decideQuality(int index) {
     bandwidth_target -= step;
   }
 
-  QUIC_LOG(WARNING) << "[TargetAbr2] bandwidth interval: [" << min_bw << ", " << max_bw << "]";
-  QUIC_LOG(WARNING) << "[TargetAbr2] bandwidth current: " << bandwidth;
-  QUIC_LOG(WARNING) << "[TargetAbr2] bandwidth estimator: " << estimator;
-  QUIC_LOG(WARNING) << "[TargetAbr2] bandwidth target: " << bandwidth_target;
+  ABRCC_LOG(WARNING) << "[TargetAbr2] bandwidth interval: [" << min_bw << ", " << max_bw << "]";
+  ABRCC_LOG(WARNING) << "[TargetAbr2] bandwidth current: " << bandwidth;
+  ABRCC_LOG(WARNING) << "[TargetAbr2] bandwidth estimator: " << estimator;
+  ABRCC_LOG(WARNING) << "[TargetAbr2] bandwidth target: " << bandwidth_target;
 
   // Adjust target rate
   interface->setTargetRate(bandwidth_target); 
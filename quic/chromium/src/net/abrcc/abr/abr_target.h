@@ -59,6 +59,9 @@ class TargetAbr : public SegmentProgressAbr, public StateTracker {
   // on the proportion of the current bandwidth value(provided by BBR) and the target
   // bandwidth computed in the decideQuality function.
   void adjustCC();
+  
+  // Resolves the BbrAdapter interface of the session's connection.
+  void bindInterfaces() override;
 
   // The bandwidth estimator is a different one than for WorthedAbr. We use a line fit 
   // estimator with (bandwidth, time) points when the time points are projected over 
@@ -92,6 +95,7 @@ class TargetAbr2 : public SegmentProgressAbr {
   std::pair<double, int> qoe(const double bandwidth);
 
   void adjustCC();
+  void bindInterfaces() override;
 
   std::unique_ptr<structs::MovingAverage<double>> bw_estimator;  
   int bandwidth_target;
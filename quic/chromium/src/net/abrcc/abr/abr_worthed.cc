@@ -1,4 +1,5 @@
 #include "net/abrcc/abr/abr_worthed.h"
+#include "net/abrcc/logging/log.h"
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wc++17-extensions"
@@ -28,8 +29,10 @@ namespace quic {
  *  - Wilder EMA of bandwidth 
  **/
 
-StateTracker::StateTracker(std::vector<int> bitrate_array) 
- : interface(BbrAdapter::BbrInterface::GetInstance()) 
+StateTracker::StateTracker(
+  std::vector<int> bitrate_array, 
+  BbrAdapter::BbrInterface* interface
+) : interface(interface) 
  , last_player_time(abr_schema::Value(0, 0)) 
  , last_buffer_level(abr_schema::Value(0, 0)) 
  , average_bandwidth(new structs::WilderEMA<double>(StateTrackerConstants::bandwidth_window))
@@ -90,10 +93,10 @@ void StateTracker::registerMetrics(const abr_schema::Metrics &metrics) {
   }
 
   if (last_bandwidth != base::nullopt) {
-    QUIC_LOG(WARNING) << " [last bw] " << last_bandwidth.value().value;
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << " [last bw] " << last_bandwidth.value().value;
   }
   if (!average_bandwidth->empty()) {
-    QUIC_LOG(WARNING) << " [bw avg] " << average_bandwidth->value();
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << " [bw avg] " << average_bandwidth->value();
   }
 }
 
@@ -129,12 +132,16 @@ namespace WorthedAbrConstants {
 
 WorthedAbr::WorthedAbr(const std::shared_ptr<DashBackendConfig>& config) 
   : SegmentProgressAbr(config)
-  , StateTracker(bitrate_array)
+  , StateTracker(bitrate_array, interfaces->adapter())
   , ban(0)
   , is_rtt_probing(true) {} 
 
 WorthedAbr::~WorthedAbr() {}
 
+void WorthedAbr::bindInterfaces() {
+  interface = interfaces->adapter();
+}
+
 double WorthedAbr::compute_reward(
   std::vector<int> qualities, 
   int start_index, 
@@ -155,12 +162,11 @@ double WorthedAbr::compute_reward(
     int chunk_quality = qualities[i];
     int current_index = start_index + i;
 
-    if (current_index > int(segments[chunk_quality].size())) {
+    if (current_index >= catalog->segments()) {
       continue;
     }
 
-    double size_kb = 8. * segments[chunk_quality][current_index].size / 1000.;
-    double download_time_ms = size_kb / bandwidth * 1000;
+    double download_time_ms = catalog->kbits(chunk_quality, current_index) / bandwidth * 1000;
 
     // simulate buffer changes
     if (current_buffer < download_time_ms) {
@@ -221,9 +227,9 @@ std::pair<double, int> WorthedAbr::compute_reward_and_quality(
   double percent = stochastic ? .2 : 1;
   int quality = 0;
   
-  int depth = std::min(int(segments[quality].size()) - start_index, WorthedAbrConstants::horizon);
+  int depth = std::min(catalog->segments() - start_index, WorthedAbrConstants::horizon);
   depth = stochastic ? std::min(depth, WorthedAbrConstants::horizon_stochastic) : depth;
-  for (auto &next : cartesian(depth, segments.size(), percent)) {
+  for (auto &next : cartesian(depth, catalog->qualities(), percent)) {
     double reward = compute_reward(
       next, start_index, bandwidth, start_buffer, current_quality
     );
@@ -250,8 +256,8 @@ int WorthedAbr::adjustedBufferLevel(int index) {
 
     double proportion = 1.0 * last_segment[index - 1].loaded / last_segment[index - 1].total;
     int download_time = 1.0 * (current_time - start_time) * (1 - proportion) / proportion;
-    if (index < int(segments[0].size())) {
-      last_segment_time_length = int(SECOND * (segments[0][index + 1].start_time - segments[0][index].start_time));
+    if (index < catalog->segments()) {
+      last_segment_time_length = catalog->durationMs(0, index);
     }
     int bonus = last_segment_time_length - download_time; 
 
@@ -287,7 +293,7 @@ std::pair<int, int> WorthedAbr::computeRates(bool stochastic) {
     stochastic,
     decisions[last_index].quality
   ).first; 
-  QUIC_LOG(INFO) << "[WorthedAbr] rate safe: " << rate_safe;
+  ABRCC_LOG(INFO) << "[WorthedAbr] rate safe: " << rate_safe;
  
   // compute rate worthed
   double scale_step_kbps = stochastic ? 150 : 100;
@@ -312,7 +318,7 @@ std::pair<int, int> WorthedAbr::computeRates(bool stochastic) {
     }
   }
   double rate_worthed = current_bandwidth_kbps; 
-  QUIC_LOG(INFO) << "[WorthedAbr] rate worthed: " << rate_worthed;
+  ABRCC_LOG(INFO) << "[WorthedAbr] rate worthed: " << rate_worthed;
 
   return std::make_pair(rate_safe, rate_worthed);
 }
@@ -352,7 +358,7 @@ double WorthedAbr::aggresivity(double bw, double delta) {
   double aggr_factor = factor(bw, delta);
   double value = partial_bw_safe(bw);
 
-  QUIC_LOG(INFO) << "[WorthedAbr] partial values: " << value << ' ' << aggr_factor << '\n';
+  ABRCC_LOG(INFO) << "[WorthedAbr] partial values: " << value << ' ' << aggr_factor << '\n';
   return std::max(std::min(value * aggr_factor, 1.), 0.);
 }
 
@@ -390,7 +396,7 @@ void WorthedAbr::adjustCC() {
     aggress = aggresivity(bw_safe, bw_worthed - bw_safe);
   }
   
-  QUIC_LOG(WARNING) << "[WorthedAbr] aggressivity: " << aggress;
+  ABRCC_LOG(WARNING) << "[WorthedAbr] aggressivity: " << aggress;
   if (aggress == 1) {
     interface->proposePacingGainCycle(std::vector<float>{1.5, 1, 1.5, 1, 1, 1, 1, 1});
   } else if (aggress >= 0.4) {
@@ -409,7 +415,10 @@ void WorthedAbr::registerMetrics(const abr_schema::Metrics &metrics) {
 
 
 int WorthedAbr::decideQuality(int index) {
-  if (index <= 2 || index > int(segments[0].size())) {
+  if (index <= 2) {
+    return startQuality();
+  }
+  if (index > catalog->segments()) {
     return 0; 
   }
   
@@ -452,9 +461,9 @@ int WorthedAbr::decideQuality(int index) {
     ban = WorthedAbrConstants::segments_upjump_banned;
   }
   
-  QUIC_LOG(WARNING) << "[WorthedAbr] quality: bandwidth used " << bandwidth;
-  QUIC_LOG(WARNING) << "[WorthedAbr] quality: buffer level used " << buffer_level;
-  QUIC_LOG(WARNING) << "[WorthedAbr] quality " << quality;
+  ABRCC_LOG(WARNING) << "[WorthedAbr] quality: bandwidth used " << bandwidth;
+  ABRCC_LOG(WARNING) << "[WorthedAbr] quality: buffer level used " << buffer_level;
+  ABRCC_LOG(WARNING) << "[WorthedAbr] quality " << quality;
   
   return quality;
 }
@@ -35,7 +35,7 @@ namespace StateTrackerConstants {
 //
 class StateTracker {
  public:
-  StateTracker(std::vector<int> bitrate_array);
+  StateTracker(std::vector<int> bitrate_array, BbrAdapter::BbrInterface* interface);
   virtual ~StateTracker();
 
   void registerMetrics(const abr_schema::Metrics &);
@@ -101,6 +101,7 @@ class WorthedAbr : public SegmentProgressAbr, public StateTracker {
 
   // Callbacks for adjusting the CC's pacing cycle. 
   void adjustCC(); 
+  void bindInterfaces() override;
 
   // Callback that can turn on or off the RTT probing functinality of BBR. When RTT probing
   // is turned on, BBR will only keep looping over the bandwidth probing functinality.
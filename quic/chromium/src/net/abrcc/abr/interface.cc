@@ -43,10 +43,48 @@ bool Decision::noop() {
   return index == -1 && quality == -1 && timestamp == -1;
 }
 
+Delivery::Delivery() : Delivery(-1, -1, 0, 0) {}
+Delivery::Delivery(int index, int quality, int64_t total, int64_t sent)
+  : index(index)
+  , quality(quality)
+  , state(PROGRESS)
+  , acked(0)
+  , total(total)
+  , retransmitted(0)
+  , sent(sent)
+  , first_acked(0)
+  , last_acked(0) {}
+
+int Delivery::elapsedMs() const {
+  if (acked == 0) {
+    return 0;
+  }
+  return (last_acked - sent) / 1000;
+}
+
+int Delivery::throughput() const {
+  if (acked == 0 || last_acked <= sent) {
+    return 0;
+  }
+  // bytes per microsecond to kbps
+  return 8000 * acked / (last_acked - sent);
+}
+
+Session::Session() : Session(0, 0) {}
+Session::Session(int bandwidth, int min_rtt) : bandwidth(bandwidth), min_rtt(min_rtt) {}
+
+bool Session::resumed() const {
+  return bandwidth > 0;
+}
+
 }
 
 namespace quic {
 
 AbrInterface::~AbrInterface() {}
 
+void AbrInterface::registerDelivery(const abr_schema::Delivery &) {}
+
+void AbrInterface::registerSession(const abr_schema::Session &) {}
+
 }
@@ -1,8 +1,15 @@
 #ifndef ABRCC_ABR_INTERFACE_H_
 #define ABRCC_ABR_INTERFACE_H_
 
+#include <cstdint>
+#include <memory>
+
 #include "net/abrcc/service/schema.h"
 
+namespace quic {
+class ConnectionInterfaces;
+}
+
 namespace abr_schema {
 
 // Decision for the `quality` of segment with `index`, `timestamp`-ed by the latest 
@@ -28,6 +35,58 @@ struct Decision {
   bool noop();
 };
 
+// Server-side delivery state of the segment `index` of quality `quality`, measured
+// from the ACKs of its response stream rather than reported by the front-end: `acked`
+// out of `total` body bytes were acked. Times are in microseconds on the server's
+// clock:
+//   - sent: the body was handed to the stream, its first byte leaving as soon as the
+//           congestion window allows
+//   - first_acked, last_acked: the first and latest ACK of the body's bytes
+// A segment is DOWNLOADED once all its bytes are acked; `last_acked` is then its
+// completion time.
+struct Delivery {
+  enum State {
+    PROGRESS, DOWNLOADED,
+  };
+
+  int index;
+  int quality;
+  State state;
+  int64_t acked;
+  int64_t total;
+  int64_t retransmitted;
+  int64_t sent;
+  int64_t first_acked;
+  int64_t last_acked;
+
+  Delivery();
+  Delivery(int index, int quality, int64_t total, int64_t sent);
+
+  // Milliseconds from handing the body to the stream to the latest ACK.
+  int elapsedMs() const;
+  // Delivery rate of the acked bytes so far(kbps), or 0 before the first ACK.
+  int throughput() const;
+};
+
+// Connection of the player, as seen on its first request. A returning client's
+// connection is resumed from the network parameters the server left in its
+// source-address token, in which case `bandwidth`(kbps) and `min_rtt`(ms) are the
+// previous connection's estimates the sender was seeded with; both are 0 for a
+// connection that started cold.
+//
+// `interfaces` are the ABR interfaces of the connection's sender, through which the
+// ABR steers the congestion control of its own player only.
+struct Session {
+  int bandwidth;
+  int min_rtt;
+  std::shared_ptr<quic::ConnectionInterfaces> interfaces;
+
+  Session();
+  Session(int bandwidth, int min_rtt);
+
+  bool resumed() const;
+};
+
 }
 
 namespace quic {
@@ -36,12 +95,18 @@ namespace quic {
 //  - registerMetrics: react to new front-end metrics
 //  - registerAbort: update internal state after an abort request at a given segment index
 //  - decide: return a decision for quality of the next(according to the metrics) segment 
+//  - registerDelivery: react to the server-side delivery progress of a segment; ignored
+//                      by default
+//  - registerSession: react to the player's connection, registered before the first
+//                     decision; ignored by default
 
 class AbrInterface {
  public:
   virtual void registerMetrics(const abr_schema::Metrics &) = 0;
   virtual void registerAbort(const int) = 0;
   virtual abr_schema::Decision decide() = 0;
+  virtual void registerDelivery(const abr_schema::Delivery &);
+  virtual void registerSession(const abr_schema::Session &);
   
   virtual ~AbrInterface();
 };
@@ -1,5 +1,6 @@
 #include "net/abrcc/abr/loop.h"
 
+#include <algorithm>
 #include <string>
 #include <chrono>
 #include <thread>
@@ -19,39 +20,53 @@ using spdy::SpdyHeaderBlock;
 namespace quic {
 
 AbrLoop::AbrLoop(
-  std::unique_ptr<AbrInterface> interface,
+  AbrFactory factory,
+  QuicConnectionId connection,
   std::shared_ptr<MetricsService> metrics,
   std::shared_ptr<PollingService> poll,
-  std::shared_ptr<StoreService> store
-) : interface(std::move(interface)), metrics(metrics), poll(poll), store(store) {}
-AbrLoop::~AbrLoop() { }
+  std::shared_ptr<StoreService> store,
+  std::shared_ptr<ControlService> control,
+  std::shared_ptr<DeliveryService> delivery
+) : factory(std::move(factory)), connection(connection)
+  , interface(nullptr), metrics(metrics), poll(poll), store(store)
+  , control(control)
+  , delivery(delivery)
+  , last_sent_response(0)
+  , last_sent_piece(0)
+  , stopping(false)
+  , stopped_(false)
+  , telemetry(TelemetryRecorder::GetInstance())
+  , telemetry_stream(TelemetryConstants::NOT_PRESENT) {}
+AbrLoop::~AbrLoop() {
+  telemetry->CloseStream(telemetry_stream);
+}
 
+// `sent` and `done` are polled by the loop's thread while the network thread sets them.
 static void Respond(
   AbrLoop *loop, 
-  bool* sent,
-  bool* done,
+  std::atomic<bool>* sent,
+  std::atomic<bool>* done,
   abr_schema::Decision decision
 ) {
-  bool couldRespond = loop->poll->SendResponse(
-    decision.path(),
-    decision.serialize());
+  bool couldRespond = loop->control->SendDecision(decision.serialize())
+    || loop->poll->SendResponse(decision.path(), decision.serialize());
   if (couldRespond) {
     *sent = true;
-    loop->sent.insert(decision.path());
+    loop->last_sent_response = std::max(loop->last_sent_response.load(), decision.index);
   }
   *done = true;
 }
 
 static void SendPiece(
   AbrLoop *loop, 
-  bool* sent,
-  bool* done,
+  std::atomic<bool>* sent,
+  std::atomic<bool>* done,
   abr_schema::Decision decision
 ) {
   auto entry = loop->poll->GetEntry(decision.resourcePath());
   if (entry) {
     *sent = true;
-    loop->sent.insert(decision.resourcePath());
+    loop->last_sent_piece = std::max(loop->last_sent_piece.load(), decision.index);
       
     // modify requeest headers to match with the Store
     SpdyHeaderBlock request_headers(entry->base_request_headers->Clone());
@@ -66,18 +81,66 @@ static void SendPiece(
   *done = true;
 }
 
+static void RecordMetrics(AbrLoop *loop, const abr_schema::Metrics& metrics) {
+  for (auto& level : metrics.bufferLevel) {
+    auto record = TelemetryRecord::Make(TelemetryRecord::BUFFER_LEVEL);
+    record.buffer_level = level->value;
+    record.player_timestamp = level->timestamp;
+    loop->telemetry->Record(loop->telemetry_stream, record);
+  }
+}
+
+static void RecordAbort(AbrLoop *loop, int index) {
+  auto record = TelemetryRecord::Make(TelemetryRecord::ABORT);
+  record.index = index;
+  loop->telemetry->Record(loop->telemetry_stream, record);
+}
+
+static void RecordDecision(AbrLoop *loop, const abr_schema::Decision& decision) {
+  auto record = TelemetryRecord::Make(TelemetryRecord::DECISION);
+  record.index = decision.index;
+  record.quality = decision.quality;
+  record.player_timestamp = decision.timestamp;
+  loop->telemetry->Record(loop->telemetry_stream, record);
+}
+
 static void Loop(AbrLoop *loop, const scoped_refptr<base::SingleThreadTaskRunner> runner) {
-  while (true) {
+  bool record = loop->telemetry_stream != TelemetryConstants::NOT_PRESENT;
+  bool session_started = false;
+  loop->interface = std::move(loop->factory).Run();
+  while (!loop->stopping) {
+    // register the player's connection; the first decision waits for it, such
+    // that the start quality can use a resumed connection's estimate
+    for (auto& session : loop->delivery->GetSessions(loop->connection)) {
+      loop->interface->registerSession(session);
+      session_started = true;
+    }
+    if (!session_started) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(20));
+      continue;
+    }
+
     // register metrics
     for (auto& metrics : loop->metrics->GetMetrics()) {
+      if (record) {
+        RecordMetrics(loop, *metrics);
+      }
       loop->interface->registerMetrics(*metrics);
     }
 
     // register aborts
     for (auto& abort : loop->metrics->GetAborts()) {
+      if (record) {
+        RecordAbort(loop, abort);
+      }
       loop->interface->registerAbort(abort);
     }
 
+    // register deliveries
+    for (auto& delivery : loop->delivery->GetDeliveries(loop->connection)) {
+      loop->interface->registerDelivery(delivery);
+    }
+
     // get decision
     auto decision = loop->interface->decide(); 
     
@@ -87,12 +150,15 @@ static void Loop(AbrLoop *loop, const scoped_refptr<base::SingleThreadTaskRunner
       std::this_thread::sleep_for(std::chrono::milliseconds(20));
       continue;
     }
+    if (record) {
+      RecordDecision(loop, decision);
+    }
     
-    if (loop->sent.find(decision.path()) == loop->sent.end()) {
-      bool sent = false;
-      while (!sent) {
-        if (loop->sent.find(decision.path()) == loop->sent.end()) {
-          bool done = false;
+    if (decision.index > loop->last_sent_response) {
+      std::atomic<bool> sent(false);
+      while (!sent && !loop->stopping) {
+        if (decision.index > loop->last_sent_response) {
+          std::atomic<bool> done(false);
           runner->PostTask(FROM_HERE,
             base::BindOnce(&Respond, loop, &sent, &done, decision));
           while (!done);
@@ -106,11 +172,11 @@ static void Loop(AbrLoop *loop, const scoped_refptr<base::SingleThreadTaskRunner
       std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
 
-    if (loop->sent.find(decision.resourcePath()) == loop->sent.end()) {
-      bool sent = false;
-      while (!sent) {
-        if (loop->sent.find(decision.resourcePath()) == loop->sent.end()) {
-          bool done = false;
+    if (decision.index > loop->last_sent_piece) {
+      std::atomic<bool> sent(false);
+      while (!sent && !loop->stopping) {
+        if (decision.index > loop->last_sent_piece) {
+          std::atomic<bool> done(false);
           runner->PostTask(FROM_HERE,
             base::BindOnce(&SendPiece, loop, &sent, &done, decision));
           while (!done);
@@ -124,9 +190,12 @@ static void Loop(AbrLoop *loop, const scoped_refptr<base::SingleThreadTaskRunner
       std::this_thread::sleep_for(std::chrono::milliseconds(20));
     }
   }
+  loop->stopped_ = true;
 }
 
 void AbrLoop::Start() {
+  telemetry_stream = telemetry->OpenStream("abr");
+
   const scoped_refptr<base::SingleThreadTaskRunner> runner(
     base::ThreadTaskRunnerHandle::Get()
   );
@@ -141,4 +210,15 @@ void AbrLoop::Start() {
   this->thread = std::move(worker_thread);
 }
 
+void AbrLoop::Stop() {
+  stopping = true;
+  if (thread == nullptr) {
+    stopped_ = true;
+  }
+}
+
+bool AbrLoop::stopped() const {
+  return stopped_;
+}
+
 }
@@ -3,37 +3,78 @@
 
 #include "net/abrcc/abr/interface.h"
 
+#include "net/abrcc/service/control_service.h"
+#include "net/abrcc/service/delivery_service.h"
 #include "net/abrcc/service/metrics_service.h"
 #include "net/abrcc/service/poll_service.h"
 #include "net/abrcc/service/store_service.h"
+#include "net/abrcc/telemetry/recorder.h"
 
+#include "base/callback.h"
 #include "base/threading/thread.h"
 
+#include "net/third_party/quiche/src/quic/core/quic_connection_id.h"
+
+#include <atomic>
+
 namespace quic {
 
+// Builds the ABR of a player; called on the loop's thread, such that reading the
+// ABR's files does not block the network thread.
+using AbrFactory = base::OnceCallback<std::unique_ptr<AbrInterface>()>;
+
 // AbrLoop class wrapper. Allows starting and periodically calling the AbrInterface
 // implementation into a separate thread. It will provide the AbrInterface with access
 // to all the relevant services.
+//
+// A loop serves the player of a single connection: the services are the player's,
+// except for the store and the delivery service, shared by the title's players, from
+// which the loop only pops the events of its `connection`.
 class AbrLoop {
  public:
   AbrLoop(
-    std::unique_ptr<AbrInterface> interface,
+    AbrFactory factory,
+    QuicConnectionId connection,
     std::shared_ptr<MetricsService> metrics,
     std::shared_ptr<PollingService> poll,
-    std::shared_ptr<StoreService> store);  
+    std::shared_ptr<StoreService> store,
+    std::shared_ptr<ControlService> control,
+    std::shared_ptr<DeliveryService> delivery);
   AbrLoop(const AbrLoop&) = delete;
   AbrLoop& operator=(const AbrLoop&) = delete;
   ~AbrLoop();
   
   void Start();
+  // Asks the loop to exit after its current iteration; the loop can be destroyed
+  // without blocking once stopped() returns true.
+  void Stop();
+  bool stopped() const;
 
+  AbrFactory factory;
+  QuicConnectionId connection;
+  // built by `factory` once the loop's thread started
   std::unique_ptr<AbrInterface> interface;
   std::shared_ptr<MetricsService> metrics;
   std::shared_ptr<PollingService> poll;    
   std::shared_ptr<StoreService> store;
+  // decisions go over the players' control channels if any is open
+  std::shared_ptr<ControlService> control;
+  // segment deliveries measured from the server's ACKs, and the player's connection
+  std::shared_ptr<DeliveryService> delivery;
 
   std::unique_ptr<base::Thread> thread;
-  std::unordered_set<std::string> sent;
+  // highest decision indices whose response and video piece were sent; decisions
+  // come in increasing index order, so older ones were sent as well. Written on the
+  // network thread, read by the loop's thread.
+  std::atomic<int> last_sent_response;
+  std::atomic<int> last_sent_piece;
+
+  std::atomic<bool> stopping;
+  std::atomic<bool> stopped_;
+
+  // buffer levels, aborts and decisions are recorded into the loop's telemetry stream
+  TelemetryRecorder* telemetry;
+  int telemetry_stream;
 };
 
 }
@@ -0,0 +1,81 @@
+#include "net/abrcc/cc/ack_channel.h"
+
+namespace quic {
+
+namespace {
+  uint64_t round_up_power_of_two(int capacity) {
+    uint64_t size = 1;
+    while (size < uint64_t(capacity)) {
+      size <<= 1;
+    }
+    return size;
+  }
+}
+
+AckChannel::AckChannel(int capacity)
+  : samples(round_up_power_of_two(capacity))
+  , mask(samples.size() - 1)
+  , tail(0)
+  , dropped_(0)
+  , application_idle(false)
+  , head(0) {}
+
+AckChannel::~AckChannel() {}
+
+bool AckChannel::push(AckSample sample) {
+  if (application_idle) {
+    sample.app_limited = true;
+  }
+
+  uint64_t current_tail = tail.load(std::memory_order_relaxed);
+  uint64_t current_head = head.load(std::memory_order_acquire);
+  if (current_tail - current_head == samples.size()) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+
+  samples[current_tail & mask] = sample;
+  tail.store(current_tail + 1, std::memory_order_release);
+  return true;
+}
+
+void AckChannel::setApplicationIdle(bool idle) {
+  application_idle = idle;
+}
+
+std::vector<AckSample> AckChannel::popAll() {
+  uint64_t current_head = head.load(std::memory_order_relaxed);
+  uint64_t current_tail = tail.load(std::memory_order_acquire);
+
+  std::vector<AckSample> out;
+  out.reserve(current_tail - current_head);
+  for (uint64_t i = current_head; i != current_tail; ++i) {
+    out.push_back(samples[i & mask]);
+  }
+  head.store(current_tail, std::memory_order_release);
+  return out;
+}
+
+std::vector<int> AckChannel::popDeliveryRates() {
+  std::vector<int> out;
+  for (auto& sample : popAll()) {
+    out.push_back(sample.delivery_rate);
+  }
+  return out;
+}
+
+std::vector<int> AckChannel::popBurstDeliveryRates() {
+  std::vector<int> out;
+  for (auto& sample : popAll()) {
+    if (!sample.app_limited) {
+      out.push_back(sample.delivery_rate);
+    }
+  }
+  return out;
+}
+
+int64_t AckChannel::dropped() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+}
@@ -0,0 +1,88 @@
+#ifndef ABRCC_CC_ACK_CHANNEL_H_
+#define ABRCC_CC_ACK_CHANNEL_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-private-field"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+namespace quic {
+
+namespace AckChannelConstants {
+  // samples buffered between two consecutive ABR polls
+  const int capacity = 1 << 12;
+}
+
+// Per-ACK telemetry registered by the congestion controllers:
+//   - timestamp: time at which the ACK was processed(us since QuicTime::Zero)
+//   - delivery_rate: the bandwidth sampler's delivery rate(kbps)
+//   - rtt: the sample's RTT(ms)
+//   - recovery: whether the sender was in loss recovery
+//   - acked_bytes: the number of acked bytes for the packet
+//   - app_limited: whether the packet was sent while the application did not fill
+//                  the pipe, so the delivery rate may underestimate the bandwidth
+struct AckSample {
+  int64_t timestamp;
+  int delivery_rate;
+  int rtt;
+  bool recovery;
+  int acked_bytes;
+  bool app_limited;
+};
+
+// Bounded single-producer/single-consumer channel of AckSamples. The producer is the
+// network thread processing ACKs, while the consumer is the ABR loop. Neither side
+// takes a lock: pushing into a full channel drops the sample(and counts it) instead
+// of blocking the ACK processing path, and popping drains all the available samples.
+//
+// The producer can also be told that the sender is idle waiting on the application,
+// e.g. between two video segments, in which case the samples it pushes are marked
+// app-limited whatever the bandwidth sampler thought. The connection's CCWrapper
+// tracks the application's bursts and sets it before each congestion event.
+class AckChannel {
+ public:
+  // The capacity is rounded up to a power of 2.
+  explicit AckChannel(int capacity);
+  AckChannel(const AckChannel&) = delete;
+  AckChannel& operator=(const AckChannel&) = delete;
+  ~AckChannel();
+
+  // Producer side; returns false if the sample was dropped.
+  bool push(AckSample sample);
+  void setApplicationIdle(bool idle);
+
+  // Consumer side.
+  std::vector<AckSample> popAll();
+  std::vector<int> popDeliveryRates();
+  // Delivery rates of the samples which are not app-limited.
+  std::vector<int> popBurstDeliveryRates();
+
+  int64_t dropped() const;
+ private:
+  std::vector<AckSample> samples;
+  uint64_t mask;
+
+  // producer and consumer positions are padded onto separate cache lines; padding
+  // is used instead of alignas so that the channel can be heap allocated without
+  // aligned operator new
+  char padding0[64];
+  std::atomic<uint64_t> tail;
+  std::atomic<int64_t> dropped_;
+  // only touched by the producer
+  bool application_idle;
+  char padding1[64];
+  std::atomic<uint64_t> head;
+  char padding2[64];
+};
+
+}
+
+#pragma GCC diagnostic pop
+#pragma GCC diagnostic pop
+
+#endif
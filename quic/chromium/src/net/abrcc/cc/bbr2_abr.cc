@@ -0,0 +1,147 @@
+#include "net/abrcc/cc/bbr2_abr.h"
+
+#include <algorithm>
+
+#include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/cc/connection_interfaces.h"
+#include "net/abrcc/logging/log.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waddress-of-packed-member"
+
+namespace quic {
+
+Bbr2Abr::Bbr2Abr(CongestionControlType type, ConnectionInterfaces* interfaces)
+  : type(type)
+  , target_interface(type == kBbr2Gap ? nullptr : interfaces->target())
+  , gap_interface(type == kBbr2Gap ? interfaces->gap() : nullptr)
+  , ack_channel(type == kBbr2Gap
+      ? gap_interface->ack_channel.get()
+      : target_interface->ack_channel.get())
+  , recovery(false)
+  , pacing_gain(1)
+  , min_rtt(0) {
+  DCHECK(type == kBbr2Target || type == kBbr2Gap);
+  if (type == kBbr2Gap) {
+    gap_interface->setBbr2Parent(this);
+    gap_interface->setRecovery(false);
+  } else {
+    target_interface->setBbr2Parent(this);
+  }
+}
+
+Bbr2Abr::~Bbr2Abr() {
+  if (type == kBbr2Gap) {
+    QuicWriterMutexLock lock(&gap_interface->parent_mutex_);
+    if (gap_interface->bbr2_parent == this) {
+      gap_interface->bbr2_parent = nullptr;
+    }
+  } else {
+    QuicWriterMutexLock lock(&target_interface->parent_mutex_);
+    if (target_interface->bbr2_parent == this) {
+      target_interface->bbr2_parent = nullptr;
+    }
+  }
+}
+
+std::vector<float> Bbr2Abr::getPacingGainCycle() {
+  if (type == kBbr2Gap) {
+    return gap_interface->getPacingGainCycle();
+  }
+  return target_interface->getPacingGainCycle();
+}
+
+base::Optional<int> Bbr2Abr::getTargetRate() const {
+  if (type == kBbr2Gap) {
+    return gap_interface->getTargetRate();
+  }
+  return target_interface->getTargetRate();
+}
+
+float Bbr2Abr::PacingGainForPhase(
+  Bbr2ProbeBwMode::CyclePhase phase,
+  float default_gain
+) {
+  if (phase != Bbr2ProbeBwMode::CyclePhase::PROBE_UP &&
+      phase != Bbr2ProbeBwMode::CyclePhase::PROBE_DOWN) {
+    return default_gain;
+  }
+  std::vector<float> cycle = getPacingGainCycle();
+  if (cycle.empty()) {
+    return default_gain;
+  }
+
+  auto gains = std::minmax_element(cycle.begin(), cycle.end());
+  if (phase == Bbr2ProbeBwMode::CyclePhase::PROBE_UP) {
+    // PROBE_UP only ends once a queue is built, so it needs a gain above 1
+    return *gains.second > 1 ? *gains.second : default_gain;
+  }
+  return std::min(*gains.first, 1.f);
+}
+
+QuicBandwidth Bbr2Abr::TargetBandwidth(const Bbr2NetworkModel& model) {
+  QuicBandwidth bandwidth = model.BandwidthEstimate();
+  auto maybe_target_bandwidth = getTargetRate();
+  if (maybe_target_bandwidth == base::nullopt) {
+    return bandwidth;
+  }
+
+  int64_t b = bandwidth.ToKBitsPerSecond();
+  int64_t tb = maybe_target_bandwidth.value();
+
+  // [Target] mean of the estimate and the target
+  int64_t adjusted = (b + tb) / 2;
+  if (type == kBbr2Gap) {
+    // [Gap] max(t, tp), with the latest round's bandwidth as the signal
+    int64_t s = model.bandwidth_latest().ToKBitsPerSecond();
+    adjusted = std::max(adjusted, (tb + s + b) / 3);
+  }
+
+  // the loss-driven lower bound is kept, such that the ABR can not override
+  // BBRv2's response to losses
+  return std::min(QuicBandwidth::FromKBitsPerSecond(adjusted), model.bandwidth_lo());
+}
+
+void Bbr2Abr::OnBandwidthSample(
+  QuicTime event_time,
+  const BandwidthSample& sample,
+  QuicByteCount bytes_acked
+) {
+  ack_channel->push(AckSample{
+    (event_time - QuicTime::Zero()).ToMicroseconds(),
+    static_cast<int>(sample.bandwidth.ToKBitsPerSecond()),
+    static_cast<int>(sample.rtt.ToMilliseconds()),
+    recovery,
+    static_cast<int>(bytes_acked),
+    sample.state_at_send.is_app_limited,
+  });
+}
+
+void Bbr2Abr::OnCongestionEventFinish(
+  const Bbr2CongestionEvent& /*congestion_event*/,
+  const Bbr2NetworkModel& model
+) {
+  pacing_gain.store(model.pacing_gain(), std::memory_order_relaxed);
+  min_rtt.store(model.MinRtt().ToMicroseconds(), std::memory_order_relaxed);
+
+  bool new_recovery = model.bandwidth_lo() < model.MaxBandwidth();
+  if (new_recovery != recovery) {
+    ABRCC_LOG(INFO) << "[Bbr2Abr] recovery: " << new_recovery;
+    recovery = new_recovery;
+    if (type == kBbr2Gap) {
+      gap_interface->setRecovery(recovery);
+    }
+  }
+}
+
+float Bbr2Abr::pacingGain() const {
+  return pacing_gain.load(std::memory_order_relaxed);
+}
+
+QuicTime::Delta Bbr2Abr::minRtt() const {
+  return QuicTime::Delta::FromMicroseconds(min_rtt.load(std::memory_order_relaxed));
+}
+
+}
+
+#pragma GCC diagnostic pop
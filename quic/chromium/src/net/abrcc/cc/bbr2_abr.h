@@ -0,0 +1,72 @@
+#ifndef ABRCC_CC_BBR2_ABR_H_
+#define ABRCC_CC_BBR2_ABR_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_abr_hooks.h"
+#include "net/third_party/quiche/src/quic/core/quic_bandwidth.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+#include "net/third_party/quiche/src/quic/core/quic_types.h"
+
+#include "net/abrcc/cc/ack_channel.h"
+#include "net/abrcc/cc/gap.h"
+#include "net/abrcc/cc/target.h"
+
+namespace quic {
+
+class ConnectionInterfaces;
+
+// The ABR-facing controls of BbrTarget(kBbr2Target) and BbrGap(kBbr2Gap) as hooks
+// into the Bbr2Sender, so that TargetAbr and GapAbr can run on top of BBRv2:
+//   - PROBE_UP and PROBE_DOWN take the maximum and minimum gains of the proposed
+//     pacing gain cycle
+//   - the target rate adjusts the bandwidth estimate as BbrTarget or BbrGap do, but
+//     never above BBRv2's loss-driven bandwidth_lo
+//   - recovery is signalled while bandwidth_lo holds the bandwidth below its maximum
+//   - delivery rates are exported for every bandwidth sample
+//
+// The hooks attach to the interface of `type` in the connection's bundle, through
+// which the estimates, samples, target rate, gain cycle and recovery signal go.
+class Bbr2Abr : public Bbr2AbrHooks {
+ public:
+  Bbr2Abr(CongestionControlType type, ConnectionInterfaces* interfaces);
+  ~Bbr2Abr() override;
+
+  float PacingGainForPhase(Bbr2ProbeBwMode::CyclePhase phase,
+                           float default_gain) override;
+  QuicBandwidth TargetBandwidth(const Bbr2NetworkModel& model) override;
+  void OnBandwidthSample(QuicTime event_time,
+                         const BandwidthSample& sample,
+                         QuicByteCount bytes_acked) override;
+  void OnCongestionEventFinish(const Bbr2CongestionEvent& congestion_event,
+                               const Bbr2NetworkModel& model) override;
+
+  // estimates exported to the ABR interfaces
+  float pacingGain() const;
+  QuicTime::Delta minRtt() const;
+ private:
+  std::vector<float> getPacingGainCycle();
+  base::Optional<int> getTargetRate() const;
+
+  CongestionControlType type;
+  // only the interface of `type` is set
+  BbrTarget::BbrInterface* target_interface;
+  BbrGap::BbrInterface* gap_interface;
+  AckChannel* ack_channel;
+  bool recovery;
+
+  // written by the network thread, read by the ABR loop
+  std::atomic<float> pacing_gain;
+  std::atomic<int64_t> min_rtt;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -12,8 +12,8 @@
 #include "net/third_party/quiche/src/quic/platform/api/quic_flag_utils.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_flags.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
 
-#include "net/abrcc/cc/singleton.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
 
 
@@ -66,10 +66,6 @@ const float minimum_proposals = 5;
  **/
 
 
-BbrAdapter::BbrInterface* BbrAdapter::BbrInterface::GetInstance() {
-  return GET_SINGLETON(BbrAdapter::BbrInterface);
-}
-
 void BbrAdapter::BbrInterface::proposePacingGainCycle(const std::vector<float>& gain) {
   if (no_adaptation) {
     return;
@@ -90,7 +86,7 @@ void BbrAdapter::BbrInterface::proposePacingGainCycle(const std::vector<float>&
   QuicWriterMutexLock lock(&pacing_cycle_mutex_);
   kPacingGainProposals.push_back(gain);
 
-  QUIC_LOG(WARNING) << "new proposal " << to_str(gain);
+  ABRCC_LOG(WARNING) << "new proposal " << to_str(gain);
 }
 
 void BbrAdapter::BbrInterface::updatePacingGainCycle() {
@@ -99,7 +95,7 @@ void BbrAdapter::BbrInterface::updatePacingGainCycle() {
   }
   
   QuicWriterMutexLock lock(&pacing_cycle_mutex_);
-  QUIC_LOG(WARNING) << "[BBR Adapter] updating pacing gain cycle";
+  ABRCC_LOG(WARNING) << "[BBR Adapter] updating pacing gain cycle";
 
   auto votes = std::map<
     std::vector<float>, 
@@ -144,7 +140,7 @@ void BbrAdapter::BbrInterface::updatePacingGainCycle() {
   };
   
   if (!best_proposal.empty() && kPacingGainProposals.size() >= minimum_proposals) {
-    QUIC_LOG(WARNING) << "[BBR Adapter] chosen proposal " << to_str(best_proposal) 
+    ABRCC_LOG(WARNING) << "[BBR Adapter] chosen proposal " << to_str(best_proposal) 
                       << " with " << most_votes << " votes";
   
     kPacingGain = best_proposal; 
@@ -166,10 +162,12 @@ QuicRoundTripCount BbrAdapter::BbrInterface::kBandwidthWindowSize() {
 }
 
 void BbrAdapter::BbrInterface::setParent(BbrAdapter *parent) {
+  QuicWriterMutexLock lock(&parent_mutex_);
   this->parent = parent;
 }
 
 base::Optional<int> BbrAdapter::BbrInterface::BandwidthEstimate() const {
+  QuicReaderMutexLock parent_lock(&parent_mutex_);
   if (parent == nullptr) {
     return base::nullopt; 
   }
@@ -177,6 +175,7 @@ base::Optional<int> BbrAdapter::BbrInterface::BandwidthEstimate() const {
 }
 
 base::Optional<float> BbrAdapter::BbrInterface::PacingGain() const {
+  QuicReaderMutexLock parent_lock(&parent_mutex_);
   QuicReaderMutexLock lock(&pacing_cycle_mutex_);
   if (parent == nullptr) {
     return base::nullopt;
@@ -185,6 +184,7 @@ base::Optional<float> BbrAdapter::BbrInterface::PacingGain() const {
 }
 
 base::Optional<int> BbrAdapter::BbrInterface::RttEstimate() const {
+  QuicReaderMutexLock parent_lock(&parent_mutex_);
   if (parent == nullptr) {
     return base::nullopt;
   }
@@ -219,7 +219,7 @@ BbrAdapter::BbrInterface::BbrInterface()
 BbrAdapter::BbrInterface::~BbrInterface() {}
 
 void BbrAdapter::changeMode(BbrAdapter::Mode newMode) {
-  QUIC_LOG(WARNING) << "[BBR Mode]: " << mode_ << " -> " << newMode;
+  ABRCC_LOG(WARNING) << "[BBR Mode]: " << mode_ << " -> " << newMode;
   mode_ = newMode;
 }
 
@@ -251,17 +251,18 @@ BbrAdapter::BbrAdapter(QuicTime now,
                      QuicPacketCount initial_tcp_congestion_window,
                      QuicPacketCount max_tcp_congestion_window,
                      QuicRandom* random,
-                     QuicConnectionStats* stats)
-    : interface(BbrInterface::GetInstance()), 
+                     QuicConnectionStats* stats,
+                     BbrInterface* interface)
+    : interface(interface), 
     
       rtt_stats_(rtt_stats),
       unacked_packets_(unacked_packets),
       random_(random),
       stats_(stats),
       mode_(STARTUP),
-      sampler_(unacked_packets, BbrInterface::GetInstance()->kBandwidthWindowSize()),
+      sampler_(unacked_packets, interface->kBandwidthWindowSize()),
       round_trip_count_(0),
-      max_bandwidth_(BbrInterface::GetInstance()->kBandwidthWindowSize(), QuicBandwidth::Zero(), 0),
+      max_bandwidth_(interface->kBandwidthWindowSize(), QuicBandwidth::Zero(), 0),
       min_rtt_(QuicTime::Delta::Zero()),
       min_rtt_timestamp_(QuicTime::Zero()),
       congestion_window_(initial_tcp_congestion_window * kDefaultTCPMSS),
@@ -313,8 +314,9 @@ BbrAdapter::BbrAdapter(QuicTime now,
 }
 
 BbrAdapter::~BbrAdapter() {
+  QuicWriterMutexLock lock(&interface->parent_mutex_);
   if (interface->parent == this) {
-    interface->setParent(nullptr);
+    interface->parent = nullptr;
   }
 }
 
@@ -19,11 +19,11 @@
 #include "net/third_party/quiche/src/quic/platform/api/quic_export.h"
 
 #include "net/abrcc/cc/cc_selector.h"
-#include "net/abrcc/cc/singleton.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
 
 namespace quic {
 
+class ConnectionInterfaces;
 class RttStats;
 
 // BbrAdapter implements BBR congestion control algorithm.  BBR aims to estimate
@@ -42,7 +42,6 @@ class QUIC_EXPORT_PRIVATE BbrAdapter : public SendAlgorithmInterface {
   class __attribute__((packed)) BbrInterface {
    public:
     virtual ~BbrInterface();
-    static BbrInterface* GetInstance();
 
     // controlling gain cycle
     void proposePacingGainCycle(const std::vector<float>& gain);
@@ -73,10 +72,14 @@ class QUIC_EXPORT_PRIVATE BbrAdapter : public SendAlgorithmInterface {
 
     BbrAdapter *parent;
     bool no_adaptation;
+    // guards the parents, attached and detached on the network thread while the
+    // ABR reads them on its own
+    mutable QuicMutex parent_mutex_;
     mutable QuicMutex rtt_probe_mutex_;
     mutable QuicMutex pacing_cycle_mutex_; 
 
     friend class BbrAdapter;
+    friend class ConnectionInterfaces;
   };
  
   /**
@@ -139,7 +142,8 @@ class QUIC_EXPORT_PRIVATE BbrAdapter : public SendAlgorithmInterface {
             QuicPacketCount initial_tcp_congestion_window,
             QuicPacketCount max_tcp_congestion_window,
             QuicRandom* random,
-            QuicConnectionStats* stats);
+            QuicConnectionStats* stats,
+             BbrInterface* interface);
   BbrAdapter(const BbrAdapter&) = delete;
   BbrAdapter& operator=(const BbrAdapter&) = delete;
   ~BbrAdapter() override;
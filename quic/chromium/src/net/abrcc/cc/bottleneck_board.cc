@@ -0,0 +1,205 @@
+#include "net/abrcc/cc/bottleneck_board.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "net/abrcc/logging/log.h"
+
+namespace quic {
+
+// The slots live in memory shared by processes, hence only hold lock-free atomics;
+// the fields are relaxed, ordered by the sequence.
+static_assert(ATOMIC_INT_LOCK_FREE == 2 && ATOMIC_LLONG_LOCK_FREE == 2,
+              "the board needs lock-free atomics");
+
+struct BottleneckBoard::Slot {
+  // pid of the process that claimed the slot, 0 if free
+  std::atomic<int32_t> owner;
+  // odd while the owner writes the slot
+  std::atomic<uint32_t> sequence;
+
+  std::atomic<int64_t> id;
+  std::atomic<int32_t> group_size;
+  std::atomic<uint64_t> group[BottleneckBoardConstants::max_group_bytes / 8];
+  std::atomic<int64_t> last_event_us;
+  std::atomic<int64_t> app_limited_until_us;
+  std::atomic<double> rate;
+  std::atomic<double> srtt;
+  std::atomic<int64_t> min_rtt;
+};
+
+static int64_t toMicros(QuicTime time) {
+  return (time - QuicTime::Zero()).ToMicroseconds();
+}
+
+static QuicTime fromMicros(int64_t micros) {
+  return QuicTime::Zero() + QuicTime::Delta::FromMicroseconds(micros);
+}
+
+static bool alive(int32_t pid) {
+  return kill(pid, 0) == 0 || errno != ESRCH;
+}
+
+size_t BottleneckBoard::BoardBytes() {
+  return sizeof(Slot) * BottleneckBoardConstants::slots;
+}
+
+BottleneckBoard::BottleneckBoard(int fd, Slot* slots)
+  : fd(fd)
+  , slots(slots)
+  , pid_(getpid()) {}
+
+BottleneckBoard::~BottleneckBoard() {
+  for (int i = 0; i < BottleneckBoardConstants::slots; ++i) {
+    if (slots[i].owner.load(std::memory_order_relaxed) == pid_) {
+      Release(i);
+    }
+  }
+  munmap(slots, BoardBytes());
+  close(fd);
+}
+
+std::unique_ptr<BottleneckBoard> BottleneckBoard::Open(const std::string& path) {
+  int fd = open(path.c_str(), O_RDWR | O_CREAT, 0666);
+  if (fd < 0) {
+    ABRCC_LOG(ERROR) << "[BottleneckBoard] can not open " << path << ": "
+                     << strerror(errno);
+    return nullptr;
+  }
+
+  // a new board is zero-filled, i.e. all its slots are free; the servers
+  // starting together all extend it to the same size
+  struct stat info;
+  if (fstat(fd, &info) != 0
+      || (static_cast<size_t>(info.st_size) < BoardBytes()
+          && ftruncate(fd, BoardBytes()) != 0)) {
+    ABRCC_LOG(ERROR) << "[BottleneckBoard] can not size " << path << ": "
+                     << strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+
+  void* memory = mmap(
+    nullptr, BoardBytes(), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  if (memory == MAP_FAILED) {
+    ABRCC_LOG(ERROR) << "[BottleneckBoard] can not map " << path << ": "
+                     << strerror(errno);
+    close(fd);
+    return nullptr;
+  }
+  ABRCC_LOG(INFO) << "[BottleneckBoard] sharing the coupled connections through "
+                  << path;
+  return std::unique_ptr<BottleneckBoard>(
+    new BottleneckBoard(fd, static_cast<Slot*>(memory)));
+}
+
+int BottleneckBoard::Claim() {
+  for (int i = 0; i < BottleneckBoardConstants::slots; ++i) {
+    Slot& slot = slots[i];
+    int32_t owner = slot.owner.load(std::memory_order_relaxed);
+    if (owner == pid_ || (owner != 0 && alive(owner))) {
+      continue;
+    }
+    if (slot.owner.compare_exchange_strong(owner, pid_, std::memory_order_acquire)) {
+      // the slot may hold the last state of a dead process, which may have died
+      // while writing it
+      uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+      slot.sequence.store(sequence + sequence % 2, std::memory_order_relaxed);
+      slot.last_event_us.store(0, std::memory_order_relaxed);
+      return i;
+    }
+  }
+  ABRCC_LOG(WARNING) << "[BottleneckBoard] board full, member not shared";
+  return -1;
+}
+
+void BottleneckBoard::Release(int slot) {
+  Slot& state = slots[slot];
+  uint32_t sequence = state.sequence.load(std::memory_order_relaxed);
+  state.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  state.last_event_us.store(0, std::memory_order_relaxed);
+  state.sequence.store(sequence + 2, std::memory_order_release);
+  state.owner.store(0, std::memory_order_release);
+}
+
+void BottleneckBoard::Publish(int slot, const Entry& entry) {
+  Slot& state = slots[slot];
+  uint64_t group[BottleneckBoardConstants::max_group_bytes / 8] = {0};
+  size_t group_size = std::min(entry.group.size(), sizeof(group));
+  memcpy(group, entry.group.data(), group_size);
+
+  uint32_t sequence = state.sequence.load(std::memory_order_relaxed);
+  state.sequence.store(sequence + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  state.id.store(entry.id, std::memory_order_relaxed);
+  state.group_size.store(group_size, std::memory_order_relaxed);
+  for (size_t i = 0; i < sizeof(group) / 8; ++i) {
+    state.group[i].store(group[i], std::memory_order_relaxed);
+  }
+  state.last_event_us.store(toMicros(entry.last_event), std::memory_order_relaxed);
+  state.app_limited_until_us.store(
+    toMicros(entry.app_limited_until), std::memory_order_relaxed);
+  state.rate.store(entry.rate, std::memory_order_relaxed);
+  state.srtt.store(entry.srtt, std::memory_order_relaxed);
+  state.min_rtt.store(entry.min_rtt, std::memory_order_relaxed);
+  state.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+std::vector<BottleneckBoard::Entry> BottleneckBoard::Peers(
+  const std::string& group
+) const {
+  std::vector<Entry> peers;
+  for (int i = 0; i < BottleneckBoardConstants::slots; ++i) {
+    const Slot& state = slots[i];
+    int32_t owner = state.owner.load(std::memory_order_acquire);
+    if (owner == 0 || owner == pid_) {
+      continue;
+    }
+
+    for (int attempt = 0; attempt < BottleneckBoardConstants::read_attempts; ++attempt) {
+      uint32_t sequence = state.sequence.load(std::memory_order_acquire);
+      if (sequence % 2 == 1) {
+        continue;
+      }
+      uint64_t key[BottleneckBoardConstants::max_group_bytes / 8];
+      for (size_t j = 0; j < sizeof(key) / 8; ++j) {
+        key[j] = state.group[j].load(std::memory_order_relaxed);
+      }
+      size_t key_size = std::min(
+        static_cast<size_t>(state.group_size.load(std::memory_order_relaxed)),
+        sizeof(key));
+      Entry entry{
+        state.id.load(std::memory_order_relaxed),
+        std::string(reinterpret_cast<const char*>(key), key_size),
+        fromMicros(state.last_event_us.load(std::memory_order_relaxed)),
+        fromMicros(state.app_limited_until_us.load(std::memory_order_relaxed)),
+        state.rate.load(std::memory_order_relaxed),
+        state.srtt.load(std::memory_order_relaxed),
+        state.min_rtt.load(std::memory_order_relaxed),
+      };
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (state.sequence.load(std::memory_order_relaxed) != sequence) {
+        continue;
+      }
+
+      if (entry.last_event != QuicTime::Zero() && entry.group == group) {
+        peers.push_back(entry);
+      }
+      break;
+    }
+  }
+  return peers;
+}
+
+int32_t BottleneckBoard::pid() const {
+  return pid_;
+}
+
+}
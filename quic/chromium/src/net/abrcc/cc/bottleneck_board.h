@@ -0,0 +1,72 @@
+#ifndef ABRCC_CC_BOTTLENECK_BOARD_H_
+#define ABRCC_CC_BOTTLENECK_BOARD_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+
+namespace quic {
+
+namespace BottleneckBoardConstants {
+  // slots of the board, i.e. coupled connections of all the servers of a host
+  const int slots = 512;
+  // bytes of a group key: the /64 prefix of an IPv6 client at most
+  const int max_group_bytes = 16;
+  // attempts to read a slot consistently while its owner keeps writing it
+  const int read_attempts = 4;
+}
+
+// Board through which the servers of a host share the state of their coupled
+// connections, such that the connections to a client are coupled even when served
+// by different processes(e.g. one dash_server per player of an experiment).
+//
+// The board is a file mapped by every server; each slot is written by the process
+// that claimed it only, under a sequence lock, and read by the others. The times are
+// those of the servers' clock, i.e. the host's monotonic clock, which all the
+// processes share. The slots of processes that died are claimed back.
+class BottleneckBoard {
+ public:
+  // State of a member as published by its server.
+  struct Entry {
+    // unique over the host: the server's pid and the member id
+    int64_t id;
+    std::string group;
+    QuicTime last_event;
+    QuicTime app_limited_until;
+    // EWMAs, in kbps and us
+    double rate;
+    double srtt;
+    int64_t min_rtt;
+  };
+
+  ~BottleneckBoard();
+
+  // Maps the board at `path`, creating it if needed; nullptr on failure.
+  static std::unique_ptr<BottleneckBoard> Open(const std::string& path);
+
+  // Claims a slot for a member of this process; -1 if the board is full.
+  int Claim();
+  void Release(int slot);
+
+  void Publish(int slot, const Entry& entry);
+  // Entries of the other processes' members of `group`.
+  std::vector<Entry> Peers(const std::string& group) const;
+
+  int32_t pid() const;
+ private:
+  struct Slot;
+  BottleneckBoard(int fd, Slot* slots);
+  static size_t BoardBytes();
+
+  int fd;
+  Slot* slots;
+  int32_t pid_;
+};
+
+}
+
+#endif
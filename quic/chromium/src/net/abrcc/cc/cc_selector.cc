@@ -1,7 +1,44 @@
 #include "net/abrcc/cc/cc_selector.h"
 #include "net/abrcc/cc/singleton.h"
+#include "net/abrcc/cc/cc_wrapper.h"
+
+#include <algorithm>
+#include <sstream>
+
+#include "net/third_party/quiche/src/quic/core/crypto/crypto_protocol.h"
 
 using namespace quic;
+
+namespace {
+  const std::pair<QuicTag, CongestionControlType> kConnectionOptions[] = {
+    {kACBB, kBBR},
+    {kACB2, kBBRv2},
+    {kACAB, kAbbr},
+    {kACTG, kTarget},
+    {kACGP, kGap},
+    {kACT2, kBbr2Target},
+    {kACG2, kBbr2Gap},
+    {kACMN, kMinervaBytes},
+    {kACPC, kPCC},
+    {kACCU, kCubicBytes},
+    {kACRN, kRenoBytes},
+  };
+
+  const std::pair<const char*, CongestionControlType> kTypeNames[] = {
+    {"bbr", kBBR},
+    {"bbr2", kBBRv2},
+    {"abbr", kAbbr},
+    {"xbbr", kAbbr},
+    {"pcc", kPCC},
+    {"cubic", kCubicBytes},
+    {"reno", kRenoBytes},
+    {"target", kTarget},
+    {"gap", kGap},
+    {"bbr2target", kBbr2Target},
+    {"bbr2gap", kBbr2Gap},
+    {"minerva", kMinervaBytes},
+  };
+}
  
 CCSelector* CCSelector::GetInstance() {
   return GET_SINGLETON(CCSelector);
@@ -18,31 +55,58 @@ bool CCSelector::getNoAdaptation() {
   return no_adaptation;
 }
 
+base::Optional<CongestionControlType> CCSelector::parseCongestionControlType(
+  const std::string& cc_type
+) {
+  for (auto& name : kTypeNames) {
+    if (cc_type == name.first) {
+      return name.second;
+    }
+  }
+  return base::nullopt;
+}
+
 void CCSelector::setCongestionControlType(const std::string& cc_type) {
-  if (cc_type == "bbr") {
-    type = kBBR;
-  } else if (cc_type == "bbr2") {
-    type = kBBRv2;
-  } else if (cc_type == "abbr") {
-    type = kAbbr;
-  } else if (cc_type == "xbbr") {
-    type = kAbbr;
+  auto parsed = parseCongestionControlType(cc_type);
+  if (parsed != base::nullopt) {
+    type = parsed.value();
+  }
+  if (cc_type == "xbbr") {
     no_adaptation = true;
-  } else if (cc_type == "pcc") {
-    type = kPCC;
-  } else if (cc_type == "cubic") {
-    type = kCubicBytes; 
-  } else if (cc_type == "reno") {
-    type = kRenoBytes;
-  } else if (cc_type == "target") {
-    type = kTarget;
-  } else if (cc_type == "gap") {
-    type = kGap;
-  } else if (cc_type == "minerva") {
-    type = kMinervaBytes;
   }
 }
 
+void CCSelector::setShadowCongestionControlTypes(const std::string& cc_types) {
+  shadow_types.clear();
+  std::stringstream stream(cc_types);
+  std::string cc_type;
+  while (std::getline(stream, cc_type, ',')) {
+    auto parsed = parseCongestionControlType(cc_type);
+    if (parsed != base::nullopt) {
+      shadow_types.push_back(parsed.value());
+    }
+  }
+}
+
+std::vector<CongestionControlType> CCSelector::getShadowCongestionControlTypes(
+  CongestionControlType primary
+) {
+  std::vector<CongestionControlType> shadows;
+  // the shadows attach to ABR interfaces of their own, hence any type can run in
+  // shadow of any other
+  for (auto shadow : shadow_types) {
+    if (shadow == primary ||
+        std::find(shadows.begin(), shadows.end(), shadow) != shadows.end()) {
+      continue;
+    }
+    if (static_cast<int>(shadows.size()) == ShadowConstants::max_shadows) {
+      break;
+    }
+    shadows.push_back(shadow);
+  }
+  return shadows;
+}
+
 SendAlgorithmInterface* CCSelector::getSendAlgorithmInterface() {
   return interface;
 }
@@ -50,3 +114,15 @@ SendAlgorithmInterface* CCSelector::getSendAlgorithmInterface() {
 void CCSelector::setSendAlgorithmInterface(SendAlgorithmInterface* interface) {
   this->interface = interface;
 }
+
+base::Optional<CongestionControlType> CCSelector::getRequestedCongestionControlType(
+  const QuicConfig& config, 
+  Perspective perspective
+) {
+  for (auto& option : kConnectionOptions) {
+    if (config.HasClientRequestedIndependentOption(option.first, perspective)) {
+      return option.second;
+    }
+  }
+  return base::nullopt;
+}
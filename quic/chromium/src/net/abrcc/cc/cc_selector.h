@@ -4,7 +4,12 @@
 #define ABRCC_CC_SELECTOR_H_
 
 #include "base/memory/singleton.h"
+#include "base/optional.h"
 
+#include <string>
+#include <vector>
+
+#include "net/third_party/quiche/src/quic/core/quic_config.h"
 #include "net/third_party/quiche/src/quic/core/quic_types.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/send_algorithm_interface.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
@@ -13,6 +18,11 @@
 #pragma GCC diagnostic ignored "-Wc++17-extensions"
 
 namespace quic {
+
+// Selects the congestion control of the server's connections. The process-wide
+// type is set from --cc_type, while a client can select the type of its connection
+// through one of the abrcc connection options(kACBB, kACAB, kACTG, ...), so that
+// cohorts of congestion controls can run side by side in the same server.
 class CCSelector {
  public: 
   virtual ~CCSelector();
@@ -20,6 +30,21 @@ class CCSelector {
 
   CongestionControlType getCongestionControlType();
   void setCongestionControlType(const std::string& cc_type);
+  // base::nullopt if `cc_type` is not the name of a type
+  static base::Optional<CongestionControlType> parseCongestionControlType(
+    const std::string& cc_type);
+
+  // Types run in shadow by every connection, from a comma-separated list.
+  void setShadowCongestionControlTypes(const std::string& cc_types);
+  // Shadow types of a connection whose primary type is `primary`: at most
+  // max_shadows, leaving out the primary and the duplicates.
+  std::vector<CongestionControlType> getShadowCongestionControlTypes(
+    CongestionControlType primary);
+
+  // Type requested by the peer through a connection option; base::nullopt if the
+  // peer did not request one.
+  static base::Optional<CongestionControlType> getRequestedCongestionControlType(
+    const QuicConfig& config, Perspective perspective);
   
   SendAlgorithmInterface* getSendAlgorithmInterface();
   void setSendAlgorithmInterface(SendAlgorithmInterface* interface);
@@ -31,6 +56,8 @@ class CCSelector {
   CongestionControlType type;
   SendAlgorithmInterface* interface;
   bool no_adaptation;
+
+  std::vector<CongestionControlType> shadow_types;
 };
 
 }
@@ -1,17 +1,130 @@
 #include "net/abrcc/cc/cc_wrapper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <limits>
+
 #include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
 
 namespace quic {
 
-CCWrapper::CCWrapper(SendAlgorithmInterface* interface) : interface(interface) {}
-CCWrapper::~CCWrapper() { }
+CCWrapper::CCWrapper(
+  SendAlgorithmInterface* interface, 
+  const RttStats* rtt_stats,
+  CongestionControlType type,
+  std::shared_ptr<ConnectionInterfaces> interfaces
+) : interface(interface)
+  , rtt_stats(rtt_stats)
+  , telemetry(TelemetryRecorder::GetInstance())
+  , telemetry_stream(telemetry->OpenStream("cc"))
+  , type(type)
+  , interfaces_(interfaces)
+  , target_interface(nullptr)
+  , gap_interface(nullptr)
+  , ack_channel(nullptr)
+  , bursts_signalled(false)
+  , open_bursts(0)
+  , pending_burst_ends(0)
+  , bottleneck(SharedBottleneck::GetInstance())
+  , bottleneck_member(SharedBottleneckConstants::NOT_PRESENT)
+  , allocation(base::nullopt)
+  , last_event_time(QuicTime::Zero())
+  , capture(CCCapture::GetInstance()->Open(type, rtt_stats))
+  , next_shadow_record(QuicTime::Zero())
+  , forwarded_events(0)
+  , primary_ns(0)
+  , shadow_ns(0) {
+  // the interfaces are resolved once, as the bundle is locked on every access
+  if (type == kTarget || type == kBbr2Target || type == kPCC) {
+    target_interface = interfaces_->target();
+    ack_channel = target_interface->ack_channel.get();
+  } else if (type == kGap || type == kBbr2Gap) {
+    gap_interface = interfaces_->gap();
+    ack_channel = gap_interface->ack_channel.get();
+  }
+}
+
+CCWrapper::~CCWrapper() {
+  if (!shadows.empty() && primary_ns > 0) {
+    ABRCC_LOG(INFO) << "[Shadow] " << shadows.size() << " shadows took "
+                    << 100. * shadow_ns / primary_ns << "% of the primary's time";
+  }
+  telemetry->CloseStream(telemetry_stream);
+  if (bottleneck_member != SharedBottleneckConstants::NOT_PRESENT) {
+    bottleneck->Leave(bottleneck_member);
+  }
+}
+
+void CCWrapper::AddShadow(
+  SendAlgorithmInterface* shadow, 
+  CongestionControlType type,
+  std::shared_ptr<ConnectionInterfaces> interfaces
+) {
+  if (shadow == nullptr) {
+    return;
+  }
+  shadows.push_back(Shadow{
+    interfaces, std::unique_ptr<SendAlgorithmInterface>(shadow), type});
+}
+
+std::shared_ptr<ConnectionInterfaces> CCWrapper::interfaces() const {
+  return interfaces_;
+}
+
+CongestionControlType CCWrapper::sender_type() const {
+  return type;
+}
+
+QuicConnectionStats* CCWrapper::shadow_stats() {
+  if (shadow_stats_ == nullptr) {
+    shadow_stats_.reset(new QuicConnectionStats());
+  }
+  return shadow_stats_.get();
+}
+
+template <typename Forward>
+void CCWrapper::ForwardEvent(const Forward& forward) {
+  // [Shadow] the cost is sampled, as reading the clock is not free either
+  if (shadows.empty() || ++forwarded_events % ShadowConstants::timing_period != 0) {
+    forward(interface);
+    for (auto& shadow : shadows) {
+      forward(shadow.sender.get());
+    }
+    return;
+  }
+  auto start = std::chrono::steady_clock::now();
+  forward(interface);
+  auto primary_end = std::chrono::steady_clock::now();
+  for (auto& shadow : shadows) {
+    forward(shadow.sender.get());
+  }
+  auto end = std::chrono::steady_clock::now();
+  primary_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+    primary_end - start).count();
+  shadow_ns += std::chrono::duration_cast<std::chrono::nanoseconds>(
+    end - primary_end).count();
+  ABRCC_LOG_EVERY_MS(INFO, ShadowConstants::log_period_ms)
+    << "[Shadow] " << shadows.size() << " shadows take "
+    << 100. * shadow_ns / std::max(primary_ns, int64_t(1)) << "% of the primary's time";
+}
 
 void CCWrapper::SetFromConfig(const QuicConfig& config, Perspective perspective) {
-  interface->SetFromConfig(config, perspective);
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->SetFromConfig(config, perspective);
+  });
+  if (capture != nullptr) {
+    capture->SetInitialRtt(rtt_stats->initial_rtt());
+  }
 }
 
 void CCWrapper::SetInitialCongestionWindowInPackets(QuicPacketCount packets) {
-  interface->SetInitialCongestionWindowInPackets(packets);
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->SetInitialCongestionWindowInPackets(packets);
+  });
+  if (capture != nullptr) {
+    capture->SetInitialCongestionWindow(packets);
+  }
 }
 
 
@@ -22,7 +135,84 @@ void CCWrapper::OnCongestionEvent(
   const AckedPacketVector& acked_packets,
   const LostPacketVector& lost_packets
 ) {
-  interface->OnCongestionEvent(rtt_updated, prior_in_flight, event_time, acked_packets, lost_packets);
+  if (ack_channel != nullptr) {
+    ack_channel->setApplicationIdle(bursts_signalled && open_bursts == 0);
+  }
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->OnCongestionEvent(rtt_updated, prior_in_flight, event_time, acked_packets, lost_packets);
+  });
+  last_event_time = event_time;
+  // the ACK completing a burst is processed after the burst's end is signalled, yet
+  // its samples belong to the burst
+  open_bursts = std::max(0, open_bursts - pending_burst_ends);
+  pending_burst_ends = 0;
+  if (capture != nullptr) {
+    capture->OnCongestionEvent(rtt_updated, prior_in_flight, event_time,
+                               acked_packets, lost_packets,
+                               interface->PacingRate(prior_in_flight),
+                               interface->GetCongestionWindow(),
+                               interface->BandwidthEstimate());
+  }
+  if (bottleneck_member != SharedBottleneckConstants::NOT_PRESENT) {
+    bottleneck->OnCongestionEvent(bottleneck_member, event_time,
+                                  interface->BandwidthEstimate(),
+                                  rtt_stats->latest_rtt(), rtt_stats->min_rtt());
+    allocation = bottleneck->GetAllocation(bottleneck_member);
+  }
+  if (telemetry_stream != TelemetryConstants::NOT_PRESENT) {
+    RecordCongestionEvent(prior_in_flight);
+    if (!shadows.empty() && event_time >= next_shadow_record) {
+      RecordShadows(prior_in_flight);
+      next_shadow_record = event_time
+        + QuicTime::Delta::FromMilliseconds(ShadowConstants::record_period_ms);
+    }
+  }
+}
+
+void CCWrapper::RecordCongestionEvent(QuicByteCount prior_in_flight) {
+  auto record = TelemetryRecord::Make(TelemetryRecord::CONGESTION_EVENT);
+  FillSenderState(&record, interface, type, prior_in_flight);
+
+  base::Optional<int> target_rate = base::nullopt;
+  if (target_interface != nullptr) {
+    target_rate = target_interface->getTargetRate();
+  } else if (gap_interface != nullptr) {
+    target_rate = gap_interface->getTargetRate();
+  }
+  if (target_rate != base::nullopt) {
+    record.target_rate = target_rate.value();
+  }
+
+  telemetry->Record(telemetry_stream, record);
+}
+
+void CCWrapper::RecordShadows(QuicByteCount prior_in_flight) {
+  for (const auto& shadow : shadows) {
+    auto record = TelemetryRecord::Make(TelemetryRecord::SHADOW_EVENT);
+    FillSenderState(&record, shadow.sender.get(), shadow.type, prior_in_flight);
+    telemetry->Record(telemetry_stream, record);
+  }
+}
+
+void CCWrapper::FillSenderState(
+  TelemetryRecord* record,
+  const SendAlgorithmInterface* sender,
+  CongestionControlType sender_type,
+  QuicByteCount prior_in_flight
+) const {
+  record->cc_type = sender_type;
+  record->mode = (sender->InSlowStart() ? TelemetryRecord::SLOW_START : 0)
+               | (sender->InRecovery() ? TelemetryRecord::RECOVERY : 0);
+
+  QuicBandwidth bandwidth = sender->BandwidthEstimate();
+  record->bandwidth = bandwidth.ToKBitsPerSecond();
+  if (!bandwidth.IsZero()) {
+    record->pacing_gain = 1. * sender->PacingRate(prior_in_flight).ToBitsPerSecond()
+                        / bandwidth.ToBitsPerSecond();
+  }
+  record->min_rtt = rtt_stats->min_rtt().ToMicroseconds();
+  record->cwnd = sender->GetCongestionWindow();
+  record->bytes_in_flight = prior_in_flight;
 }
 
 
@@ -33,27 +223,86 @@ void CCWrapper::OnPacketSent(
   QuicByteCount bytes,
   HasRetransmittableData is_retransmittable
 ) {
-  interface->OnPacketSent(sent_time, bytes_in_flight, packet_number, bytes, is_retransmittable); 
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->OnPacketSent(sent_time, bytes_in_flight, packet_number, bytes, is_retransmittable);
+  });
+  if (capture != nullptr) {
+    capture->OnPacketSent(sent_time, bytes_in_flight, packet_number, bytes,
+                          is_retransmittable == HAS_RETRANSMITTABLE_DATA);
+  }
 }
 
 
 void CCWrapper::OnRetransmissionTimeout(bool packets_retransmitted) {
-  interface->OnRetransmissionTimeout(packets_retransmitted); 
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->OnRetransmissionTimeout(packets_retransmitted);
+  });
+  if (capture != nullptr) {
+    capture->OnRetransmissionTimeout(packets_retransmitted);
+  }
 }
 
 
 void CCWrapper::OnConnectionMigration() {
-  interface->OnConnectionMigration();
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->OnConnectionMigration();
+  });
+  if (capture != nullptr) {
+    capture->OnConnectionMigration();
+  }
+}
+
+
+void CCWrapper::OnReplaced() {
+  // the connection is recorded and captured by the replacing wrapper
+  telemetry->CloseStream(telemetry_stream);
+  telemetry_stream = TelemetryConstants::NOT_PRESENT;
+  if (capture != nullptr) {
+    capture->Discard();
+    capture.reset();
+  }
+}
+
+void CCWrapper::SetPeerAddress(const QuicSocketAddress& peer_address) {
+  if (!bottleneck->enabled()) {
+    return;
+  }
+  // a migrated connection moves to the group of its new address
+  if (bottleneck_member != SharedBottleneckConstants::NOT_PRESENT) {
+    bottleneck->Leave(bottleneck_member);
+  }
+  bottleneck_member = bottleneck->Join(peer_address);
+  allocation = base::nullopt;
+}
+
+
+void CCWrapper::OnRttUpdated(
+  QuicTime::Delta send_delta,
+  QuicTime::Delta ack_delay,
+  QuicTime now
+) {
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->OnRttUpdated(send_delta, ack_delay, now);
+  });
+  if (capture != nullptr) {
+    capture->OnRttUpdated(send_delta, ack_delay, now);
+  }
 }
 
 
 bool CCWrapper::CanSend(QuicByteCount bytes_in_flight) {
-  return interface->CanSend(bytes_in_flight);
+  return interface->CanSend(bytes_in_flight) && bytes_in_flight < AllocatedWindow();
 }
 
 
 QuicBandwidth CCWrapper::PacingRate(QuicByteCount bytes_in_flight) const {
-  return interface->PacingRate(bytes_in_flight); 
+  QuicBandwidth pacing_rate = interface->PacingRate(bytes_in_flight);
+  if (allocation != base::nullopt) {
+    // [SharedBottleneck] the sender's own gain cycle runs within its share
+    pacing_rate = std::min(pacing_rate,
+                           allocation->max_pacing_gain * allocation->rate);
+  }
+  return pacing_rate;
 }
 
 
@@ -62,7 +311,24 @@ QuicBandwidth CCWrapper::BandwidthEstimate() const {
 }
 
 QuicByteCount CCWrapper::GetCongestionWindow() const {
-  return interface->GetCongestionWindow();
+  return std::min(interface->GetCongestionWindow(), AllocatedWindow());
+}
+
+QuicByteCount CCWrapper::AllocatedWindow() const {
+  if (allocation == base::nullopt) {
+    return std::numeric_limits<QuicByteCount>::max();
+  }
+
+  // [SharedBottleneck] a window larger than the share's BDP would let the
+  // sender queue above its share between the paced sends
+  QuicTime::Delta rtt = rtt_stats->min_rtt().IsZero()
+    ? rtt_stats->initial_rtt() : rtt_stats->min_rtt();
+  QuicBandwidth rate = allocation->max_pacing_gain * allocation->rate;
+  QuicByteCount bdp = rate.ToBytesPerPeriod(rtt);
+  return std::max(
+    QuicByteCount(SharedBottleneckConstants::cwnd_gain * bdp),
+    QuicByteCount(SharedBottleneckConstants::min_cwnd_packets * kDefaultTCPMSS)
+  );
 }
 
 bool CCWrapper::InSlowStart() const {
@@ -86,15 +352,52 @@ CongestionControlType CCWrapper::GetCongestionControlType() const {
 }
 
 void CCWrapper::AdjustNetworkParameters(const NetworkParams& params) {
-  interface->AdjustNetworkParameters(params);
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->AdjustNetworkParameters(params);
+  });
+  if (capture != nullptr) {
+    capture->SetInitialRtt(rtt_stats->initial_rtt());
+    capture->AdjustNetworkParameters(params.bandwidth, params.rtt,
+                                     params.allow_cwnd_to_decrease);
+  }
 }
 
 std::string CCWrapper::GetDebugState() const {
   return interface->GetDebugState();
 }
 
+void CCWrapper::OnApplicationBurst(bool started) {
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->OnApplicationBurst(started);
+  });
+  if (ack_channel == nullptr) {
+    return;
+  }
+  if (started) {
+    bursts_signalled = true;
+    open_bursts += 1;
+  } else {
+    pending_burst_ends += 1;
+  }
+}
+
+
 void CCWrapper::OnApplicationLimited(QuicByteCount bytes_in_flight) {
-  interface->OnApplicationLimited(bytes_in_flight);
+  ForwardEvent([&](SendAlgorithmInterface* sender) {
+    sender->OnApplicationLimited(bytes_in_flight);
+  });
+  if (ack_channel != nullptr && bytes_in_flight == 0) {
+    // nothing left of the bursts, including the ones whose end never came(e.g. a
+    // reset stream)
+    open_bursts = 0;
+    pending_burst_ends = 0;
+  }
+  if (capture != nullptr) {
+    capture->OnApplicationLimited(bytes_in_flight);
+  }
+  if (bottleneck_member != SharedBottleneckConstants::NOT_PRESENT) {
+    bottleneck->OnApplicationLimited(bottleneck_member, last_event_time);
+  }
 }
 
 }
@@ -1,6 +1,9 @@
 #ifndef ABRCC_CC_WRAPPER_H_
 #define ABRCC_CC_WRAPPER_H_
 
+#include <memory>
+#include <vector>
+
 #include "net/third_party/quiche/src/quic/core/congestion_control/bandwidth_sampler.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_drain.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_misc.h"
@@ -11,14 +14,37 @@
 #include "net/third_party/quiche/src/quic/core/congestion_control/send_algorithm_interface.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/windowed_filter.h"
 #include "net/third_party/quiche/src/quic/core/quic_bandwidth.h"
+#include "net/third_party/quiche/src/quic/core/quic_connection_stats.h"
 #include "net/third_party/quiche/src/quic/core/quic_types.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_export.h"
 
+#include "net/abrcc/cc/connection_interfaces.h"
+#include "net/abrcc/cc/gap.h"
+#include "net/abrcc/cc/shared_bottleneck.h"
+#include "net/abrcc/cc/target.h"
+#include "net/abrcc/replay/event_log.h"
+#include "net/abrcc/telemetry/recorder.h"
+
 namespace quic {
 
+namespace ShadowConstants {
+  // shadow senders run per connection at most
+  const int max_shadows = 2;
+
+  // period(ms) between two telemetry records of a connection's shadows
+  const int record_period_ms = 50;
+
+  // one in timing_period forwarded events is timed, to measure the shadows' cost
+  const int timing_period = 64;
+  // period(ms) with which the measured cost is logged
+  const int log_period_ms = 10000;
+}
+
 class CCWrapper : public SendAlgorithmInterface { 
  public:
-  CCWrapper(SendAlgorithmInterface* interface);
+  CCWrapper(SendAlgorithmInterface* interface, const RttStats* rtt_stats,
+            CongestionControlType type,
+            std::shared_ptr<ConnectionInterfaces> interfaces);
   ~CCWrapper() override;
 
   void SetFromConfig(const QuicConfig& config, Perspective perspective) override;
@@ -35,6 +61,12 @@ class CCWrapper : public SendAlgorithmInterface {
                     HasRetransmittableData is_retransmittable) override;
   void OnRetransmissionTimeout(bool packets_retransmitted) override;
   void OnConnectionMigration() override;
+  void SetPeerAddress(const QuicSocketAddress& peer_address) override;
+  void OnRttUpdated(QuicTime::Delta send_delta,
+                    QuicTime::Delta ack_delay,
+                    QuicTime now) override;
+  void OnApplicationBurst(bool started) override;
+  void OnReplaced() override;
   bool CanSend(QuicByteCount bytes_in_flight) override;
   QuicBandwidth PacingRate(QuicByteCount bytes_in_flight) const override;
   QuicBandwidth BandwidthEstimate() const override;
@@ -47,8 +79,83 @@ class CCWrapper : public SendAlgorithmInterface {
   void AdjustNetworkParameters(const NetworkParams& params) override;
   std::string GetDebugState() const override;
   void OnApplicationLimited(QuicByteCount bytes_in_flight) override;
+
+  // Runs `shadow` on the same events as the primary sender, which keeps the sole
+  // control over CanSend and PacingRate; takes ownership. The shadow's ABR
+  // interfaces, `interfaces`, are not read by any ABR.
+  void AddShadow(SendAlgorithmInterface* shadow, CongestionControlType type,
+                 std::shared_ptr<ConnectionInterfaces> interfaces);
+  // Connection stats updated by the shadows, kept apart from the connection's.
+  QuicConnectionStats* shadow_stats();
+
+  // ABR interfaces of the primary sender, to be bound by the connection's ABR.
+  std::shared_ptr<ConnectionInterfaces> interfaces() const;
+  // Type the primary sender was created for, which selects the interfaces it
+  // feeds; unlike GetCongestionControlType, the abrcc types are kept.
+  CongestionControlType sender_type() const;
  private:
+  struct Shadow {
+    // declared first, as the sender detaches from its interface when destroyed
+    std::shared_ptr<ConnectionInterfaces> interfaces;
+    std::unique_ptr<SendAlgorithmInterface> sender;
+    CongestionControlType type;
+  };
+
+  // Calls `forward` with the primary sender, then with every shadow.
+  template <typename Forward>
+  void ForwardEvent(const Forward& forward);
+
+  // Records the sender's state after a congestion event into the connection's
+  // telemetry stream.
+  void RecordCongestionEvent(QuicByteCount prior_in_flight);
+  void RecordShadows(QuicByteCount prior_in_flight);
+  void FillSenderState(TelemetryRecord* record, const SendAlgorithmInterface* sender,
+                       CongestionControlType sender_type,
+                       QuicByteCount prior_in_flight) const;
+
   SendAlgorithmInterface* interface;
+  const RttStats* rtt_stats;
+
+  // telemetry; the stream is NOT_PRESENT when the recorder is disabled
+  TelemetryRecorder* telemetry;
+  int telemetry_stream;
+  CongestionControlType type;
+  std::shared_ptr<ConnectionInterfaces> interfaces_;
+  BbrTarget::BbrInterface* target_interface;
+  BbrGap::BbrInterface* gap_interface;
+  // delivery rate samples of the ABR's interface, accounting the application's
+  // bursts; nullptr for the senders without ABR interface
+  AckChannel* ack_channel;
+  // the application's bursts; once one was signalled, the connection is idle while
+  // none is open
+  bool bursts_signalled;
+  int open_bursts;
+  // bursts whose end was signalled before the ACK completing them was processed
+  int pending_burst_ends;
+
+  // Congestion window allowed by the member's allocation; unbounded while the
+  // member is not coupled.
+  QuicByteCount AllocatedWindow() const;
+
+  // coupling with the connections behind the same bottleneck; the pacing rate and
+  // the congestion window are capped by the allocation while the member is coupled
+  SharedBottleneck* bottleneck;
+  int bottleneck_member;
+  base::Optional<SharedBottleneck::Allocation> allocation;
+  QuicTime last_event_time;
+
+  // capture of the sender's inputs for offline replay; nullptr if disabled
+  std::unique_ptr<CCEventWriter> capture;
+
+  // senders run in shadow
+  std::vector<Shadow> shadows;
+  std::unique_ptr<QuicConnectionStats> shadow_stats_;
+  QuicTime next_shadow_record;
+  // forwarded events and the time(ns) the timed ones spent in the primary and in
+  // the shadows
+  int64_t forwarded_events;
+  int64_t primary_ns;
+  int64_t shadow_ns;
 };
 
 }
@@ -0,0 +1,40 @@
+#include "net/abrcc/cc/connection_interfaces.h"
+
+namespace quic {
+
+ConnectionInterfaces::ConnectionInterfaces() {}
+ConnectionInterfaces::~ConnectionInterfaces() {}
+
+BbrTarget::BbrInterface* ConnectionInterfaces::target() {
+  QuicWriterMutexLock lock(&mutex_);
+  if (target_ == nullptr) {
+    target_.reset(new BbrTarget::BbrInterface());
+  }
+  return target_.get();
+}
+
+BbrGap::BbrInterface* ConnectionInterfaces::gap() {
+  QuicWriterMutexLock lock(&mutex_);
+  if (gap_ == nullptr) {
+    gap_.reset(new BbrGap::BbrInterface());
+  }
+  return gap_.get();
+}
+
+BbrAdapter::BbrInterface* ConnectionInterfaces::adapter() {
+  QuicWriterMutexLock lock(&mutex_);
+  if (adapter_ == nullptr) {
+    adapter_.reset(new BbrAdapter::BbrInterface());
+  }
+  return adapter_.get();
+}
+
+MinervaInterface* ConnectionInterfaces::minerva() {
+  QuicWriterMutexLock lock(&mutex_);
+  if (minerva_ == nullptr) {
+    minerva_.reset(new MinervaInterface());
+  }
+  return minerva_.get();
+}
+
+}
@@ -0,0 +1,42 @@
+#ifndef ABRCC_CC_CONNECTION_INTERFACES_H_
+#define ABRCC_CC_CONNECTION_INTERFACES_H_
+
+#include <memory>
+
+#include "net/abrcc/cc/bbr_adapter.h"
+#include "net/abrcc/cc/gap.h"
+#include "net/abrcc/cc/minerva.h"
+#include "net/abrcc/cc/target.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
+
+namespace quic {
+
+// The ABR interfaces of a single connection. The connection's sender attaches to
+// the interface of its type and the ABR serving the connection binds to the same
+// bundle, such that the connections of a process do not share their samples, gain
+// cycles or targets.
+//
+// Each interface is created on first use, from either the network thread or the
+// ABR loop; the bundle is shared by the CCWrapper and the ABR, as either may
+// outlive the other.
+class ConnectionInterfaces {
+ public:
+  ConnectionInterfaces();
+  ~ConnectionInterfaces();
+
+  BbrTarget::BbrInterface* target();
+  BbrGap::BbrInterface* gap();
+  BbrAdapter::BbrInterface* adapter();
+  MinervaInterface* minerva();
+ private:
+  std::unique_ptr<BbrTarget::BbrInterface> target_;
+  std::unique_ptr<BbrGap::BbrInterface> gap_;
+  std::unique_ptr<BbrAdapter::BbrInterface> adapter_;
+  std::unique_ptr<MinervaInterface> minerva_;
+
+  mutable QuicMutex mutex_;
+};
+
+}
+
+#endif
@@ -12,11 +12,12 @@
 #include "net/third_party/quiche/src/quic/platform/api/quic_flag_utils.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_flags.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
+#include "net/abrcc/cc/bbr2_abr.h"
 
 #include "net/abrcc/structs/estimators.h"
 #include "net/abrcc/structs/averages.h"
 
-#include "net/abrcc/cc/singleton.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
 
 
@@ -65,19 +66,20 @@ const float kSimilarMinRttThreshold = 1.125;
  * ABRCC Extension -- BEGIN
  **/
 
-BbrGap::BbrInterface* BbrGap::BbrInterface::GetInstance() {
-  return GET_SINGLETON(BbrGap::BbrInterface);
-}
-
 std::vector<float> BbrGap::BbrInterface::getPacingGainCycle() {
   return kPacingGain;
 }
 
 std::vector<int> BbrGap::BbrInterface::popDeliveryRates() {
-  QuicWriterMutexLock lock(&delivery_rates_mutex_);
-  std::vector<int> out = deliveryRates;
-  deliveryRates = std::vector<int>();
-  return out;
+  return ack_channel->popDeliveryRates();
+}
+
+std::vector<int> BbrGap::BbrInterface::popBurstDeliveryRates() {
+  return ack_channel->popBurstDeliveryRates();
+}
+
+std::vector<AckSample> BbrGap::BbrInterface::popAckSamples() {
+  return ack_channel->popAll();
 }
 
 int BbrGap::BbrInterface::getGainCycleLength() {
@@ -90,7 +92,15 @@ QuicRoundTripCount BbrGap::BbrInterface::kBandwidthWindowSize() {
 }
 
 void BbrGap::BbrInterface::setParent(BbrGap *parent) {
+  QuicWriterMutexLock lock(&parent_mutex_);
   this->parent = parent;
+  this->bbr2_parent = nullptr;
+}
+
+void BbrGap::BbrInterface::setBbr2Parent(Bbr2Abr *parent) {
+  QuicWriterMutexLock lock(&parent_mutex_);
+  this->bbr2_parent = parent;
+  this->parent = nullptr;
 }
 
 bool BbrGap::BbrInterface::recovery() const {
@@ -104,7 +114,11 @@ void BbrGap::BbrInterface::setRecovery(bool recovery) {
 }
 
 base::Optional<float> BbrGap::BbrInterface::PacingGain() const {
+  QuicReaderMutexLock parent_lock(&parent_mutex_);
   QuicReaderMutexLock lock(&pacing_cycle_mutex_);
+  if (bbr2_parent != nullptr) {
+    return bbr2_parent->pacingGain();
+  }
   if (parent == nullptr) {
     return base::nullopt;
   }
@@ -112,8 +126,9 @@ base::Optional<float> BbrGap::BbrInterface::PacingGain() const {
 }
 
 base::Optional<int> BbrGap::BbrInterface::getTargetRate() const { 
+  QuicReaderMutexLock parent_lock(&parent_mutex_);
   QuicReaderMutexLock lock(&target_rate_mutex_);
-  if (parent == nullptr) {
+  if (parent == nullptr && bbr2_parent == nullptr) {
     return base::nullopt;
   }
   return targetRate;
@@ -125,24 +140,29 @@ void BbrGap::BbrInterface::setTargetRate(int rate) {
 }
 
 base::Optional<int> BbrGap::BbrInterface::RttEstimate() const {
-  if (parent == nullptr) {
-    return base::nullopt;
-  }
-  return !parent->min_rtt_.IsZero() 
-    ? base::Optional<int>(parent->min_rtt_.ToMilliseconds()) 
+  QuicReaderMutexLock parent_lock(&parent_mutex_);
+  QuicTime::Delta min_rtt = QuicTime::Delta::Zero();
+  if (bbr2_parent != nullptr) {
+    min_rtt = bbr2_parent->minRtt();
+  } else if (parent != nullptr) {
+    min_rtt = parent->min_rtt_;
+  }
+  return !min_rtt.IsZero() 
+    ? base::Optional<int>(min_rtt.ToMilliseconds()) 
     : base::nullopt;
 }
 
 BbrGap::BbrInterface::BbrInterface() 
   : kPacingGain(std::vector<float>{1.25, 0.75, 1, 1, 1, 1, 1, 1})
-  , deliveryRates(std::vector<int>{})
   , targetRate(base::nullopt)
-  , parent(nullptr) {} 
+  , parent(nullptr)
+  , bbr2_parent(nullptr)
+  , ack_channel(new AckChannel(AckChannelConstants::capacity)) {} 
 
 BbrGap::BbrInterface::~BbrInterface() {}
 
 void BbrGap::changeMode(BbrGap::Mode newMode) {
-  QUIC_LOG(WARNING) << "[BBR Mode]: " << mode_ << " -> " << newMode;
+  ABRCC_LOG(WARNING) << "[BBR Mode]: " << mode_ << " -> " << newMode;
   mode_ = newMode;
 }
 
@@ -183,23 +203,26 @@ BbrGap::BbrGap(QuicTime now,
                      QuicPacketCount initial_tcp_congestion_window,
                      QuicPacketCount max_tcp_congestion_window,
                      QuicRandom* random,
-                     QuicConnectionStats* stats)
-    : interface(BbrInterface::GetInstance()), 
+                     QuicConnectionStats* stats,
+                     BbrInterface* interface)
+    : interface(interface), 
       bandwidth_estimator(new structs::PIDEstimator<double>(
         BbrGapConstants::bandwidth_estimator_window_size, 
         BbrGapConstants::bandwidth_estimator_p,
         BbrGapConstants::bandwidth_estimator_i, 
         BbrGapConstants::bandwidth_estimator_d
       )), 
+      min_estimator_trace(BbrGapConstants::bandwidth_estimator_window_size + 1),
+      max_estimator_trace(BbrGapConstants::bandwidth_estimator_window_size + 1),
 
       rtt_stats_(rtt_stats),
       unacked_packets_(unacked_packets),
       random_(random),
       stats_(stats),
       mode_(STARTUP),
-      sampler_(unacked_packets, BbrInterface::GetInstance()->kBandwidthWindowSize()),
+      sampler_(unacked_packets, interface->kBandwidthWindowSize()),
       round_trip_count_(0),
-      max_bandwidth_(BbrInterface::GetInstance()->kBandwidthWindowSize(), QuicBandwidth::Zero(), 0),
+      max_bandwidth_(interface->kBandwidthWindowSize(), QuicBandwidth::Zero(), 0),
       min_rtt_(QuicTime::Delta::Zero()),
       min_rtt_timestamp_(QuicTime::Zero()),
       congestion_window_(initial_tcp_congestion_window * kDefaultTCPMSS),
@@ -251,8 +274,9 @@ BbrGap::BbrGap(QuicTime now,
 }
 
 BbrGap::~BbrGap() {
+  QuicWriterMutexLock lock(&interface->parent_mutex_);
   if (interface->parent == this) {
-    interface->setParent(nullptr);
+    interface->parent = nullptr;
   }
 }
 
@@ -614,30 +638,25 @@ QuicByteCount BbrGap::GetTargetCongestionWindow(float gain) const {
   }
   auto potential_window_ = GetMinRtt() * potential_;
 
-  // Compute the windowed maximum and minium estimator trace values
-  double min_estimator_trace = (double)(1 << 30);
-  double max_estimator_trace = -(double)(1 << 30);
-  int min_idx = 0;
-  int max_idx = 0;
-  for (int i = std::max(0, int(estimator_trace.size()) - 1 - BbrGapConstants::bandwidth_estimator_window_size);
-      i < int(estimator_trace.size()); ++i) {
-    if (estimator_trace[i] < min_estimator_trace) {
-      min_estimator_trace = estimator_trace[i];
-      min_idx = i;
-    }
-    if (estimator_trace[i] > max_estimator_trace) {
-      max_estimator_trace = estimator_trace[i];
-      max_idx = i;
-    }
+  // Windowed maximum and minium estimator trace values
+  double min_trace = (double)(1 << 30);
+  double max_trace = -(double)(1 << 30);
+  long long min_idx = 0;
+  long long max_idx = 0;
+  if (!min_estimator_trace.empty()) {
+    min_trace = min_estimator_trace.best();
+    max_trace = max_estimator_trace.best();
+    min_idx = min_estimator_trace.best_index();
+    max_idx = max_estimator_trace.best_index();
   }
 
   // If the estimator increased rapidly(e.g. 10 times) it may be that the bdp and rrt was increased, so we
   // are about to cause congestion, hence we should decrease the potential window 
   interface->setRecovery(false);
   double scale_factor = 1.;
-  if (max_estimator_trace > 10 * min_estimator_trace && min_idx < max_idx) {
+  if (max_trace > 10 * min_trace && min_idx < max_idx) {
     //QUIC_LOG(WARNING) << "[GapCC] estimator trace large difference detected: " 
-    //                  << min_estimator_trace << " -> " << max_estimator_trace;
+    //                  << min_trace << " -> " << max_trace;
     scale_factor = BbrGapConstants::scale_factor;
     interface->setRecovery(true);
   }
@@ -716,9 +735,6 @@ bool BbrGap::UpdateRoundTripCounter(QuicPacketNumber last_acked_packet) {
 bool BbrGap::UpdateBandwidthAndMinRtt(
     QuicTime now,
     const AckedPacketVector& acked_packets) {
-  // Use lock to register delivery rates
-  QuicWriterMutexLock lock(&interface->delivery_rates_mutex_);
-  
   QuicTime::Delta sample_min_rtt = QuicTime::Delta::Infinite();
   for (const auto& packet : acked_packets) {
     BandwidthSample bandwidth_sample =
@@ -730,9 +746,14 @@ bool BbrGap::UpdateBandwidthAndMinRtt(
     }
 
     // Register delivery rates
-    interface->deliveryRates.push_back(
-      bandwidth_sample.bandwidth.ToKBitsPerSecond()
-    );
+    interface->ack_channel->push(AckSample{
+      (now - QuicTime::Zero()).ToMicroseconds(),
+      static_cast<int>(bandwidth_sample.bandwidth.ToKBitsPerSecond()),
+      static_cast<int>(bandwidth_sample.rtt.ToMilliseconds()),
+      recovery_state_ != NOT_IN_RECOVERY,
+      static_cast<int>(packet.bytes_acked),
+      bandwidth_sample.state_at_send.is_app_limited,
+    });
 
     last_sample_is_app_limited_ = bandwidth_sample.state_at_send.is_app_limited;
     has_non_app_limited_sample_ |=
@@ -816,7 +837,9 @@ void BbrGap::UpdateGainCyclePhase(
     bandwidth_estimator->sample(BandwidthEstimate().ToKBitsPerSecond()); 
 
     // Add to the estimator trace the bandwidth product, so we can observe abrupt changes 
-    estimator_trace.push_back(BandwidthEstimate() * GetMinRtt());
+    double bdp = BandwidthEstimate() * GetMinRtt();
+    min_estimator_trace.push(bdp);
+    max_estimator_trace.push(bdp);
 
     // we always use pacing_gain_ = 1
     pacing_gain_ = 1;
@@ -19,12 +19,16 @@
 #include "net/third_party/quiche/src/quic/platform/api/quic_export.h"
 
 #include "net/abrcc/structs/estimators.h"
+#include "net/abrcc/structs/monotonic_window.h"
+#include "net/abrcc/cc/ack_channel.h"
 #include "net/abrcc/cc/cc_selector.h"
-#include "net/abrcc/cc/singleton.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
 
 namespace quic {
 
+class Bbr2Abr;
+class CCWrapper;
+class ConnectionInterfaces;
 class RttStats;
 
 // GapAbr's default congestion control. The main modifications to BBR are present
@@ -58,7 +62,6 @@ class QUIC_EXPORT_PRIVATE BbrGap : public SendAlgorithmInterface {
   class __attribute__((packed)) BbrInterface {
    public:
     virtual ~BbrInterface();
-    static BbrInterface* GetInstance();
 
     // controlling gain cycle
     std::vector<float> getPacingGainCycle();
@@ -67,6 +70,8 @@ class QUIC_EXPORT_PRIVATE BbrGap : public SendAlgorithmInterface {
     
     // attach parent when instance changes
     void setParent(BbrGap* parent);
+    // attach a Bbr2Sender steered through Bbr2Abr instead of a parent
+    void setBbr2Parent(Bbr2Abr* parent);
     
     // recovery mode
     bool recovery() const;
@@ -76,8 +81,10 @@ class QUIC_EXPORT_PRIVATE BbrGap : public SendAlgorithmInterface {
     base::Optional<float> PacingGain() const;
     base::Optional<int> RttEstimate() const; 
    
-    // delivery rate samples
+    // delivery rate samples; the burst ones are not app-limited
     std::vector<int> popDeliveryRates();
+    std::vector<int> popBurstDeliveryRates();
+    std::vector<AckSample> popAckSamples();
    
     // target 
     void setTargetRate(int targetRate);
@@ -86,17 +93,26 @@ class QUIC_EXPORT_PRIVATE BbrGap : public SendAlgorithmInterface {
     BbrInterface();
 
     std::vector<float> kPacingGain;  
-    std::vector<int> deliveryRates;
     base::Optional<int> targetRate;
     bool recovery_;
 
     BbrGap *parent;
-    mutable QuicMutex delivery_rates_mutex_;
+    Bbr2Abr *bbr2_parent;
+
+    // held through a pointer as the interface is packed
+    std::unique_ptr<AckChannel> ack_channel;
+
+    // guards the parents, attached and detached on the network thread while the
+    // ABR reads them on its own
+    mutable QuicMutex parent_mutex_;
     mutable QuicMutex pacing_cycle_mutex_; 
     mutable QuicMutex target_rate_mutex_;
     mutable QuicMutex recovery_mutex_;
 
     friend class BbrGap;
+    friend class ConnectionInterfaces;
+    friend class Bbr2Abr;
+    friend class CCWrapper;
   };
 
   /**
@@ -159,7 +175,8 @@ class QUIC_EXPORT_PRIVATE BbrGap : public SendAlgorithmInterface {
             QuicPacketCount initial_tcp_congestion_window,
             QuicPacketCount max_tcp_congestion_window,
             QuicRandom* random,
-            QuicConnectionStats* stats);
+            QuicConnectionStats* stats,
+         BbrInterface* interface);
   BbrGap(const BbrGap&) = delete;
   BbrGap& operator=(const BbrGap&) = delete;
   ~BbrGap() override;
@@ -243,8 +260,11 @@ class QUIC_EXPORT_PRIVATE BbrGap : public SendAlgorithmInterface {
   // future bandwidth estimator
   std::unique_ptr<structs::MovingAverage<double>> bandwidth_estimator;
 
-  // estimator trace
-  std::vector<double> estimator_trace;
+  // windowed minimum and maximum of the estimator trace(the BDP registered at each
+  // gain cycle step) over the last `bandwidth_estimator_window_size` + 1 steps;
+  // ties are resolved towards the earliest step
+  structs::WindowedMin<double> min_estimator_trace;
+  structs::WindowedMax<double> max_estimator_trace;
 
   void changeMode(Mode newMode);
 
@@ -60,9 +60,10 @@ const QuicPacketCount kMaxResumptionCongestionWindow = 200;
 /// ------------------------ MinervaBytes ----------------------------
 /// ------------------------------------------------------------------
 
-MinervaBytes::MinervaBytes() 
+MinervaBytes::MinervaBytes(MinervaInterface* interface) 
     : num_connections_(kDefaultNumConnections),
-      epoch_(QuicTime::Zero()) {
+      epoch_(QuicTime::Zero()),
+      interface(interface) {
  ResetCubicState();
 }
 
@@ -115,7 +116,6 @@ float MinervaBytes::BetaLastMax() const {
 }
 
 void MinervaBytes::ResetCubicState() {
-  interface = MinervaInterface::GetInstance();
   epoch_ = QuicTime::Zero();             // Reset time.
   last_max_congestion_window_ = 0;
   acked_bytes_count_ = 0;
@@ -234,14 +234,11 @@ QuicByteCount MinervaBytes::CongestionWindowAfterAck(
 /// ------------------------ MinervaInterface ------------------------
 /// ------------------------------------------------------------------
 
-MinervaInterface *MinervaInterface::GetInstance() {
-  return GET_SINGLETON(MinervaInterface);
-}
-
 MinervaInterface::MinervaInterface()
-  : min_rtt_(base::nullopt)
-  , acked_bytes_(0)
-  , link_weight_(base::nullopt) {}
+  : parent(nullptr)
+  , min_rtt_(base::nullopt)
+  , link_weight_(base::nullopt)
+  , acked_bytes_(new std::atomic<int>(0)) {}
 MinervaInterface::~MinervaInterface() {}
 
 void MinervaInterface::updateMinRtt() {
@@ -271,18 +268,15 @@ base::Optional<int> MinervaInterface::minRtt() const {
 
 
 int MinervaInterface::ackedBytes() const {
-  QuicReaderMutexLock lock(&acked_bytes_mutex_);
-  return acked_bytes_;
+  return acked_bytes_->load(std::memory_order_relaxed);
 }
 
 void MinervaInterface::addAckedBytes(const int bytes) {
-  QuicWriterMutexLock lock(&acked_bytes_mutex_);
-  acked_bytes_ += bytes;
+  acked_bytes_->fetch_add(bytes, std::memory_order_relaxed);
 }
 
 void MinervaInterface::resetAckedBytes() {
-  QuicWriterMutexLock lock(&acked_bytes_mutex_);
-  acked_bytes_ = 0;
+  acked_bytes_->store(0, std::memory_order_relaxed);
 }
 
 void MinervaInterface::setLinkWeight(const double weight) {
@@ -303,13 +297,15 @@ TcpMinervaSenderBytes::TcpMinervaSenderBytes(
     const RttStats* rtt_stats,
     QuicPacketCount initial_tcp_congestion_window,
     QuicPacketCount max_congestion_window,
-    QuicConnectionStats* stats)
+    QuicConnectionStats* stats,
+    MinervaInterface* interface)
     : rtt_stats_(rtt_stats),
       stats_(stats),
       num_connections_(kDefaultNumConnections),
       min4_mode_(false),
       last_cutback_exited_slowstart_(false),
       slow_start_large_reduction_(false),
+      cubic_(interface),
       num_acked_packets_(0),
       congestion_window_(initial_tcp_congestion_window * kDefaultTCPMSS),
       min_congestion_window_(kDefaultMinimumCongestionWindow),
@@ -320,12 +316,17 @@ TcpMinervaSenderBytes::TcpMinervaSenderBytes(
       initial_max_tcp_congestion_window_(max_congestion_window *
                                          kDefaultTCPMSS),
       min_slow_start_exit_window_(min_congestion_window_),
-      interface(MinervaInterface::GetInstance()) {
+      interface(interface) {
   QuicWriterMutexLock lock(&interface->parent_mutex_);
   interface->parent = this;
 }
 
-TcpMinervaSenderBytes::~TcpMinervaSenderBytes() {}
+TcpMinervaSenderBytes::~TcpMinervaSenderBytes() {
+  QuicWriterMutexLock lock(&interface->parent_mutex_);
+  if (interface->parent == this) {
+    interface->parent = nullptr;
+  }
+}
 
 void TcpMinervaSenderBytes::AdjustNetworkParameters(const NetworkParams& params) {
   if (params.bandwidth.IsZero() || params.rtt.IsZero()) {
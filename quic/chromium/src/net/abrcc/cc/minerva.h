@@ -1,7 +1,9 @@
 #ifndef ABRCC_CC_MINERVA_H_
 #define ABRCC_CC_MINERVA_H_
 
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <string>
 
 #include "net/third_party/quiche/src/quic/core/congestion_control/hybrid_slow_start.h"
@@ -13,11 +15,11 @@
 #include "net/third_party/quiche/src/quic/core/quic_time.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_export.h"
 
-#include "net/abrcc/cc/singleton.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
 
 namespace quic {
 
+class ConnectionInterfaces;
 class TcpMinervaSenderBytes;
 class MinervaBytes;
 class RttStats;
@@ -26,7 +28,6 @@ class RttStats;
 class __attribute__((packed)) MinervaInterface {
  public:
   virtual ~MinervaInterface();
-  static MinervaInterface* GetInstance();
 
   // general access functions
   base::Optional<int> minRtt() const;
@@ -46,23 +47,26 @@ class __attribute__((packed)) MinervaInterface {
   // parent to be attached when instance changes
   TcpMinervaSenderBytes *parent;
   base::Optional<int> min_rtt_;
-  int acked_bytes_;
   base::Optional<double> link_weight_;
 
+  // updated on every ACK without locking; held through a pointer as the
+  // interface is packed
+  std::unique_ptr<std::atomic<int>> acked_bytes_;
+
   // locks
   mutable QuicMutex min_rtt_mutex_;
-  mutable QuicMutex acked_bytes_mutex_;
   mutable QuicMutex link_weight_mutex_;
   mutable QuicMutex parent_mutex_;
 
   friend class TcpMinervaSenderBytes;
   friend class MinervaAbr;
   friend class MinervaBytes;
+  friend class ConnectionInterfaces;
 };
 
 class QUIC_EXPORT_PRIVATE MinervaBytes {
  public:
-  explicit MinervaBytes();
+  explicit MinervaBytes(MinervaInterface* interface);
   MinervaBytes(const MinervaBytes&) = delete;
   MinervaBytes& operator=(const MinervaBytes&) = delete;
 
@@ -114,7 +118,8 @@ class QUIC_EXPORT_PRIVATE TcpMinervaSenderBytes : public SendAlgorithmInterface
   TcpMinervaSenderBytes(const RttStats* rtt_stats,
                       QuicPacketCount initial_tcp_congestion_window,
                       QuicPacketCount max_congestion_window,
-                      QuicConnectionStats* stats);
+                      QuicConnectionStats* stats,
+                      MinervaInterface* interface);
   TcpMinervaSenderBytes(const TcpMinervaSenderBytes&) = delete;
   TcpMinervaSenderBytes& operator=(const TcpMinervaSenderBytes&) = delete;
   ~TcpMinervaSenderBytes() override;
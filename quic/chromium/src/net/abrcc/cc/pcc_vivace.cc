@@ -0,0 +1,463 @@
+#include "net/abrcc/cc/pcc_vivace.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+
+#include "net/third_party/quiche/src/quic/core/congestion_control/rtt_stats.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Waddress-of-packed-member"
+
+namespace quic {
+
+namespace {
+// The minimum CWND to ensure delayed acks don't reduce bandwidth measurements.
+const QuicByteCount kDefaultMinimumCongestionWindow = 4 * kMaxSegmentSize;
+// Window of the sampler's ack height tracker, in round trips; unused by PCC.
+const QuicRoundTripCount kAckHeightWindowLength = 10;
+
+double ToMbps(QuicBandwidth bandwidth) {
+  return bandwidth.ToBitsPerSecond() / 1e6;
+}
+
+QuicBandwidth FromMbps(double mbps) {
+  return QuicBandwidth::FromBitsPerSecond(static_cast<int64_t>(mbps * 1e6));
+}
+}  // namespace
+
+PccVivace::PccVivace(QuicTime /*now*/,
+                     const RttStats* rtt_stats,
+                     const QuicUnackedPacketMap* unacked_packets,
+                     QuicPacketCount initial_tcp_congestion_window,
+                     QuicPacketCount max_tcp_congestion_window,
+                     QuicRandom* random,
+                     QuicConnectionStats* /*stats*/,
+                     BbrTarget::BbrInterface* interface)
+  : interface(interface)
+  , rtt_stats_(rtt_stats)
+  , unacked_packets_(unacked_packets)
+  , random_(random)
+  , sampler_(unacked_packets, kAckHeightWindowLength)
+  , mode_(STARTING)
+  , rate_(QuicBandwidth::FromBytesAndTimeDelta(
+      initial_tcp_congestion_window * kDefaultTCPMSS, rtt_stats->initial_rtt()))
+  , initial_rate_(rate_)
+  , min_congestion_window_(kDefaultMinimumCongestionWindow)
+  , max_congestion_window_(max_tcp_congestion_window * kDefaultTCPMSS)
+  , useful_started_(0)
+  , useful_evaluated_(0)
+  , round_invalid_(false)
+  , best_(base::nullopt)
+  , last_(Result{0, 0})
+  , direction_(0)
+  , confidence_(1)
+  , step_bound_(PccConstants::initial_step_bound)
+  , bandwidth_estimate_(QuicBandwidth::Zero())
+  , pacing_gain_(1)
+  , min_rtt_(0) {
+  StartRound();
+  interface->setPccParent(this);
+}
+
+PccVivace::~PccVivace() {
+  QuicWriterMutexLock lock(&interface->parent_mutex_);
+  if (interface->pcc_parent == this) {
+    interface->pcc_parent = nullptr;
+  }
+}
+
+bool PccVivace::InSlowStart() const {
+  return mode_ == STARTING;
+}
+
+bool PccVivace::InRecovery() const {
+  return false;
+}
+
+bool PccVivace::ShouldSendProbingPacket() const {
+  return false;
+}
+
+void PccVivace::SetFromConfig(const QuicConfig& /*config*/,
+                              Perspective /*perspective*/) {}
+
+void PccVivace::AdjustNetworkParameters(const NetworkParams& params) {
+  if (mode_ != STARTING || params.bandwidth.IsZero()) {
+    return;
+  }
+  rate_ = params.allow_cwnd_to_decrease
+    ? params.bandwidth
+    : std::max(rate_, params.bandwidth);
+}
+
+void PccVivace::SetInitialCongestionWindowInPackets(
+    QuicPacketCount congestion_window) {
+  if (mode_ == STARTING && best_ == base::nullopt) {
+    rate_ = QuicBandwidth::FromBytesAndTimeDelta(
+      congestion_window * kDefaultTCPMSS, rtt_stats_->initial_rtt());
+  }
+}
+
+void PccVivace::OnPacketSent(QuicTime sent_time,
+                             QuicByteCount bytes_in_flight,
+                             QuicPacketNumber packet_number,
+                             QuicByteCount bytes,
+                             HasRetransmittableData is_retransmittable) {
+  MaybeStartInterval(sent_time);
+  sampler_.OnPacketSent(sent_time, packet_number, bytes, bytes_in_flight,
+                        is_retransmittable);
+
+  MonitorInterval& interval = intervals_.back();
+  if (!interval.first_packet.IsInitialized()) {
+    interval.first_packet = packet_number;
+  }
+  interval.last_packet = packet_number;
+  interval.bytes_sent += bytes;
+}
+
+void PccVivace::OnCongestionEvent(bool rtt_updated,
+                                  QuicByteCount /*prior_in_flight*/,
+                                  QuicTime event_time,
+                                  const AckedPacketVector& acked_packets,
+                                  const LostPacketVector& lost_packets) {
+  QuicPacketNumber largest_acked;
+  for (const auto& packet : acked_packets) {
+    BandwidthSample sample =
+        sampler_.OnPacketAcknowledged(event_time, packet.packet_number);
+    if (sample.state_at_send.is_valid) {
+      // Register delivery rates
+      interface->ack_channel->push(AckSample{
+        (event_time - QuicTime::Zero()).ToMicroseconds(),
+        static_cast<int>(sample.bandwidth.ToKBitsPerSecond()),
+        static_cast<int>(sample.rtt.ToMilliseconds()),
+        !lost_packets.empty(),
+        static_cast<int>(packet.bytes_acked),
+        sample.state_at_send.is_app_limited,
+      });
+    }
+
+    MonitorInterval* interval = FindInterval(packet.packet_number);
+    if (interval != nullptr) {
+      interval->bytes_acked += packet.bytes_acked;
+    }
+    if (!largest_acked.IsInitialized() || packet.packet_number > largest_acked) {
+      largest_acked = packet.packet_number;
+    }
+  }
+  for (const auto& packet : lost_packets) {
+    sampler_.OnPacketLost(packet.packet_number);
+    MonitorInterval* interval = FindInterval(packet.packet_number);
+    if (interval != nullptr) {
+      interval->bytes_lost += packet.bytes_lost;
+    }
+  }
+
+  // the latest RTT belongs to the largest acked packet
+  if (rtt_updated && largest_acked.IsInitialized()) {
+    MonitorInterval* interval = FindInterval(largest_acked);
+    if (interval != nullptr) {
+      double t = (event_time - interval->start_time).ToMicroseconds() / 1e6;
+      double rtt = rtt_stats_->latest_rtt().ToMicroseconds() / 1e6;
+      interval->rtt_samples += 1;
+      interval->sum_t += t;
+      interval->sum_rtt += rtt;
+      interval->sum_t_rtt += t * rtt;
+      interval->sum_t_t += t * t;
+    }
+  }
+
+  sampler_.RemoveObsoletePackets(unacked_packets_->GetLeastUnacked());
+  min_rtt_.store(rtt_stats_->min_rtt().ToMicroseconds(), std::memory_order_relaxed);
+  EvaluateCompletedIntervals(event_time);
+}
+
+void PccVivace::MaybeStartInterval(QuicTime now) {
+  if (!intervals_.empty() && now < intervals_.back().end_time) {
+    return;
+  }
+
+  bool useful = useful_started_ < UsefulIntervals();
+  float gain = 1;
+  if (useful) {
+    if (mode_ == PROBING) {
+      // the intervals of a pair go up and down in the pair's random order
+      bool first = useful_started_ % 2 == 0;
+      bool up = first == probe_up_first_[useful_started_ / 2];
+      gain = up ? 1 + PccConstants::probing_step : 1 - PccConstants::probing_step;
+    }
+    ++useful_started_;
+  }
+
+  QuicTime::Delta duration = std::max(
+    SmoothedRtt() * static_cast<double>(PccConstants::mi_rtts),
+    QuicTime::Delta::FromMilliseconds(PccConstants::min_mi_ms));
+  intervals_.push_back(MonitorInterval{
+    rate_, gain, useful,
+    now, now + duration,
+    QuicPacketNumber(), QuicPacketNumber(),
+    0, 0, 0, false,
+    0, 0, 0, 0, 0,
+  });
+  pacing_gain_.store(gain, std::memory_order_relaxed);
+}
+
+bool PccVivace::IsComplete(const MonitorInterval& interval, QuicTime now) const {
+  if (now < interval.end_time) {
+    return false;
+  }
+  if (interval.bytes_acked + interval.bytes_lost >= interval.bytes_sent) {
+    return true;
+  }
+  return now > interval.end_time + SmoothedRtt() * PccConstants::mi_timeout_rtts;
+}
+
+void PccVivace::EvaluateCompletedIntervals(QuicTime now) {
+  while (!intervals_.empty() && IsComplete(intervals_.front(), now)) {
+    MonitorInterval interval = intervals_.front();
+    intervals_.pop_front();
+
+    if (!interval.app_limited && interval.bytes_acked > 0) {
+      bandwidth_estimate_ = QuicBandwidth::FromBytesAndTimeDelta(
+        interval.bytes_acked, interval.end_time - interval.start_time);
+    }
+    if (!interval.useful) {
+      continue;
+    }
+
+    // an application-limited interval did not send at its rate
+    if (interval.app_limited || interval.bytes_sent == 0) {
+      round_invalid_ = true;
+    } else {
+      results_.push_back(Evaluate(interval));
+    }
+    if (++useful_evaluated_ < UsefulIntervals()) {
+      continue;
+    }
+
+    if (!round_invalid_) {
+      OnResults();
+    }
+    StartRound();
+  }
+}
+
+PccVivace::Result PccVivace::Evaluate(const MonitorInterval& interval) const {
+  double seconds = (interval.end_time - interval.start_time).ToMicroseconds() / 1e6;
+  double rate = interval.bytes_sent * 8 / seconds / 1e6;
+  double loss = std::min(1., 1. * interval.bytes_lost / interval.bytes_sent);
+
+  // least squares slope of the RTT over time
+  double rtt_gradient = 0;
+  int n = interval.rtt_samples;
+  double denominator = n * interval.sum_t_t - interval.sum_t * interval.sum_t;
+  if (n >= 2 && denominator > 0) {
+    rtt_gradient = (n * interval.sum_t_rtt - interval.sum_t * interval.sum_rtt)
+                 / denominator;
+  }
+  if (std::abs(rtt_gradient) < PccConstants::rtt_gradient_tolerance) {
+    rtt_gradient = 0;
+  }
+
+  double utility = std::pow(rate, PccConstants::utility_exponent)
+                 - PccConstants::latency_coefficient * rate * rtt_gradient
+                 - PccConstants::loss_coefficient * rate * loss;
+  return Result{rate, utility};
+}
+
+void PccVivace::OnResults() {
+  switch (mode_) {
+    case STARTING: {
+      // [Starting] double the rate while the utility increases
+      const Result& result = results_[0];
+      if (best_ == base::nullopt || result.utility > best_->utility) {
+        best_ = result;
+        rate_ = rate_ * 2.f;
+      } else {
+        rate_ = FromMbps(best_->rate);
+        EnterProbing();
+      }
+      break;
+    }
+    case PROBING: {
+      // [Probing] results come in sending order, the pairs being consecutive
+      double gradient = 0;
+      int sign = 0;
+      Result center{0, 0};
+      for (int pair = 0; pair < PccConstants::probing_pairs; ++pair) {
+        const Result& a = results_[2 * pair];
+        const Result& b = results_[2 * pair + 1];
+        if (std::abs(a.rate - b.rate) < 1e-9) {
+          return;
+        }
+        double pair_gradient = (a.utility - b.utility) / (a.rate - b.rate);
+        int pair_sign = pair_gradient > 0 ? 1 : -1;
+        if (sign != 0 && pair_sign != sign) {
+          // inconclusive; probe again around the same rate
+          return;
+        }
+        sign = pair_sign;
+        gradient += pair_gradient / PccConstants::probing_pairs;
+        center.rate += (a.rate + b.rate) / results_.size();
+        center.utility += (a.utility + b.utility) / results_.size();
+      }
+
+      mode_ = MOVING;
+      last_ = center;
+      direction_ = sign;
+      confidence_ = 1;
+      step_bound_ = PccConstants::initial_step_bound;
+      rate_ = Step(rate_, gradient);
+      ABRCC_LOG(INFO) << "[PCC Mode]: PROBING -> MOVING, direction " << direction_;
+      break;
+    }
+    case MOVING: {
+      // [Moving] follow the gradient while the utility grows in the direction
+      const Result& result = results_[0];
+      double delta = result.rate - last_.rate;
+      double gradient = std::abs(delta) < 1e-9
+        ? 0
+        : (result.utility - last_.utility) / delta;
+      if (gradient == 0 || (gradient > 0 ? 1 : -1) != direction_) {
+        rate_ = FromMbps(last_.rate);
+        EnterProbing();
+        break;
+      }
+
+      last_ = result;
+      ++confidence_;
+      rate_ = Step(rate_, gradient);
+      break;
+    }
+  }
+}
+
+void PccVivace::StartRound() {
+  useful_started_ = 0;
+  useful_evaluated_ = 0;
+  results_.clear();
+  round_invalid_ = false;
+
+  probe_up_first_.clear();
+  for (int pair = 0; pair < PccConstants::probing_pairs; ++pair) {
+    probe_up_first_.push_back(random_->RandUint64() % 2 == 0);
+  }
+}
+
+void PccVivace::EnterProbing() {
+  ABRCC_LOG(INFO) << "[PCC Mode]: " << mode_ << " -> " << PROBING;
+  mode_ = PROBING;
+}
+
+QuicBandwidth PccVivace::Step(QuicBandwidth rate, double gradient) {
+  double change = confidence_ * PccConstants::step_size * gradient;
+  double bound = step_bound_ * ToMbps(rate);
+  if (std::abs(change) > bound) {
+    change = std::copysign(bound, change);
+    step_bound_ += PccConstants::step_bound_increment;
+  } else {
+    step_bound_ = PccConstants::initial_step_bound;
+  }
+  return std::max(FromMbps(ToMbps(rate) + change),
+                  QuicBandwidth::FromKBitsPerSecond(PccConstants::min_rate_kbps));
+}
+
+int PccVivace::UsefulIntervals() const {
+  return mode_ == PROBING ? 2 * PccConstants::probing_pairs : 1;
+}
+
+PccVivace::MonitorInterval* PccVivace::FindInterval(QuicPacketNumber packet_number) {
+  for (auto& interval : intervals_) {
+    if (interval.first_packet.IsInitialized() &&
+        interval.first_packet <= packet_number &&
+        packet_number <= interval.last_packet) {
+      return &interval;
+    }
+  }
+  return nullptr;
+}
+
+QuicTime::Delta PccVivace::SmoothedRtt() const {
+  return rtt_stats_->smoothed_rtt().IsZero()
+    ? rtt_stats_->initial_rtt()
+    : rtt_stats_->smoothed_rtt();
+}
+
+QuicBandwidth PccVivace::TargetRate(QuicBandwidth rate) const {
+  // [Target] mean of the learned rate and the ABR's target, as for BbrTarget
+  auto maybe_target_bandwidth = interface->getTargetRate();
+  if (maybe_target_bandwidth == base::nullopt) {
+    return rate;
+  }
+  return QuicBandwidth::FromKBitsPerSecond(
+    (rate.ToKBitsPerSecond() + maybe_target_bandwidth.value()) / 2);
+}
+
+void PccVivace::OnConnectionMigration() {
+  intervals_.clear();
+  mode_ = STARTING;
+  rate_ = initial_rate_;
+  best_ = base::nullopt;
+  bandwidth_estimate_ = QuicBandwidth::Zero();
+  StartRound();
+}
+
+bool PccVivace::CanSend(QuicByteCount bytes_in_flight) {
+  return bytes_in_flight < GetCongestionWindow();
+}
+
+QuicBandwidth PccVivace::PacingRate(QuicByteCount /*bytes_in_flight*/) const {
+  if (intervals_.empty()) {
+    return TargetRate(rate_);
+  }
+  const MonitorInterval& interval = intervals_.back();
+  return interval.gain * TargetRate(interval.rate);
+}
+
+QuicBandwidth PccVivace::BandwidthEstimate() const {
+  return bandwidth_estimate_.IsZero() ? rate_ : bandwidth_estimate_;
+}
+
+QuicByteCount PccVivace::GetCongestionWindow() const {
+  // rate-based: the window only bounds the bytes in flight to 2 BDPs
+  QuicByteCount congestion_window = 2 * (PacingRate(0) * SmoothedRtt());
+  return std::min(std::max(congestion_window, min_congestion_window_),
+                  max_congestion_window_);
+}
+
+QuicByteCount PccVivace::GetSlowStartThreshold() const {
+  return 0;
+}
+
+CongestionControlType PccVivace::GetCongestionControlType() const {
+  return kPCC;
+}
+
+std::string PccVivace::GetDebugState() const {
+  std::ostringstream stream;
+  stream << "[PCC] mode: " << mode_
+         << ", rate: " << rate_.ToKBitsPerSecond() << "kbps"
+         << ", intervals: " << intervals_.size();
+  return stream.str();
+}
+
+void PccVivace::OnApplicationLimited(QuicByteCount /*bytes_in_flight*/) {
+  sampler_.OnAppLimited();
+  if (!intervals_.empty()) {
+    intervals_.back().app_limited = true;
+  }
+}
+
+float PccVivace::pacingGain() const {
+  return pacing_gain_.load(std::memory_order_relaxed);
+}
+
+QuicTime::Delta PccVivace::minRtt() const {
+  return QuicTime::Delta::FromMicroseconds(min_rtt_.load(std::memory_order_relaxed));
+}
+
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,222 @@
+#ifndef ABRCC_CC_PCC_VIVACE_H_
+#define ABRCC_CC_PCC_VIVACE_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <atomic>
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+#include "net/third_party/quiche/src/quic/core/congestion_control/bandwidth_sampler.h"
+#include "net/third_party/quiche/src/quic/core/congestion_control/send_algorithm_interface.h"
+#include "net/third_party/quiche/src/quic/core/crypto/quic_random.h"
+#include "net/third_party/quiche/src/quic/core/quic_bandwidth.h"
+#include "net/third_party/quiche/src/quic/core/quic_packets.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+#include "net/third_party/quiche/src/quic/core/quic_unacked_packet_map.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_export.h"
+
+#include "net/abrcc/cc/target.h"
+
+namespace quic {
+
+class RttStats;
+
+namespace PccConstants {
+  // utility of a monitor interval sending at x Mbps:
+  //   x^exponent - latency_coefficient * x * dRTT/dt - loss_coefficient * x * loss
+  const double utility_exponent = 0.9;
+  const double latency_coefficient = 900;
+  const double loss_coefficient = 11.35;
+  // RTT gradients below the tolerance are measurement noise
+  const double rtt_gradient_tolerance = 0.01;
+
+  // a monitor interval lasts mi_rtts smoothed RTTs, but at least min_mi_ms
+  const float mi_rtts = 1.5;
+  const int min_mi_ms = 10;
+  // an interval whose packets are not all acked or lost after this many RTTs
+  // from its end is evaluated with the feedback received so far
+  const int mi_timeout_rtts = 4;
+
+  // probing intervals send at rate * (1 +- probing_step), in pairs of random order;
+  // the rate only moves once all the pairs agree on the direction
+  const float probing_step = 0.05;
+  const int probing_pairs = 2;
+
+  // gradient ascent: the rate moves by confidence * step_size(Mbps) * gradient, the
+  // confidence growing with every consecutive step in the same direction; a step is
+  // bounded to a fraction of the rate, the bound growing while steps are bounded
+  const double step_size = 1;
+  const float initial_step_bound = 0.05;
+  const float step_bound_increment = 0.1;
+
+  const int min_rate_kbps = 100;
+}
+
+// Online-learning rate controller in the style of PCC-Vivace:
+//   - the connection is split into monitor intervals(MIs), each sending at a fixed rate
+//   - once all the packets of an interval are acked or lost, its utility is computed
+//     from its sending rate, RTT gradient and loss rate
+//   - STARTING doubles the rate while the utility increases, PROBING compares pairs
+//     of intervals around the rate and MOVING follows the utility gradient
+//
+// Intervals that were application-limited are discarded, as their sending rate does
+// not reflect the rate under test.
+//
+// The sender attaches to BbrTarget::BbrInterface, such that ABRs written for Target
+// can run on top of it: the ABR's target rate is blended with the learned rate(the
+// mean of the two, as BbrTarget does), while delivery rates, the RTT and the current
+// interval's gain are exported through the interface.
+class QUIC_EXPORT_PRIVATE PccVivace : public SendAlgorithmInterface {
+ public:
+  enum Mode {
+    STARTING,
+    PROBING,
+    MOVING,
+  };
+
+  PccVivace(QuicTime now,
+            const RttStats* rtt_stats,
+            const QuicUnackedPacketMap* unacked_packets,
+            QuicPacketCount initial_tcp_congestion_window,
+            QuicPacketCount max_tcp_congestion_window,
+            QuicRandom* random,
+            QuicConnectionStats* stats,
+            BbrTarget::BbrInterface* interface);
+  PccVivace(const PccVivace&) = delete;
+  PccVivace& operator=(const PccVivace&) = delete;
+  ~PccVivace() override;
+
+  // Start implementation of SendAlgorithmInterface.
+  bool InSlowStart() const override;
+  bool InRecovery() const override;
+  bool ShouldSendProbingPacket() const override;
+
+  void SetFromConfig(const QuicConfig& config,
+                     Perspective perspective) override;
+
+  void AdjustNetworkParameters(const NetworkParams& params) override;
+  void SetInitialCongestionWindowInPackets(
+      QuicPacketCount congestion_window) override;
+  void OnCongestionEvent(bool rtt_updated,
+                         QuicByteCount prior_in_flight,
+                         QuicTime event_time,
+                         const AckedPacketVector& acked_packets,
+                         const LostPacketVector& lost_packets) override;
+  void OnPacketSent(QuicTime sent_time,
+                    QuicByteCount bytes_in_flight,
+                    QuicPacketNumber packet_number,
+                    QuicByteCount bytes,
+                    HasRetransmittableData is_retransmittable) override;
+  void OnRetransmissionTimeout(bool /*packets_retransmitted*/) override {}
+  void OnConnectionMigration() override;
+  bool CanSend(QuicByteCount bytes_in_flight) override;
+  QuicBandwidth PacingRate(QuicByteCount bytes_in_flight) const override;
+  QuicBandwidth BandwidthEstimate() const override;
+  QuicByteCount GetCongestionWindow() const override;
+  QuicByteCount GetSlowStartThreshold() const override;
+  CongestionControlType GetCongestionControlType() const override;
+  std::string GetDebugState() const override;
+  void OnApplicationLimited(QuicByteCount bytes_in_flight) override;
+  // End implementation of SendAlgorithmInterface.
+
+  // estimates exported to the ABR interface
+  float pacingGain() const;
+  QuicTime::Delta minRtt() const;
+ private:
+  struct MonitorInterval {
+    // the interval sends at gain * rate
+    QuicBandwidth rate;
+    float gain;
+    // the interval is evaluated by the current mode; the others fill the time
+    // until the evaluated intervals are acked
+    bool useful;
+
+    QuicTime start_time;
+    QuicTime end_time;
+    QuicPacketNumber first_packet;
+    QuicPacketNumber last_packet;
+
+    QuicByteCount bytes_sent;
+    QuicByteCount bytes_acked;
+    QuicByteCount bytes_lost;
+    bool app_limited;
+
+    // sums for the least squares fit of the RTT(s) over the time(s) since start
+    int rtt_samples;
+    double sum_t;
+    double sum_rtt;
+    double sum_t_rtt;
+    double sum_t_t;
+  };
+
+  struct Result {
+    double rate;  // Mbps
+    double utility;
+  };
+
+  // Starts a new interval at `now` if the current one has ended.
+  void MaybeStartInterval(QuicTime now);
+  void EvaluateCompletedIntervals(QuicTime now);
+  bool IsComplete(const MonitorInterval& interval, QuicTime now) const;
+  Result Evaluate(const MonitorInterval& interval) const;
+
+  // Updates the rate once all the useful intervals of the mode are evaluated.
+  void OnResults();
+  void StartRound();
+  void EnterProbing();
+  // Moves `rate` in the gradient's direction; returns the new rate.
+  QuicBandwidth Step(QuicBandwidth rate, double gradient);
+
+  int UsefulIntervals() const;
+  MonitorInterval* FindInterval(QuicPacketNumber packet_number);
+  QuicTime::Delta SmoothedRtt() const;
+  // The learned rate blended with the ABR's target rate.
+  QuicBandwidth TargetRate(QuicBandwidth rate) const;
+
+  BbrTarget::BbrInterface* interface;
+
+  const RttStats* rtt_stats_;
+  const QuicUnackedPacketMap* unacked_packets_;
+  QuicRandom* random_;
+  BandwidthSampler sampler_;
+
+  Mode mode_;
+  QuicBandwidth rate_;
+  QuicBandwidth initial_rate_;
+  QuicByteCount min_congestion_window_;
+  QuicByteCount max_congestion_window_;
+
+  std::deque<MonitorInterval> intervals_;
+  // useful intervals started and evaluated in the current round of the mode
+  int useful_started_;
+  int useful_evaluated_;
+  std::vector<Result> results_;
+  // the round has to be repeated, as one of its intervals was application-limited
+  bool round_invalid_;
+  // order of the probing pairs of the round
+  std::vector<bool> probe_up_first_;
+
+  // STARTING: the best interval so far
+  base::Optional<Result> best_;
+  // MOVING: the last evaluated point and the direction of the moves
+  Result last_;
+  int direction_;
+  int confidence_;
+  float step_bound_;
+
+  QuicBandwidth bandwidth_estimate_;
+
+  // written by the network thread, read by the ABR loop
+  std::atomic<float> pacing_gain_;
+  std::atomic<int64_t> min_rtt_;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
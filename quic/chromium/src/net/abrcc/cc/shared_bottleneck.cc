@@ -0,0 +1,271 @@
+#include "net/abrcc/cc/shared_bottleneck.h"
+#include "net/abrcc/cc/singleton.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "net/abrcc/logging/log.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+namespace quic {
+
+SharedBottleneck* SharedBottleneck::GetInstance() {
+  return GET_SINGLETON(SharedBottleneck);
+}
+
+SharedBottleneck::SharedBottleneck() : enabled_(false), next_member(0) {}
+SharedBottleneck::~SharedBottleneck() {}
+
+SharedBottleneck::Group::Group(int window)
+  : aggregate(window)
+  , next_sample(QuicTime::Zero()) {}
+
+void SharedBottleneck::setEnabled(bool enabled) {
+  enabled_.store(enabled, std::memory_order_relaxed);
+}
+
+bool SharedBottleneck::enabled() const {
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+void SharedBottleneck::setBoard(std::unique_ptr<BottleneckBoard> board) {
+  QuicWriterMutexLock lock(&mutex_);
+  this->board = std::move(board);
+}
+
+std::string SharedBottleneck::GroupKey(const QuicSocketAddress& peer) {
+  // IPv4 clients of a dual-stack socket are seen as IPv4-mapped IPv6 addresses
+  QuicIpAddress host = peer.host().Normalized();
+  int bits = host.IsIPv4()
+    ? SharedBottleneckConstants::ipv4_prefix_bits
+    : SharedBottleneckConstants::ipv6_prefix_bits;
+  return host.ToPackedString().substr(0, bits / 8);
+}
+
+int SharedBottleneck::Join(const QuicSocketAddress& peer) {
+  QuicWriterMutexLock lock(&mutex_);
+  std::string key = GroupKey(peer);
+
+  int member = next_member++;
+  int slot = board != nullptr ? board->Claim() : -1;
+  members.emplace(member, Member{
+    key, slot, QuicTime::Zero(), QuicTime::Zero(), 0, 0, 0, base::nullopt
+  });
+
+  auto& group = groups[key];
+  if (group == nullptr) {
+    group.reset(new Group(SharedBottleneckConstants::budget_window_ms
+                          / SharedBottleneckConstants::sample_period_ms));
+  }
+  group->members.push_back(member);
+
+  ABRCC_LOG(INFO) << "[SharedBottleneck] member " << member << " for "
+                  << peer.host().ToString() << " joined a group of "
+                  << group->members.size();
+  return member;
+}
+
+void SharedBottleneck::Leave(int member) {
+  QuicWriterMutexLock lock(&mutex_);
+  auto it = members.find(member);
+  if (it == members.end()) {
+    return;
+  }
+
+  auto group = groups.find(it->second.group);
+  auto& group_members = group->second->members;
+  group_members.erase(
+    std::remove(group_members.begin(), group_members.end(), member),
+    group_members.end());
+  if (group_members.empty()) {
+    groups.erase(group);
+  }
+  if (it->second.slot != -1) {
+    board->Release(it->second.slot);
+  }
+  members.erase(it);
+}
+
+void SharedBottleneck::OnCongestionEvent(
+  int member,
+  QuicTime now,
+  QuicBandwidth bandwidth,
+  QuicTime::Delta rtt,
+  QuicTime::Delta min_rtt
+) {
+  QuicWriterMutexLock lock(&mutex_);
+  auto it = members.find(member);
+  if (it == members.end()) {
+    return;
+  }
+
+  const float alpha = SharedBottleneckConstants::ewma_alpha;
+  Member& state = it->second;
+  state.last_event = now;
+  double rate = bandwidth.ToKBitsPerSecond();
+  state.rate = state.rate == 0 ? rate : state.rate + alpha * (rate - state.rate);
+  if (!rtt.IsZero()) {
+    double sample = rtt.ToMicroseconds();
+    state.srtt = state.srtt == 0 ? sample : state.srtt + alpha * (sample - state.srtt);
+  }
+  if (!min_rtt.IsZero()) {
+    state.min_rtt = min_rtt.ToMicroseconds();
+  }
+
+  Publish(member);
+  Allocate(state.group, *groups[state.group], now);
+}
+
+void SharedBottleneck::OnApplicationLimited(int member, QuicTime now) {
+  QuicWriterMutexLock lock(&mutex_);
+  auto it = members.find(member);
+  if (it != members.end()) {
+    it->second.app_limited_until = now + QuicTime::Delta::FromMilliseconds(
+      SharedBottleneckConstants::app_limited_ms);
+    Publish(member);
+  }
+}
+
+base::Optional<SharedBottleneck::Allocation> SharedBottleneck::GetAllocation(
+  int member
+) const {
+  QuicReaderMutexLock lock(&mutex_);
+  auto it = members.find(member);
+  if (it == members.end()) {
+    return base::nullopt;
+  }
+  return it->second.allocation;
+}
+
+BottleneckBoard::Entry SharedBottleneck::State(int member) const {
+  // the ids are unique over the servers sharing a board, and ordered as the members
+  // joined within a server
+  int64_t pid = board != nullptr ? board->pid() : 0;
+  const Member& state = members.at(member);
+  return BottleneckBoard::Entry{
+    (pid << 32) | member, state.group, state.last_event, state.app_limited_until,
+    state.rate, state.srtt, state.min_rtt,
+  };
+}
+
+void SharedBottleneck::Publish(int member) {
+  int slot = members.at(member).slot;
+  if (slot != -1) {
+    board->Publish(slot, State(member));
+  }
+}
+
+void SharedBottleneck::Allocate(const std::string& key, Group& group, QuicTime now) {
+  const QuicTime::Delta idle = QuicTime::Delta::FromMilliseconds(
+    SharedBottleneckConstants::idle_ms);
+
+  // only the members that recently acked data share the bottleneck, be they of
+  // this server(`member` set) or of another one sharing the board
+  struct Participant {
+    BottleneckBoard::Entry state;
+    int member;
+  };
+  std::vector<Participant> active;
+  for (int id : group.members) {
+    Member& member = members.at(id);
+    member.allocation = base::nullopt;
+    if (member.last_event + idle < now || member.rate == 0) {
+      continue;
+    }
+    active.push_back(Participant{State(id), id});
+  }
+  if (board != nullptr) {
+    for (const auto& peer : board->Peers(key)) {
+      if (peer.last_event + idle < now || peer.rate == 0) {
+        continue;
+      }
+      active.push_back(Participant{peer, SharedBottleneckConstants::NOT_PRESENT});
+    }
+  }
+
+  double aggregate = 0;
+  double queue_ratio = std::numeric_limits<double>::infinity();
+  for (const auto& participant : active) {
+    const BottleneckBoard::Entry& state = participant.state;
+    aggregate += state.rate;
+    if (state.min_rtt > 0 && state.srtt > 0) {
+      queue_ratio = std::min(queue_ratio, state.srtt / state.min_rtt);
+    }
+  }
+
+  if (now >= group.next_sample) {
+    group.aggregate.push(static_cast<int64_t>(aggregate));
+    group.next_sample = now + QuicTime::Delta::FromMilliseconds(
+      SharedBottleneckConstants::sample_period_ms);
+  }
+  if (active.size() < 2) {
+    return;
+  }
+
+  // [Budget] the best aggregate rate seen lately, backed off while even the least
+  // delayed member sees a standing queue
+  double budget = std::max(aggregate, static_cast<double>(group.aggregate.best()));
+  const float tolerance = 1 + SharedBottleneckConstants::queue_tolerance;
+  if (queue_ratio != std::numeric_limits<double>::infinity() && queue_ratio > tolerance) {
+    double scale = std::max(
+      static_cast<double>(SharedBottleneckConstants::min_queue_scale),
+      tolerance / queue_ratio);
+    budget *= scale;
+    ABRCC_LOG_EVERY_MS(INFO, 1000) << "[SharedBottleneck] queue ratio " << queue_ratio
+                                   << ", budget scaled by " << scale;
+  }
+
+  // [Shares] max-min fair; application-limited members only demand their rate
+  // plus headroom, the rest of the budget going to the others
+  auto demand = [&](const Participant& participant) {
+    const BottleneckBoard::Entry& state = participant.state;
+    if (now < state.app_limited_until) {
+      return state.rate * SharedBottleneckConstants::app_limited_headroom;
+    }
+    return std::numeric_limits<double>::infinity();
+  };
+
+  // [Probing] the turn moves to the next member that is not application-limited
+  // every `probe_turn_ms` of the host's clock, over the members ordered by id, such
+  // that all the servers of the group give it to the same member
+  std::sort(active.begin(), active.end(), [](const Participant& a, const Participant& b) {
+    return a.state.id < b.state.id;
+  });
+  int64_t turn = (now - QuicTime::Zero()).ToMilliseconds()
+    / SharedBottleneckConstants::probe_turn_ms;
+  int64_t holder = active[turn % active.size()].state.id;
+  for (size_t i = 0; i < active.size(); ++i) {
+    const Participant& candidate = active[(turn + i) % active.size()];
+    if (demand(candidate) == std::numeric_limits<double>::infinity()) {
+      holder = candidate.state.id;
+      break;
+    }
+  }
+
+  std::vector<Participant> order(active);
+  std::sort(order.begin(), order.end(), [&](const Participant& a, const Participant& b) {
+    return demand(a) < demand(b);
+  });
+  double remaining = budget;
+  int left = order.size();
+  for (const auto& participant : order) {
+    double share = std::min(demand(participant), remaining / left);
+    remaining -= share;
+    --left;
+
+    // the other servers steer their own members
+    if (participant.member == SharedBottleneckConstants::NOT_PRESENT) {
+      continue;
+    }
+    members.at(participant.member).allocation = Allocation{
+      QuicBandwidth::FromKBitsPerSecond(std::max(static_cast<int64_t>(share), int64_t(1))),
+      participant.state.id == holder ? SharedBottleneckConstants::probe_gain : 1.f,
+    };
+  }
+}
+
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,154 @@
+#ifndef ABRCC_CC_SHARED_BOTTLENECK_H_
+#define ABRCC_CC_SHARED_BOTTLENECK_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/optional.h"
+
+#include "net/abrcc/cc/bottleneck_board.h"
+#include "net/abrcc/structs/monotonic_window.h"
+#include "net/third_party/quiche/src/quic/core/quic_bandwidth.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+namespace SharedBottleneckConstants {
+  // member id of a connection that is not coupled
+  const int NOT_PRESENT = -1;
+
+  // connections whose clients share the prefix are grouped behind one bottleneck
+  const int ipv4_prefix_bits = 24;
+  const int ipv6_prefix_bits = 64;
+
+  // period(ms) with which the aggregate delivery rate of a group is sampled
+  const int sample_period_ms = 100;
+  // window(ms) over which the budget is the maximum aggregate delivery rate
+  const int budget_window_ms = 10000;
+
+  // a member without congestion events for this long(ms) is left out of the shares
+  const int idle_ms = 1000;
+  // a member stays application-limited for this long(ms) after being signalled
+  const int app_limited_ms = 500;
+  // headroom over its delivery rate left to an application-limited member
+  const float app_limited_headroom = 1.5;
+
+  // period(ms) after which the probing turn passes to the next member
+  const int probe_turn_ms = 2000;
+  // pacing gain of the member holding the probing turn over its share
+  const float probe_gain = 1.25;
+
+  // a coupled member's congestion window is capped at this gain over the BDP of its
+  // allocation at the minimum RTT, and at no less than `min_cwnd_packets` packets
+  const float cwnd_gain = 2;
+  const int min_cwnd_packets = 4;
+
+  // the budget is scaled by (1 + tolerance) * min_rtt / srtt once the smoothed RTT
+  // exceeds the minimum RTT by more than the tolerance, such that the queue drains
+  const float queue_tolerance = 0.25;
+  const float min_queue_scale = 0.5;
+
+  // weight of a new delivery rate or RTT sample in the members' EWMAs
+  const float ewma_alpha = 0.125;
+}
+
+// Coordinator of the connections that go through the same bottleneck.
+//
+// Independently probing senders to the same household fight each other: each one
+// builds its own queue while probing and the others read it as lost bandwidth.
+// The coordinator groups the connections by their client's /24(IPv4) or /64(IPv6)
+// prefix and, for each group of at least 2 active connections:
+//   - estimates the group's budget as the windowed maximum of the members' summed
+//     delivery rates, scaled down while the group's RTT shows a standing queue
+//   - splits the budget max-min fairly, application-limited members only being
+//     given their delivery rate plus headroom
+//   - gives the probing turn to one member at a time, such that only that member
+//     paces above its share
+//
+// With a board, the groups span all the servers of the host that share it: each
+// server publishes its members and counts the other servers' ones in its groups'
+// budgets and shares, while only steering its own. The probing turn follows the
+// host's clock, such that the servers agree on its holder.
+//
+// The members are fed and steered by the CCWrapper, on the network thread.
+class SharedBottleneck {
+ public:
+  // What a member may pace at; the member's sender keeps pacing below the rate and
+  // its congestion window below the allocation's BDP(see `cwnd_gain`).
+  struct Allocation {
+    QuicBandwidth rate;
+    float max_pacing_gain;
+  };
+
+  virtual ~SharedBottleneck();
+  static SharedBottleneck* GetInstance();
+
+  // The coordinator is a no-op until enabled.
+  void setEnabled(bool enabled);
+  bool enabled() const;
+  // Couples the members with those of the other servers sharing `board`; set
+  // before any member joins.
+  void setBoard(std::unique_ptr<BottleneckBoard> board);
+
+  // Registers a connection to the client at `peer`; returns its member id.
+  int Join(const QuicSocketAddress& peer);
+  void Leave(int member);
+
+  // Registers the state of `member` after a congestion event.
+  void OnCongestionEvent(int member, QuicTime now, QuicBandwidth bandwidth,
+                         QuicTime::Delta rtt, QuicTime::Delta min_rtt);
+  void OnApplicationLimited(int member, QuicTime now);
+
+  // base::nullopt while `member` is not coupled with other active members.
+  base::Optional<Allocation> GetAllocation(int member) const;
+ private:
+  SharedBottleneck();
+
+  struct Member {
+    std::string group;
+    // slot of the board, -1 without
+    int slot;
+    QuicTime last_event;
+    QuicTime app_limited_until;
+    // EWMAs, in kbps and us
+    double rate;
+    double srtt;
+    int64_t min_rtt;
+    base::Optional<Allocation> allocation;
+  };
+
+  struct Group {
+    explicit Group(int window);
+
+    std::vector<int> members;
+    structs::WindowedMax<int64_t> aggregate;
+    QuicTime next_sample;
+  };
+
+  static std::string GroupKey(const QuicSocketAddress& peer);
+  BottleneckBoard::Entry State(int member) const;
+  void Publish(int member);
+  void Allocate(const std::string& key, Group& group, QuicTime now);
+
+  std::atomic<bool> enabled_;
+  int next_member;
+  std::unordered_map<int, Member> members;
+  std::unordered_map<std::string, std::unique_ptr<Group>> groups;
+  std::unique_ptr<BottleneckBoard> board;
+  mutable QuicMutex mutex_;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -12,8 +12,10 @@
 #include "net/third_party/quiche/src/quic/platform/api/quic_flag_utils.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_flags.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
+#include "net/abrcc/cc/bbr2_abr.h"
+#include "net/abrcc/cc/pcc_vivace.h"
 
-#include "net/abrcc/cc/singleton.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
 
 
@@ -62,10 +64,6 @@ const float kSimilarMinRttThreshold = 1.125;
  * ABRCC Extension -- BEGIN
  **/
 
-BbrTarget::BbrInterface* BbrTarget::BbrInterface::GetInstance() {
-  return GET_SINGLETON(BbrTarget::BbrInterface);
-}
-
 void BbrTarget::BbrInterface::setPacingGainCycle(const std::vector<float>& gain) {
   QuicWriterMutexLock lock(&pacing_cycle_mutex_);
   kPacingGain = gain; 
@@ -76,10 +74,15 @@ std::vector<float> BbrTarget::BbrInterface::getPacingGainCycle() {
 }
 
 std::vector<int> BbrTarget::BbrInterface::popDeliveryRates() {
-  QuicWriterMutexLock lock(&delivery_rates_mutex_);
-  std::vector<int> out = deliveryRates;
-  deliveryRates = std::vector<int>();
-  return out;
+  return ack_channel->popDeliveryRates();
+}
+
+std::vector<int> BbrTarget::BbrInterface::popBurstDeliveryRates() {
+  return ack_channel->popBurstDeliveryRates();
+}
+
+std::vector<AckSample> BbrTarget::BbrInterface::popAckSamples() {
+  return ack_channel->popAll();
 }
 
 int BbrTarget::BbrInterface::getGainCycleLength() {
@@ -92,11 +95,35 @@ QuicRoundTripCount BbrTarget::BbrInterface::kBandwidthWindowSize() {
 }
 
 void BbrTarget::BbrInterface::setParent(BbrTarget *parent) {
+  QuicWriterMutexLock lock(&parent_mutex_);
   this->parent = parent;
+  this->bbr2_parent = nullptr;
+  this->pcc_parent = nullptr;
+}
+
+void BbrTarget::BbrInterface::setBbr2Parent(Bbr2Abr *parent) {
+  QuicWriterMutexLock lock(&parent_mutex_);
+  this->bbr2_parent = parent;
+  this->parent = nullptr;
+  this->pcc_parent = nullptr;
+}
+
+void BbrTarget::BbrInterface::setPccParent(PccVivace *parent) {
+  QuicWriterMutexLock lock(&parent_mutex_);
+  this->pcc_parent = parent;
+  this->parent = nullptr;
+  this->bbr2_parent = nullptr;
 }
 
 base::Optional<float> BbrTarget::BbrInterface::PacingGain() const {
+  QuicReaderMutexLock parent_lock(&parent_mutex_);
   QuicReaderMutexLock lock(&pacing_cycle_mutex_);
+  if (bbr2_parent != nullptr) {
+    return bbr2_parent->pacingGain();
+  }
+  if (pcc_parent != nullptr) {
+    return pcc_parent->pacingGain();
+  }
   if (parent == nullptr) {
     return base::nullopt;
   }
@@ -104,8 +131,9 @@ base::Optional<float> BbrTarget::BbrInterface::PacingGain() const {
 }
 
 base::Optional<int> BbrTarget::BbrInterface::getTargetRate() const { 
+  QuicReaderMutexLock parent_lock(&parent_mutex_);
   QuicReaderMutexLock lock(&target_rate_mutex_);
-  if (parent == nullptr) {
+  if (parent == nullptr && bbr2_parent == nullptr && pcc_parent == nullptr) {
     return base::nullopt;
   }
   return targetRate;
@@ -117,24 +145,32 @@ void BbrTarget::BbrInterface::setTargetRate(int rate) {
 }
 
 base::Optional<int> BbrTarget::BbrInterface::RttEstimate() const {
-  if (parent == nullptr) {
-    return base::nullopt;
-  }
-  return !parent->min_rtt_.IsZero() 
-    ? base::Optional<int>(parent->min_rtt_.ToMilliseconds()) 
+  QuicReaderMutexLock parent_lock(&parent_mutex_);
+  QuicTime::Delta min_rtt = QuicTime::Delta::Zero();
+  if (bbr2_parent != nullptr) {
+    min_rtt = bbr2_parent->minRtt();
+  } else if (pcc_parent != nullptr) {
+    min_rtt = pcc_parent->minRtt();
+  } else if (parent != nullptr) {
+    min_rtt = parent->min_rtt_;
+  }
+  return !min_rtt.IsZero() 
+    ? base::Optional<int>(min_rtt.ToMilliseconds()) 
     : base::nullopt;
 }
 
 BbrTarget::BbrInterface::BbrInterface() 
   : kPacingGain(std::vector<float>{1.25, 0.75, 1, 1, 1, 1, 1, 1})
-  , deliveryRates(std::vector<int>{})
   , targetRate(base::nullopt)
-  , parent(nullptr) {} 
+  , parent(nullptr)
+  , bbr2_parent(nullptr)
+  , pcc_parent(nullptr)
+  , ack_channel(new AckChannel(AckChannelConstants::capacity)) {} 
 
 BbrTarget::BbrInterface::~BbrInterface() {}
 
 void BbrTarget::changeMode(BbrTarget::Mode newMode) {
-  QUIC_LOG(WARNING) << "[BBR Mode]: " << mode_ << " -> " << newMode;
+  ABRCC_LOG(WARNING) << "[BBR Mode]: " << mode_ << " -> " << newMode;
   mode_ = newMode;
 }
 
@@ -166,17 +202,18 @@ BbrTarget::BbrTarget(QuicTime now,
                      QuicPacketCount initial_tcp_congestion_window,
                      QuicPacketCount max_tcp_congestion_window,
                      QuicRandom* random,
-                     QuicConnectionStats* stats)
-    : interface(BbrInterface::GetInstance()), 
+                     QuicConnectionStats* stats,
+                     BbrInterface* interface)
+    : interface(interface), 
     
       rtt_stats_(rtt_stats),
       unacked_packets_(unacked_packets),
       random_(random),
       stats_(stats),
       mode_(STARTUP),
-      sampler_(unacked_packets, BbrInterface::GetInstance()->kBandwidthWindowSize()),
+      sampler_(unacked_packets, interface->kBandwidthWindowSize()),
       round_trip_count_(0),
-      max_bandwidth_(BbrInterface::GetInstance()->kBandwidthWindowSize(), QuicBandwidth::Zero(), 0),
+      max_bandwidth_(interface->kBandwidthWindowSize(), QuicBandwidth::Zero(), 0),
       min_rtt_(QuicTime::Delta::Zero()),
       min_rtt_timestamp_(QuicTime::Zero()),
       congestion_window_(initial_tcp_congestion_window * kDefaultTCPMSS),
@@ -228,8 +265,9 @@ BbrTarget::BbrTarget(QuicTime now,
 }
 
 BbrTarget::~BbrTarget() {
+  QuicWriterMutexLock lock(&interface->parent_mutex_);
   if (interface->parent == this) {
-    interface->setParent(nullptr);
+    interface->parent = nullptr;
   }
 }
 
@@ -623,9 +661,6 @@ bool BbrTarget::UpdateRoundTripCounter(QuicPacketNumber last_acked_packet) {
 bool BbrTarget::UpdateBandwidthAndMinRtt(
     QuicTime now,
     const AckedPacketVector& acked_packets) {
-  // Use lock to register delivery rates
-  QuicWriterMutexLock lock(&interface->delivery_rates_mutex_);
-  
   QuicTime::Delta sample_min_rtt = QuicTime::Delta::Infinite();
   for (const auto& packet : acked_packets) {
     BandwidthSample bandwidth_sample =
@@ -637,9 +672,14 @@ bool BbrTarget::UpdateBandwidthAndMinRtt(
     }
 
     // Register delivery rates
-    interface->deliveryRates.push_back(
-      bandwidth_sample.bandwidth.ToKBitsPerSecond()
-    );
+    interface->ack_channel->push(AckSample{
+      (now - QuicTime::Zero()).ToMicroseconds(),
+      static_cast<int>(bandwidth_sample.bandwidth.ToKBitsPerSecond()),
+      static_cast<int>(bandwidth_sample.rtt.ToMilliseconds()),
+      recovery_state_ != NOT_IN_RECOVERY,
+      static_cast<int>(packet.bytes_acked),
+      bandwidth_sample.state_at_send.is_app_limited,
+    });
 
     last_sample_is_app_limited_ = bandwidth_sample.state_at_send.is_app_limited;
     has_non_app_limited_sample_ |=
@@ -18,12 +18,16 @@
 #include "net/third_party/quiche/src/quic/core/quic_unacked_packet_map.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_export.h"
 
+#include "net/abrcc/cc/ack_channel.h"
 #include "net/abrcc/cc/cc_selector.h"
-#include "net/abrcc/cc/singleton.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
 
 namespace quic {
 
+class Bbr2Abr;
+class CCWrapper;
+class PccVivace;
+class ConnectionInterfaces;
 class RttStats;
 
 class QUIC_EXPORT_PRIVATE BbrTarget : public SendAlgorithmInterface {
@@ -31,7 +35,6 @@ class QUIC_EXPORT_PRIVATE BbrTarget : public SendAlgorithmInterface {
   class __attribute__((packed)) BbrInterface {
    public:
     virtual ~BbrInterface();
-    static BbrInterface* GetInstance();
 
     // controlling gain cycle
     void setPacingGainCycle(const std::vector<float>& gain);
@@ -41,13 +44,19 @@ class QUIC_EXPORT_PRIVATE BbrTarget : public SendAlgorithmInterface {
     
     // attach parent when instance changes
     void setParent(BbrTarget* parent);
+    // attach a Bbr2Sender steered through Bbr2Abr instead of a parent
+    void setBbr2Parent(Bbr2Abr* parent);
+    // attach a PccVivace sender instead of a parent
+    void setPccParent(PccVivace* parent);
     
     // estimates
     base::Optional<float> PacingGain() const;
     base::Optional<int> RttEstimate() const; 
    
-    // delivery rate samples
+    // delivery rate samples; the burst ones are not app-limited
     std::vector<int> popDeliveryRates();
+    std::vector<int> popBurstDeliveryRates();
+    std::vector<AckSample> popAckSamples();
    
     // target 
     void setTargetRate(int targetRate);
@@ -56,15 +65,26 @@ class QUIC_EXPORT_PRIVATE BbrTarget : public SendAlgorithmInterface {
     BbrInterface();
 
     std::vector<float> kPacingGain;  
-    std::vector<int> deliveryRates;
     base::Optional<int> targetRate;
 
     BbrTarget *parent;
-    mutable QuicMutex delivery_rates_mutex_;
+    Bbr2Abr *bbr2_parent;
+    PccVivace *pcc_parent;
+
+    // held through a pointer as the interface is packed
+    std::unique_ptr<AckChannel> ack_channel;
+
+    // guards the parents, attached and detached on the network thread while the
+    // ABR reads them on its own
+    mutable QuicMutex parent_mutex_;
     mutable QuicMutex pacing_cycle_mutex_; 
     mutable QuicMutex target_rate_mutex_;
 
     friend class BbrTarget;
+    friend class ConnectionInterfaces;
+    friend class Bbr2Abr;
+    friend class CCWrapper;
+    friend class PccVivace;
   };
  
   /**
@@ -127,7 +147,8 @@ class QUIC_EXPORT_PRIVATE BbrTarget : public SendAlgorithmInterface {
             QuicPacketCount initial_tcp_congestion_window,
             QuicPacketCount max_tcp_congestion_window,
             QuicRandom* random,
-            QuicConnectionStats* stats);
+            QuicConnectionStats* stats,
+            BbrInterface* interface);
   BbrTarget(const BbrTarget&) = delete;
   BbrTarget& operator=(const BbrTarget&) = delete;
   ~BbrTarget() override;
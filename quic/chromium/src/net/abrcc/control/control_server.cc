@@ -0,0 +1,122 @@
+#include "net/abrcc/control/control_server.h"
+
+#include <utility>
+
+#include "base/bind.h"
+#include "base/threading/thread_task_runner_handle.h"
+#include "net/base/net_errors.h"
+#include "net/quic/address_utils.h"
+#include "net/quic/quic_chromium_alarm_factory.h"
+#include "net/quic/quic_chromium_connection_helper.h"
+#include "net/tools/quic/quic_simple_server_packet_writer.h"
+#include "net/tools/quic/quic_simple_server_socket.h"
+
+#include "net/abrcc/logging/log.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_default_proof_providers.h"
+
+namespace quic {
+
+namespace {
+
+const char source_address_token_secret[] = "abrcc control";
+
+class ControlSessionHelper : public QuicCryptoServerStream::Helper {
+ public:
+  bool CanAcceptClientHello(const CryptoHandshakeMessage& /*message*/,
+                            const QuicSocketAddress& /*client_address*/,
+                            const QuicSocketAddress& /*peer_address*/,
+                            const QuicSocketAddress& /*self_address*/,
+                            std::string* /*error_details*/) const override {
+    return true;
+  }
+};
+
+}
+
+ControlServer::ControlServer(
+  int port,
+  const std::vector<url::Origin>& accepted_origins,
+  ControlResolver resolver)
+  : port(port)
+  // QuicTransport requires the TLS handshake
+  , version_manager({ParsedQuicVersion{PROTOCOL_TLS1_3, QUIC_VERSION_99}})
+  , clock(QuicChromiumClock::GetInstance())
+  , crypto_config(source_address_token_secret,
+                  QuicRandom::GetInstance(),
+                  CreateDefaultProofSource(),
+                  KeyExchangeSource::Default())
+  , dispatcher(&config,
+               &crypto_config,
+               &version_manager,
+               std::make_unique<net::QuicChromiumConnectionHelper>(
+                 clock, QuicRandom::GetInstance()),
+               std::make_unique<ControlSessionHelper>(),
+               std::make_unique<net::QuicChromiumAlarmFactory>(
+                 base::ThreadTaskRunnerHandle::Get().get(), clock),
+               accepted_origins,
+               std::move(resolver))
+  , read_buffer(base::MakeRefCounted<net::IOBufferWithSize>(2 * kMaxIncomingPacketSize))
+  , weak_factory(this) {}
+
+ControlServer::~ControlServer() {
+  if (socket != nullptr) {
+    dispatcher.Shutdown();
+  }
+}
+
+bool ControlServer::Listen() {
+  socket = net::CreateQuicSimpleServerSocket(
+    net::IPEndPoint(net::IPAddress::IPv6AllZeros(), port), &server_address);
+  if (socket == nullptr) {
+    return false;
+  }
+
+  dispatcher.InitializeWithWriter(
+    new net::QuicSimpleServerPacketWriter(socket.get(), &dispatcher));
+  ABRCC_LOG(WARNING) << "[Control] listening on " << server_address.ToString();
+
+  ScheduleReadPackets();
+  return true;
+}
+
+void ControlServer::ScheduleReadPackets() {
+  base::ThreadTaskRunnerHandle::Get()->PostTask(
+    FROM_HERE, base::BindOnce(&ControlServer::ReadPackets, weak_factory.GetWeakPtr()));
+}
+
+void ControlServer::ReadPackets() {
+  dispatcher.ProcessBufferedChlos(ControlServerConstants::max_new_connections_per_event);
+  for (size_t i = 0; i < ControlServerConstants::max_reads_per_event; ++i) {
+    int result = socket->RecvFrom(
+      read_buffer.get(), read_buffer->size(), &client_address,
+      base::BindOnce(&ControlServer::OnReadComplete, weak_factory.GetWeakPtr()));
+    if (result == net::ERR_IO_PENDING) {
+      return;
+    }
+    if (result <= 0) {
+      // the HTTP/3 server keeps running without the control channels
+      ABRCC_LOG(WARNING) << "[Control] read failed: " << net::ErrorToString(result);
+      return;
+    }
+    ProcessReadPacket(result);
+  }
+  ScheduleReadPackets();
+}
+
+void ControlServer::OnReadComplete(int result) {
+  if (result <= 0) {
+    ABRCC_LOG(WARNING) << "[Control] read failed: " << net::ErrorToString(result);
+    return;
+  }
+  ProcessReadPacket(result);
+  ReadPackets();
+}
+
+void ControlServer::ProcessReadPacket(int result) {
+  QuicReceivedPacket packet(read_buffer->data(), result, clock->Now(),
+                            /*owns_buffer=*/false);
+  dispatcher.ProcessPacket(net::ToQuicSocketAddress(server_address),
+                           net::ToQuicSocketAddress(client_address), packet);
+}
+
+}
@@ -0,0 +1,72 @@
+#ifndef ABRCC_CONTROL_CONTROL_SERVER_H_
+#define ABRCC_CONTROL_CONTROL_SERVER_H_
+
+#include <memory>
+#include <vector>
+
+#include "base/memory/weak_ptr.h"
+#include "net/base/io_buffer.h"
+#include "net/base/ip_endpoint.h"
+#include "net/socket/udp_server_socket.h"
+
+#include "net/abrcc/control/control_session.h"
+
+#include "net/quic/platform/impl/quic_chromium_clock.h"
+#include "net/third_party/quiche/src/quic/core/crypto/quic_crypto_server_config.h"
+#include "net/third_party/quiche/src/quic/core/quic_config.h"
+#include "net/third_party/quiche/src/quic/core/quic_version_manager.h"
+
+namespace quic {
+
+namespace ControlServerConstants {
+  // packets read per event loop iteration, as by the QuicTransport simple server
+  const size_t max_reads_per_event = 32;
+  const size_t max_new_connections_per_event = 32;
+}
+
+// QuicTransport server of the players' control channels(see ControlSession),
+// listening on its own UDP port next to the HTTP/3 server, as QuicTransport has its
+// own ALPN and handshake.
+//
+// The server runs on the network thread's message loop, the one of the HTTP/3
+// server, so the sessions use the player sessions' services directly. Only the pages of
+// `accepted_origins` can open channels.
+class ControlServer {
+ public:
+  ControlServer(
+    int port,
+    const std::vector<url::Origin>& accepted_origins,
+    ControlResolver resolver);
+  ControlServer(const ControlServer&) = delete;
+  ControlServer& operator=(const ControlServer&) = delete;
+  ~ControlServer();
+
+  // Binds the port and starts reading packets; returns false if the port can not
+  // be bound.
+  bool Listen();
+ private:
+  void ScheduleReadPackets();
+  void ReadPackets();
+  void OnReadComplete(int result);
+  void ProcessReadPacket(int result);
+
+  const int port;
+
+  QuicVersionManager version_manager;
+  QuicChromiumClock* clock; // not owned
+  QuicConfig config;
+  QuicCryptoServerConfig crypto_config;
+
+  ControlDispatcher dispatcher;
+  std::unique_ptr<net::UDPServerSocket> socket;
+  net::IPEndPoint server_address;
+
+  scoped_refptr<net::IOBufferWithSize> read_buffer;
+  net::IPEndPoint client_address;
+
+  base::WeakPtrFactory<ControlServer> weak_factory;
+};
+
+}
+
+#endif
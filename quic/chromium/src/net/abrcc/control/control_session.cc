@@ -0,0 +1,220 @@
+#include "net/abrcc/control/control_session.h"
+
+#include <utility>
+
+#include "base/json/json_reader.h"
+#include "base/values.h"
+
+#include "net/abrcc/logging/log.h"
+#include "net/third_party/quiche/src/quic/core/quic_connection.h"
+#include "net/third_party/quiche/src/quic/core/quic_types.h"
+
+namespace quic {
+
+// A stream of a control session, bound to a title by its first message. Decisions
+// are buffered while the stream is blocked, such that they are never dropped.
+class ControlSession::Channel : public QuicTransportStream::Visitor,
+                                public ControlChannel {
+ public:
+  Channel(ControlSession* session, QuicTransportStream* stream)
+    : session(session), stream(stream) {}
+  Channel(const Channel&) = delete;
+  Channel& operator=(const Channel&) = delete;
+  ~Channel() override {
+    if (service != nullptr) {
+      service->RemoveChannel(this);
+    }
+  }
+
+  void OnCanRead() override {
+    stream->Read(&buffer);
+
+    size_t start = 0;
+    size_t end;
+    while ((end = buffer.find(ControlConstants::delimiter, start)) != std::string::npos) {
+      if (!onMessage(buffer.substr(start, end - start))) {
+        stream->Reset(QUIC_BAD_APPLICATION_PAYLOAD);
+        return;
+      }
+      start = end + 1;
+    }
+    buffer.erase(0, start);
+
+    if (buffer.size() > ControlConstants::max_message_size) {
+      ABRCC_LOG(WARNING) << "[Control] message exceeds "
+                         << ControlConstants::max_message_size << " bytes";
+      stream->Reset(QUIC_BAD_APPLICATION_PAYLOAD);
+    }
+  }
+
+  void OnFinRead() override {
+    // the channel is removed once the stream is closed
+    if (!stream->write_side_closed() && !stream->SendFin()) {
+      ABRCC_LOG(WARNING) << "[Control] could not close stream " << stream->id();
+    }
+  }
+
+  void OnCanWrite() override {
+    flush();
+  }
+
+  bool Send(const std::string& message) override {
+    if (stream->write_side_closed()) {
+      return false;
+    }
+    pending += message;
+    pending += ControlConstants::delimiter;
+    flush();
+    return true;
+  }
+ private:
+  bool onMessage(const std::string& message) {
+    if (service != nullptr) {
+      if (!service->OnMessage(message)) {
+        ABRCC_LOG_EVERY_MS(WARNING, 1000) << "[Control] malformed message " << message;
+      }
+      return true;
+    }
+
+    // the first message binds the channel
+    base::Optional<base::Value> value = base::JSONReader::Read(message);
+    const std::string* path = nullptr;
+    const std::string* player = nullptr;
+    if (value && value->is_dict()) {
+      path = value->FindStringKey("path");
+      player = value->FindStringKey("session");
+    }
+    if (path == nullptr || player == nullptr) {
+      ABRCC_LOG(WARNING) << "[Control] expected a path and a session, got " << message;
+      return false;
+    }
+    service = session->resolver.Run(*path, *player);
+    if (service == nullptr) {
+      ABRCC_LOG(WARNING) << "[Control] no session " << *player << " of " << *path;
+      return false;
+    }
+    service->AddChannel(this);
+    if (session->service == nullptr) {
+      session->service = service;
+    }
+    return true;
+  }
+
+  void flush() {
+    if (pending.empty() || !stream->Write(pending)) {
+      return;
+    }
+    pending.clear();
+  }
+
+  ControlSession* session;
+  QuicTransportStream* stream;
+  std::shared_ptr<ControlService> service;
+
+  // received bytes of the unterminated message, and the messages not yet written
+  std::string buffer;
+  std::string pending;
+};
+
+ControlSession::ControlSession(
+  QuicConnection* connection,
+  Visitor* owner,
+  const QuicConfig& config,
+  const ParsedQuicVersionVector& supported_versions,
+  const QuicCryptoServerConfig* crypto_config,
+  QuicCompressedCertsCache* compressed_certs_cache,
+  const std::vector<url::Origin>& accepted_origins,
+  ControlResolver resolver
+) : QuicTransportServerSession(connection, owner, config, supported_versions,
+                                 crypto_config, compressed_certs_cache, this)
+  , connection_(connection)
+  , accepted_origins(accepted_origins)
+  , resolver(std::move(resolver))
+  , last_sequence(-1)
+  , datagrams_lost(0) {
+  Initialize();
+}
+
+ControlSession::~ControlSession() {
+  delete connection_;
+}
+
+void ControlSession::OnIncomingDataStream(QuicTransportStream* stream) {
+  // unidirectional streams only carry messages up
+  stream->set_visitor(std::make_unique<Channel>(this, stream));
+}
+
+void ControlSession::OnMessageReceived(QuicStringPiece message) {
+  if (!IsSessionReady()) {
+    return;
+  }
+
+  base::Optional<base::Value> value = base::JSONReader::Read(message);
+  if (!value || !value->is_dict() || value->FindKey("stats") == nullptr) {
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << "[Control] malformed datagram " << message;
+    return;
+  }
+  base::Optional<int> sequence = value->FindIntKey("seq");
+  if (!sequence) {
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << "[Control] datagram without sequence number";
+    return;
+  }
+  if (service == nullptr) {
+    // no stream bound the session to a title yet
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << "[Control] datagram of an unbound session";
+    return;
+  }
+  if (*sequence <= last_sequence) {
+    // reordered: a newer update was already registered
+    return;
+  }
+  if (last_sequence >= 0) {
+    datagrams_lost += *sequence - last_sequence - 1;
+  }
+  last_sequence = *sequence;
+
+  service->OnMetrics(*value);
+  ABRCC_LOG_EVERY_MS(INFO, 1000) << "[Control] datagram " << *sequence << ", "
+                                 << datagrams_lost << " lost";
+}
+
+bool ControlSession::CheckOrigin(url::Origin origin) {
+  for (const url::Origin& accepted_origin : accepted_origins) {
+    if (origin.IsSameOriginWith(accepted_origin)) {
+      return true;
+    }
+  }
+  ABRCC_LOG(WARNING) << "[Control] refused origin " << origin.Serialize();
+  return false;
+}
+
+ControlDispatcher::ControlDispatcher(
+  const QuicConfig* config,
+  const QuicCryptoServerConfig* crypto_config,
+  QuicVersionManager* version_manager,
+  std::unique_ptr<QuicConnectionHelperInterface> helper,
+  std::unique_ptr<QuicCryptoServerStream::Helper> session_helper,
+  std::unique_ptr<QuicAlarmFactory> alarm_factory,
+  const std::vector<url::Origin>& accepted_origins,
+  ControlResolver resolver
+) : QuicDispatcher(config, crypto_config, version_manager, std::move(helper),
+                   std::move(session_helper), std::move(alarm_factory),
+                   kQuicDefaultConnectionIdLength)
+  , accepted_origins(accepted_origins)
+  , resolver(resolver) {}
+
+QuicSession* ControlDispatcher::CreateQuicSession(
+  QuicConnectionId server_connection_id,
+  const QuicSocketAddress& peer_address,
+  QuicStringPiece alpn,
+  const ParsedQuicVersion& version
+) {
+  auto connection = std::make_unique<QuicConnection>(
+    server_connection_id, peer_address, helper(), alarm_factory(), writer(),
+    /*owns_writer=*/false, Perspective::IS_SERVER, ParsedQuicVersionVector{version});
+  return new ControlSession(
+    connection.release(), this, config(), GetSupportedVersions(), crypto_config(),
+    compressed_certs_cache(), accepted_origins, resolver);
+}
+
+}
@@ -0,0 +1,102 @@
+#ifndef ABRCC_CONTROL_CONTROL_SESSION_H_
+#define ABRCC_CONTROL_CONTROL_SESSION_H_
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/callback.h"
+#include "url/origin.h"
+
+#include "net/abrcc/service/control_service.h"
+
+#include "net/third_party/quiche/src/quic/core/quic_dispatcher.h"
+#include "net/third_party/quiche/src/quic/quic_transport/quic_transport_server_session.h"
+#include "net/third_party/quiche/src/quic/quic_transport/quic_transport_stream.h"
+
+namespace quic {
+
+// Returns the control service of the player session `session` of the title serving
+// `path`, or nullptr if no title serves it or the session is unknown.
+using ControlResolver = base::RepeatingCallback<std::shared_ptr<ControlService>(
+  const std::string& path, const std::string& session)>;
+
+// QuicTransport(WebTransport over QUIC) session of a player's control channel.
+//
+// The player opens a bidirectional stream whose first message names the page it
+// was loaded from and its session, as named by the `abrcc-session` header of the
+// title's responses({"path": "/<title>/index.html", "session": "<id>"}), which binds
+// the stream to the ControlService of the player's session; the following messages
+// are the ones of the service. A session can carry several streams, each stream
+// being a channel.
+//
+// Metrics can also be sent unreliably, as QUIC DATAGRAM frames: a lost metrics
+// update is superseded by the next tick, so it is better dropped than retransmitted
+// ahead of segment bytes. A datagram is a self-contained JSON object
+// {"seq": <n>, "stats": ...}, which has to fit a single packet; it always goes to
+// the player session of the session's first bound stream, whose sequence numbers
+// are the session's. Datagrams older than the latest one received are dropped.
+class ControlSession
+    : public QuicTransportServerSession,
+      QuicTransportServerSession::ServerVisitor {
+ public:
+  ControlSession(
+    QuicConnection* connection,
+    Visitor* owner,
+    const QuicConfig& config,
+    const ParsedQuicVersionVector& supported_versions,
+    const QuicCryptoServerConfig* crypto_config,
+    QuicCompressedCertsCache* compressed_certs_cache,
+    const std::vector<url::Origin>& accepted_origins,
+    ControlResolver resolver
+  );
+  ControlSession(const ControlSession&) = delete;
+  ControlSession& operator=(const ControlSession&) = delete;
+  ~ControlSession() override;
+
+  void OnIncomingDataStream(QuicTransportStream* stream) override;
+  // Registers the metrics of a datagram.
+  void OnMessageReceived(QuicStringPiece message) override;
+  // Only the players loaded from one of the accepted origins can open channels.
+  bool CheckOrigin(url::Origin origin) override;
+ private:
+  class Channel;
+
+  QuicConnection* connection_;
+  std::vector<url::Origin> accepted_origins;
+  ControlResolver resolver;
+
+  // player session of the first bound channel, the only one to get the datagrams
+  std::shared_ptr<ControlService> service;
+  // latest datagram sequence number received, and the datagrams missed so far
+  int last_sequence;
+  int datagrams_lost;
+};
+
+// Dispatcher creating a ControlSession for every incoming connection.
+class ControlDispatcher : public QuicDispatcher {
+ public:
+  ControlDispatcher(
+    const QuicConfig* config,
+    const QuicCryptoServerConfig* crypto_config,
+    QuicVersionManager* version_manager,
+    std::unique_ptr<QuicConnectionHelperInterface> helper,
+    std::unique_ptr<QuicCryptoServerStream::Helper> session_helper,
+    std::unique_ptr<QuicAlarmFactory> alarm_factory,
+    const std::vector<url::Origin>& accepted_origins,
+    ControlResolver resolver
+  );
+ protected:
+  QuicSession* CreateQuicSession(
+    QuicConnectionId server_connection_id,
+    const QuicSocketAddress& peer_address,
+    QuicStringPiece alpn,
+    const ParsedQuicVersion& version) override;
+ private:
+  std::vector<url::Origin> accepted_origins;
+  ControlResolver resolver;
+};
+
+}
+
+#endif
@@ -1,82 +1,94 @@
 #include "net/abrcc/dash_backend.h"
 
-#include "net/abrcc/abr/abr.h"
-#include "net/abrcc/abr/interface.h"
-#include "net/abrcc/service/store_service.h"
-#include "net/abrcc/service/metrics_service.h"
-#include "net/abrcc/service/poll_service.h"
-
 #include <utility>
 #include <string>
-#include <fstream>
-#include <streambuf>
-
-#include "base/json/json_value_converter.h"
-#include "base/json/json_reader.h"
-#include "base/values.h"
 
-#include "net/abrcc/dash_config.h"
+#include "base/bind.h"
 #include "net/third_party/quiche/src/quic/core/http/spdy_utils.h"
-#include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_ip_address.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_text_utils.h"
 
-const std::string API_PATH = "/request";
-const std::string ABORT_PATH = "/abort";
-const std::string PIECE_PATH = "/piece";
-
 using spdy::SpdyHeaderBlock;
 
 namespace quic {
 
+static void Respond(
+  QuicSimpleServerBackend::RequestHandler* quic_stream,
+  int status,
+  const std::string& body
+) {
+  SpdyHeaderBlock response_headers;
+  response_headers[":status"] = QuicTextUtils::Uint64ToString(status);
+  response_headers["content-length"] = QuicTextUtils::Uint64ToString(body.size());
+
+  QuicBackendResponse quic_response;
+  quic_response.set_response_type(QuicBackendResponse::REGULAR_RESPONSE);
+  quic_response.set_headers(std::move(response_headers));
+  quic_response.set_body(body);
+  quic_response.set_trailers(SpdyHeaderBlock());
+  quic_response.set_stop_sending_code(0);
+
+  auto push_info = std::list<QuicBackendResponse::ServerPushInfo>();
+  quic_stream->OnResponseBackendComplete(&quic_response, push_info);
+}
+
+// Whether the request comes from the server's host, for the admin endpoints.
+static bool IsLocalPeer(QuicSimpleServerBackend::RequestHandler* quic_stream) {
+  QuicIpAddress peer;
+  if (!peer.FromString(quic_stream->peer_host())) {
+    return false;
+  }
+  peer = peer.Normalized();
+  return peer.InSameSubnet(QuicIpAddress::Loopback4(), 8)
+      || peer == QuicIpAddress::Loopback6();
+}
+
 DashBackend::DashBackend(
-  const std::string& abr_type, 
+  const std::string& abr_type,
   const std::string& config_path,
   const std::string& site,
-  const std::string& minerva_config_path // only used by Minerva
-) : config_path(config_path)
-  , site(site)
-  , store(new StoreService())
-  , metrics(new MetricsService())
-  , polling(new PollingService())
-  , backend_initialized_(false) 
-{ 
-  // read config file
-  std::ifstream stream(config_path);
-  std::string data((std::istreambuf_iterator<char>(stream)),
-                   std::istreambuf_iterator<char>());
- 
-  // get config
-  base::Optional<base::Value> value = base::JSONReader::Read(data);
-  config = std::shared_ptr<DashBackendConfig>(new DashBackendConfig());
-  base::JSONValueConverter<DashBackendConfig> converter;
-  converter.Convert(*value, config.get()); 
-
-  // override shared config values using site
-  config->domain = this->site;
-  config->base_path = config->base_path + this->site;
-  
-  // initialize rest of DashBackend
-  std::unique_ptr<AbrInterface> interface(
-    getAbr(abr_type, config, minerva_config_path)
-  );
-  std::unique_ptr<AbrLoop> loop(
-    new AbrLoop(std::move(interface), metrics, polling, store)
-  );
-  this->abr_loop = std::move(loop); 
+  const std::string& minerva_config_path, // only used by Minerva
+  const std::string& pensieve_model_path, // only used by Pensieve
+  const std::string& titles_path,
+  const SegmentCacheConfig& segment_cache,
+  int control_port,
+  const std::vector<url::Origin>& control_origins
+) : control_port(control_port)
+  , control_origins(control_origins)
+  , backend_initialized_(false)
+{
+  if (titles_path.empty()) {
+    title.reset(new DashTitle(
+      abr_type, config_path, site, minerva_config_path, pensieve_model_path,
+      segment_cache));
+  } else {
+    titles.reset(new TitleService(
+      titles_path, abr_type, site, minerva_config_path, pensieve_model_path,
+      segment_cache));
+  }
 }
 DashBackend::~DashBackend() {}
 
 bool DashBackend::InitializeBackend(const std::string& _unused) {
-  // paths
-  std::string dir_path = config_path.substr(0, config_path.find_last_of("/"));
-  std::string base_path = dir_path + config->base_path;
- 
-  // register stores
-  store->MetaFromConfig(base_path, config); 
-  store->VideoFromConfig(dir_path, config);
+  if (title != nullptr) {
+    if (!title->configured()) {
+      return false;
+    }
+    title->Initialize();
+  } else {
+    // titles are loaded on their first request
+    titles->Reload();
+  }
 
-  // start abr loop
-  abr_loop->Start();
+  if (control_port != 0) {
+    control_server.reset(new ControlServer(control_port, control_origins,
+      base::BindRepeating(&DashBackend::ResolveControl, base::Unretained(this))));
+    if (!control_server->Listen()) {
+      ABRCC_LOG(WARNING) << "[Control] can not listen on port " << control_port;
+      control_server.reset();
+    }
+  }
 
   backend_initialized_ = true;
   return true;
@@ -88,58 +100,77 @@ bool DashBackend::IsBackendInitialized() const {
 
 void DashBackend::FetchResponseFromBackend(
   const SpdyHeaderBlock& request_headers,
-  const std::string& request_body, 
+  const std::string& request_body,
   QuicSimpleServerBackend::RequestHandler* quic_stream
 ) {
+  if (title != nullptr) {
+    title->FetchResponseFromBackend(request_headers, request_body, quic_stream);
+    return;
+  }
+
   auto pathWrapper = request_headers.find(":path");
-  if (pathWrapper != request_headers.end()) {
-    auto path = pathWrapper->second;
-    if (path == API_PATH) {
-      // new metrics received
-      metrics->AddMetrics(request_headers, request_body, quic_stream);
- 
-      // respond with 'OK'
-      QuicStringPiece response_body("OK");
-      SpdyHeaderBlock response_headers;
-      response_headers[":status"] = QuicTextUtils::Uint64ToString(200);
-      response_headers["content-length"] = 
-        QuicTextUtils::Uint64ToString(response_body.length());
-    
-      QuicBackendResponse quic_response; 
-      quic_response.set_response_type(QuicBackendResponse::REGULAR_RESPONSE);
-      quic_response.set_headers(std::move(response_headers));
-      quic_response.set_body(response_body);
-      quic_response.set_trailers(SpdyHeaderBlock());
-      quic_response.set_stop_sending_code(0);
-
-      auto push_info = std::list<QuicBackendResponse::ServerPushInfo>();
-      quic_stream->OnResponseBackendComplete(&quic_response, push_info);
-    } else if (path.find(API_PATH) != std::string::npos) {
-      // add a long polling request
-      polling->AddRequest(request_headers, request_body, std::move(quic_stream));
-    } else if (path.find(PIECE_PATH) != std::string::npos) {
-      // a request for a piece was received
-      polling->AddRequest(request_headers, request_body, std::move(quic_stream));
-    } else if (path.find(ABORT_PATH) != std::string::npos) {
-      std::string index_raw = std::string(path).substr(
-        path.find(ABORT_PATH) + ABORT_PATH.size() + 1
-      );
-      int abort_index = std::stoi(index_raw);
-      
-      QUIC_LOG(WARNING) << "Aborting: " << abort_index;
-      metrics->AddAbort(abort_index);
-    } else {
-      // serving pieces
-      store->FetchResponseFromBackend(request_headers, request_body, quic_stream);
-      QUIC_LOG(WARNING) << "Serving: " << path;
+  if (pathWrapper == request_headers.end()) {
+    Respond(quic_stream, 404, "");
+    return;
+  }
+  std::string path = pathWrapper->second.as_string();
+  if (path == TitleConstants::reload_path) {
+    if (!IsLocalPeer(quic_stream)) {
+      ABRCC_LOG(WARNING) << "[Titles] reload refused to " << quic_stream->peer_host();
+      Respond(quic_stream, 403, "");
+      return;
     }
-  } else {
-    store->FetchResponseFromBackend(request_headers, request_body, quic_stream);
+    std::string body;
+    for (auto &name : titles->Reload()) {
+      body += name + "\n";
+    }
+    Respond(quic_stream, 200, body);
+    return;
+  }
+
+  std::string rest;
+  bool loading = false;
+  DashTitle* target = titles->Resolve(path, &rest, &loading);
+  if (loading) {
+    // the title is unavailable until loaded off the network thread
+    Respond(quic_stream, 503, "");
+    return;
   }
+  if (target == nullptr) {
+    ABRCC_LOG_EVERY_MS(WARNING, 1000) << "[Titles] no title serves " << path;
+    Respond(quic_stream, 404, "");
+    return;
+  }
+
+  // the title serves paths relative to itself
+  SpdyHeaderBlock title_headers = request_headers.Clone();
+  title_headers[":path"] = rest;
+  target->FetchResponseFromBackend(title_headers, request_body, quic_stream);
+}
+
+std::shared_ptr<ControlService> DashBackend::ResolveControl(
+  const std::string& path,
+  const std::string& session
+) {
+  if (title != nullptr) {
+    return title->GetControlService(session);
+  }
+  std::string rest;
+  DashTitle* target = titles->Resolve(path, &rest);
+  if (target == nullptr) {
+    return nullptr;
+  }
+  return target->GetControlService(session);
 }
 
 void DashBackend::CloseBackendResponseStream(
   QuicSimpleServerBackend::RequestHandler* quic_server_stream
-) {}
+) {
+  if (title != nullptr) {
+    title->CloseBackendResponseStream(quic_server_stream);
+  } else {
+    titles->CloseStream(quic_server_stream);
+  }
+}
 
-}  
+}
@@ -1,11 +1,10 @@
 #ifndef ABRCC_DASH_BACKEND_H_
 #define ABRCC_DASH_BACKEND_H_
 
-#include "net/abrcc/abr/loop.h"
+#include "net/abrcc/dash_title.h"
 
-#include "net/abrcc/service/store_service.h"
-#include "net/abrcc/service/metrics_service.h"
-#include "net/abrcc/service/poll_service.h"
+#include "net/abrcc/control/control_server.h"
+#include "net/abrcc/service/title_service.h"
 
 #include "net/third_party/quiche/src/quic/tools/quic_backend_response.h"
 #include "net/third_party/quiche/src/quic/tools/quic_simple_server_backend.h"
@@ -13,17 +12,30 @@
 
 namespace quic {
 
-// QUIC backend handler that reacts on each individual request sent to 
+// QUIC backend handler that reacts on each individual request sent to
 // the server port. Used as a dispacher to the backend services: storage
 // service, metrics service ad polling service.
+//
+// The backend either serves the single title at `config_path`, or, given a
+// `titles_path`, the titles of a directory under the paths "/<title>/..."(see
+// TitleService). Requests to a title being loaded are answered with 503, and the
+// titles are only rescanned on requests from the server's host.
+//
+// Given a `control_port`, the players loaded from `control_origins` can also open
+// control channels to their session over QuicTransport on that port(see ControlServer).
 class DashBackend : public QuicSimpleServerBackend {
  public:
   // Note we need the config path for abr
   DashBackend(
-    const std::string& abr_type, 
+    const std::string& abr_type,
     const std::string& config_path,
     const std::string& site,
-    const std::string& minerva_config_path_ // only used by Minerva
+    const std::string& minerva_config_path_, // only used by Minerva
+    const std::string& pensieve_model_path_, // only used by Pensieve
+    const std::string& titles_path = "", // serves a titles directory if not empty
+    const SegmentCacheConfig& segment_cache = SegmentCacheConfig(),
+    int control_port = 0, // control channels are disabled if 0
+    const std::vector<url::Origin>& control_origins = {}
   );
   DashBackend(const DashBackend&) = delete;
   DashBackend& operator=(const DashBackend&) = delete;
@@ -39,20 +51,21 @@ class DashBackend : public QuicSimpleServerBackend {
   void CloseBackendResponseStream(
       QuicSimpleServerBackend::RequestHandler* quic_server_stream) override;
  private:
-  std::string config_path;
-  std::string site;
+  // Control service of the player session `session` of the title serving `path`,
+  // for the control channels.
+  std::shared_ptr<ControlService> ResolveControl(
+    const std::string& path, const std::string& session);
 
-  std::shared_ptr<StoreService> store;
-  std::shared_ptr<MetricsService> metrics;
-  std::shared_ptr<PollingService> polling;
-  
-  std::shared_ptr<DashBackendConfig> config;
+  std::unique_ptr<DashTitle> title;
+  std::unique_ptr<TitleService> titles;
+
+  int control_port;
+  std::vector<url::Origin> control_origins;
+  std::unique_ptr<ControlServer> control_server;
 
   bool backend_initialized_;
-  
-  std::unique_ptr<AbrLoop> abr_loop;
 };
 
-}  
+}
 
-#endif  
+#endif
@@ -2,9 +2,13 @@
 #define ABRCC_DASH_CONFIG_H_
 
 #include "base/json/json_value_converter.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
 
 namespace quic {
 
+class SegmentPredictor;
+class VideoCatalog;
+
 struct PlayerConfig {
   std::string index;
   std::string manifest;
@@ -71,6 +75,13 @@ struct DashBackendConfig {
   std::vector<std::unique_ptr<VideoConfig>> video_configs;
   int segments;
 
+  // columnar view of `video_configs`, built by VideoCatalog::ForConfig
+  std::shared_ptr<const VideoCatalog> catalog;
+  // predictor of the segments past the catalog's, built by SegmentPredictor::ForConfig
+  std::shared_ptr<SegmentPredictor> predictor;
+  // guards `catalog` and `predictor`, as the ABRs of a title are built on any thread
+  QuicMutex lazy_mutex;
+
   DashBackendConfig();
   DashBackendConfig(const DashBackendConfig&) = delete;
   DashBackendConfig& operator=(const DashBackendConfig&) = delete;
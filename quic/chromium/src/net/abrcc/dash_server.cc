@@ -5,8 +5,14 @@
 #include <iostream>
 
 #include "net/abrcc/cc/cc_selector.h"
+#include "net/abrcc/cc/shared_bottleneck.h"
+#include "net/abrcc/replay/event_log.h"
+#include "net/abrcc/logging/log.h"
+#include "net/abrcc/telemetry/recorder.h"
 
 #include "net/abrcc/dash_backend.h"
+#include "base/strings/string_split.h"
+#include "url/gurl.h"
 #include "net/third_party/quiche/src/quic/core/quic_versions.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_default_proof_providers.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_flags.h"
@@ -30,6 +36,18 @@ DEFINE_QUIC_COMMAND_LINE_FLAG(
     "Specifies the path to the directory of Minerva configuration"
     "paths. The video structures provided in the directory are used"
     "to compute the PQ normalization curve.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    pensieve_model_path,
+    "",
+    "Specifies the path to the Pensieve actor weights exported "
+    "by exp/abr/export_pensieve.py.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    telemetry_path,
+    "",
+    "Specifies the directory to which the binary CC and ABR "
+    "telemetry is recorded. Telemetry is disabled if empty.");
 DEFINE_QUIC_COMMAND_LINE_FLAG(
     std::string,
     quic_config_path,
@@ -37,6 +55,52 @@ DEFINE_QUIC_COMMAND_LINE_FLAG(
     "Specifies the path to the JSON configuration path of the"
     "quic server. In the JSON we should specify the paths for"
     "videos and the DASH manifest.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    titles_path,
+    "",
+    "Specifies a directory of titles, each title <name> being "
+    "configured by <name>/config.json and served under /<name>/. "
+    "Titles are rescanned on /.titles/reload, requested from the "
+    "server's host. Overrides "
+    "quic_config_path if not empty.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    segment_cache_path,
+    "",
+    "Specifies the directory of the persistent segment cache. If "
+    "not empty, segments are served from the cache and their raw "
+    "files, while only segment_memory_mb of them are held in memory.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              segment_cache_mb,
+                              16 * 1024,
+                              "Capacity of the persistent segment cache(MB).");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              segment_memory_mb,
+                              1024,
+                              "Segments held in memory per title when the "
+                              "persistent segment cache or an origin is used(MB).");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    origin_url,
+    "",
+    "Specifies the HTTP origin of the segments. If not empty, the "
+    "server is an edge cache: segments missing from memory and from "
+    "the segment cache are fetched from the origin, a single fetch "
+    "serving all the concurrent requests of a segment.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    int32_t,
+    control_port,
+    0,
+    "The port on which players open QuicTransport control channels, "
+    "carrying metrics and decisions in place of the /request POSTs "
+    "and long polls. Control channels are disabled if 0.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    control_origins,
+    "",
+    "Comma-separated origins of the pages allowed to open control "
+    "channels. Defaults to the server's own pages, https://<site>:<port>.");
 DEFINE_QUIC_COMMAND_LINE_FLAG(
     std::string,
     site,
@@ -47,6 +111,35 @@ DEFINE_QUIC_COMMAND_LINE_FLAG(
     cc_type,
     "bbr",
     "Congestion control type.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    bool,
+    coupled_cc,
+    false,
+    "Couples the congestion control of the connections to the "
+    "same client subnet, such that they share one rate budget: "
+    "the pacing rate and the congestion window of each connection "
+    "are capped by its share.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    coupled_cc_board,
+    "",
+    "Path of the file through which the servers of the host share their "
+    "coupled connections, such that the connections to the same client "
+    "subnet are coupled across servers(e.g. one server per player).");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    cc_capture_path,
+    "",
+    "Specifies the directory to which the inputs of every "
+    "connection's congestion control are captured, for replay by "
+    "abrcc_cc_replay. Capture is disabled if empty.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    shadow_cc,
+    "",
+    "Comma-separated congestion control types run in shadow by "
+    "every connection: they see the same events as the primary,"
+    "their estimates being recorded into the telemetry only.");
 DEFINE_QUIC_COMMAND_LINE_FLAG(
     std::string,
     abr_type,
@@ -55,14 +148,43 @@ DEFINE_QUIC_COMMAND_LINE_FLAG(
 
 namespace quic {
 
+// Origins of the pages allowed to open control channels.
+static std::vector<url::Origin> ControlOrigins() {
+  std::string origins_text = GetQuicFlag(FLAGS_control_origins);
+  if (origins_text.empty()) {
+    origins_text = "https://" + GetQuicFlag(FLAGS_site) + ":"
+                 + std::to_string(GetQuicFlag(FLAGS_port));
+  }
+
+  std::vector<url::Origin> origins;
+  for (const base::StringPiece& origin : base::SplitStringPiece(
+         origins_text, ",", base::TRIM_WHITESPACE, base::SPLIT_WANT_NONEMPTY)) {
+    GURL url{origin};
+    if (!url.is_valid()) {
+      ABRCC_LOG(WARNING) << "[Control] can not parse origin " << origin;
+      continue;
+    }
+    origins.push_back(url::Origin::Create(url));
+  }
+  return origins;
+}
+
 std::unique_ptr<quic::QuicSimpleServerBackend>
 QuicDashServer::MemoryCacheBackendFactory::CreateBackend() {
+  SegmentCacheConfig segment_cache(
+    GetQuicFlag(FLAGS_segment_cache_path),
+    int64_t(GetQuicFlag(FLAGS_segment_cache_mb)) * 1024 * 1024,
+    int64_t(GetQuicFlag(FLAGS_segment_memory_mb)) * 1024 * 1024,
+    GetQuicFlag(FLAGS_origin_url));
   auto dash_backend = std::make_unique<DashBackend>(
-    FLAGS_abr_type, FLAGS_quic_config_path, FLAGS_site, FLAGS_minerva_config_path
+    FLAGS_abr_type, FLAGS_quic_config_path, FLAGS_site, FLAGS_minerva_config_path,
+    FLAGS_pensieve_model_path, FLAGS_titles_path, segment_cache,
+    GetQuicFlag(FLAGS_control_port), ControlOrigins()
   );
-  if (!GetQuicFlag(FLAGS_quic_config_path).empty()) {
-    dash_backend->InitializeBackend(
-      GetQuicFlag(FLAGS_quic_config_path));
+  if (!GetQuicFlag(FLAGS_quic_config_path).empty()
+      || !GetQuicFlag(FLAGS_titles_path).empty()) {
+    CHECK(dash_backend->InitializeBackend(GetQuicFlag(FLAGS_quic_config_path)))
+      << "malformed config " << GetQuicFlag(FLAGS_quic_config_path);
   }
   return dash_backend;
 }
@@ -87,6 +209,20 @@ int QuicDashServer::Start() {
   // Set the CCSelector singleton's congestion control type
   auto *selector = CCSelector::GetInstance();
   selector->setCongestionControlType(GetQuicFlag(FLAGS_cc_type));
+  selector->setShadowCongestionControlTypes(GetQuicFlag(FLAGS_shadow_cc));
+  SharedBottleneck::GetInstance()->setEnabled(GetQuicFlag(FLAGS_coupled_cc));
+  if (GetQuicFlag(FLAGS_coupled_cc) && !GetQuicFlag(FLAGS_coupled_cc_board).empty()) {
+    SharedBottleneck::GetInstance()->setBoard(
+      BottleneckBoard::Open(GetQuicFlag(FLAGS_coupled_cc_board)));
+  }
+
+  // Start the telemetry recorder before any connection or ABR loop is created
+  if (!GetQuicFlag(FLAGS_telemetry_path).empty()) {
+    TelemetryRecorder::GetInstance()->Start(GetQuicFlag(FLAGS_telemetry_path));
+  }
+  if (!GetQuicFlag(FLAGS_cc_capture_path).empty()) {
+    CCCapture::GetInstance()->Start(GetQuicFlag(FLAGS_cc_capture_path));
+  }
 
   // Create a server with the DASH backend handler from the factory 
   auto supported_versions = AllSupportedVersions();
@@ -1,7 +1,14 @@
 #include <vector>
 
+#include "base/logging.h"
+#include "base/strings/string_number_conversions.h"
+#include "base/threading/thread_task_runner_handle.h"
 #include "net/abrcc/dash_server.h"
 #include "net/abrcc/dash_server_backend_factory.h"
+#include "net/abrcc/emulation/link_emulator.h"
+#include "net/quic/platform/impl/quic_chromium_clock.h"
+#include "net/quic/quic_chromium_alarm_factory.h"
+#include "net/third_party/quiche/src/quic/core/crypto/crypto_protocol.h"
 #include "net/third_party/quiche/src/quic/core/quic_versions.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_flags.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_ptr_util.h"
@@ -9,8 +16,73 @@
 #include "net/third_party/quiche/src/quic/tools/quic_simple_server_backend.h"
 #include "net/tools/quic/quic_simple_server.h"
 
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    emulation_trace,
+    "",
+    "Specifies the path to a bandwidth trace(exp/network_traces or "
+    "Mahimahi format) replayed on the server's egress link in-process. "
+    "The link emulation is disabled if empty.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              emulation_delay_ms,
+                              0,
+                              "One-way propagation delay of the emulated link(ms).");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              emulation_queue_bytes,
+                              64 * 1024,
+                              "Queue capacity of the emulated link(bytes).");
+DEFINE_QUIC_COMMAND_LINE_FLAG(std::string,
+                              emulation_queue,
+                              "droptail",
+                              "Queue discipline of the emulated link: "
+                              "droptail or red.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(std::string,
+                              emulation_loss,
+                              "0",
+                              "Random loss rate of the emulated link.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              emulation_seed,
+                              0,
+                              "Seed of the emulated link's losses.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    bool,
+    bandwidth_resumption,
+    false,
+    "Resumes the connections of returning clients from the bandwidth and "
+    "min RTT of their previous connection, which the server leaves in their "
+    "source-address token, and seeds the ABR's start quality with them.");
+
+// Players without a control channel open a stream per metrics POST and long poll.
 const int MAX_STREAMS = 1000000;
 
+// Returns the link emulator from the emulation flags, or nullptr if the emulation
+// is disabled.
+std::unique_ptr<quic::QuicPacketWriterWrapper> CreateLinkEmulator() {
+  if (GetQuicFlag(FLAGS_emulation_trace).empty()) {
+    return nullptr;
+  }
+  auto trace = quic::BandwidthTrace::FromFile(GetQuicFlag(FLAGS_emulation_trace));
+  CHECK(trace) << "can not read trace " << GetQuicFlag(FLAGS_emulation_trace);
+
+  quic::LinkEmulatorConfig config;
+  config.delay = quic::QuicTime::Delta::FromMilliseconds(
+      GetQuicFlag(FLAGS_emulation_delay_ms));
+  config.queue_capacity = GetQuicFlag(FLAGS_emulation_queue_bytes);
+  config.seed = GetQuicFlag(FLAGS_emulation_seed);
+  CHECK(quic::LinkEmulatorConfig::ParseQueueDiscipline(
+      GetQuicFlag(FLAGS_emulation_queue), &config.queue_discipline))
+      << "unknown queue discipline " << GetQuicFlag(FLAGS_emulation_queue);
+  CHECK(base::StringToDouble(GetQuicFlag(FLAGS_emulation_loss), &config.loss_rate))
+      << "invalid loss rate " << GetQuicFlag(FLAGS_emulation_loss);
+
+  const quic::QuicClock* clock = quic::QuicChromiumClock::GetInstance();
+  return std::make_unique<quic::LinkEmulatorWriter>(
+      clock,
+      std::make_unique<net::QuicChromiumAlarmFactory>(
+          base::ThreadTaskRunnerHandle::Get().get(), clock),
+      std::move(trace), config);
+}
+
 class QuicSimpleServerFactory : public quic::QuicDashServer::ServerFactory {
   std::unique_ptr<quic::QuicSpdyServerBase> CreateServer(
       quic::QuicSimpleServerBackend* backend,
@@ -21,10 +93,21 @@ class QuicSimpleServerFactory : public quic::QuicDashServer::ServerFactory {
     config_.SetMaxIncomingBidirectionalStreamsToSend(MAX_STREAMS);
     config_.SetMaxIncomingUnidirectionalStreamsToSend(MAX_STREAMS);
 
-    return std::make_unique<net::QuicSimpleServer>(
+    if (GetQuicFlag(FLAGS_bandwidth_resumption)) {
+      // as if every client asked for it: the server then sends its estimates in
+      // server config updates, and resumes from the ones the client sends back
+      config_.SetInitialReceivedConnectionOptions({quic::kBWRE});
+    }
+
+    auto server = std::make_unique<net::QuicSimpleServer>(
         std::move(proof_source), config_,
         quic::QuicCryptoServerConfig::ConfigOptions(), supported_versions,
         backend);
+    auto link_emulator = CreateLinkEmulator();
+    if (link_emulator) {
+      server->SetPacketWriterWrapper(std::move(link_emulator));
+    }
+    return server;
   }
 
  private:
@@ -0,0 +1,290 @@
+#include "net/abrcc/dash_title.h"
+
+#include "net/abrcc/abr/abr.h"
+#include "net/abrcc/abr/interface.h"
+
+#include <algorithm>
+#include <utility>
+#include <string>
+#include <fstream>
+#include <streambuf>
+
+#include "base/bind.h"
+#include "base/json/json_value_converter.h"
+#include "base/json/json_reader.h"
+#include "base/values.h"
+
+#include "net/abrcc/cc/cc_wrapper.h"
+#include "net/abrcc/dash_config.h"
+#include "net/third_party/quiche/src/quic/core/http/spdy_utils.h"
+#include "net/abrcc/logging/log.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_text_utils.h"
+#include "net/third_party/quiche/src/quic/tools/quic_simple_server_stream.h"
+
+const std::string API_PATH = "/request";
+const std::string ABORT_PATH = "/abort";
+const std::string PIECE_PATH = "/piece";
+
+using spdy::SpdyHeaderBlock;
+
+namespace quic {
+
+DashTitle::DashTitle(
+  const std::string& abr_type,
+  const std::string& config_path,
+  const std::string& site,
+  const std::string& minerva_config_path, // only used by Minerva
+  const std::string& pensieve_model_path, // only used by Pensieve
+  const SegmentCacheConfig& segment_cache
+) : abr_type(abr_type)
+  , config_path(config_path)
+  , site(site)
+  , minerva_config_path(minerva_config_path)
+  , pensieve_model_path(pensieve_model_path)
+  , store(new StoreService(segment_cache))
+  , delivery(new DeliveryService())
+  , config(nullptr)
+  , loaded_(false)
+  , initialized_(false)
+  , last_collect(std::chrono::steady_clock::now())
+{
+  // read config file
+  std::ifstream stream(config_path);
+  std::string data((std::istreambuf_iterator<char>(stream)),
+                   std::istreambuf_iterator<char>());
+
+  // get config
+  base::Optional<base::Value> value = base::JSONReader::Read(data);
+  std::shared_ptr<DashBackendConfig> parsed(new DashBackendConfig());
+  base::JSONValueConverter<DashBackendConfig> converter;
+  if (!value || !converter.Convert(*value, parsed.get())) {
+    ABRCC_LOG(WARNING) << "[Title] malformed config " << config_path;
+    return;
+  }
+  config = parsed;
+
+  // override shared config values using site
+  config->domain = this->site;
+  config->base_path = config->base_path + this->site;
+
+  store->TrackDeliveries(delivery);
+}
+DashTitle::~DashTitle() {}
+
+bool DashTitle::configured() const {
+  return config != nullptr;
+}
+
+static std::unique_ptr<AbrInterface> newAbr(
+  const std::string& abr_type,
+  std::shared_ptr<DashBackendConfig> config,
+  const std::string& minerva_config_path,
+  const std::string& pensieve_model_path
+) {
+  return std::unique_ptr<AbrInterface>(
+    getAbr(abr_type, config, minerva_config_path, pensieve_model_path));
+}
+
+void DashTitle::Load() {
+  // paths
+  std::string dir_path = config_path.substr(0, config_path.find_last_of("/"));
+  std::string base_path = dir_path + config->base_path;
+
+  // register stores; the on-demand segments are bound to the network thread
+  store->MetaFromConfig(base_path, config);
+  if (!store->OnDemand()) {
+    store->VideoFromConfig(dir_path, config);
+  }
+  loaded_ = true;
+}
+
+void DashTitle::Initialize() {
+  if (!loaded_) {
+    Load();
+  }
+  if (store->OnDemand()) {
+    std::string dir_path = config_path.substr(0, config_path.find_last_of("/"));
+    store->VideoFromConfig(dir_path, config);
+  }
+
+  // the ABR loops are started with the players' sessions
+  initialized_ = true;
+}
+
+bool DashTitle::initialized() const {
+  return initialized_;
+}
+
+std::shared_ptr<ControlService> DashTitle::GetControlService(
+  const std::string& session
+) const {
+  for (auto &entry : sessions) {
+    if (entry.first.ToString() == session) {
+      return entry.second->control;
+    }
+  }
+  return nullptr;
+}
+
+DashTitle::Session* DashTitle::GetSession(
+  QuicSimpleServerBackend::RequestHandler* quic_stream
+) {
+  Collect();
+
+  auto now = std::chrono::steady_clock::now();
+  QuicConnectionId connection = quic_stream->connection_id();
+  auto found = sessions.find(connection);
+  if (found != sessions.end()) {
+    found->second->last_request = now;
+    return found->second.get();
+  }
+
+  // the player's first request registers its connection with its ABR
+  delivery->TrackSession(quic_stream);
+
+  // the ABR pairs with the connection's sender, which the client may request
+  auto stream = static_cast<QuicSimpleServerStream*>(quic_stream);
+  std::string session_abr_type = getSessionAbrType(
+    abr_type,
+    static_cast<const CCWrapper*>(stream->SendAlgorithm())->sender_type(),
+    minerva_config_path);
+
+  std::unique_ptr<Session> session(new Session());
+  session->metrics.reset(new MetricsService());
+  session->polling.reset(new PollingService());
+  session->control.reset(new ControlService(session->metrics));
+  session->abr_loop.reset(new AbrLoop(
+    base::BindOnce(&newAbr, session_abr_type, config, minerva_config_path, pensieve_model_path),
+    connection, session->metrics, session->polling, store, session->control, delivery));
+  session->abr_loop->Start();
+  session->last_request = now;
+  ABRCC_LOG(INFO) << "[Title] session " << connection << " started, "
+                  << sessions.size() + 1 << " sessions";
+
+  Session* out = session.get();
+  sessions[connection] = std::move(session);
+  return out;
+}
+
+void DashTitle::Collect() {
+  auto now = std::chrono::steady_clock::now();
+  if (now - last_collect
+      < std::chrono::milliseconds(DashTitleConstants::collect_period_ms)) {
+    return;
+  }
+  last_collect = now;
+
+  for (auto it = sessions.begin(); it != sessions.end();) {
+    if (now - it->second->last_request
+        > std::chrono::milliseconds(DashTitleConstants::session_idle_ms)) {
+      ABRCC_LOG(INFO) << "[Title] session " << it->first << " idle";
+      it->second->abr_loop->Stop();
+      delivery->Forget(it->first);
+      stopping.push_back(std::move(it->second));
+      it = sessions.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  // the ABR loop has exited, so destroying the session does not block
+  stopping.erase(
+    std::remove_if(stopping.begin(), stopping.end(),
+                   [](const std::unique_ptr<Session>& session) {
+                     return session->abr_loop->stopped();
+                   }),
+    stopping.end());
+}
+
+bool DashTitle::IsEntryPath(const std::string& path) const {
+  return path == "/" || path == config->player_config.index;
+}
+
+void DashTitle::Stop() {
+  for (auto &session : sessions) {
+    session.second->abr_loop->Stop();
+  }
+  for (auto &session : stopping) {
+    session->abr_loop->Stop();
+  }
+}
+
+bool DashTitle::stopped() const {
+  for (auto &session : sessions) {
+    if (!session.second->abr_loop->stopped()) {
+      return false;
+    }
+  }
+  for (auto &session : stopping) {
+    if (!session->abr_loop->stopped()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void DashTitle::CloseBackendResponseStream(
+  QuicSimpleServerBackend::RequestHandler* quic_stream
+) {
+  store->CloseStream(quic_stream);
+}
+
+void DashTitle::FetchResponseFromBackend(
+  const SpdyHeaderBlock& request_headers,
+  const std::string& request_body,
+  QuicSimpleServerBackend::RequestHandler* quic_stream
+) {
+  Session* session = GetSession(quic_stream);
+  std::shared_ptr<MetricsService> metrics = session->metrics;
+  std::shared_ptr<PollingService> polling = session->polling;
+
+  auto pathWrapper = request_headers.find(":path");
+  if (pathWrapper != request_headers.end()) {
+    auto path = pathWrapper->second;
+    if (path == API_PATH) {
+      // new metrics received
+      metrics->AddMetrics(request_headers, request_body, quic_stream);
+
+      // respond with 'OK'
+      QuicStringPiece response_body("OK");
+      SpdyHeaderBlock response_headers;
+      response_headers[":status"] = QuicTextUtils::Uint64ToString(200);
+      response_headers["content-length"] =
+        QuicTextUtils::Uint64ToString(response_body.length());
+      response_headers[DashTitleConstants::session_header] =
+        quic_stream->connection_id().ToString();
+
+      QuicBackendResponse quic_response;
+      quic_response.set_response_type(QuicBackendResponse::REGULAR_RESPONSE);
+      quic_response.set_headers(std::move(response_headers));
+      quic_response.set_body(response_body);
+      quic_response.set_trailers(SpdyHeaderBlock());
+      quic_response.set_stop_sending_code(0);
+
+      auto push_info = std::list<QuicBackendResponse::ServerPushInfo>();
+      quic_stream->OnResponseBackendComplete(&quic_response, push_info);
+    } else if (path.find(API_PATH) != std::string::npos) {
+      // add a long polling request
+      polling->AddRequest(request_headers, request_body, std::move(quic_stream));
+    } else if (path.find(PIECE_PATH) != std::string::npos) {
+      // a request for a piece was received
+      polling->AddRequest(request_headers, request_body, std::move(quic_stream));
+    } else if (path.find(ABORT_PATH) != std::string::npos) {
+      std::string index_raw = std::string(path).substr(
+        path.find(ABORT_PATH) + ABORT_PATH.size() + 1
+      );
+      int abort_index = std::stoi(index_raw);
+
+      ABRCC_LOG(WARNING) << "Aborting: " << abort_index;
+      metrics->AddAbort(abort_index);
+    } else {
+      // serving pieces
+      store->FetchResponseFromBackend(request_headers, request_body, quic_stream);
+      ABRCC_LOG_EVERY_MS(WARNING, 1000) << "Serving: " << path;
+    }
+  } else {
+    store->FetchResponseFromBackend(request_headers, request_body, quic_stream);
+  }
+}
+
+}
@@ -0,0 +1,120 @@
+#ifndef ABRCC_DASH_TITLE_H_
+#define ABRCC_DASH_TITLE_H_
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "net/abrcc/abr/loop.h"
+
+#include "net/abrcc/service/control_service.h"
+#include "net/abrcc/service/delivery_service.h"
+#include "net/abrcc/service/store_service.h"
+#include "net/abrcc/service/metrics_service.h"
+#include "net/abrcc/service/poll_service.h"
+
+#include "net/third_party/quiche/src/quic/tools/quic_backend_response.h"
+#include "net/third_party/quiche/src/quic/tools/quic_simple_server_backend.h"
+
+namespace quic {
+
+namespace DashTitleConstants {
+  // a player session is stopped after not sending requests for `session_idle_ms`
+  const int session_idle_ms = 30000;
+  // idle sessions are checked at most every `collect_period_ms`
+  const int collect_period_ms = 1000;
+  // response header naming the player's session, for binding its control channels
+  const std::string session_header = "abrcc-session";
+}
+
+// One title served by the DASH backend: its video configuration, the stores of its
+// segments and metadata, and the sessions of its players. Requests reaching the
+// title carry paths relative to the title, as in the configuration.
+//
+// A player session is keyed by its connection: it has its own metrics, long polls,
+// control channels and ABR loop, such that the players of a title do not share the
+// ABR's state nor its congestion control interfaces. A session starts on the first
+// request of a connection and is stopped once idle.
+class DashTitle {
+ public:
+  // Reads the configuration at `config_path`; configured() is false if it can not
+  // be parsed.
+  DashTitle(
+    const std::string& abr_type,
+    const std::string& config_path,
+    const std::string& site,
+    const std::string& minerva_config_path_, // only used by Minerva
+    const std::string& pensieve_model_path_, // only used by Pensieve
+    const SegmentCacheConfig& segment_cache
+  );
+  DashTitle(const DashTitle&) = delete;
+  DashTitle& operator=(const DashTitle&) = delete;
+  ~DashTitle();
+
+  bool configured() const;
+
+  // Loads the metadata, and the segments unless the store serves them on demand,
+  // into the store; it can be called on any thread, before Initialize.
+  void Load();
+  // Loads the title if not loaded yet and registers the on-demand segments; it has
+  // to be called on the network thread.
+  void Initialize();
+  bool initialized() const;
+
+  void FetchResponseFromBackend(
+      const spdy::SpdyHeaderBlock& request_headers,
+      const std::string& request_body,
+      QuicSimpleServerBackend::RequestHandler* quic_server_stream);
+  void CloseBackendResponseStream(
+      QuicSimpleServerBackend::RequestHandler* quic_server_stream);
+
+  // Control service of the player session `session`, as named by the session's
+  // responses(see `session_header`), or nullptr if the session is unknown.
+  std::shared_ptr<ControlService> GetControlService(const std::string& session) const;
+
+  // Whether `path` starts a new session of the title, i.e. loads the player page.
+  bool IsEntryPath(const std::string& path) const;
+
+  // Stops the ABR loops; the title can be destroyed without blocking once stopped.
+  void Stop();
+  bool stopped() const;
+ private:
+  struct Session {
+    std::shared_ptr<MetricsService> metrics;
+    std::shared_ptr<PollingService> polling;
+    std::shared_ptr<ControlService> control;
+    std::unique_ptr<AbrLoop> abr_loop;
+    std::chrono::steady_clock::time_point last_request;
+  };
+
+  // Returns the session of the connection of `quic_stream`, starting it if new.
+  Session* GetSession(QuicSimpleServerBackend::RequestHandler* quic_stream);
+  // Stops the idle sessions and drops the stopped ones.
+  void Collect();
+
+  std::string abr_type;
+  std::string config_path;
+  std::string site;
+  std::string minerva_config_path;
+  std::string pensieve_model_path;
+
+  std::shared_ptr<StoreService> store;
+  std::shared_ptr<DeliveryService> delivery;
+
+  std::shared_ptr<DashBackendConfig> config;
+
+  bool loaded_;
+  bool initialized_;
+
+  std::unordered_map<QuicConnectionId, std::unique_ptr<Session>, QuicConnectionIdHash>
+    sessions;
+  // idle sessions whose ABR loop is exiting
+  std::vector<std::unique_ptr<Session>> stopping;
+  std::chrono::steady_clock::time_point last_collect;
+};
+
+}
+
+#endif
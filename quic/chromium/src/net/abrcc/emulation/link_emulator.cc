@@ -0,0 +1,182 @@
+#include "net/abrcc/emulation/link_emulator.h"
+
+#include <algorithm>
+
+#include "net/abrcc/logging/log.h"
+#include "net/third_party/quiche/src/quic/core/quic_clock.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+namespace quic {
+
+LinkEmulatorConfig::LinkEmulatorConfig()
+  : delay(QuicTime::Delta::Zero())
+  , queue_capacity(64 * 1024)
+  , queue_discipline(DROP_TAIL)
+  , loss_rate(0)
+  , seed(0) {}
+
+bool LinkEmulatorConfig::ParseQueueDiscipline(const std::string& value,
+                                              QueueDiscipline* field) {
+  if (value == "droptail") {
+    *field = DROP_TAIL;
+    return true;
+  }
+  if (value == "red") {
+    *field = RED;
+    return true;
+  }
+  return false;
+}
+
+LinkEmulatorWriter::DeliveryDelegate::DeliveryDelegate(LinkEmulatorWriter* writer)
+  : writer(writer) {}
+
+void LinkEmulatorWriter::DeliveryDelegate::OnAlarm() {
+  writer->OnDeliveryAlarm();
+}
+
+LinkEmulatorWriter::LinkEmulatorWriter(
+  const QuicClock* clock,
+  std::unique_ptr<QuicAlarmFactory> alarm_factory,
+  std::unique_ptr<BandwidthTrace> trace,
+  const LinkEmulatorConfig& config
+) : clock(clock)
+  , alarm_factory(std::move(alarm_factory))
+  , trace(std::move(trace))
+  , config(config)
+  , start(clock->Now())
+  , link_free(start)
+  , generator(config.seed)
+  , uniform(0, 1)
+  , dropped_(0) {
+  alarm = std::unique_ptr<QuicAlarm>(
+    this->alarm_factory->CreateAlarm(new DeliveryDelegate(this)));
+  ABRCC_LOG(WARNING) << "[LinkEmulatorWriter] trace " << this->trace->name()
+                     << " [mean bandwidth] " << this->trace->meanBandwidth().ToKBitsPerSecond()
+                     << " [delay] " << config.delay.ToMilliseconds()
+                     << " [queue] " << config.queue_capacity;
+}
+
+LinkEmulatorWriter::~LinkEmulatorWriter() {
+  alarm->Cancel();
+}
+
+bool LinkEmulatorWriter::shouldDrop(QuicByteCount backlog, QuicByteCount bytes) {
+  if (config.loss_rate > 0 && uniform(generator) < config.loss_rate) {
+    return true;
+  }
+  if (backlog + bytes > config.queue_capacity) {
+    return true;
+  }
+  if (config.queue_discipline != LinkEmulatorConfig::RED) {
+    return false;
+  }
+
+  double fraction = 1. * backlog / config.queue_capacity;
+  if (fraction < LinkEmulatorConstants::red_min_fraction) {
+    return false;
+  }
+  if (fraction >= LinkEmulatorConstants::red_max_fraction) {
+    return true;
+  }
+  double probability = LinkEmulatorConstants::red_max_probability
+    * (fraction - LinkEmulatorConstants::red_min_fraction)
+    / (LinkEmulatorConstants::red_max_fraction - LinkEmulatorConstants::red_min_fraction);
+  return uniform(generator) < probability;
+}
+
+WriteResult LinkEmulatorWriter::WritePacket(
+  const char* buffer,
+  size_t buf_len,
+  const QuicIpAddress& self_address,
+  const QuicSocketAddress& peer_address,
+  PerPacketOptions* /*options*/
+) {
+  QuicTime now = clock->Now();
+
+  // bytes still to be serialized before this packet
+  QuicTime begin = std::max(now, link_free);
+  QuicByteCount backlog = trace->capacity(now - start, begin - start);
+  if (shouldDrop(backlog, buf_len)) {
+    dropped_ += 1;
+    return WriteResult(WRITE_STATUS_OK, buf_len);
+  }
+
+  link_free = start + trace->deliveryTime(begin - start, buf_len);
+  packets.push_back(QueuedPacket{
+    std::string(buffer, buf_len),
+    self_address,
+    peer_address,
+    link_free + config.delay,
+  });
+  if (!alarm->IsSet()) {
+    alarm->Set(packets.front().delivery_time);
+  }
+  return WriteResult(WRITE_STATUS_OK, buf_len);
+}
+
+void LinkEmulatorWriter::OnDeliveryAlarm() {
+  QuicTime now = clock->Now();
+  while (!packets.empty() && packets.front().delivery_time <= now) {
+    if (writer()->IsWriteBlocked()) {
+      alarm->Set(now + QuicTime::Delta::FromMilliseconds(
+        LinkEmulatorConstants::blocked_retry_ms));
+      return;
+    }
+
+    const QueuedPacket& packet = packets.front();
+    WriteResult result = writer()->WritePacket(
+      packet.data.data(), packet.data.size(), packet.self_address,
+      packet.peer_address, nullptr);
+    if (result.status == WRITE_STATUS_BLOCKED) {
+      // the packet was not buffered by the writer
+      alarm->Set(now + QuicTime::Delta::FromMilliseconds(
+        LinkEmulatorConstants::blocked_retry_ms));
+      return;
+    }
+    if (IsWriteError(result.status)) {
+      ABRCC_LOG_EVERY_MS(WARNING, 1000) << "[LinkEmulatorWriter] write error "
+                                        << result.error_code;
+    }
+    packets.pop_front();
+  }
+
+  if (!packets.empty()) {
+    alarm->Set(packets.front().delivery_time);
+  }
+}
+
+bool LinkEmulatorWriter::IsWriteBlocked() const {
+  // the queue absorbs or drops the packets, as the emulated link would
+  return false;
+}
+
+bool LinkEmulatorWriter::SupportsReleaseTime() const {
+  return false;
+}
+
+bool LinkEmulatorWriter::IsBatchMode() const {
+  return false;
+}
+
+char* LinkEmulatorWriter::GetNextWriteLocation(
+  const QuicIpAddress& /*self_address*/,
+  const QuicSocketAddress& /*peer_address*/
+) {
+  // the packets are copied into the queue
+  return nullptr;
+}
+
+WriteResult LinkEmulatorWriter::Flush() {
+  return WriteResult(WRITE_STATUS_OK, 0);
+}
+
+int64_t LinkEmulatorWriter::dropped() const {
+  return dropped_;
+}
+
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,128 @@
+#ifndef ABRCC_EMULATION_LINK_EMULATOR_H_
+#define ABRCC_EMULATION_LINK_EMULATOR_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <random>
+#include <string>
+
+#include "net/abrcc/structs/bandwidth_trace.h"
+#include "net/third_party/quiche/src/quic/core/quic_alarm.h"
+#include "net/third_party/quiche/src/quic/core/quic_alarm_factory.h"
+#include "net/third_party/quiche/src/quic/core/quic_packet_writer_wrapper.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+class QuicClock;
+
+namespace LinkEmulatorConstants {
+  // period after which packets held back by a blocked writer are retried(ms)
+  const int blocked_retry_ms = 1;
+
+  // RED drops with a probability growing from 0, when the queue is at
+  // red_min_fraction of its capacity, to red_max_probability, at red_max_fraction;
+  // above red_max_fraction, all packets are dropped
+  const double red_min_fraction = 0.25;
+  const double red_max_fraction = 0.75;
+  const double red_max_probability = 0.1;
+}
+
+struct LinkEmulatorConfig {
+  enum QueueDiscipline {
+    DROP_TAIL, RED,
+  };
+
+  // one-way propagation delay added to every packet
+  QuicTime::Delta delay;
+  // bytes waiting to be serialized on the link
+  QuicByteCount queue_capacity;
+  QueueDiscipline queue_discipline;
+  // probability of a random loss
+  double loss_rate;
+  uint64_t seed;
+
+  LinkEmulatorConfig();
+
+  // Returns false if `value` is neither "droptail" nor "red".
+  static bool ParseQueueDiscipline(const std::string& value, QueueDiscipline* field);
+};
+
+// Emulates the bottleneck link of the server's egress traffic in-process, in place
+// of `tc`: the packets are serialized at the bandwidth of a BandwidthTrace, queued
+// in a drop-tail or RED queue, randomly lost and delayed by the propagation delay
+// before being handed to the wrapped writer. All the server's connections share the
+// link.
+//
+// A packet leaves the link at the exact time its last byte is serialized at the
+// trace's bandwidth; it is written once the alarm fires, hence with the alarm's
+// granularity. The emulator is only installed when enabled, so it costs nothing
+// otherwise.
+class LinkEmulatorWriter : public QuicPacketWriterWrapper {
+ public:
+  LinkEmulatorWriter(const QuicClock* clock,
+                     std::unique_ptr<QuicAlarmFactory> alarm_factory,
+                     std::unique_ptr<BandwidthTrace> trace,
+                     const LinkEmulatorConfig& config);
+  ~LinkEmulatorWriter() override;
+
+  // The packets are always accepted; dropped ones are reported as written.
+  WriteResult WritePacket(const char* buffer,
+                          size_t buf_len,
+                          const QuicIpAddress& self_address,
+                          const QuicSocketAddress& peer_address,
+                          PerPacketOptions* options) override;
+  bool IsWriteBlocked() const override;
+  bool SupportsReleaseTime() const override;
+  bool IsBatchMode() const override;
+  char* GetNextWriteLocation(const QuicIpAddress& self_address,
+                             const QuicSocketAddress& peer_address) override;
+  WriteResult Flush() override;
+
+  int64_t dropped() const;
+ private:
+  class DeliveryDelegate : public QuicAlarm::Delegate {
+   public:
+    explicit DeliveryDelegate(LinkEmulatorWriter* writer);
+    void OnAlarm() override;
+   private:
+    LinkEmulatorWriter* writer;
+  };
+
+  struct QueuedPacket {
+    std::string data;
+    QuicIpAddress self_address;
+    QuicSocketAddress peer_address;
+    QuicTime delivery_time;
+  };
+
+  bool shouldDrop(QuicByteCount backlog, QuicByteCount bytes);
+  void OnDeliveryAlarm();
+
+  const QuicClock* clock;
+  std::unique_ptr<QuicAlarmFactory> alarm_factory;
+  std::unique_ptr<QuicAlarm> alarm;
+  std::unique_ptr<BandwidthTrace> trace;
+  LinkEmulatorConfig config;
+
+  // the trace starts with the emulator
+  QuicTime start;
+  // time at which the last queued packet is serialized
+  QuicTime link_free;
+  std::deque<QueuedPacket> packets;
+
+  std::mt19937_64 generator;
+  std::uniform_real_distribution<double> uniform;
+  int64_t dropped_;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -0,0 +1,107 @@
+#include "net/abrcc/logging/log.h"
+#include "net/abrcc/cc/singleton.h"
+
+#include <chrono>
+#include <thread>
+
+#include "base/bind.h"
+#include "base/logging.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+namespace quic {
+
+bool LogSite::everyN(int n) {
+  return count.fetch_add(1, std::memory_order_relaxed) % uint64_t(n) == 0;
+}
+
+bool LogSite::everyMs(int ms) {
+  int64_t now = std::chrono::duration_cast<std::chrono::milliseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+  int64_t current = next.load(std::memory_order_relaxed);
+  if (now < current) {
+    return false;
+  }
+  // only the thread that moves the deadline logs
+  return next.compare_exchange_strong(current, now + ms, std::memory_order_relaxed);
+}
+
+AsyncLogSink* AsyncLogSink::GetInstance() {
+  return GET_SINGLETON(AsyncLogSink);
+}
+
+AsyncLogSink::AsyncLogSink() : dropped(0) {}
+AsyncLogSink::~AsyncLogSink() {}
+
+void AsyncLogSink::Push(const char* file, int line, int level, std::string message) {
+  Entry entry{file, line, level, std::move(message)};
+  if (level >= ABRCC_LOG_LEVEL_ERROR) {
+    Write(entry);
+    return;
+  }
+
+  QuicWriterMutexLock lock(&mutex_);
+  if (thread == nullptr) {
+    std::unique_ptr<base::Thread> writer(new base::Thread("abrcc_log"));
+    CHECK(writer->Start());
+    writer->task_runner()->PostTask(FROM_HERE, base::BindOnce(&DrainLoop, this));
+    thread = std::move(writer);
+  }
+  if (int(entries.size()) >= AsyncLogConstants::capacity) {
+    ++dropped;
+    return;
+  }
+  entries.push_back(std::move(entry));
+}
+
+void AsyncLogSink::Write(const Entry& entry) {
+  logging::LogSeverity severity = logging::LOG_INFO;
+  if (entry.level == ABRCC_LOG_LEVEL_WARNING) {
+    severity = logging::LOG_WARNING;
+  } else if (entry.level >= ABRCC_LOG_LEVEL_ERROR) {
+    severity = logging::LOG_ERROR;
+  }
+  logging::LogMessage(entry.file, entry.line, severity).stream() << entry.message;
+}
+
+void AsyncLogSink::DrainLoop(AsyncLogSink* sink) {
+  while (true) {
+    sink->Drain();
+    std::this_thread::sleep_for(
+      std::chrono::milliseconds(AsyncLogConstants::drain_period));
+  }
+}
+
+void AsyncLogSink::Drain() {
+  // the messages are written outside the lock, so producers only wait for the swap
+  std::vector<Entry> current;
+  int64_t current_dropped;
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    current.swap(entries);
+    current_dropped = dropped;
+    dropped = 0;
+  }
+
+  for (auto& entry : current) {
+    Write(entry);
+  }
+  if (current_dropped > 0) {
+    Write(Entry{__FILE__, __LINE__, ABRCC_LOG_LEVEL_WARNING,
+                "[AsyncLogSink] dropped " + std::to_string(current_dropped) + " messages"});
+  }
+}
+
+AsyncLogMessage::AsyncLogMessage(const char* file, int line, int level)
+  : file(file), line(line), level(level) {}
+
+AsyncLogMessage::~AsyncLogMessage() {
+  // GetInstance is resolved once, as it is too expensive for every message
+  static AsyncLogSink* sink = AsyncLogSink::GetInstance();
+  sink->Push(file, line, level, stream_.str());
+}
+
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,137 @@
+#ifndef ABRCC_LOGGING_LOG_H_
+#define ABRCC_LOGGING_LOG_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/threading/thread.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
+
+// Logging facade for abrcc:
+//   - ABRCC_LOG(severity) << ...
+//   - ABRCC_LOG_EVERY_N(severity, n) << ...: logs 1 in n messages of the call site
+//   - ABRCC_LOG_EVERY_MS(severity, ms) << ...: logs at most once per `ms` for the call site
+// with `severity` one of INFO, WARNING, ERROR.
+//
+// Messages below ABRCC_MIN_LOG_LEVEL are eliminated at compile time, including the
+// evaluation of their arguments. Messages dropped by sampling are not formatted. The
+// remaining messages are formatted on the caller's thread and written to the base
+// logging destinations by the AsyncLogSink's background thread; ERROR messages are
+// written synchronously, so that they are not lost on a crash.
+
+#define ABRCC_LOG_LEVEL_INFO 0
+#define ABRCC_LOG_LEVEL_WARNING 1
+#define ABRCC_LOG_LEVEL_ERROR 2
+
+#ifndef ABRCC_MIN_LOG_LEVEL
+#if defined(NDEBUG)
+#define ABRCC_MIN_LOG_LEVEL ABRCC_LOG_LEVEL_WARNING
+#else
+#define ABRCC_MIN_LOG_LEVEL ABRCC_LOG_LEVEL_INFO
+#endif
+#endif
+
+#define ABRCC_LOG_IS_ON(severity) (ABRCC_LOG_LEVEL_##severity >= ABRCC_MIN_LOG_LEVEL)
+
+#define ABRCC_LAZY_STREAM(condition, severity)                      \
+  !(condition) ? (void)0 : ::quic::AsyncLogVoidify() &              \
+    ::quic::AsyncLogMessage(__FILE__, __LINE__, ABRCC_LOG_LEVEL_##severity).stream()
+
+// Every expansion instantiates a distinct lambda, hence a distinct static LogSite.
+#define ABRCC_LOG_SITE() \
+  ([]() -> ::quic::LogSite& { static ::quic::LogSite site; return site; }())
+
+#define ABRCC_LOG(severity) ABRCC_LAZY_STREAM(ABRCC_LOG_IS_ON(severity), severity)
+
+#define ABRCC_LOG_EVERY_N(severity, n) \
+  ABRCC_LAZY_STREAM(ABRCC_LOG_IS_ON(severity) && ABRCC_LOG_SITE().everyN(n), severity)
+
+#define ABRCC_LOG_EVERY_MS(severity, ms) \
+  ABRCC_LAZY_STREAM(ABRCC_LOG_IS_ON(severity) && ABRCC_LOG_SITE().everyMs(ms), severity)
+
+namespace quic {
+
+namespace AsyncLogConstants {
+  // messages buffered between two consecutive drains
+  const int capacity = 1 << 14;
+
+  // period of the background writer(ms)
+  const int drain_period = 50;
+}
+
+// Sampling state of a logging call site.
+class LogSite {
+ public:
+  constexpr LogSite() : count(0), next(0) {}
+
+  bool everyN(int n);
+  bool everyMs(int ms);
+ private:
+  std::atomic<uint64_t> count;
+  std::atomic<int64_t> next;
+};
+
+// Bounded queue of formatted messages written by a background thread. Pushing into
+// a full queue drops the message; the number of dropped messages is logged by the
+// background thread.
+class AsyncLogSink {
+ public:
+  virtual ~AsyncLogSink();
+  static AsyncLogSink* GetInstance();
+
+  void Push(const char* file, int line, int level, std::string message);
+ private:
+  AsyncLogSink();
+
+  struct Entry {
+    const char* file;
+    int line;
+    int level;
+    std::string message;
+  };
+
+  static void Write(const Entry& entry);
+  static void DrainLoop(AsyncLogSink* sink);
+  void Drain();
+
+  std::vector<Entry> entries;
+  int64_t dropped;
+  mutable QuicMutex mutex_;
+
+  // the writer is started by the first pushed message
+  std::unique_ptr<base::Thread> thread;
+};
+
+class AsyncLogMessage {
+ public:
+  AsyncLogMessage(const char* file, int line, int level);
+  AsyncLogMessage(const AsyncLogMessage&) = delete;
+  AsyncLogMessage& operator=(const AsyncLogMessage&) = delete;
+  ~AsyncLogMessage();
+
+  std::ostream& stream() { return stream_; }
+ private:
+  const char* file;
+  int line;
+  int level;
+  std::ostringstream stream_;
+};
+
+// Lowers the precedence of the stream below `?:` in ABRCC_LAZY_STREAM.
+class AsyncLogVoidify {
+ public:
+  void operator&(std::ostream&) {}
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -0,0 +1,361 @@
+// Replays the CC event logs captured by the dash_server(--cc_capture_path) into
+// freshly built senders and diffs their pacing rate, congestion window and bandwidth
+// estimate against the recorded sender's after every congestion event.
+//
+// The sender sees the recorded inputs in their original order, over its own
+// RttStats and QuicUnackedPacketMap, while a mock clock follows the events' times.
+// Each log is replayed once per CC type; with no --cc_types, the recorded type is
+// replayed, which measures the sender's non-determinism(e.g. BBR's random gain
+// cycle offset). ABR-steered senders run without an ABR, hence without a target
+// rate. One CSV row is printed per log and CC(or per congestion event with
+// --per_event); the replay throughput is printed to stderr. With --decode_only, the
+// logs are only decoded, and the decoding throughput is printed to stderr.
+//
+// Usage: abrcc_cc_replay [--cc_types=bbr,target] [--per_event] <log.events>... > diff.csv
+//        abrcc_cc_replay --decode_only <log.events>...
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/strings/string_split.h"
+
+#include "net/abrcc/cc/cc_selector.h"
+#include "net/abrcc/replay/event_log.h"
+#include "net/third_party/quiche/src/quic/core/congestion_control/rtt_stats.h"
+#include "net/third_party/quiche/src/quic/core/congestion_control/send_algorithm_interface.h"
+#include "net/third_party/quiche/src/quic/core/quic_connection_stats.h"
+#include "net/third_party/quiche/src/quic/core/quic_constants.h"
+#include "net/third_party/quiche/src/quic/core/quic_packets.h"
+#include "net/third_party/quiche/src/quic/core/quic_unacked_packet_map.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_flags.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_system_event_loop.h"
+#include "net/third_party/quiche/src/quic/test_tools/mock_clock.h"
+#include "net/third_party/quiche/src/quic/test_tools/quic_test_utils.h"
+
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    cc_types,
+    "",
+    "Comma-separated congestion control types to replay the logs "
+    "into; the recorded type if empty.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(bool,
+                              per_event,
+                              false,
+                              "Prints one row per congestion event instead "
+                              "of one row per log and CC.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(bool,
+                              decode_only,
+                              false,
+                              "Only decodes the logs, measuring the decoding "
+                              "throughput.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              seed,
+                              0,
+                              "Seed of the senders' random generator.");
+
+namespace {
+
+using namespace quic;
+
+// Running mean and maximum of the relative difference(%) of a replayed output.
+struct Difference {
+  double sum = 0;
+  double max = 0;
+
+  void add(double recorded, double replayed) {
+    double difference = 100. * std::abs(replayed - recorded) / std::max(recorded, 1.);
+    sum += difference;
+    max = std::max(max, difference);
+  }
+};
+
+struct ReplayResult {
+  int64_t events = 0;
+  int64_t congestion_events = 0;
+  Difference pacing_rate;
+  Difference cwnd;
+  Difference bandwidth;
+  double wall_time = 0; // s
+};
+
+std::vector<std::string> split(const std::string& value) {
+  return base::SplitString(value, ",", base::TRIM_WHITESPACE,
+                           base::SPLIT_WANT_NONEMPTY);
+}
+
+bool load_log(const std::string& path, std::string* data) {
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream.is_open()) {
+    return false;
+  }
+  std::stringstream buffer;
+  buffer << stream.rdbuf();
+  *data = buffer.str();
+  return true;
+}
+
+// Mirrors the QuicSentPacketManager's bookkeeping of the unacked packets around a
+// congestion event, such that senders see the same bytes in flight.
+void mark_handled(const CCEvent& event, QuicUnackedPacketMap* unacked_packets) {
+  QuicPacketNumber largest_acked;
+  for (const auto& packet : event.acked) {
+    if (unacked_packets->IsUnacked(packet.packet_number)) {
+      QuicTransmissionInfo* info =
+        unacked_packets->GetMutableTransmissionInfo(packet.packet_number);
+      unacked_packets->RemoveFromInFlight(info);
+      info->state = ACKED;
+    }
+    if (!largest_acked.IsInitialized() || packet.packet_number > largest_acked) {
+      largest_acked = packet.packet_number;
+    }
+  }
+  for (const auto& packet : event.lost) {
+    if (unacked_packets->IsUnacked(packet.packet_number)) {
+      QuicTransmissionInfo* info =
+        unacked_packets->GetMutableTransmissionInfo(packet.packet_number);
+      unacked_packets->RemoveFromInFlight(info);
+      info->state = LOST;
+    }
+  }
+  if (largest_acked.IsInitialized()
+      && (!unacked_packets->largest_acked().IsInitialized()
+          || largest_acked > unacked_packets->largest_acked())) {
+    unacked_packets->IncreaseLargestAcked(largest_acked);
+  }
+}
+
+// Decodes all the events of the log in `data`, adding them to `result`; returns false if the log has no
+// valid header.
+bool decode(const std::string& data, ReplayResult* result) {
+  CCEventReader reader(data.data(), data.size());
+  CCEventLogHeader header{kCubicBytes, QuicTime::Delta::Zero()};
+  if (!reader.ReadHeader(&header)) {
+    return false;
+  }
+
+  CCEvent event;
+  auto start = std::chrono::steady_clock::now();
+  while (reader.Next(&event)) {
+    ++result->events;
+    if (event.kind == CCEvent::CONGESTION_EVENT) {
+      ++result->congestion_events;
+    }
+  }
+  auto end = std::chrono::steady_clock::now();
+  result->wall_time += std::chrono::duration<double>(end - start).count();
+  return true;
+}
+
+// Replays the log in `data` into a sender of `cc_type`(the recorded type if empty);
+// returns false if the log has no valid header.
+bool replay(const std::string& name, const std::string& data, const std::string& cc_type,
+            ReplayResult* result) {
+  CCEventReader reader(data.data(), data.size());
+  CCEventLogHeader header{kCubicBytes, QuicTime::Delta::Zero()};
+  if (!reader.ReadHeader(&header)) {
+    return false;
+  }
+
+  MockClock clock;
+  RttStats rtt_stats;
+  rtt_stats.set_initial_rtt(header.initial_rtt);
+  QuicUnackedPacketMap unacked_packets(Perspective::IS_SERVER);
+  test::SimpleRandom random;
+  random.set_seed(GetQuicFlag(FLAGS_seed));
+  QuicConnectionStats stats;
+
+  CCEvent event;
+  if (!reader.Next(&event)) {
+    return true;
+  }
+  // the sender is created at the time of the first event
+  clock.AdvanceTime(event.time - clock.Now());
+
+  std::unique_ptr<SendAlgorithmInterface> sender;
+  if (cc_type.empty()) {
+    sender.reset(SendAlgorithmInterface::CreateForConnection(
+      &clock, &rtt_stats, &unacked_packets, header.cc_type, &random, &stats,
+      kInitialCongestionWindow));
+  } else {
+    CCSelector::GetInstance()->setCongestionControlType(cc_type);
+    sender.reset(SendAlgorithmInterface::Create(
+      &clock, &rtt_stats, &unacked_packets, kCubicBytes, &random, &stats,
+      kInitialCongestionWindow));
+  }
+  const char* label = cc_type.empty() ? "recorded" : cc_type.c_str();
+
+  auto start = std::chrono::steady_clock::now();
+  do {
+    ++result->events;
+    if (event.time > clock.Now()) {
+      clock.AdvanceTime(event.time - clock.Now());
+    }
+
+    switch (event.kind) {
+      case CCEvent::PACKET_SENT: {
+        sender->OnPacketSent(event.time, event.bytes_in_flight, event.packet_number,
+                             event.bytes, event.retransmittable
+                               ? HAS_RETRANSMITTABLE_DATA
+                               : NO_RETRANSMITTABLE_DATA);
+        if (!unacked_packets.largest_sent_packet().IsInitialized()
+            || event.packet_number > unacked_packets.largest_sent_packet()) {
+          SerializedPacket packet(event.packet_number, PACKET_4BYTE_PACKET_NUMBER,
+                                  nullptr, static_cast<QuicPacketLength>(event.bytes),
+                                  false, false);
+          unacked_packets.AddSentPacket(&packet, NOT_RETRANSMISSION, event.time,
+                                        event.retransmittable);
+        }
+        break;
+      }
+      case CCEvent::CONGESTION_EVENT: {
+        mark_handled(event, &unacked_packets);
+        sender->OnCongestionEvent(event.rtt_updated, event.bytes_in_flight, event.time,
+                                  event.acked, event.lost);
+        unacked_packets.RemoveObsoletePackets();
+
+        QuicBandwidth pacing_rate = sender->PacingRate(event.bytes_in_flight);
+        QuicByteCount cwnd = sender->GetCongestionWindow();
+        QuicBandwidth bandwidth = sender->BandwidthEstimate();
+        ++result->congestion_events;
+        result->pacing_rate.add(event.pacing_rate.ToBitsPerSecond(),
+                                pacing_rate.ToBitsPerSecond());
+        result->cwnd.add(event.cwnd, cwnd);
+        result->bandwidth.add(event.bandwidth.ToBitsPerSecond(),
+                              bandwidth.ToBitsPerSecond());
+        if (GetQuicFlag(FLAGS_per_event)) {
+          printf("%s,%s,%lld,%lld,%lld,%llu,%llu,%lld,%lld\n",
+                 name.c_str(), label,
+                 static_cast<long long>((event.time - QuicTime::Zero()).ToMicroseconds()),
+                 static_cast<long long>(event.pacing_rate.ToKBitsPerSecond()),
+                 static_cast<long long>(pacing_rate.ToKBitsPerSecond()),
+                 static_cast<unsigned long long>(event.cwnd),
+                 static_cast<unsigned long long>(cwnd),
+                 static_cast<long long>(event.bandwidth.ToKBitsPerSecond()),
+                 static_cast<long long>(bandwidth.ToKBitsPerSecond()));
+        }
+        break;
+      }
+      case CCEvent::APPLICATION_LIMITED:
+        sender->OnApplicationLimited(event.bytes_in_flight);
+        break;
+      case CCEvent::RTT_UPDATE:
+        rtt_stats.UpdateRtt(event.rtt, event.ack_delay, event.time);
+        sender->OnRttUpdated(event.rtt, event.ack_delay, event.time);
+        break;
+      case CCEvent::RETRANSMISSION_TIMEOUT:
+        sender->OnRetransmissionTimeout(event.packets_retransmitted);
+        break;
+      case CCEvent::CONNECTION_MIGRATION:
+        rtt_stats.OnConnectionMigration();
+        sender->OnConnectionMigration();
+        break;
+      case CCEvent::INITIAL_RTT:
+        rtt_stats.set_initial_rtt(event.rtt);
+        break;
+      case CCEvent::INITIAL_WINDOW:
+        sender->SetInitialCongestionWindowInPackets(event.cwnd);
+        break;
+      case CCEvent::NETWORK_PARAMS:
+        sender->AdjustNetworkParameters(SendAlgorithmInterface::NetworkParams(
+          event.bandwidth, event.rtt, event.allow_cwnd_to_decrease));
+        break;
+    }
+  } while (reader.Next(&event));
+  auto end = std::chrono::steady_clock::now();
+  result->wall_time = std::chrono::duration<double>(end - start).count();
+  return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+  QuicSystemEventLoop event_loop("abrcc_cc_replay");
+  const char* usage = "Usage: abrcc_cc_replay [options] <log.events>...";
+  std::vector<std::string> logs = quic::QuicParseCommandLineFlags(usage, argc, argv);
+  if (logs.empty()) {
+    quic::QuicPrintCommandLineFlagHelp(usage);
+    exit(0);
+  }
+
+  if (GetQuicFlag(FLAGS_decode_only)) {
+    int status = 0;
+    ReplayResult result;
+    for (const auto& path : logs) {
+      std::string data;
+      if (!load_log(path, &data) || !decode(data, &result)) {
+        fprintf(stderr, "not a readable CC event log: %s\n", path.c_str());
+        status = 1;
+      }
+    }
+    fprintf(stderr, "%lld events decoded in %.3f s(%.0f events/s)\n",
+            static_cast<long long>(result.events), result.wall_time,
+            result.events / std::max(result.wall_time, 1e-9));
+    return status;
+  }
+
+  std::vector<std::string> cc_types = split(GetQuicFlag(FLAGS_cc_types));
+  if (cc_types.empty()) {
+    cc_types.push_back("");
+  }
+
+  if (GetQuicFlag(FLAGS_per_event)) {
+    printf("log,cc,time_us,recorded_pacing_kbps,pacing_kbps,recorded_cwnd,cwnd,"
+           "recorded_bandwidth_kbps,bandwidth_kbps\n");
+  } else {
+    printf("log,cc,events,congestion_events,pacing_diff_mean,pacing_diff_max,"
+           "cwnd_diff_mean,cwnd_diff_max,bandwidth_diff_mean,bandwidth_diff_max,"
+           "events_per_s\n");
+  }
+
+  int status = 0;
+  int64_t total_events = 0;
+  double total_time = 0;
+  for (const auto& path : logs) {
+    std::string data;
+    if (!load_log(path, &data)) {
+      fprintf(stderr, "can not read log: %s\n", path.c_str());
+      status = 1;
+      continue;
+    }
+    for (const auto& cc_type : cc_types) {
+      ReplayResult result;
+      if (!replay(path, data, cc_type, &result)) {
+        fprintf(stderr, "not a CC event log: %s\n", path.c_str());
+        status = 1;
+        break;
+      }
+      total_events += result.events;
+      total_time += result.wall_time;
+      if (GetQuicFlag(FLAGS_per_event)) {
+        continue;
+      }
+
+      double events = std::max(result.congestion_events, int64_t(1));
+      printf("%s,%s,%lld,%lld,%.3f,%.3f,%.3f,%.3f,%.3f,%.3f,%.0f\n",
+             path.c_str(), cc_type.empty() ? "recorded" : cc_type.c_str(),
+             static_cast<long long>(result.events),
+             static_cast<long long>(result.congestion_events),
+             result.pacing_rate.sum / events, result.pacing_rate.max,
+             result.cwnd.sum / events, result.cwnd.max,
+             result.bandwidth.sum / events, result.bandwidth.max,
+             result.events / std::max(result.wall_time, 1e-9));
+      fflush(stdout);
+    }
+  }
+  fprintf(stderr, "%lld events replayed in %.2f s(%.0f events/s)\n",
+          static_cast<long long>(total_events), total_time,
+          total_events / std::max(total_time, 1e-9));
+  return status;
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,423 @@
+#include "net/abrcc/replay/event_log.h"
+#include "net/abrcc/cc/singleton.h"
+
+#include "net/abrcc/logging/log.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+namespace quic {
+
+namespace {
+  // varints are 7 bits per byte, least significant group first
+  const int max_varint_bytes = 10;
+
+  // the ack timestamp is mostly absent, which is encoded as 0
+  const uint64_t no_timestamp = 0;
+
+  uint64_t zigzag(int64_t value) {
+    return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+  }
+
+  int64_t unzigzag(uint64_t value) {
+    return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+  }
+}
+
+CCEvent::CCEvent()
+  : kind(CONNECTION_MIGRATION)
+  , time(QuicTime::Zero())
+  , bytes(0)
+  , bytes_in_flight(0)
+  , retransmittable(false)
+  , rtt_updated(false)
+  , pacing_rate(QuicBandwidth::Zero())
+  , cwnd(0)
+  , bandwidth(QuicBandwidth::Zero())
+  , rtt(QuicTime::Delta::Zero())
+  , ack_delay(QuicTime::Delta::Zero())
+  , packets_retransmitted(false)
+  , allow_cwnd_to_decrease(false) {}
+
+CCEventWriter::CCEventWriter(const std::string& path, const CCEventLogHeader& header)
+  : path(path)
+  , file(fopen(path.c_str(), "wb"))
+  , last_time(0)
+  , last_packet(0)
+  , initial_rtt(header.initial_rtt) {
+  if (file == nullptr) {
+    ABRCC_LOG(WARNING) << "[CCCapture] can not create " << path;
+    return;
+  }
+  buffer.reserve(CCEventLogConstants::buffer_size + 64);
+  PutVarint(CCEventLogConstants::magic);
+  PutVarint(CCEventLogConstants::version);
+  PutVarint(header.cc_type);
+  PutVarint(header.initial_rtt.ToMicroseconds());
+}
+
+CCEventWriter::~CCEventWriter() {
+  if (file != nullptr) {
+    Flush();
+    fclose(file);
+  }
+}
+
+void CCEventWriter::OnPacketSent(
+  QuicTime sent_time,
+  QuicByteCount bytes_in_flight,
+  QuicPacketNumber packet_number,
+  QuicByteCount bytes,
+  bool retransmittable
+) {
+  Begin(CCEvent::PACKET_SENT, sent_time);
+  PutPacketNumber(packet_number);
+  PutVarint(bytes);
+  PutVarint(bytes_in_flight);
+  buffer.push_back(retransmittable);
+  MaybeFlush();
+}
+
+void CCEventWriter::OnCongestionEvent(
+  bool rtt_updated,
+  QuicByteCount prior_in_flight,
+  QuicTime event_time,
+  const AckedPacketVector& acked_packets,
+  const LostPacketVector& lost_packets,
+  QuicBandwidth pacing_rate,
+  QuicByteCount cwnd,
+  QuicBandwidth bandwidth
+) {
+  Begin(CCEvent::CONGESTION_EVENT, event_time);
+  buffer.push_back(rtt_updated);
+  PutVarint(prior_in_flight);
+
+  PutVarint(acked_packets.size());
+  for (const auto& packet : acked_packets) {
+    PutPacketNumber(packet.packet_number);
+    PutVarint(packet.bytes_acked);
+    if (packet.receive_timestamp == QuicTime::Zero()) {
+      PutVarint(no_timestamp);
+    } else {
+      PutVarint(zigzag((packet.receive_timestamp - event_time).ToMicroseconds()) + 1);
+    }
+  }
+  PutVarint(lost_packets.size());
+  for (const auto& packet : lost_packets) {
+    PutPacketNumber(packet.packet_number);
+    PutVarint(packet.bytes_lost);
+  }
+
+  PutVarint(pacing_rate.ToBitsPerSecond());
+  PutVarint(cwnd);
+  PutVarint(bandwidth.ToBitsPerSecond());
+  MaybeFlush();
+}
+
+void CCEventWriter::OnApplicationLimited(QuicByteCount bytes_in_flight) {
+  Begin(CCEvent::APPLICATION_LIMITED);
+  PutVarint(bytes_in_flight);
+  MaybeFlush();
+}
+
+void CCEventWriter::OnRttUpdated(
+  QuicTime::Delta send_delta,
+  QuicTime::Delta ack_delay,
+  QuicTime now
+) {
+  Begin(CCEvent::RTT_UPDATE, now);
+  PutSigned(send_delta.ToMicroseconds());
+  PutSigned(ack_delay.ToMicroseconds());
+  MaybeFlush();
+}
+
+void CCEventWriter::OnRetransmissionTimeout(bool packets_retransmitted) {
+  Begin(CCEvent::RETRANSMISSION_TIMEOUT);
+  buffer.push_back(packets_retransmitted);
+  MaybeFlush();
+}
+
+void CCEventWriter::OnConnectionMigration() {
+  Begin(CCEvent::CONNECTION_MIGRATION);
+  MaybeFlush();
+}
+
+void CCEventWriter::SetInitialRtt(QuicTime::Delta rtt) {
+  // the initial RTT is only recorded when changed, as it is polled by the wrapper
+  if (rtt == initial_rtt) {
+    return;
+  }
+  initial_rtt = rtt;
+  Begin(CCEvent::INITIAL_RTT);
+  PutVarint(rtt.ToMicroseconds());
+  MaybeFlush();
+}
+
+void CCEventWriter::SetInitialCongestionWindow(QuicPacketCount packets) {
+  Begin(CCEvent::INITIAL_WINDOW);
+  PutVarint(packets);
+  MaybeFlush();
+}
+
+void CCEventWriter::AdjustNetworkParameters(
+  QuicBandwidth bandwidth,
+  QuicTime::Delta rtt,
+  bool allow_cwnd_to_decrease
+) {
+  Begin(CCEvent::NETWORK_PARAMS);
+  PutVarint(bandwidth.ToBitsPerSecond());
+  PutSigned(rtt.ToMicroseconds());
+  buffer.push_back(allow_cwnd_to_decrease);
+  MaybeFlush();
+}
+
+void CCEventWriter::Begin(CCEvent::Kind kind, QuicTime time) {
+  int64_t now = (time - QuicTime::Zero()).ToMicroseconds();
+  buffer.push_back(kind);
+  PutSigned(now - last_time);
+  last_time = now;
+}
+
+void CCEventWriter::Begin(CCEvent::Kind kind) {
+  buffer.push_back(kind);
+  PutSigned(0);
+}
+
+void CCEventWriter::PutVarint(uint64_t value) {
+  while (value >= 0x80) {
+    buffer.push_back(static_cast<char>(value | 0x80));
+    value >>= 7;
+  }
+  buffer.push_back(static_cast<char>(value));
+}
+
+void CCEventWriter::PutSigned(int64_t value) {
+  PutVarint(zigzag(value));
+}
+
+void CCEventWriter::PutPacketNumber(QuicPacketNumber packet_number) {
+  uint64_t value = packet_number.IsInitialized() ? packet_number.ToUint64() : 0;
+  PutSigned(static_cast<int64_t>(value - last_packet));
+  last_packet = value;
+}
+
+void CCEventWriter::MaybeFlush() {
+  if (buffer.size() >= CCEventLogConstants::buffer_size) {
+    Flush();
+  }
+}
+
+void CCEventWriter::Discard() {
+  if (file == nullptr) {
+    return;
+  }
+  fclose(file);
+  file = nullptr;
+  buffer.clear();
+  if (remove(path.c_str()) != 0) {
+    ABRCC_LOG(WARNING) << "[CCCapture] can not remove " << path;
+  }
+}
+
+void CCEventWriter::Flush() {
+  if (file != nullptr && !buffer.empty()) {
+    fwrite(buffer.data(), 1, buffer.size(), file);
+  }
+  buffer.clear();
+}
+
+CCEventReader::CCEventReader(const char* data, size_t size)
+  : position(reinterpret_cast<const uint8_t*>(data))
+  , end(reinterpret_cast<const uint8_t*>(data) + size)
+  , last_time(0)
+  , last_packet(0) {}
+
+bool CCEventReader::ReadHeader(CCEventLogHeader* header) {
+  uint64_t magic, version, cc_type, initial_rtt;
+  if (!GetVarint(&magic) || magic != CCEventLogConstants::magic) {
+    return false;
+  }
+  if (!GetVarint(&version) || version != CCEventLogConstants::version) {
+    return false;
+  }
+  if (!GetVarint(&cc_type) || !GetVarint(&initial_rtt)) {
+    return false;
+  }
+  header->cc_type = static_cast<CongestionControlType>(cc_type);
+  header->initial_rtt = QuicTime::Delta::FromMicroseconds(initial_rtt);
+  return true;
+}
+
+bool CCEventReader::Next(CCEvent* event) {
+  if (position == end) {
+    return false;
+  }
+  event->kind = static_cast<CCEvent::Kind>(*position++);
+
+  int64_t delta;
+  if (!GetSigned(&delta)) {
+    return false;
+  }
+  last_time += delta;
+  event->time = QuicTime::Zero() + QuicTime::Delta::FromMicroseconds(last_time);
+
+  uint64_t value, count;
+  int64_t signed_value;
+  switch (event->kind) {
+    case CCEvent::PACKET_SENT:
+      if (!GetPacketNumber(&event->packet_number) || !GetVarint(&event->bytes)
+          || !GetVarint(&event->bytes_in_flight) || position == end) {
+        return false;
+      }
+      event->retransmittable = *position++ != 0;
+      return true;
+    case CCEvent::CONGESTION_EVENT:
+      if (position == end) {
+        return false;
+      }
+      event->rtt_updated = *position++ != 0;
+      if (!GetVarint(&event->bytes_in_flight) || !GetVarint(&count)) {
+        return false;
+      }
+      event->acked.clear();
+      for (uint64_t i = 0; i < count; ++i) {
+        QuicPacketNumber packet_number;
+        uint64_t bytes, timestamp;
+        if (!GetPacketNumber(&packet_number) || !GetVarint(&bytes) || !GetVarint(&timestamp)) {
+          return false;
+        }
+        QuicTime receive_timestamp = timestamp == no_timestamp
+          ? QuicTime::Zero()
+          : event->time + QuicTime::Delta::FromMicroseconds(unzigzag(timestamp - 1));
+        event->acked.emplace_back(
+          packet_number, static_cast<QuicPacketLength>(bytes), receive_timestamp);
+      }
+      if (!GetVarint(&count)) {
+        return false;
+      }
+      event->lost.clear();
+      for (uint64_t i = 0; i < count; ++i) {
+        QuicPacketNumber packet_number;
+        uint64_t bytes;
+        if (!GetPacketNumber(&packet_number) || !GetVarint(&bytes)) {
+          return false;
+        }
+        event->lost.emplace_back(packet_number, static_cast<QuicPacketLength>(bytes));
+      }
+      if (!GetVarint(&value)) {
+        return false;
+      }
+      event->pacing_rate = QuicBandwidth::FromBitsPerSecond(value);
+      if (!GetVarint(&event->cwnd) || !GetVarint(&value)) {
+        return false;
+      }
+      event->bandwidth = QuicBandwidth::FromBitsPerSecond(value);
+      return true;
+    case CCEvent::APPLICATION_LIMITED:
+      return GetVarint(&event->bytes_in_flight);
+    case CCEvent::RTT_UPDATE:
+      if (!GetSigned(&signed_value)) {
+        return false;
+      }
+      event->rtt = QuicTime::Delta::FromMicroseconds(signed_value);
+      if (!GetSigned(&signed_value)) {
+        return false;
+      }
+      event->ack_delay = QuicTime::Delta::FromMicroseconds(signed_value);
+      return true;
+    case CCEvent::RETRANSMISSION_TIMEOUT:
+      if (position == end) {
+        return false;
+      }
+      event->packets_retransmitted = *position++ != 0;
+      return true;
+    case CCEvent::CONNECTION_MIGRATION:
+      return true;
+    case CCEvent::INITIAL_RTT:
+      if (!GetVarint(&value)) {
+        return false;
+      }
+      event->rtt = QuicTime::Delta::FromMicroseconds(value);
+      return true;
+    case CCEvent::INITIAL_WINDOW:
+      return GetVarint(&event->cwnd);
+    case CCEvent::NETWORK_PARAMS:
+      if (!GetVarint(&value) || !GetSigned(&signed_value) || position == end) {
+        return false;
+      }
+      event->bandwidth = QuicBandwidth::FromBitsPerSecond(value);
+      event->rtt = QuicTime::Delta::FromMicroseconds(signed_value);
+      event->allow_cwnd_to_decrease = *position++ != 0;
+      return true;
+  }
+  ABRCC_LOG(WARNING) << "[CCEventReader] unknown event kind " << int(event->kind);
+  return false;
+}
+
+bool CCEventReader::GetVarint(uint64_t* value) {
+  uint64_t result = 0;
+  for (int shift = 0, i = 0; i < max_varint_bytes && position != end; ++i, shift += 7) {
+    uint8_t byte = *position++;
+    result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0) {
+      *value = result;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool CCEventReader::GetSigned(int64_t* value) {
+  uint64_t encoded;
+  if (!GetVarint(&encoded)) {
+    return false;
+  }
+  *value = unzigzag(encoded);
+  return true;
+}
+
+bool CCEventReader::GetPacketNumber(QuicPacketNumber* packet_number) {
+  int64_t delta;
+  if (!GetSigned(&delta)) {
+    return false;
+  }
+  last_packet += delta;
+  *packet_number = last_packet == 0 ? QuicPacketNumber() : QuicPacketNumber(last_packet);
+  return true;
+}
+
+CCCapture* CCCapture::GetInstance() {
+  return GET_SINGLETON(CCCapture);
+}
+
+CCCapture::CCCapture() : enabled_(false), next_log_(0) {}
+CCCapture::~CCCapture() {}
+
+void CCCapture::Start(const std::string& directory) {
+  if (enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  this->directory = directory;
+  enabled_.store(true, std::memory_order_release);
+}
+
+bool CCCapture::enabled() const {
+  return enabled_.load(std::memory_order_acquire);
+}
+
+std::unique_ptr<CCEventWriter> CCCapture::Open(
+  CongestionControlType cc_type,
+  const RttStats* rtt_stats
+) {
+  if (!enabled()) {
+    return nullptr;
+  }
+  int log = next_log_.fetch_add(1, std::memory_order_relaxed);
+  std::string path = directory + "/cc." + std::to_string(log) + ".events";
+  return std::unique_ptr<CCEventWriter>(new CCEventWriter(
+    path, CCEventLogHeader{cc_type, rtt_stats->initial_rtt()}));
+}
+
+}
+
+#pragma GCC diagnostic pop
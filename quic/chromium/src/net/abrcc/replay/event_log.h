@@ -0,0 +1,182 @@
+#ifndef ABRCC_REPLAY_EVENT_LOG_H_
+#define ABRCC_REPLAY_EVENT_LOG_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+
+#include "net/third_party/quiche/src/quic/core/congestion_control/rtt_stats.h"
+#include "net/third_party/quiche/src/quic/core/quic_bandwidth.h"
+#include "net/third_party/quiche/src/quic/core/quic_packet_number.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+#include "net/third_party/quiche/src/quic/core/quic_types.h"
+
+namespace quic {
+
+namespace CCEventLogConstants {
+  // every log starts with the magic, followed by the version of the format
+  const uint32_t magic = 0x4c434341; // "ACCL"
+  const uint32_t version = 1;
+
+  // bytes buffered by a writer between two writes to its file
+  const size_t buffer_size = 1 << 16;
+}
+
+// One input of a SendAlgorithmInterface, as read from a CC event log. Only the
+// fields of the event's kind are set:
+//   - PACKET_SENT: packet_number, bytes, bytes_in_flight, retransmittable
+//   - CONGESTION_EVENT: rtt_updated, bytes_in_flight(prior to the event), acked,
+//     lost and the recorded sender's pacing_rate, cwnd and bandwidth after the event
+//   - APPLICATION_LIMITED: bytes_in_flight
+//   - RTT_UPDATE: rtt(the send delta) and ack_delay, as taken by the RttStats
+//   - RETRANSMISSION_TIMEOUT: packets_retransmitted
+//   - INITIAL_RTT: rtt
+//   - INITIAL_WINDOW: cwnd(packets)
+//   - NETWORK_PARAMS: bandwidth, rtt, allow_cwnd_to_decrease
+struct CCEvent {
+  enum Kind : uint8_t {
+    PACKET_SENT = 1, CONGESTION_EVENT = 2, APPLICATION_LIMITED = 3, RTT_UPDATE = 4,
+    RETRANSMISSION_TIMEOUT = 5, CONNECTION_MIGRATION = 6, INITIAL_RTT = 7,
+    INITIAL_WINDOW = 8, NETWORK_PARAMS = 9,
+  };
+
+  CCEvent();
+
+  Kind kind;
+  // time of the event; events without one take the time of the previous event
+  QuicTime time;
+
+  QuicPacketNumber packet_number;
+  QuicByteCount bytes;
+  QuicByteCount bytes_in_flight;
+  bool retransmittable;
+
+  bool rtt_updated;
+  AckedPacketVector acked;
+  LostPacketVector lost;
+
+  QuicBandwidth pacing_rate;
+  QuicByteCount cwnd;
+  QuicBandwidth bandwidth;
+
+  QuicTime::Delta rtt;
+  QuicTime::Delta ack_delay;
+  bool packets_retransmitted;
+  bool allow_cwnd_to_decrease;
+};
+
+struct CCEventLogHeader {
+  CongestionControlType cc_type;
+  QuicTime::Delta initial_rtt;
+};
+
+// Writer of the inputs of one connection's sender into a compact binary log.
+//
+// Events are written as a kind byte followed by varints; times, packet numbers and
+// ack timestamps are delta-encoded against the previous event, such that a typical
+// event takes a few bytes. The events are buffered and written on the network
+// thread once buffer_size bytes are pending, so that capturing costs one write per
+// tens of thousands of events.
+class CCEventWriter {
+ public:
+  // The writer is a no-op if `path` cannot be created.
+  CCEventWriter(const std::string& path, const CCEventLogHeader& header);
+  ~CCEventWriter();
+
+  void OnPacketSent(QuicTime sent_time,
+                    QuicByteCount bytes_in_flight,
+                    QuicPacketNumber packet_number,
+                    QuicByteCount bytes,
+                    bool retransmittable);
+  void OnCongestionEvent(bool rtt_updated,
+                         QuicByteCount prior_in_flight,
+                         QuicTime event_time,
+                         const AckedPacketVector& acked_packets,
+                         const LostPacketVector& lost_packets,
+                         QuicBandwidth pacing_rate,
+                         QuicByteCount cwnd,
+                         QuicBandwidth bandwidth);
+  void OnApplicationLimited(QuicByteCount bytes_in_flight);
+  void OnRttUpdated(QuicTime::Delta send_delta, QuicTime::Delta ack_delay, QuicTime now);
+  void OnRetransmissionTimeout(bool packets_retransmitted);
+  void OnConnectionMigration();
+  void SetInitialRtt(QuicTime::Delta rtt);
+  void SetInitialCongestionWindow(QuicPacketCount packets);
+  void AdjustNetworkParameters(QuicBandwidth bandwidth, QuicTime::Delta rtt,
+                               bool allow_cwnd_to_decrease);
+
+  // Closes and removes the log, such that a sender replaced before it controlled
+  // its connection leaves no log behind; the writer is a no-op afterwards.
+  void Discard();
+ private:
+  void Begin(CCEvent::Kind kind, QuicTime time);
+  // begins an event without a time of its own
+  void Begin(CCEvent::Kind kind);
+  void PutVarint(uint64_t value);
+  void PutSigned(int64_t value);
+  void PutPacketNumber(QuicPacketNumber packet_number);
+  void MaybeFlush();
+  void Flush();
+
+  std::string path;
+  FILE* file;
+  std::string buffer;
+  int64_t last_time;
+  uint64_t last_packet;
+  // last recorded initial RTT
+  QuicTime::Delta initial_rtt;
+};
+
+// Reader of a CC event log held in memory.
+class CCEventReader {
+ public:
+  // `data` must outlive the reader.
+  CCEventReader(const char* data, size_t size);
+
+  // Returns false if the log does not start with a header of this version.
+  bool ReadHeader(CCEventLogHeader* header);
+  // Reads the next event into `event`, reusing its vectors; returns false at the
+  // end of the log, including on an event truncated by a killed writer.
+  bool Next(CCEvent* event);
+ private:
+  bool GetVarint(uint64_t* value);
+  bool GetSigned(int64_t* value);
+  bool GetPacketNumber(QuicPacketNumber* packet_number);
+
+  const uint8_t* position;
+  const uint8_t* end;
+  int64_t last_time;
+  uint64_t last_packet;
+};
+
+// Per-process switch of the capture: once started, every CCWrapper records its
+// sender's inputs into `<directory>/cc.<log>.events`.
+class CCCapture {
+ public:
+  virtual ~CCCapture();
+  static CCCapture* GetInstance();
+
+  void Start(const std::string& directory);
+  bool enabled() const;
+
+  // Opens the log of a new sender; nullptr if the capture is disabled.
+  std::unique_ptr<CCEventWriter> Open(CongestionControlType cc_type,
+                                      const RttStats* rtt_stats);
+ private:
+  CCCapture();
+
+  std::atomic<bool> enabled_;
+  std::atomic<int> next_log_;
+  std::string directory;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -0,0 +1,273 @@
+#include "net/abrcc/segment_predictor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <initializer_list>
+#include <limits>
+
+namespace quic {
+
+std::shared_ptr<SegmentPredictor> SegmentPredictor::ForConfig(DashBackendConfig* config) {
+  std::shared_ptr<const VideoCatalog> catalog = VideoCatalog::ForConfig(config);
+  QuicWriterMutexLock lock(&config->lazy_mutex);
+  if (config->predictor == nullptr && catalog->qualities() > 0
+      && config->segments > catalog->segments()) {
+    config->predictor = std::make_shared<SegmentPredictor>(catalog, config->segments);
+  }
+  return config->predictor;
+}
+
+SegmentPredictor::SegmentPredictor(std::shared_ptr<const VideoCatalog> known, int segments)
+  : known(known)
+  , segments(segments)
+  , sizes(known->qualities(), std::vector<int>(segments, 0))
+  , vmafs(known->qualities(),
+          std::vector<double>(segments, std::numeric_limits<double>::quiet_NaN()))
+  , mean_size(known->qualities(), 0)
+  , mean_vmaf(known->qualities(), std::numeric_limits<double>::quiet_NaN())
+  , error(known->qualities(), SegmentPredictorConstants::default_error)
+  , last_index(-1)
+  , last_complexity(0)
+  , last_count(0)
+  , ar_xy(0)
+  , ar_xx(0)
+  , unsized(known->qualities())
+  , vmaf_changed(known->qualities(), false)
+  , version(0)
+  , snapshot_version(-1) {
+  // seeded in playback order, as the autoregression follows consecutive segments
+  for (int index = 0; index < known->segments(); ++index) {
+    for (int quality = 0; quality < known->qualities(); ++quality) {
+      observe(quality, index, known->size(quality, index), known->vmaf(quality, index));
+    }
+  }
+  for (int quality = 0; quality < known->qualities(); ++quality) {
+    for (int index = 0; index < segments; ++index) {
+      if (sizes[quality][index] == 0) {
+        unsized[quality].push_back(index);
+      }
+    }
+  }
+}
+SegmentPredictor::~SegmentPredictor() {}
+
+void SegmentPredictor::Observe(
+  int quality,
+  int index,
+  int size,
+  base::Optional<double> vmaf
+) {
+  QuicWriterMutexLock lock(&mutex_);
+  observe(quality, index, size, vmaf);
+}
+
+SegmentPredictor::Estimate SegmentPredictor::Predict(int quality, int index) const {
+  QuicReaderMutexLock lock(&mutex_);
+  return predict(quality, index);
+}
+
+int SegmentPredictor::Size(int quality, int index) const {
+  QuicReaderMutexLock lock(&mutex_);
+  if (quality < 0 || quality >= known->qualities() || index < 0 || index >= segments) {
+    return 0;
+  }
+  if (sizes[quality][index] > 0) {
+    return sizes[quality][index];
+  }
+  return int(predict(quality, index).size);
+}
+
+void SegmentPredictor::observe(
+  int quality,
+  int index,
+  int size,
+  base::Optional<double> vmaf
+) {
+  if (quality < 0 || quality >= known->qualities() || index < 0 || index >= segments
+      || size <= 0 || sizes[quality][index] != 0) {
+    return;
+  }
+
+  // check the prediction before learning from the segment
+  double predicted = predict(quality, index).size;
+  if (predicted > 0) {
+    double relative_error = std::abs(size - predicted) / predicted;
+    error[quality] = SegmentPredictorConstants::error_weight * relative_error
+                   + (1 - SegmentPredictorConstants::error_weight) * error[quality];
+  }
+
+  double mean = meanSize(quality);
+  if (mean > 0) {
+    double complexity = std::log(size / mean);
+    if (index == last_index) {
+      last_complexity = (last_complexity * last_count + complexity) / (last_count + 1);
+      last_count += 1;
+    } else if (index > last_index) {
+      if (index == last_index + 1) {
+        double weight = SegmentPredictorConstants::ar_weight;
+        ar_xy = weight * last_complexity * complexity + (1 - weight) * ar_xy;
+        ar_xx = weight * last_complexity * last_complexity + (1 - weight) * ar_xx;
+      }
+      last_index = index;
+      last_complexity = complexity;
+      last_count = 1;
+    }
+  }
+
+  sizes[quality][index] = size;
+  auto unknown = std::lower_bound(unsized[quality].begin(), unsized[quality].end(), index);
+  if (unknown != unsized[quality].end() && *unknown == index) {
+    unsized[quality].erase(unknown);
+  }
+  observed_since.emplace_back(quality, index);
+  if (mean_size[quality] == 0) {
+    mean_size[quality] = size;
+  } else {
+    mean_size[quality] = SegmentPredictorConstants::mean_weight * size
+                       + (1 - SegmentPredictorConstants::mean_weight) * mean_size[quality];
+  }
+
+  if (vmaf) {
+    vmafs[quality][index] = *vmaf;
+    if (std::isnan(mean_vmaf[quality])) {
+      mean_vmaf[quality] = *vmaf;
+    } else {
+      mean_vmaf[quality] = SegmentPredictorConstants::mean_weight * *vmaf
+                         + (1 - SegmentPredictorConstants::mean_weight) * mean_vmaf[quality];
+    }
+    vmaf_changed[quality] = true;
+  }
+  version += 1;
+}
+
+double SegmentPredictor::meanSize(int quality) const {
+  if (mean_size[quality] > 0) {
+    return mean_size[quality];
+  }
+
+  // scale the nearest quality seen along the ladder
+  for (int distance = 1; distance < known->qualities(); ++distance) {
+    for (int other : {quality - distance, quality + distance}) {
+      if (other >= 0 && other < known->qualities() && mean_size[other] > 0
+          && known->trackBitrate(other) > 0) {
+        return mean_size[other] * known->trackBitrate(quality) / known->trackBitrate(other);
+      }
+    }
+  }
+
+  // kbps * ms / 8 = bytes
+  return known->trackBitrate(quality) * durationMs(quality, 0) / 8.;
+}
+
+int SegmentPredictor::durationMs(int quality, int index) const {
+  if (known->segments() < 2) {
+    return SegmentPredictorConstants::default_duration_ms;
+  }
+  return known->durationMs(quality, index);
+}
+
+SegmentPredictor::Estimate SegmentPredictor::predict(int quality, int index) const {
+  Estimate estimate;
+
+  double complexity = 0;
+  if (last_index >= 0 && index > last_index) {
+    double phi = SegmentPredictorConstants::default_phi;
+    if (ar_xx > 0) {
+      phi = std::max(0., std::min(ar_xy / ar_xx, SegmentPredictorConstants::max_phi));
+    }
+    complexity = last_complexity * std::pow(phi, index - last_index);
+  }
+  estimate.size = meanSize(quality) * std::exp(complexity);
+
+  double width = SegmentPredictorConstants::bound_width * error[quality];
+  estimate.lower = estimate.size * std::max(0., 1 - width);
+  estimate.upper = estimate.size * (1 + width);
+
+  estimate.vmaf = std::isnan(mean_vmaf[quality]) ? 0 : mean_vmaf[quality];
+  return estimate;
+}
+
+std::shared_ptr<VideoCatalog> SegmentPredictor::buildSnapshot() const {
+  std::shared_ptr<VideoCatalog> catalog(new VideoCatalog(known->qualities(), segments));
+  catalog->bitrates_ = known->bitrates();
+  catalog->track_bitrates_ = known->track_bitrates_;
+  for (int quality = 0; quality < known->qualities(); ++quality) {
+    double start_time = 0;
+    for (int index = 0; index < segments; ++index) {
+      int size = sizes[quality][index];
+      double vmaf = vmafs[quality][index];
+      if (size == 0 || std::isnan(vmaf)) {
+        Estimate estimate = predict(quality, index);
+        if (size == 0) {
+          size = int(estimate.upper);
+        }
+        if (std::isnan(vmaf)) {
+          vmaf = estimate.vmaf;
+        }
+      }
+      if (index < known->segments()) {
+        start_time = known->startTime(quality, index);
+      }
+
+      int at = catalog->at(quality, index);
+      catalog->size_.get()[at] = size;
+      catalog->kbits_.get()[at] = 8. * size / 1000.;
+      catalog->vmaf_.get()[at] = vmaf;
+      catalog->start_time_.get()[at] = start_time;
+      catalog->duration_ms_.get()[at] = durationMs(quality, index);
+
+      start_time += durationMs(quality, index) / 1000.;
+    }
+  }
+  return catalog;
+}
+
+std::shared_ptr<const VideoCatalog> SegmentPredictor::Snapshot() {
+  QuicWriterMutexLock lock(&mutex_);
+  if (snapshot != nullptr && snapshot_version == version) {
+    return snapshot;
+  }
+
+  std::shared_ptr<VideoCatalog> catalog;
+  if (snapshot == nullptr) {
+    catalog = buildSnapshot();
+  } else {
+    // the start times, the durations and the observed segments do not move
+    catalog = snapshot->Clone();
+    for (auto &segment : observed_since) {
+      int quality = segment.first;
+      int index = segment.second;
+      int at = catalog->at(quality, index);
+      catalog->size_.get()[at] = sizes[quality][index];
+      catalog->kbits_.get()[at] = 8. * sizes[quality][index] / 1000.;
+      if (!std::isnan(vmafs[quality][index])) {
+        catalog->vmaf_.get()[at] = vmafs[quality][index];
+      }
+    }
+    for (int quality = 0; quality < known->qualities(); ++quality) {
+      if (vmaf_changed[quality]) {
+        double vmaf = predict(quality, 0).vmaf;
+        for (int index = 0; index < segments; ++index) {
+          if (std::isnan(vmafs[quality][index])) {
+            catalog->vmaf_.get()[catalog->at(quality, index)] = vmaf;
+          }
+        }
+      }
+      // every observation moves the model, hence all the predicted sizes
+      for (int index : unsized[quality]) {
+        int size = int(predict(quality, index).upper);
+        int at = catalog->at(quality, index);
+        catalog->size_.get()[at] = size;
+        catalog->kbits_.get()[at] = 8. * size / 1000.;
+      }
+    }
+  }
+  observed_since.clear();
+  std::fill(vmaf_changed.begin(), vmaf_changed.end(), false);
+
+  snapshot = catalog;
+  snapshot_version = version;
+  return snapshot;
+}
+
+}
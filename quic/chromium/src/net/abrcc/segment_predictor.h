@@ -0,0 +1,128 @@
+#ifndef ABRCC_SEGMENT_PREDICTOR_H_
+#define ABRCC_SEGMENT_PREDICTOR_H_
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "base/optional.h"
+#include "net/abrcc/dash_config.h"
+#include "net/abrcc/video_catalog.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
+
+namespace quic {
+
+namespace SegmentPredictorConstants {
+  // weight of a new segment in the per-quality means
+  const double mean_weight = 0.1;
+  // weight of a new segment in the per-quality relative errors
+  const double error_weight = 0.2;
+  // weight of a new pair of consecutive complexities in the autoregression
+  const double ar_weight = 0.1;
+
+  // autoregression coefficient until enough pairs are seen, and its cap
+  const double default_phi = 0.5;
+  const double max_phi = 0.95;
+  // relative error assumed before any prediction was checked
+  const double default_error = 0.25;
+  // half-width of the confidence bounds, in relative errors
+  const double bound_width = 1.5;
+
+  // segment length(ms) if the configuration has too few segments to tell
+  const int default_duration_ms = 4000;
+}
+
+// Online predictor of the sizes and VMAF of segments not described by the
+// configuration, i.e. the future segments of a live stream or of a title whose
+// metadata is only partially known.
+//
+// A predicted size is the product of:
+//   - the mean size of the quality: an EWMA over the quality's segments, or, for a
+//     quality with no segments yet, the mean of the nearest quality scaled by the
+//     ratio of their track bitrates
+//   - the scene complexity: the log-ratio of the latest segment's size to the mean
+//     of its quality, carried over to the next segments through an AR(1) whose
+//     coefficient is fitted on consecutive segments
+// The confidence bounds are the prediction +/- bound_width times an EWMA of the
+// relative error of past predictions of the quality. VMAF is predicted by the mean
+// of the quality.
+//
+// The predictor is seeded with the configuration's segments and learns from the
+// segments ingested by the store. Observe, Size and Snapshot can be called from any
+// thread.
+class SegmentPredictor {
+ public:
+  // Returns the predictor of `config`, building it on first use, or nullptr if the
+  // configuration describes all of its `segments`; thread-safe.
+  static std::shared_ptr<SegmentPredictor> ForConfig(DashBackendConfig* config);
+
+  // Predicts `segments` segments, the first ones described by `known`.
+  SegmentPredictor(std::shared_ptr<const VideoCatalog> known, int segments);
+  SegmentPredictor(const SegmentPredictor&) = delete;
+  SegmentPredictor& operator=(const SegmentPredictor&) = delete;
+  ~SegmentPredictor();
+
+  struct Estimate {
+    double size;
+    double lower;
+    double upper;
+    double vmaf;
+  };
+
+  // Learns the `size`(bytes), and possibly the VMAF, of segment `index` of `quality`.
+  void Observe(int quality, int index, int size, base::Optional<double> vmaf = base::nullopt);
+  // Predicted size of a segment that was not observed.
+  Estimate Predict(int quality, int index) const;
+  // Observed size of a segment, or its predicted size if not observed; 0 if the
+  // segment is out of range.
+  int Size(int quality, int index) const;
+
+  // Catalog of all the segments with the observed values, and the upper bounds of
+  // the sizes otherwise, such that the DP kernels plan for the slower downloads.
+  // After new observations, the snapshot copies the previous one and only rewrites
+  // the newly observed segments and the predicted ones.
+  std::shared_ptr<const VideoCatalog> Snapshot();
+ private:
+  void observe(int quality, int index, int size, base::Optional<double> vmaf);
+  Estimate predict(int quality, int index) const;
+  // mean size of a quality, in bytes
+  double meanSize(int quality) const;
+  int durationMs(int quality, int index) const;
+  // Builds the first snapshot, holding every segment.
+  std::shared_ptr<VideoCatalog> buildSnapshot() const;
+
+  std::shared_ptr<const VideoCatalog> known;
+  int segments;
+
+  // observed values by quality and index: 0 sizes are unknown, as are NaN VMAFs
+  std::vector<std::vector<int>> sizes;
+  std::vector<std::vector<double>> vmafs;
+
+  std::vector<double> mean_size;
+  std::vector<double> mean_vmaf;
+  std::vector<double> error;
+
+  // complexity of the latest segment, averaged over its observed qualities
+  int last_index;
+  double last_complexity;
+  int last_count;
+  // decayed sums of the autoregression of consecutive complexities
+  double ar_xy;
+  double ar_xx;
+
+  // indices of the segments of unknown size by quality, in increasing order
+  std::vector<std::vector<int>> unsized;
+  // segments observed, and qualities whose mean VMAF moved, since the last snapshot
+  std::vector<std::pair<int, int>> observed_since;
+  std::vector<bool> vmaf_changed;
+
+  int version;
+  int snapshot_version;
+  std::shared_ptr<const VideoCatalog> snapshot;
+
+  mutable QuicMutex mutex_;
+};
+
+}
+
+#endif
@@ -0,0 +1,54 @@
+#include "net/abrcc/service/control_service.h"
+
+#include "base/json/json_reader.h"
+
+#include "net/abrcc/logging/log.h"
+
+namespace quic {
+
+ControlService::ControlService(std::shared_ptr<MetricsService> metrics)
+  : metrics(metrics) {}
+ControlService::~ControlService() {}
+
+void ControlService::AddChannel(ControlChannel* channel) {
+  channels.insert(channel);
+  ABRCC_LOG(INFO) << "[Control] " << channels.size() << " open channels";
+}
+
+void ControlService::RemoveChannel(ControlChannel* channel) {
+  channels.erase(channel);
+  ABRCC_LOG(INFO) << "[Control] " << channels.size() << " open channels";
+}
+
+bool ControlService::OnMessage(const std::string& message) {
+  base::Optional<base::Value> value = base::JSONReader::Read(message);
+  if (!value || !value->is_dict()) {
+    return false;
+  }
+
+  base::Optional<int> abort_index = value->FindIntKey("abort");
+  if (abort_index) {
+    ABRCC_LOG(WARNING) << "Aborting: " << *abort_index;
+    metrics->AddAbort(*abort_index);
+    return true;
+  }
+  if (value->FindKey("stats") != nullptr) {
+    metrics->AddMetrics(*value);
+    return true;
+  }
+  return false;
+}
+
+void ControlService::OnMetrics(const base::Value& value) {
+  metrics->AddMetrics(value);
+}
+
+bool ControlService::SendDecision(const std::string& decision) {
+  bool sent = false;
+  for (auto channel : channels) {
+    sent = channel->Send(decision) || sent;
+  }
+  return sent;
+}
+
+}
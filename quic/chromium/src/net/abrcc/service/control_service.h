@@ -0,0 +1,64 @@
+#ifndef ABRCC_SERVICE_CONTROL_H_
+#define ABRCC_SERVICE_CONTROL_H_
+
+#include <memory>
+#include <set>
+#include <string>
+
+#include "base/values.h"
+
+#include "net/abrcc/service/metrics_service.h"
+
+namespace quic {
+
+namespace ControlConstants {
+  // the messages of a control stream are separated by newlines
+  const char delimiter = '\n';
+  // bytes of an unterminated message after which a control stream is reset
+  const size_t max_message_size = 64 * 1024;
+}
+
+// Player end of a control channel, over which the ABR's decisions are sent.
+class ControlChannel {
+ public:
+  virtual ~ControlChannel() {}
+
+  // Queues `message` to the player; returns false if the channel can not send.
+  virtual bool Send(const std::string& message) = 0;
+};
+
+// Control service of a player session: the persistent control channels of the
+// player, each carrying the metrics up and the decisions down, in place of a POST to
+// `/request` per metrics tick and a long poll of `/request/<index>` per decision.
+//
+// A message is a JSON object on its own line:
+//   - up: the body of a metrics POST({"stats": ...}), or an abort({"abort": <index>})
+//   - down: a decision, as answered to the long polls
+// Decisions go to the long polls as long as no channel is open, such that players
+// without a control channel keep working.
+//
+// All the methods have to be called on the network thread.
+class ControlService {
+ public:
+  explicit ControlService(std::shared_ptr<MetricsService> metrics);
+  ControlService(const ControlService&) = delete;
+  ControlService& operator=(const ControlService&) = delete;
+  ~ControlService();
+
+  void AddChannel(ControlChannel* channel);
+  void RemoveChannel(ControlChannel* channel);
+
+  // Registers a message received on a channel; returns false if it is malformed.
+  bool OnMessage(const std::string& message);
+  // Registers the metrics of a datagram({"seq": <n>, "stats": ...}).
+  void OnMetrics(const base::Value& metrics);
+  // Sends a decision over the open channels; returns false if none could send it.
+  bool SendDecision(const std::string& decision);
+ private:
+  std::shared_ptr<MetricsService> metrics;
+  std::set<ControlChannel*> channels;
+};
+
+}
+
+#endif
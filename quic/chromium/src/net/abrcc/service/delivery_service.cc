@@ -0,0 +1,164 @@
+#include "net/abrcc/service/delivery_service.h"
+
+#include <utility>
+
+#include "net/abrcc/cc/cc_wrapper.h"
+#include "net/abrcc/logging/log.h"
+
+#include "net/quic/platform/impl/quic_chromium_clock.h"
+#include "net/third_party/quiche/src/quic/core/proto/cached_network_parameters_proto.h"
+#include "net/third_party/quiche/src/quic/core/quic_ack_listener_interface.h"
+#include "net/third_party/quiche/src/quic/tools/quic_simple_server_stream.h"
+
+namespace quic {
+
+// Listener of the ACKs of a segment's body bytes. The stream holds the listener, which
+// holds the service, so events of a title being replaced are still safe to add; the
+// stream is only used from the listener's callbacks, which the stream calls.
+class DeliveryService::Listener : public QuicAckListenerInterface {
+ public:
+  Listener(std::shared_ptr<DeliveryService> service,
+           QuicSimpleServerStream* stream,
+           abr_schema::Delivery delivery)
+    : service(std::move(service))
+    , stream(stream)
+    , connection(stream->connection_id())
+    , delivery(delivery)
+    , last_event(delivery.sent) {}
+  Listener(const Listener&) = delete;
+  Listener& operator=(const Listener&) = delete;
+
+  void OnPacketAcked(int acked_bytes, QuicTime::Delta ack_delay_time) override {
+    if (acked_bytes <= 0 || delivery.state == abr_schema::Delivery::DOWNLOADED) {
+      return;
+    }
+
+    int64_t now = (service->clock->Now() - QuicTime::Zero()).ToMicroseconds();
+    if (delivery.acked == 0) {
+      delivery.first_acked = now;
+    }
+    delivery.acked += acked_bytes;
+    delivery.last_acked = now;
+
+    if (delivery.acked >= delivery.total) {
+      delivery.state = abr_schema::Delivery::DOWNLOADED;
+      ABRCC_LOG(INFO) << "[Delivery] segment " << delivery.index << " acked in "
+                      << delivery.elapsedMs() << "ms at " << delivery.throughput() << "kbps";
+      service->AddDelivery(connection, delivery);
+      stream->OnApplicationBurst(false);
+      return;
+    }
+    if (now - last_event >= DeliveryConstants::progress_interval_us) {
+      last_event = now;
+      service->AddDelivery(connection, delivery);
+    }
+  }
+
+  void OnPacketRetransmitted(int retransmitted_bytes) override {
+    delivery.retransmitted += retransmitted_bytes;
+  }
+ protected:
+  ~Listener() override {}
+ private:
+  std::shared_ptr<DeliveryService> service;
+  QuicSimpleServerStream* stream;
+  QuicConnectionId connection;
+  abr_schema::Delivery delivery;
+  // time of the latest progress event
+  int64_t last_event;
+};
+
+DeliveryService::DeliveryService() : clock(QuicChromiumClock::GetInstance()) {}
+DeliveryService::~DeliveryService() {}
+
+void DeliveryService::Track(
+  QuicSimpleServerBackend::RequestHandler* quic_stream,
+  int index,
+  int quality,
+  int64_t total
+) {
+  if (total <= 0) {
+    return;
+  }
+  int64_t now = (clock->Now() - QuicTime::Zero()).ToMicroseconds();
+
+  // the handlers of the server are the streams of its sessions
+  auto stream = static_cast<QuicSimpleServerStream*>(quic_stream);
+  stream->SetResponseAckListener(
+    QuicReferenceCountedPointer<QuicAckListenerInterface>(new Listener(
+      shared_from_this(), stream, abr_schema::Delivery(index, quality, total, now))));
+  // the segment is a burst of the connection's sender
+  stream->OnApplicationBurst(true);
+}
+
+void DeliveryService::AddDelivery(
+  QuicConnectionId connection,
+  const abr_schema::Delivery& delivery
+) {
+  QuicWriterMutexLock lock(&mutex_);
+  auto entry = pending.find(connection);
+  if (entry == pending.end()) {
+    // the player's session already ended
+    return;
+  }
+  entry->second.deliveries.push_back(delivery);
+}
+
+std::vector<abr_schema::Delivery> DeliveryService::GetDeliveries(
+  QuicConnectionId connection
+) {
+  QuicWriterMutexLock lock(&mutex_);
+  auto entry = pending.find(connection);
+  if (entry == pending.end()) {
+    return std::vector<abr_schema::Delivery>();
+  }
+
+  std::vector<abr_schema::Delivery> out = std::move(entry->second.deliveries);
+  entry->second.deliveries = std::vector<abr_schema::Delivery>();
+  return out;
+}
+
+void DeliveryService::TrackSession(QuicSimpleServerBackend::RequestHandler* quic_stream) {
+  {
+    QuicReaderMutexLock lock(&mutex_);
+    if (pending.find(quic_stream->connection_id()) != pending.end()) {
+      return;
+    }
+  }
+
+  abr_schema::Session session;
+  auto stream = static_cast<QuicSimpleServerStream*>(quic_stream);
+  const CachedNetworkParameters* params = stream->ResumedNetworkParams();
+  if (params != nullptr) {
+    // bytes per second to kbps
+    session = abr_schema::Session(
+      8 * int64_t(params->bandwidth_estimate_bytes_per_second()) / 1000,
+      params->min_rtt_ms());
+    ABRCC_LOG(WARNING) << "[Delivery] connection resumed at " << session.bandwidth
+                       << "kbps, min rtt " << session.min_rtt << "ms";
+  }
+  session.interfaces = static_cast<const CCWrapper*>(stream->SendAlgorithm())
+    ->interfaces();
+
+  QuicWriterMutexLock lock(&mutex_);
+  pending[quic_stream->connection_id()].sessions.push_back(session);
+}
+
+std::vector<abr_schema::Session> DeliveryService::GetSessions(QuicConnectionId connection) {
+  QuicWriterMutexLock lock(&mutex_);
+  auto entry = pending.find(connection);
+  if (entry == pending.end()) {
+    return std::vector<abr_schema::Session>();
+  }
+
+  std::vector<abr_schema::Session> out = std::move(entry->second.sessions);
+  entry->second.sessions = std::vector<abr_schema::Session>();
+  return out;
+}
+
+void DeliveryService::Forget(QuicConnectionId connection) {
+  QuicWriterMutexLock lock(&mutex_);
+  pending.erase(connection);
+}
+
+}
@@ -0,0 +1,82 @@
+#ifndef ABRCC_SERVICE_DELIVERY_H_
+#define ABRCC_SERVICE_DELIVERY_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "net/abrcc/abr/interface.h"
+
+#include "net/third_party/quiche/src/quic/core/quic_clock.h"
+#include "net/third_party/quiche/src/quic/core/quic_connection_id.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
+#include "net/third_party/quiche/src/quic/tools/quic_simple_server_backend.h"
+
+namespace quic {
+
+namespace DeliveryConstants {
+  // minimum time between two progress events of a segment; the ABR loop polls every 20ms
+  const int64_t progress_interval_us = 20000;
+}
+
+// Delivery measurement service. It attaches an ACK listener to the response stream
+// of each segment, such that the ABR gets the segment's delivery progress and
+// completion from the server's ACKs, a metrics tick before the front-end reports them
+// and independently of the front-end's timers.
+//
+// Each segment is signalled to the connection's sender as a burst, from handing the
+// segment to its stream to the ACK of its last byte, such that the samples taken while
+// the server waits between segments are told apart as app-limited.
+//
+// The service also registers the player's connection on its first request, with the
+// network parameters its sender was resumed from, if any, and the sender's ABR
+// interfaces.
+//
+// A title serves several players, each with the ABR loop of its own connection: the
+// events are kept by connection, from TrackSession until Forget, and the events of
+// other connections are dropped.
+//
+// The listeners run on the network thread, while the ABR loops pop the events on their
+// own threads; the events are protected by a read-write lock.
+class DeliveryService : public std::enable_shared_from_this<DeliveryService> {
+ public:
+  DeliveryService();
+  DeliveryService(const DeliveryService&) = delete;
+  DeliveryService& operator=(const DeliveryService&) = delete;
+  ~DeliveryService();
+
+  // Tracks the delivery of the `total` body bytes of the segment `index` of quality
+  // `quality`, about to be answered on `quic_stream`. It has to be called on the
+  // network thread, before the response is written.
+  void Track(QuicSimpleServerBackend::RequestHandler* quic_stream,
+             int index, int quality, int64_t total);
+  // Get all delivery events of `connection` so far, in the order of the ACKs
+  std::vector<abr_schema::Delivery> GetDeliveries(QuicConnectionId connection);
+
+  // Registers the connection of `quic_stream`, once per connection. It has to be
+  // called on the network thread.
+  void TrackSession(QuicSimpleServerBackend::RequestHandler* quic_stream);
+  // Get the registration of `connection`, if not popped yet
+  std::vector<abr_schema::Session> GetSessions(QuicConnectionId connection);
+  // Drops the events of `connection`, whose player session ended.
+  void Forget(QuicConnectionId connection);
+ private:
+  class Listener;
+
+  // events of a connection not yet popped by its ABR loop
+  struct Pending {
+    std::vector<abr_schema::Delivery> deliveries;
+    std::vector<abr_schema::Session> sessions;
+  };
+
+  void AddDelivery(QuicConnectionId connection, const abr_schema::Delivery& delivery);
+
+  const QuicClock* clock; // not owned
+
+  mutable QuicMutex mutex_;
+  std::unordered_map<QuicConnectionId, Pending, QuicConnectionIdHash> pending;
+};
+
+}
+
+#endif
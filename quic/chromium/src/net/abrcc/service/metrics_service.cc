@@ -23,11 +23,15 @@ void MetricsService::AddMetrics(
   const std::string& data, 
   QuicSimpleServerBackend::RequestHandler* quic_stream
 ) {
-  DashRequest* request(new DashRequest());
-   
   base::Optional<base::Value> value = base::JSONReader::Read(data);
+  AddMetrics(*value);
+}
+
+void MetricsService::AddMetrics(const base::Value& value) {
+  DashRequest* request(new DashRequest());
+
   base::JSONValueConverter<DashRequest> converter;
-  converter.Convert(*value, request);
+  converter.Convert(value, request);
   
   AddMetricsImpl(&request->metrics);
 }
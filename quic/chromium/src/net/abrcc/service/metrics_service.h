@@ -3,6 +3,8 @@
 
 #include "net/abrcc/service/schema.h"
 
+#include "base/values.h"
+
 #include "net/third_party/quiche/src/quic/platform/api/quic_string_piece.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
 #include "net/third_party/quiche/src/quic/tools/quic_backend_response.h"
@@ -28,6 +30,8 @@ class MetricsService {
       const spdy::SpdyHeaderBlock& request_headers,
       const std::string& request_body,
       QuicSimpleServerBackend::RequestHandler* quic_server_stream);
+  // Add new metrics from the parsed body of a request
+  void AddMetrics(const base::Value& request);
   // Get all registered metrics so far
   std::vector<std::unique_ptr<abr_schema::Metrics>> GetMetrics();
  
@@ -0,0 +1,305 @@
+// Check of the edge cache mode of the StoreService against a stand-in origin.
+//
+// The store serves a synthetic title from an in-process HTTP origin, which counts
+// the requests it gets for every path: each OriginFetcher::Fetch is a single origin
+// request, as the fetcher neither caches nor retries. Every phase starts a fresh
+// store on the same segment cache, as a restarted server would, and has --players
+// concurrent players request the same segment:
+//   - coalescing: the misses make a single origin request, whose body all the
+//     players get;
+//   - revalidation: the segment is read from the segment cache and revalidated with
+//     a single conditional request, which the origin answers with 304, the players
+//     getting the cached body;
+//   - update: once the origin's version of the segment changed, the conditional
+//     request is answered with the new body, which the players get.
+// One line is printed per phase; the exit code is 1 if any phase failed.
+//
+// Usage: abrcc_origin_check [--players=<n>]
+
+#include <cstdio>
+#include <list>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/bind.h"
+#include "base/files/scoped_temp_dir.h"
+#include "base/run_loop.h"
+#include "base/task/thread_pool/thread_pool_instance.h"
+#include "base/threading/platform_thread.h"
+#include "base/time/time.h"
+#include "net/http/http_status_code.h"
+#include "net/test/embedded_test_server/embedded_test_server.h"
+#include "net/test/embedded_test_server/http_request.h"
+#include "net/test/embedded_test_server/http_response.h"
+
+#include "net/abrcc/dash_config.h"
+#include "net/abrcc/service/segment_cache.h"
+#include "net/abrcc/service/store_service.h"
+#include "net/third_party/quiche/src/quic/core/quic_connection_id.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_flags.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_system_event_loop.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_text_utils.h"
+#include "net/third_party/quiche/src/quic/tools/quic_simple_server_backend.h"
+
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              players,
+                              100,
+                              "Concurrent players requesting the segment "
+                              "in every phase.");
+
+namespace {
+
+const std::string TITLE_DOMAIN = "www.example.org";
+const std::string SEGMENT = "/video1/1.m4s";
+const int QUALITIES = 2;
+const int SEGMENTS = 3;
+// bytes of the segment cache and of the memory tier
+const int64_t CACHE_BYTES = 16 * 1024 * 1024;
+const int64_t MEMORY_BYTES = 1024 * 1024;
+// wall time after which a phase stops waiting for its players' responses
+const base::TimeDelta TIMEOUT = base::TimeDelta::FromSeconds(10);
+
+// HTTP origin standing in for the edge's: the body of every path is
+// "<path>@<version>", the version being its ETag.
+class StandInOrigin {
+ public:
+  StandInOrigin() : version("1") {}
+
+  bool Start() {
+    server.RegisterRequestHandler(
+      base::BindRepeating(&StandInOrigin::handle, base::Unretained(this)));
+    return server.Start();
+  }
+
+  // URL of the origin, to which the store appends the segments' paths.
+  std::string url() const {
+    std::string spec = server.base_url().spec();
+    return spec.substr(0, spec.size() - 1);
+  }
+
+  void SetVersion(const std::string& version) {
+    quic::QuicWriterMutexLock lock(&mutex);
+    this->version = version;
+  }
+
+  std::string Body(const std::string& path) {
+    quic::QuicReaderMutexLock lock(&mutex);
+    return path + "@" + version;
+  }
+
+  int Requests(const std::string& path) {
+    quic::QuicReaderMutexLock lock(&mutex);
+    return requests[path];
+  }
+
+  int ConditionalRequests(const std::string& path) {
+    quic::QuicReaderMutexLock lock(&mutex);
+    return conditional_requests[path];
+  }
+ private:
+  // runs on the server's IO thread
+  std::unique_ptr<net::test_server::HttpResponse> handle(
+    const net::test_server::HttpRequest& request
+  ) {
+    quic::QuicWriterMutexLock lock(&mutex);
+    std::string etag = "\"" + version + "\"";
+    requests[request.relative_url] += 1;
+
+    auto response = std::make_unique<net::test_server::BasicHttpResponse>();
+    response->AddCustomHeader("ETag", etag);
+    auto validator = request.headers.find("If-None-Match");
+    if (validator != request.headers.end()) {
+      conditional_requests[request.relative_url] += 1;
+      if (validator->second == etag) {
+        response->set_code(net::HTTP_NOT_MODIFIED);
+        return response;
+      }
+    }
+    response->set_code(net::HTTP_OK);
+    response->set_content(request.relative_url + "@" + version);
+    return response;
+  }
+
+  quic::QuicMutex mutex;
+  std::string version;
+  std::map<std::string, int> requests;
+  std::map<std::string, int> conditional_requests;
+  // shut down first, as its IO thread uses the members above
+  net::EmbeddedTestServer server;
+};
+
+// Stream of a player waiting for the segment.
+class Player : public quic::QuicSimpleServerBackend::RequestHandler {
+ public:
+  Player(quic::QuicStreamId id, int* answered) : id(id), answered(answered) {}
+
+  quic::QuicConnectionId connection_id() const override {
+    return quic::EmptyQuicConnectionId();
+  }
+  quic::QuicStreamId stream_id() const override { return id; }
+  std::string peer_host() const override { return "127.0.0.1"; }
+
+  void OnResponseBackendComplete(
+    const quic::QuicBackendResponse* response,
+    std::list<quic::QuicBackendResponse::ServerPushInfo> resources
+  ) override {
+    *answered += 1;
+    if (response == nullptr) {
+      return;
+    }
+    auto status_header = response->headers().find(":status");
+    if (status_header != response->headers().end()) {
+      status = status_header->second.as_string();
+    }
+    body = response->body().as_string();
+  }
+
+  std::string status;
+  std::string body;
+ private:
+  quic::QuicStreamId id;
+  int* answered;
+};
+
+// Synthetic title, whose segments are only known to the origin.
+std::shared_ptr<quic::DashBackendConfig> makeConfig() {
+  auto config = std::shared_ptr<quic::DashBackendConfig>(new quic::DashBackendConfig());
+  config->domain = TITLE_DOMAIN;
+  config->segments = SEGMENTS;
+  for (int quality = 0; quality < QUALITIES; ++quality) {
+    auto video_config = std::make_unique<quic::VideoConfig>();
+    video_config->resource = "/video" + quic::QuicTextUtils::Uint64ToString(quality);
+    video_config->path = video_config->resource;
+    video_config->quality = 300 * (quality + 1);
+    for (int i = 0; i < SEGMENTS; ++i) {
+      video_config->video_info.push_back(
+        std::make_unique<quic::VideoInfo>(4. * i, 90., 100000 * (quality + 1)));
+    }
+    config->video_configs.push_back(std::move(video_config));
+  }
+  return config;
+}
+
+// Runs the tasks hopping between the network thread and the thread pool(e.g. the
+// segment cache's disk I/O), whose chains are a few hops long.
+void settle() {
+  for (int i = 0; i < 16; ++i) {
+    base::ThreadPoolInstance::Get()->FlushForTesting();
+    base::RunLoop().RunUntilIdle();
+  }
+}
+
+// Runs the network thread until `expected` players were answered, or the timeout.
+bool waitFor(const int* answered, int expected) {
+  base::TimeTicks deadline = base::TimeTicks::Now() + TIMEOUT;
+  while (*answered < expected) {
+    if (base::TimeTicks::Now() > deadline) {
+      return false;
+    }
+    base::RunLoop().RunUntilIdle();
+    base::PlatformThread::Sleep(base::TimeDelta::FromMilliseconds(1));
+  }
+  return true;
+}
+
+// Has `players` concurrent players request the segment from a fresh store; returns
+// whether all of them got `body`.
+bool servePlayers(
+  const quic::SegmentCacheConfig& segment_cache_config,
+  int players,
+  const std::string& body
+) {
+  std::vector<std::unique_ptr<Player>> streams;
+  int answered = 0;
+  {
+    quic::StoreService store(segment_cache_config);
+    store.VideoFromConfig("/check", makeConfig());
+    // the segment cache opens asynchronously
+    settle();
+
+    spdy::SpdyHeaderBlock request_headers;
+    request_headers[":authority"] = TITLE_DOMAIN;
+    request_headers[":path"] = SEGMENT;
+    request_headers[":method"] = "GET";
+    for (int i = 0; i < players; ++i) {
+      streams.push_back(std::make_unique<Player>(4 * i, &answered));
+      store.FetchResponseFromBackend(request_headers, "", streams.back().get());
+    }
+    if (!waitFor(&answered, players)) {
+      fprintf(stderr, "%d of %d players answered\n", answered, players);
+      return false;
+    }
+    // the segment is written to the segment cache for the next phase
+    settle();
+  }
+
+  for (const auto& stream : streams) {
+    if (stream->status != "200" || stream->body != body) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Prints the outcome of a phase given the origin requests expected since the start;
+// returns whether it passed.
+bool report(
+  const std::string& phase,
+  bool served,
+  StandInOrigin* origin,
+  int expected_requests,
+  int expected_conditional_requests
+) {
+  int requests = origin->Requests(SEGMENT);
+  int conditional_requests = origin->ConditionalRequests(SEGMENT);
+  bool passed = served && requests == expected_requests
+    && conditional_requests == expected_conditional_requests;
+  printf("%s: players %s, %d origin requests(%d conditional), expected %d(%d): %s\n",
+         phase.c_str(), served ? "served" : "not served", requests,
+         conditional_requests, expected_requests, expected_conditional_requests,
+         passed ? "ok" : "FAILED");
+  return passed;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+  QuicSystemEventLoop event_loop("abrcc_origin_check");
+  const char* usage = "Usage: abrcc_origin_check [options]";
+  std::vector<std::string> non_option_args =
+      quic::QuicParseCommandLineFlags(usage, argc, argv);
+  if (!non_option_args.empty()) {
+    quic::QuicPrintCommandLineFlagHelp(usage);
+    exit(0);
+  }
+
+  StandInOrigin origin;
+  if (!origin.Start()) {
+    fprintf(stderr, "can not start the stand-in origin\n");
+    return 1;
+  }
+  base::ScopedTempDir cache_dir;
+  if (!cache_dir.CreateUniqueTempDir()) {
+    fprintf(stderr, "can not create the segment cache directory\n");
+    return 1;
+  }
+  quic::SegmentCacheConfig segment_cache_config(
+    cache_dir.GetPath().value(), CACHE_BYTES, MEMORY_BYTES, origin.url());
+  int players = GetQuicFlag(FLAGS_players);
+
+  bool passed = true;
+  bool served = servePlayers(segment_cache_config, players, origin.Body(SEGMENT));
+  passed = report("coalescing", served, &origin, 1, 0) && passed;
+
+  served = servePlayers(segment_cache_config, players, origin.Body(SEGMENT));
+  passed = report("revalidation", served, &origin, 2, 1) && passed;
+
+  origin.SetVersion("2");
+  served = servePlayers(segment_cache_config, players, origin.Body(SEGMENT));
+  passed = report("update", served, &origin, 3, 2) && passed;
+
+  return passed ? 0 : 1;
+}
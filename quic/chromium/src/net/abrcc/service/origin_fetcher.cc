@@ -0,0 +1,230 @@
+#include "net/abrcc/service/origin_fetcher.h"
+
+#include <map>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/memory/weak_ptr.h"
+#include "base/message_loop/message_pump_type.h"
+#include "base/sequenced_task_runner.h"
+#include "base/threading/sequenced_task_runner_handle.h"
+#include "build/build_config.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/request_priority.h"
+#include "net/http/http_request_headers.h"
+#include "net/http/http_response_headers.h"
+#include "net/http/http_status_code.h"
+#include "net/proxy_resolution/proxy_config_service_fixed.h"
+#include "net/traffic_annotation/network_traffic_annotation.h"
+#include "net/url_request/url_request.h"
+#include "net/url_request/url_request_context.h"
+#include "net/url_request/url_request_context_builder.h"
+#include "url/gurl.h"
+
+#include "net/abrcc/logging/log.h"
+
+namespace quic {
+
+SourceResponse::SourceResponse() : body(base::nullopt), not_modified(false) {}
+SourceResponse::SourceResponse(SourceResponse&& other) = default;
+SourceResponse& SourceResponse::operator=(SourceResponse&& other) = default;
+SourceResponse::~SourceResponse() {}
+
+// Requests in flight, and the URLRequestContext they run in.
+class OriginFetcher::Context {
+ public:
+  Context() : weak_factory(this) {}
+  Context(const Context&) = delete;
+  Context& operator=(const Context&) = delete;
+  ~Context() {
+    // the requests have to go before their context
+    requests.clear();
+  }
+
+  void Start(
+    const GURL& url,
+    const std::string& validator,
+    scoped_refptr<base::SequencedTaskRunner> reply_runner,
+    FetchCallback callback
+  );
+  void Remove(Request* request);
+  base::WeakPtr<Context> GetWeakPtr() { return weak_factory.GetWeakPtr(); }
+ private:
+  net::URLRequestContext* GetURLRequestContext();
+
+  std::unique_ptr<net::URLRequestContext> url_context;
+  std::map<Request*, std::unique_ptr<Request>> requests;
+  base::WeakPtrFactory<Context> weak_factory;
+};
+
+// A single GET of a resource, reading the whole body; conditional given a validator.
+class OriginFetcher::Request : public net::URLRequest::Delegate {
+ public:
+  Request(
+    base::WeakPtr<Context> context,
+    scoped_refptr<base::SequencedTaskRunner> reply_runner,
+    FetchCallback callback
+  ) : context(context)
+    , reply_runner(reply_runner)
+    , callback(std::move(callback))
+    , buffer(base::MakeRefCounted<net::IOBuffer>(OriginConstants::read_size)) {}
+  Request(const Request&) = delete;
+  Request& operator=(const Request&) = delete;
+  ~Request() override {}
+
+  void Start(
+    net::URLRequestContext* url_context,
+    const GURL& url,
+    const std::string& validator
+  ) {
+    request = url_context->CreateRequest(
+      url, net::HIGHEST, this, MISSING_TRAFFIC_ANNOTATION);
+    if (validator.compare(0, OriginConstants::etag_validator.size(),
+                          OriginConstants::etag_validator) == 0) {
+      request->SetExtraRequestHeaderByName(
+        net::HttpRequestHeaders::kIfNoneMatch,
+        validator.substr(OriginConstants::etag_validator.size()), true);
+    } else if (validator.compare(0, OriginConstants::modified_validator.size(),
+                                 OriginConstants::modified_validator) == 0) {
+      request->SetExtraRequestHeaderByName(
+        net::HttpRequestHeaders::kIfModifiedSince,
+        validator.substr(OriginConstants::modified_validator.size()), true);
+    }
+    request->Start();
+  }
+
+  void OnResponseStarted(net::URLRequest* unused, int net_error) override {
+    if (net_error == net::OK && request->GetResponseCode() == net::HTTP_NOT_MODIFIED) {
+      response.not_modified = true;
+      Finish(false);
+      return;
+    }
+    if (net_error != net::OK || request->GetResponseCode() != 200) {
+      ABRCC_LOG(WARNING) << "[Origin] " << request->url().spec() << " failed: "
+                         << net::ErrorToString(net_error) << ' '
+                         << request->GetResponseCode();
+      Finish(false);
+      return;
+    }
+    std::string value;
+    const net::HttpResponseHeaders* headers = request->response_headers();
+    if (headers->EnumerateHeader(nullptr, "ETag", &value)) {
+      response.validator = OriginConstants::etag_validator + value;
+    } else if (headers->EnumerateHeader(nullptr, "Last-Modified", &value)) {
+      response.validator = OriginConstants::modified_validator + value;
+    }
+    Read();
+  }
+
+  void OnReadCompleted(net::URLRequest* unused, int bytes_read) override {
+    if (bytes_read <= 0) {
+      Finish(bytes_read == 0);
+      return;
+    }
+    body.append(buffer->data(), bytes_read);
+    Read();
+  }
+ private:
+  void Read() {
+    while (true) {
+      int bytes_read = request->Read(buffer.get(), OriginConstants::read_size);
+      if (bytes_read == net::ERR_IO_PENDING) {
+        return;
+      }
+      if (bytes_read <= 0) {
+        Finish(bytes_read == 0);
+        return;
+      }
+      body.append(buffer->data(), bytes_read);
+    }
+  }
+
+  void Finish(bool success) {
+    if (success) {
+      response.body = std::move(body);
+    }
+    reply_runner->PostTask(
+      FROM_HERE, base::BindOnce(std::move(callback), std::move(response)));
+
+    // the request is not destroyed from within its delegate
+    base::SequencedTaskRunnerHandle::Get()->PostTask(
+      FROM_HERE, base::BindOnce(&Context::Remove, context, this));
+  }
+
+  base::WeakPtr<Context> context;
+  scoped_refptr<base::SequencedTaskRunner> reply_runner;
+  FetchCallback callback;
+
+  std::unique_ptr<net::URLRequest> request;
+  scoped_refptr<net::IOBuffer> buffer;
+  std::string body;
+  SourceResponse response;
+};
+
+net::URLRequestContext* OriginFetcher::Context::GetURLRequestContext() {
+  if (url_context == nullptr) {
+    net::URLRequestContextBuilder builder;
+    // the segments are cached by the store
+    builder.DisableHttpCache();
+    builder.SetSpdyAndQuicEnabled(true /* http2 */, false /* quic */);
+#if defined(OS_LINUX)
+    builder.set_proxy_config_service(
+      std::make_unique<net::ProxyConfigServiceFixed>(
+        net::ProxyConfigWithAnnotation::CreateDirect()));
+#endif
+    builder.SetCookieStore(nullptr);
+    url_context = builder.Build();
+  }
+  return url_context.get();
+}
+
+void OriginFetcher::Context::Start(
+  const GURL& url,
+  const std::string& validator,
+  scoped_refptr<base::SequencedTaskRunner> reply_runner,
+  FetchCallback callback
+) {
+  std::unique_ptr<Request> request(
+    new Request(GetWeakPtr(), reply_runner, std::move(callback)));
+  Request* started = request.get();
+  requests[started] = std::move(request);
+  started->Start(GetURLRequestContext(), url, validator);
+}
+
+void OriginFetcher::Context::Remove(Request* request) {
+  requests.erase(request);
+}
+
+OriginFetcher::OriginFetcher(const std::string& origin_url)
+  : origin_url(origin_url)
+  , thread(new base::Thread("origin fetcher"))
+  , context(new Context()) {
+  base::Thread::Options options;
+  options.message_pump_type = base::MessagePumpType::IO;
+  CHECK(thread->StartWithOptions(options));
+}
+
+OriginFetcher::~OriginFetcher() {
+  // the context is destroyed on its thread, before the thread is joined
+  thread->task_runner()->DeleteSoon(FROM_HERE, context);
+  thread.reset();
+}
+
+void OriginFetcher::Fetch(
+  const std::string& path,
+  const std::string& validator,
+  FetchCallback callback
+) {
+  GURL url(origin_url + path);
+  if (!url.is_valid() || !url.SchemeIsHTTPOrHTTPS()) {
+    ABRCC_LOG(WARNING) << "[Origin] invalid url " << origin_url + path;
+    std::move(callback).Run(SourceResponse());
+    return;
+  }
+  thread->task_runner()->PostTask(FROM_HERE, base::BindOnce(
+    &Context::Start, base::Unretained(context), url, validator,
+    base::SequencedTaskRunnerHandle::Get(), std::move(callback)));
+}
+
+}
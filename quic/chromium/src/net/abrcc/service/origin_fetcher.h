@@ -0,0 +1,67 @@
+#ifndef ABRCC_SERVICE_ORIGIN_FETCHER_H_
+#define ABRCC_SERVICE_ORIGIN_FETCHER_H_
+
+#include <memory>
+#include <string>
+
+#include "base/callback.h"
+#include "base/optional.h"
+#include "base/threading/thread.h"
+
+namespace quic {
+
+namespace OriginConstants {
+  // bytes read from the origin's response at once
+  const int read_size = 64 * 1024;
+  // prefixes of the validators built from the ETag and Last-Modified headers
+  const std::string etag_validator = "etag:";
+  const std::string modified_validator = "modified:";
+}
+
+// Response of the source of a resource. A conditional load of a resource still
+// matching the given validator answers `not_modified` without a body; otherwise the
+// body is missing if the load failed. The `validator` identifies the version of the
+// body, and is empty if the source gives none.
+struct SourceResponse {
+  SourceResponse();
+  SourceResponse(SourceResponse&& other);
+  SourceResponse& operator=(SourceResponse&& other);
+  ~SourceResponse();
+
+  base::Optional<std::string> body;
+  std::string validator;
+  bool not_modified;
+};
+
+// HTTP client of the origin of an edge server: fetches resources from the
+// origin with net::URLRequest, as the proxy backend in tools/quic does.
+//
+// The requests run on a dedicated IO thread, which owns the URLRequestContext.
+// Fetch can be called from any sequence, its callback being run back on the
+// calling sequence.
+class OriginFetcher {
+ public:
+  using FetchCallback = base::OnceCallback<void(SourceResponse)>;
+
+  explicit OriginFetcher(const std::string& origin_url);
+  OriginFetcher(const OriginFetcher&) = delete;
+  OriginFetcher& operator=(const OriginFetcher&) = delete;
+  ~OriginFetcher();
+
+  // Fetches `origin_url + path`; `callback` gets the body, or none if the origin did
+  // not answer with 200. Given the `validator` of a previous response, the fetch is
+  // conditional, an unchanged resource being answered with `not_modified`.
+  void Fetch(const std::string& path, const std::string& validator, FetchCallback callback);
+ private:
+  class Context;
+  class Request;
+
+  std::string origin_url;
+  std::unique_ptr<base::Thread> thread;
+  // owned by, and only used on, `thread`
+  Context* context;
+};
+
+}
+
+#endif
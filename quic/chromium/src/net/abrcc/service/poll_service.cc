@@ -5,7 +5,7 @@
 
 #include "net/third_party/quiche/src/quic/core/http/spdy_utils.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
-#include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_text_utils.h"
 
 using spdy::SpdyHeaderBlock;
@@ -30,7 +30,7 @@ void PollingService::AddRequest(
         new CacheEntry(request_headers, request_body, quic_server_stream)
       );
   
-      QUIC_LOG(WARNING) << "NEW ENTRY " << path;
+      ABRCC_LOG_EVERY_MS(WARNING, 1000) << "NEW ENTRY " << path;
       
       QuicWriterMutexLock lock(&mutex_);
       stream_cache[path] = std::move(entry);
@@ -0,0 +1,212 @@
+#include "net/abrcc/service/segment_cache.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "base/bind.h"
+#include "base/callback_helpers.h"
+#include "base/files/file_path.h"
+#include "net/base/cache_type.h"
+#include "net/base/io_buffer.h"
+#include "net/base/net_errors.h"
+#include "net/base/request_priority.h"
+#include "net/abrcc/logging/log.h"
+
+namespace quic {
+
+// the body of a segment is held in the entry's first stream, its validator in the
+// second one
+static const int kBodyStream = 0;
+static const int kValidatorStream = 1;
+
+SegmentCacheConfig::SegmentCacheConfig()
+  : path(""), max_bytes(0), memory_bytes(0), origin_url("") {}
+SegmentCacheConfig::SegmentCacheConfig(
+  const std::string& path,
+  int64_t max_bytes,
+  int64_t memory_bytes,
+  const std::string& origin_url
+) : path(path), max_bytes(max_bytes), memory_bytes(memory_bytes), origin_url(origin_url) {}
+
+struct SegmentCache::Operation {
+  std::string key;
+  disk_cache::ScopedEntryPtr entry;
+  scoped_refptr<net::IOBufferWithSize> buffer;
+  std::string validator;
+  ReadCallback callback;
+};
+
+SegmentCache::SegmentCache(const std::string& path, int64_t max_bytes)
+  : path(path)
+  , max_bytes(max_bytes)
+  , ready_(false)
+  , weak_factory(this) {}
+SegmentCache::~SegmentCache() {}
+
+void SegmentCache::Open(base::OnceCallback<void(bool)> opened) {
+  auto callback = base::AdaptCallbackForRepeating(base::BindOnce(
+    &SegmentCache::OnOpened, weak_factory.GetWeakPtr(), std::move(opened)));
+  int result = disk_cache::CreateCacheBackend(
+    net::DISK_CACHE, net::CACHE_BACKEND_SIMPLE, base::FilePath(path), max_bytes,
+    disk_cache::ResetHandling::kResetOnError, nullptr, &backend, callback);
+  if (result != net::ERR_IO_PENDING) {
+    callback.Run(result);
+  }
+}
+
+void SegmentCache::OnOpened(base::OnceCallback<void(bool)> opened, int result) {
+  ready_ = result == net::OK && backend != nullptr;
+  if (ready_) {
+    ABRCC_LOG(INFO) << "[SegmentCache] opened " << path << " with "
+                    << backend->GetEntryCount() << " entries";
+  } else {
+    ABRCC_LOG(WARNING) << "[SegmentCache] can not open " << path << ": "
+                       << net::ErrorToString(result);
+    backend.reset();
+  }
+  std::move(opened).Run(ready_);
+}
+
+bool SegmentCache::ready() const {
+  return ready_;
+}
+
+void SegmentCache::Read(const std::string& key, ReadCallback callback) {
+  if (!ready_) {
+    std::move(callback).Run(base::nullopt, "");
+    return;
+  }
+  std::unique_ptr<Operation> operation(new Operation());
+  operation->key = key;
+  operation->callback = std::move(callback);
+
+  auto opened = base::AdaptCallbackForRepeating(base::BindOnce(
+    &SegmentCache::OnReadEntry, weak_factory.GetWeakPtr(), std::move(operation)));
+  disk_cache::EntryResult result = backend->OpenEntry(key, net::HIGHEST, opened);
+  if (result.net_error() != net::ERR_IO_PENDING) {
+    opened.Run(std::move(result));
+  }
+}
+
+void SegmentCache::OnReadEntry(
+  std::unique_ptr<Operation> operation,
+  disk_cache::EntryResult result
+) {
+  if (result.net_error() != net::OK) {
+    std::move(operation->callback).Run(base::nullopt, "");
+    return;
+  }
+  operation->entry.reset(result.ReleaseEntry());
+  int size = operation->entry->GetDataSize(kValidatorStream);
+  if (size <= 0) {
+    // entries written without a validator are read as always stale
+    OnReadValidator(std::move(operation), 0);
+    return;
+  }
+  operation->buffer = base::MakeRefCounted<net::IOBufferWithSize>(size);
+
+  // the operation is owned by the callback from here on
+  Operation* pending = operation.get();
+  auto read = base::AdaptCallbackForRepeating(base::BindOnce(
+    &SegmentCache::OnReadValidator, weak_factory.GetWeakPtr(), std::move(operation)));
+  int rv = pending->entry->ReadData(
+    kValidatorStream, 0, pending->buffer.get(), size, read);
+  if (rv != net::ERR_IO_PENDING) {
+    read.Run(rv);
+  }
+}
+
+void SegmentCache::OnReadValidator(std::unique_ptr<Operation> operation, int result) {
+  if (operation->buffer != nullptr && result == operation->buffer->size()) {
+    operation->validator = std::string(operation->buffer->data(), result);
+  }
+  int size = operation->entry->GetDataSize(kBodyStream);
+  if (size <= 0) {
+    std::move(operation->callback).Run(base::nullopt, "");
+    return;
+  }
+  operation->buffer = base::MakeRefCounted<net::IOBufferWithSize>(size);
+
+  Operation* pending = operation.get();
+  auto read = base::AdaptCallbackForRepeating(base::BindOnce(
+    &SegmentCache::OnReadData, weak_factory.GetWeakPtr(), std::move(operation)));
+  int rv = pending->entry->ReadData(
+    kBodyStream, 0, pending->buffer.get(), size, read);
+  if (rv != net::ERR_IO_PENDING) {
+    read.Run(rv);
+  }
+}
+
+void SegmentCache::OnReadData(std::unique_ptr<Operation> operation, int result) {
+  if (result != operation->buffer->size()) {
+    ABRCC_LOG(WARNING) << "[SegmentCache] short read of " << operation->key << ": "
+                       << result << " of " << operation->buffer->size();
+    std::move(operation->callback).Run(base::nullopt, "");
+    return;
+  }
+  std::move(operation->callback).Run(
+    std::string(operation->buffer->data(), operation->buffer->size()),
+    operation->validator);
+}
+
+void SegmentCache::Write(
+  const std::string& key,
+  const std::string& data,
+  const std::string& validator
+) {
+  if (!ready_ || data.empty()) {
+    return;
+  }
+  std::unique_ptr<Operation> operation(new Operation());
+  operation->key = key;
+  operation->validator = validator;
+  operation->buffer = base::MakeRefCounted<net::IOBufferWithSize>(data.size());
+  std::copy(data.begin(), data.end(), operation->buffer->data());
+
+  auto opened = base::AdaptCallbackForRepeating(base::BindOnce(
+    &SegmentCache::OnWriteEntry, weak_factory.GetWeakPtr(), std::move(operation)));
+  disk_cache::EntryResult result = backend->OpenOrCreateEntry(key, net::LOWEST, opened);
+  if (result.net_error() != net::ERR_IO_PENDING) {
+    opened.Run(std::move(result));
+  }
+}
+
+static void OnWriteData(const std::string& key, int size, int result) {
+  if (result != size) {
+    ABRCC_LOG(WARNING) << "[SegmentCache] failed to write " << key << ": "
+                       << net::ErrorToString(result);
+  }
+}
+
+void SegmentCache::OnWriteEntry(
+  std::unique_ptr<Operation> operation,
+  disk_cache::EntryResult result
+) {
+  if (result.net_error() != net::OK) {
+    ABRCC_LOG(WARNING) << "[SegmentCache] can not create " << operation->key;
+    return;
+  }
+  // the entry keeps the buffer until the write completes, so it can be closed
+  // right away by dropping the operation
+  operation->entry.reset(result.ReleaseEntry());
+  int size = operation->buffer->size();
+  int rv = operation->entry->WriteData(
+    kBodyStream, 0, operation->buffer.get(), size,
+    base::BindOnce(&OnWriteData, operation->key, size), true);
+  if (rv != net::ERR_IO_PENDING) {
+    OnWriteData(operation->key, size, rv);
+  }
+
+  // a body whose validator failed to be written is read as stale
+  int validator_size = operation->validator.size();
+  auto validator = base::MakeRefCounted<net::IOBufferWithSize>(validator_size);
+  std::copy(operation->validator.begin(), operation->validator.end(), validator->data());
+  rv = operation->entry->WriteData(
+    kValidatorStream, 0, validator.get(), validator_size,
+    base::BindOnce(&OnWriteData, operation->key, validator_size), true);
+  if (rv != net::ERR_IO_PENDING) {
+    OnWriteData(operation->key, validator_size, rv);
+  }
+}
+
+}
@@ -0,0 +1,87 @@
+#ifndef ABRCC_SERVICE_SEGMENT_CACHE_H_
+#define ABRCC_SERVICE_SEGMENT_CACHE_H_
+
+#include <memory>
+#include <string>
+
+#include "base/callback.h"
+#include "base/memory/weak_ptr.h"
+#include "base/optional.h"
+#include "net/disk_cache/disk_cache.h"
+
+namespace quic {
+
+// Configuration of the segment store's tiers. The disk tier is disabled if `path`
+// is empty, in which case all the segments are kept in memory. With an `origin_url`,
+// the store is an edge cache: segments missing from the tiers are fetched from the
+// origin instead of being read from local files.
+struct SegmentCacheConfig {
+  SegmentCacheConfig();
+  SegmentCacheConfig(const std::string& path, int64_t max_bytes, int64_t memory_bytes,
+                     const std::string& origin_url = "");
+
+  // directory of the persistent tier
+  std::string path;
+  // capacity of the persistent tier
+  int64_t max_bytes;
+  // bytes of segments held in the memory tier
+  int64_t memory_bytes;
+  // origin of the segments in edge mode
+  std::string origin_url;
+
+  bool enabled() const { return !path.empty(); }
+  bool edge() const { return !origin_url.empty(); }
+};
+
+// Persistent tier of the segment store on top of the simple disk cache backend: an
+// entry maps a resource key to the resource's body, held in stream 0 of the entry,
+// and to the validator of the body's version at its source, held in stream 1, such
+// that stale entries can be told apart.
+//
+// The cache survives restarts, such that segments packaged or fetched before are
+// served without reading their raw files again. All the methods, and the callbacks,
+// run on the thread which opened the cache(i.e. the network thread); the disk I/O
+// happens on the backend's worker pool. Callbacks are dropped once the cache is
+// destroyed.
+class SegmentCache {
+ public:
+  using ReadCallback =
+    base::OnceCallback<void(base::Optional<std::string>, const std::string&)>;
+
+  SegmentCache(const std::string& path, int64_t max_bytes);
+  SegmentCache(const SegmentCache&) = delete;
+  SegmentCache& operator=(const SegmentCache&) = delete;
+  ~SegmentCache();
+
+  // Opens, or creates, the cache directory; `opened` runs with whether the cache
+  // can be used.
+  void Open(base::OnceCallback<void(bool)> opened);
+  bool ready() const;
+
+  // Reads the body of `key`, or base::nullopt if the entry is absent, with the
+  // validator it was written with.
+  void Read(const std::string& key, ReadCallback callback);
+  // Stores `data` as the body of `key`, and its source's `validator`, replacing the
+  // previous ones.
+  void Write(const std::string& key, const std::string& data, const std::string& validator);
+ private:
+  struct Operation;
+
+  void OnOpened(base::OnceCallback<void(bool)> opened, int result);
+  void OnReadEntry(std::unique_ptr<Operation> operation, disk_cache::EntryResult result);
+  void OnReadValidator(std::unique_ptr<Operation> operation, int result);
+  void OnReadData(std::unique_ptr<Operation> operation, int result);
+  void OnWriteEntry(std::unique_ptr<Operation> operation, disk_cache::EntryResult result);
+
+  std::string path;
+  int64_t max_bytes;
+
+  std::unique_ptr<disk_cache::Backend> backend;
+  bool ready_;
+
+  base::WeakPtrFactory<SegmentCache> weak_factory;
+};
+
+}
+
+#endif
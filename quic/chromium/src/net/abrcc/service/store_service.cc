@@ -11,28 +11,87 @@
 
 #include "net/abrcc/dash_config.h"
 #include "net/third_party/quiche/src/quic/core/http/spdy_utils.h"
-#include "net/third_party/quiche/src/quic/platform/api/quic_logging.h"
+#include "net/abrcc/logging/log.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_text_utils.h"
 
 #include "base/bind.h"
 #include "base/run_loop.h"
+#include "base/task/post_task.h"
 #include "base/task_runner.h"
+#include "base/task_runner_util.h"
 #include "base/threading/thread.h"
 
+#include <sys/stat.h>
+
 using spdy::SpdyHeaderBlock;
 
 namespace quic { 
 
-StoreService::StoreService() : cache(new QuicMemoryCacheBackend()) {}
+StoreService::StoreService() : StoreService(SegmentCacheConfig()) {}
+StoreService::StoreService(const SegmentCacheConfig& segment_cache_config)
+  : cache(new QuicMemoryCacheBackend())
+  , segment_cache_config(segment_cache_config)
+  , tiered(false)
+  , warm_next(0)
+  , memory_used(0)
+  , next_request(0)
+  , weak_factory(this) {}
 StoreService::~StoreService() {}
 
+static std::string readFile(const std::string& path) {
+  std::ifstream stream(path, std::ios::binary);
+  return std::string((std::istreambuf_iterator<char>(stream)),
+                     std::istreambuf_iterator<char>());
+}
+
+// Loads a segment's file as from an origin, its validator being the file's
+// modification time and size.
+static SourceResponse loadFile(const std::string& path, const std::string& validator) {
+  SourceResponse response;
+  struct stat info;
+  if (stat(path.c_str(), &info) != 0) {
+    return response;
+  }
+  response.validator = QuicTextUtils::Uint64ToString(info.st_mtim.tv_sec) + "."
+                     + QuicTextUtils::Uint64ToString(info.st_mtim.tv_nsec) + ":"
+                     + QuicTextUtils::Uint64ToString(info.st_size);
+  if (response.validator == validator) {
+    response.not_modified = true;
+    return response;
+  }
+  std::string data = readFile(path);
+  if (!data.empty()) {
+    response.body = std::move(data);
+  }
+  return response;
+}
+
+static void respond(
+  QuicSimpleServerBackend::RequestHandler* quic_stream,
+  const std::string& data
+) {
+  SpdyHeaderBlock response_headers;
+  response_headers[":status"] = QuicTextUtils::Uint64ToString(200);
+  response_headers["content-length"] = QuicTextUtils::Uint64ToString(data.size());
+
+  QuicBackendResponse quic_response;
+  quic_response.set_response_type(QuicBackendResponse::REGULAR_RESPONSE);
+  quic_response.set_headers(std::move(response_headers));
+  quic_response.set_body(data);
+  quic_response.set_trailers(SpdyHeaderBlock());
+  quic_response.set_stop_sending_code(0);
+
+  auto push_info = std::list<QuicBackendResponse::ServerPushInfo>();
+  quic_stream->OnResponseBackendComplete(&quic_response, push_info);
+}
+
 static void staticRegisterResource(
   quic::StoreService* service,
   const std::string& domain, 
   const std::string& resource_path, 
   const std::string& resource
 ) {
-  QUIC_LOG(WARNING) << "[register resource] " << domain << " -> " << resource 
+  ABRCC_LOG(WARNING) << "[register resource] " << domain << " -> " << resource 
                  << " : " << resource_path;
 
   std::ifstream stream(resource_path);
@@ -46,7 +105,7 @@ static void staticRegisterResource(
     data = bin_data;  
   }
 
-  QUIC_LOG(WARNING) << "[data] " << resource << ' ' << data.size() << '\n';
+  ABRCC_LOG(WARNING) << "[data] " << resource << ' ' << data.size() << '\n';
   
   SpdyHeaderBlock response_headers;
   response_headers[":status"] = QuicTextUtils::Uint64ToString(200);
@@ -110,6 +169,49 @@ void StoreService::VideoFromConfig(
   // init
   this->dir_path = dir_path;
   this->config = config;
+  predictor = SegmentPredictor::ForConfig(config.get());
+
+  if (OnDemand()) {
+    // the segments are only registered: the tiers are filled on demand and by warming
+    tiered = true;
+    std::vector<std::string> init, segments;
+    for (const auto& video_config : config->video_configs) {
+      std::string resource = video_config->resource;
+      std::string path = dir_path + video_config->path;
+      segment_files[resource + "/init.mp4"] = path + "/init.mp4";
+      init.push_back(resource + "/init.mp4");
+    }
+    for (int i = 1; i <= config->segments; ++i) {
+      std::string file = "/" + QuicTextUtils::Uint64ToString(i) + ".m4s";
+      for (const auto& video_config : config->video_configs) {
+        segment_files[video_config->resource + file] = dir_path + video_config->path + file;
+        segments.push_back(video_config->resource + file);
+      }
+    }
+    warm_order = init;
+    warm_order.insert(warm_order.end(), segments.begin(), segments.end());
+
+    file_runner = base::CreateSequencedTaskRunner(
+      {base::ThreadPool(), base::MayBlock(), base::TaskPriority::USER_VISIBLE});
+    if (segment_cache_config.edge()) {
+      origin.reset(new OriginFetcher(segment_cache_config.origin_url));
+    }
+    if (segment_cache_config.enabled()) {
+      // one cache directory per title, as a directory has a single backend
+      std::string title = dir_path.substr(dir_path.find_last_of("/") + 1);
+      segment_cache.reset(new SegmentCache(
+        segment_cache_config.path + "/" + title, segment_cache_config.max_bytes));
+      segment_cache->Open(base::BindOnce(
+        [](base::WeakPtr<StoreService> service, bool ready) {
+          if (service) {
+            service->warm();
+          }
+        }, weak_factory.GetWeakPtr()));
+    }
+
+    ABRCC_LOG(WARNING) << "Registered " << segment_files.size() << " segments";
+    return;
+  }
   
   // add resources
   std::vector<std::unique_ptr<base::Thread>> threads;
@@ -117,7 +219,7 @@ void StoreService::VideoFromConfig(
     std::string resource = video_config->resource;    
     std::string path = dir_path + video_config->path; 
    
-    QUIC_LOG(INFO) << "Caching resource " << resource << " at path " << path;
+    ABRCC_LOG(INFO) << "Caching resource " << resource << " at path " << path;
     
     int video_length = config->segments;
     threads.push_back(
@@ -127,7 +229,23 @@ void StoreService::VideoFromConfig(
   for (auto &thread: threads) {
      thread->Stop();
   }
-  QUIC_LOG(WARNING) << "Finished storing videos";
+  if (predictor != nullptr) {
+    for (const auto& video_config : config->video_configs) {
+      for (int i = 1; i <= config->segments; ++i) {
+        std::string resource = video_config->resource + "/"
+                             + QuicTextUtils::Uint64ToString(i) + ".m4s";
+        auto response = cache->GetResponse(config->domain, resource);
+        if (response != nullptr) {
+          observeSegment(resource, response->body().size());
+        }
+      }
+    }
+  }
+  ABRCC_LOG(WARNING) << "Finished storing videos";
+}
+
+bool StoreService::OnDemand() const {
+  return segment_cache_config.enabled() || segment_cache_config.edge();
 }
 
 void StoreService::MetaFromConfig(
@@ -147,7 +265,7 @@ void StoreService::MetaFromConfig(
   registerResource(
     config->domain, base_path + config->player_config.player, config->player_config.player);
   
-  QUIC_LOG(WARNING) << "Finished storing metadata";
+  ABRCC_LOG(WARNING) << "Finished storing metadata";
 }
 
 void StoreService::FetchResponseFromBackend(
@@ -155,12 +273,275 @@ void StoreService::FetchResponseFromBackend(
   const std::string& string, 
   QuicSimpleServerBackend::RequestHandler* quic_stream
 ) {
-  QUIC_LOG(INFO) << "[Store] Headers";
-  for (const auto& pair : request_headers) {
-    QUIC_LOG(INFO) << pair.first << ' ' << pair.second;
+  ABRCC_LOG_EVERY_MS(INFO, 1000) << "[Store] Headers " << request_headers.DebugString()
+                                 << " [String] " << string;
+  auto authority = request_headers.find(":authority");
+  auto path = request_headers.find(":path");
+  bool located = authority != request_headers.end() && path != request_headers.end();
+  const QuicBackendResponse* response = located
+    ? cache->GetResponse(authority->second, path->second) : nullptr;
+  if (response != nullptr) {
+    trackDelivery(quic_stream, path->second.as_string(), response->body().size());
+  }
+
+  // metadata and unknown resources are answered by the memory cache
+  if (!tiered || !located || response != nullptr || !isSegment(path->second.as_string())) {
+    cache->FetchResponseFromBackend(request_headers, string, quic_stream);
+    return;
+  }
+
+  std::string resource = path->second.as_string();
+  const std::string* data = fromMemory(resource);
+  if (data != nullptr) {
+    trackDelivery(quic_stream, resource, data->size());
+    respond(quic_stream, *data);
+    return;
+  }
+
+  int request = next_request++;
+  pending[quic_stream] = request;
+  loadSegment(resource, base::BindOnce(
+    &StoreService::onSegmentLoaded, weak_factory.GetWeakPtr(), quic_stream, request,
+    resource));
+}
+
+void StoreService::CloseStream(QuicSimpleServerBackend::RequestHandler* quic_stream) {
+  pending.erase(quic_stream);
+}
+
+void StoreService::TrackDeliveries(std::shared_ptr<DeliveryService> delivery) {
+  this->delivery = delivery;
+}
+
+bool StoreService::isSegment(const std::string& resource) const {
+  if (segment_files.find(resource) != segment_files.end()) {
+    return true;
+  }
+  // a live origin publishes segments past the configured ones
+  if (origin == nullptr || resource.size() < 4
+      || resource.compare(resource.size() - 4, 4, ".m4s") != 0) {
+    return false;
+  }
+  for (const auto& video_config : config->video_configs) {
+    if (resource.compare(0, video_config->resource.size() + 1,
+                         video_config->resource + "/") == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+std::string StoreService::originPath(const std::string& resource) const {
+  for (const auto& video_config : config->video_configs) {
+    if (resource.compare(0, video_config->resource.size() + 1,
+                         video_config->resource + "/") == 0) {
+      return video_config->path + resource.substr(video_config->resource.size());
+    }
+  }
+  return resource;
+}
+
+void StoreService::loadSegment(const std::string& resource, LoadCallback callback) {
+  auto waiting = loading.find(resource);
+  if (waiting != loading.end()) {
+    waiting->second.push_back(std::move(callback));
+    return;
+  }
+  loading[resource].push_back(std::move(callback));
+
+  if (segment_cache != nullptr) {
+    segment_cache->Read(resource, base::BindOnce(
+      &StoreService::onCacheRead, weak_factory.GetWeakPtr(), resource));
+  } else {
+    onCacheRead(resource, base::nullopt, "");
+  }
+}
+
+void StoreService::onCacheRead(
+  const std::string& resource,
+  base::Optional<std::string> data,
+  const std::string& validator
+) {
+  // a cached segment is only revalidated against its source
+  std::string cached_validator = data ? validator : "";
+  loadSource(resource, cached_validator, base::BindOnce(
+    &StoreService::onSourceLoaded, weak_factory.GetWeakPtr(), resource, std::move(data)));
+}
+
+void StoreService::loadSource(
+  const std::string& resource,
+  const std::string& validator,
+  OriginFetcher::FetchCallback callback
+) {
+  if (origin != nullptr) {
+    origin->Fetch(originPath(resource), validator, std::move(callback));
+    return;
+  }
+  base::PostTaskAndReplyWithResult(
+    file_runner.get(), FROM_HERE,
+    base::BindOnce(&loadFile, segment_files[resource], validator),
+    std::move(callback));
+}
+
+void StoreService::onSourceLoaded(
+  const std::string& resource,
+  base::Optional<std::string> cached,
+  SourceResponse response
+) {
+  if (response.not_modified) {
+    onLoaded(resource, std::move(cached));
+    return;
+  }
+  if (!response.body) {
+    if (cached) {
+      ABRCC_LOG_EVERY_MS(WARNING, 1000) << "[Store] serving unvalidated " << resource;
+    } else {
+      ABRCC_LOG(WARNING) << "[Store] missing segment " << resource;
+    }
+    onLoaded(resource, std::move(cached));
+    return;
+  }
+  if (segment_cache != nullptr) {
+    // the segment is persisted for the next restarts
+    segment_cache->Write(resource, *response.body, response.validator);
+  }
+  onLoaded(resource, std::move(response.body));
+}
+
+void StoreService::onLoaded(const std::string& resource, base::Optional<std::string> data) {
+  if (data) {
+    observeSegment(resource, data->size());
+    // warming does not evict, the segments warmed first being played first
+    addToMemory(resource, *data, resource != warming);
+  }
+  std::vector<LoadCallback> callbacks = std::move(loading[resource]);
+  loading.erase(resource);
+  for (auto& callback : callbacks) {
+    std::move(callback).Run(data);
+  }
+}
+
+bool StoreService::parseSegment(const std::string& resource, int* quality, int* number) {
+  // segments are numbered from 1
+  if (resource.compare(0, 6, "/video") != 0) {
+    return false;
+  }
+  size_t slash = resource.find('/', 1);
+  size_t extension = resource.rfind(".m4s");
+  if (slash == std::string::npos || extension == std::string::npos || extension < slash) {
+    return false;
+  }
+  uint32_t parsed_quality, parsed_number;
+  if (!QuicTextUtils::StringToUint32(resource.substr(6, slash - 6), &parsed_quality)
+      || !QuicTextUtils::StringToUint32(
+           resource.substr(slash + 1, extension - slash - 1), &parsed_number)
+      || parsed_number == 0) {
+    return false;
+  }
+  *quality = parsed_quality;
+  *number = parsed_number;
+  return true;
+}
+
+void StoreService::observeSegment(const std::string& resource, int size) {
+  int quality, number;
+  if (predictor == nullptr || !parseSegment(resource, &quality, &number)) {
+    return;
+  }
+  predictor->Observe(quality, number - 1, size);
+}
+
+void StoreService::trackDelivery(
+  QuicSimpleServerBackend::RequestHandler* quic_stream,
+  const std::string& resource,
+  int size
+) {
+  int quality, number;
+  if (delivery == nullptr || !parseSegment(resource, &quality, &number)) {
+    return;
+  }
+  // the segment numbers are the decisions' indices
+  delivery->Track(quic_stream, number, quality, size);
+}
+
+bool StoreService::addToMemory(
+  const std::string& resource,
+  const std::string& data,
+  bool evict
+) {
+  if (fromMemory(resource) != nullptr) {
+    return true;
+  }
+  int64_t size = data.size();
+  if (size > segment_cache_config.memory_bytes
+      || (!evict && memory_used + size > segment_cache_config.memory_bytes)) {
+    return false;
+  }
+  while (memory_used + size > segment_cache_config.memory_bytes) {
+    memory_used -= memory.back().second.size();
+    memory_index.erase(memory.back().first);
+    memory.pop_back();
+  }
+  memory.emplace_front(resource, data);
+  memory_index[resource] = memory.begin();
+  memory_used += size;
+  return true;
+}
+
+const std::string* StoreService::fromMemory(const std::string& resource) {
+  auto it = memory_index.find(resource);
+  if (it == memory_index.end()) {
+    return nullptr;
+  }
+  memory.splice(memory.begin(), memory, it->second);
+  return &it->second->second;
+}
+
+void StoreService::onSegmentLoaded(
+  QuicSimpleServerBackend::RequestHandler* quic_stream,
+  int request,
+  const std::string& resource,
+  base::Optional<std::string> data
+) {
+  // the stream was closed, or the handler belongs to a later stream
+  auto waiting = pending.find(quic_stream);
+  if (waiting == pending.end() || waiting->second != request) {
+    return;
+  }
+  pending.erase(waiting);
+
+  if (!data) {
+    auto push_info = std::list<QuicBackendResponse::ServerPushInfo>();
+    quic_stream->OnResponseBackendComplete(nullptr, push_info);
+    return;
+  }
+
+  trackDelivery(quic_stream, resource, data->size());
+  respond(quic_stream, *data);
+}
+
+void StoreService::warm() {
+  if (origin != nullptr) {
+    // an edge fills its tiers on demand only
+    return;
+  }
+  if (warm_next >= warm_order.size()) {
+    ABRCC_LOG(WARNING) << "Warmed " << warm_next << " segments, " << memory_used
+                       << " bytes, into memory";
+    return;
+  }
+  warming = warm_order[warm_next++];
+  loadSegment(warming, base::BindOnce(
+    &StoreService::onWarmed, weak_factory.GetWeakPtr(), warming));
+}
+
+void StoreService::onWarmed(const std::string& resource, base::Optional<std::string> data) {
+  warming.clear();
+  if (data && memory_index.find(resource) == memory_index.end()) {
+    // the memory tier is full
+    warm_next = warm_order.size();
   }
-  QUIC_LOG(INFO) << "[String] " << string;
-  cache->FetchResponseFromBackend(request_headers, string, quic_stream);
+  warm();
 }
 
 }
@@ -1,8 +1,17 @@
 #ifndef ABRCC_SERVICE_STORE_H_
 #define ABRCC_SERVICE_STORE_H_
 
+#include <list>
+#include <map>
+
 #include "net/abrcc/dash_config.h"
+#include "net/abrcc/segment_predictor.h"
+#include "net/abrcc/service/delivery_service.h"
+#include "net/abrcc/service/origin_fetcher.h"
+#include "net/abrcc/service/segment_cache.h"
 
+#include "base/memory/weak_ptr.h"
+#include "base/sequenced_task_runner.h"
 #include "base/threading/thread.h"
 
 #include "net/third_party/quiche/src/quic/tools/quic_backend_response.h"
@@ -13,18 +22,48 @@
 namespace quic {
 
 // Store service for all video fragment and video metadata. 
+//
+// With a segment cache configured, the segments are stored in two tiers: the memory
+// tier holds up to `memory_bytes` of segments, warmed asynchronously in playback
+// order, while the rest are served from the persistent SegmentCache, falling back
+// to the raw files which are then written to the cache. Metadata always lives in
+// memory. Requests missing the memory tier are answered asynchronously on the
+// network thread. The memory tier evicts its least recently requested segments for
+// the ones loaded on demand, including the ones promoted from the segment cache.
+//
+// As an edge cache(SegmentCacheConfig::edge), the segments missing from the tiers
+// are fetched from the origin rather than read from files, and kept in the tiers
+// within their budgets. Concurrent misses of the same segment share a single load,
+// such that the origin sees one request per segment however many players ask.
+//
+// A segment read from the segment cache is revalidated against its source before
+// being served: its file's modification time and size, or the origin's ETag or
+// Last-Modified through a conditional request. A stale segment is loaded again; if
+// the source can not be reached, the cached segment is served.
+//
+// If the configuration does not describe all of its segments, the sizes of the
+// segments loaded by the store are fed to the title's SegmentPredictor.
+//
+// With a DeliveryService, the delivery of every segment answered by the store is
+// measured from the ACKs of its response.
 class StoreService {
  public:
   StoreService();
+  explicit StoreService(const SegmentCacheConfig& segment_cache_config);
   StoreService(const StoreService&) = delete;
   StoreService& operator=(const StoreService&) = delete;
   ~StoreService();
 
   // Load into memory all video segments from `dir_path` based on the configuration `config`. 
+  // With a segment cache, only registers the segments and starts warming the memory tier.
   void VideoFromConfig(const std::string& dir_path, std::shared_ptr<DashBackendConfig> config);
   // Load into memory all video metadata from `base_path` based on the configuration `config`. 
   void MetaFromConfig(const std::string& base_path, std::shared_ptr<DashBackendConfig> config);
 
+  // Whether the segments are served on demand by the tiers, rather than all loaded
+  // by VideoFromConfig; on-demand segments have to be registered on the network thread.
+  bool OnDemand() const;
+
   // Request handler that can handle usual DASH requests(that include both the quality band
   // and segment number in the request path).
   void FetchResponseFromBackend(
@@ -32,12 +71,78 @@ class StoreService {
     const std::string& string, 
     QuicSimpleServerBackend::RequestHandler* quic_stream
   );
+  // Drops the pending responses of a closed stream.
+  void CloseStream(QuicSimpleServerBackend::RequestHandler* quic_stream);
+  // Measures the delivery of the segments answered from now on.
+  void TrackDeliveries(std::shared_ptr<DeliveryService> delivery);
 
   std::unique_ptr<QuicMemoryCacheBackend> cache;
  private:
+  using LoadCallback = base::OnceCallback<void(base::Optional<std::string>)>;
+
+  // Whether `resource` is a segment served by the tiers.
+  bool isSegment(const std::string& resource) const;
+  // Path of a segment at the origin, which mirrors the layout of the video directory.
+  std::string originPath(const std::string& resource) const;
+  // Loads the body of `resource` from the segment cache, then from the origin or its
+  // file; loads of a resource already being loaded wait for the first one.
+  void loadSegment(const std::string& resource, LoadCallback callback);
+  void onCacheRead(const std::string& resource, base::Optional<std::string> data,
+                   const std::string& validator);
+  // Loads `resource` from the origin or its file, conditionally on `validator` if
+  // not empty.
+  void loadSource(const std::string& resource, const std::string& validator,
+                  OriginFetcher::FetchCallback callback);
+  void onSourceLoaded(const std::string& resource, base::Optional<std::string> cached,
+                      SourceResponse response);
+  void onLoaded(const std::string& resource, base::Optional<std::string> data);
+  // Parses a segment's resource, "/video<quality>/<number>.m4s"; returns false if
+  // `resource` is not a segment.
+  static bool parseSegment(const std::string& resource, int* quality, int* number);
+  // Feeds the size of a segment to the predictor.
+  void observeSegment(const std::string& resource, int size);
+  // Tracks the delivery of a segment about to be answered on `quic_stream`.
+  void trackDelivery(QuicSimpleServerBackend::RequestHandler* quic_stream,
+                     const std::string& resource, int size);
+  // Adds a segment to the memory tier if it fits the budget, evicting the least
+  // recently used segments to make room if `evict` is set.
+  bool addToMemory(const std::string& resource, const std::string& data, bool evict);
+  // Returns the body of a segment of the memory tier, marking it as recently used,
+  // or nullptr if the segment is not in memory.
+  const std::string* fromMemory(const std::string& resource);
+  void onSegmentLoaded(QuicSimpleServerBackend::RequestHandler* quic_stream, int request,
+                       const std::string& resource, base::Optional<std::string> data);
+  // Warms the memory tier one segment at a time.
+  void warm();
+  void onWarmed(const std::string& resource, base::Optional<std::string> data);
+
   std::shared_ptr<DashBackendConfig> config;
+  std::shared_ptr<SegmentPredictor> predictor;
+  std::shared_ptr<DeliveryService> delivery;
   std::string base_path;
   std::string dir_path;
+
+  SegmentCacheConfig segment_cache_config;
+  // whether the segments are served by the tiers rather than all held in memory
+  bool tiered;
+  std::unique_ptr<SegmentCache> segment_cache;
+  std::unique_ptr<OriginFetcher> origin;
+  scoped_refptr<base::SequencedTaskRunner> file_runner;
+  // files of the segments by resource, and the resources in playback order
+  std::map<std::string, std::string> segment_files;
+  std::vector<std::string> warm_order;
+  size_t warm_next;
+  // segment being warmed, which does not evict the segments warmed before
+  std::string warming;
+  // segments of the memory tier, the most recently used first
+  std::list<std::pair<std::string, std::string>> memory;
+  std::map<std::string, std::list<std::pair<std::string, std::string>>::iterator> memory_index;
+  int64_t memory_used;
+  // callbacks waiting for the segments being loaded
+  std::map<std::string, std::vector<LoadCallback>> loading;
+  // streams waiting for a segment, with the id of their request
+  std::map<QuicSimpleServerBackend::RequestHandler*, int> pending;
+  int next_request;
   
   void registerResource(
     const std::string& domain, 
@@ -53,6 +158,8 @@ class StoreService {
     const std::string& base_path,
     const std::string& resource,
     const int video_length);
+
+  base::WeakPtrFactory<StoreService> weak_factory;
 };
 
 }  
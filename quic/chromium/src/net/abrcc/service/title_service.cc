@@ -0,0 +1,235 @@
+#include "net/abrcc/service/title_service.h"
+
+#include <fstream>
+#include <string>
+#include <utility>
+
+#include "net/abrcc/logging/log.h"
+
+#include "base/bind.h"
+#include "base/task_runner_util.h"
+
+#include <sys/types.h>
+#include <dirent.h>
+
+namespace quic {
+
+TitleService::TitleService(
+  const std::string& titles_path,
+  const std::string& abr_type,
+  const std::string& site,
+  const std::string& minerva_config_path, // only used by Minerva
+  const std::string& pensieve_model_path, // only used by Pensieve
+  const SegmentCacheConfig& segment_cache
+) : titles_path(titles_path)
+  , abr_type(abr_type)
+  , site(site)
+  , minerva_config_path(minerva_config_path)
+  , pensieve_model_path(pensieve_model_path)
+  , segment_cache(segment_cache)
+  , last_collect(std::chrono::steady_clock::now())
+  , loader(new base::Thread("title loader"))
+  , weak_factory(this) {
+  CHECK(loader->Start());
+}
+TitleService::~TitleService() {}
+
+static std::unique_ptr<DashTitle> loadTitle(
+  const std::string& abr_type,
+  const std::string& config_path,
+  const std::string& site,
+  const std::string& minerva_config_path,
+  const std::string& pensieve_model_path,
+  const SegmentCacheConfig& segment_cache
+) {
+  std::unique_ptr<DashTitle> title(new DashTitle(
+    abr_type, config_path, site, minerva_config_path, pensieve_model_path,
+    segment_cache));
+  if (!title->configured()) {
+    return nullptr;
+  }
+  title->Load();
+  return title;
+}
+
+std::vector<std::string> TitleService::Reload() {
+  std::vector<std::string> names;
+  DIR *dr = opendir(titles_path.c_str());
+  if (dr == NULL) {
+    // keep serving the current titles
+    ABRCC_LOG(WARNING) << "[Titles] cannot open " << titles_path;
+    for (auto &title : titles) {
+      names.push_back(title.first);
+    }
+    return names;
+  }
+
+  auto now = std::chrono::steady_clock::now();
+  std::map<std::string, std::unique_ptr<Entry>> scanned;
+  struct dirent *en;
+  while ((en = readdir(dr)) != NULL) {
+    std::string name(en->d_name);
+    if (name.empty() || name[0] == '.') {
+      continue;
+    }
+    std::string config_path = titles_path + "/" + name + "/" + TitleConstants::config_file;
+    if (!std::ifstream(config_path).good()) {
+      continue;
+    }
+
+    // titles already known keep their state, including the retired ones which
+    // were not stopped yet
+    auto active = titles.find(name);
+    auto old = FindRetired(name);
+    if (active != titles.end()) {
+      scanned[name] = std::move(active->second);
+      titles.erase(active);
+    } else if (old != retired.end()) {
+      scanned[name] = std::move(old->second);
+      retired.erase(old);
+    } else {
+      scanned[name] = std::unique_ptr<Entry>(
+        new Entry{config_path, nullptr, now, false, false});
+    }
+    names.push_back(name);
+  }
+  closedir(dr);
+
+  // the removed titles which serve sessions are retired, the others are dropped;
+  // a title still loading is dropped once loaded
+  for (auto &title : titles) {
+    if (title.second->title != nullptr) {
+      ABRCC_LOG(INFO) << "[Titles] retiring " << title.first;
+      retired.emplace(title.first, std::move(title.second));
+    }
+  }
+  titles.swap(scanned);
+
+  ABRCC_LOG(INFO) << "[Titles] " << titles.size() << " titles, "
+                  << retired.size() << " retired";
+  return names;
+}
+
+DashTitle* TitleService::Resolve(
+  const std::string& path,
+  std::string* rest,
+  bool* loading
+) {
+  Collect();
+  if (path.size() < 2 || path[0] != '/') {
+    return nullptr;
+  }
+  size_t end = path.find('/', 1);
+  std::string name = path.substr(1, end == std::string::npos ? end : end - 1);
+  *rest = end == std::string::npos ? "/" : path.substr(end);
+
+  auto now = std::chrono::steady_clock::now();
+  auto active = titles.find(name);
+  if (active != titles.end()) {
+    Entry* entry = active->second.get();
+    entry->last_request = now;
+    if (entry->title == nullptr) {
+      if (!entry->loading) {
+        Load(name, entry);
+      }
+      if (loading != nullptr) {
+        *loading = true;
+      }
+      return nullptr;
+    }
+    return entry->title.get();
+  }
+
+  // retired titles only finish their sessions
+  auto old = FindRetired(name);
+  if (old != retired.end() && !old->second->title->IsEntryPath(*rest)) {
+    old->second->last_request = now;
+    return old->second->title.get();
+  }
+  return nullptr;
+}
+
+void TitleService::Load(const std::string& name, Entry* entry) {
+  ABRCC_LOG(INFO) << "[Titles] loading " << name << " from " << entry->config_path;
+  entry->loading = true;
+
+  // the origin serves the titles under the same paths as the edge
+  SegmentCacheConfig title_cache = segment_cache;
+  if (title_cache.edge()) {
+    title_cache.origin_url += "/" + name;
+  }
+  base::PostTaskAndReplyWithResult(
+    loader->task_runner().get(), FROM_HERE,
+    base::BindOnce(&loadTitle, abr_type, entry->config_path, site,
+                   minerva_config_path, pensieve_model_path, title_cache),
+    base::BindOnce(&TitleService::OnLoaded, weak_factory.GetWeakPtr(), name));
+}
+
+void TitleService::OnLoaded(const std::string& name, std::unique_ptr<DashTitle> title) {
+  auto active = titles.find(name);
+  if (active == titles.end() || !active->second->loading) {
+    ABRCC_LOG(INFO) << "[Titles] dropping " << name << ", removed while loading";
+    return;
+  }
+  if (title == nullptr) {
+    // skipped until the next reload, which may find the configuration fixed
+    ABRCC_LOG(WARNING) << "[Titles] skipping " << name << ", malformed configuration";
+    titles.erase(active);
+    return;
+  }
+  Entry* entry = active->second.get();
+  entry->loading = false;
+  entry->title = std::move(title);
+  entry->title->Initialize();
+  ABRCC_LOG(INFO) << "[Titles] loaded " << name;
+}
+
+void TitleService::CloseStream(QuicSimpleServerBackend::RequestHandler* quic_stream) {
+  for (auto &title : titles) {
+    if (title.second->title != nullptr) {
+      title.second->title->CloseBackendResponseStream(quic_stream);
+    }
+  }
+  for (auto &title : retired) {
+    title.second->title->CloseBackendResponseStream(quic_stream);
+  }
+}
+
+std::multimap<std::string, std::unique_ptr<TitleService::Entry>>::iterator
+TitleService::FindRetired(const std::string& name) {
+  auto range = retired.equal_range(name);
+  for (auto it = range.first; it != range.second; ++it) {
+    if (!it->second->stopping) {
+      return it;
+    }
+  }
+  return retired.end();
+}
+
+void TitleService::Collect() {
+  auto now = std::chrono::steady_clock::now();
+  if (retired.empty()
+      || now - last_collect < std::chrono::milliseconds(TitleConstants::collect_period_ms)) {
+    return;
+  }
+  last_collect = now;
+
+  for (auto it = retired.begin(); it != retired.end();) {
+    Entry* entry = it->second.get();
+    if (!entry->stopping
+        && now - entry->last_request
+           > std::chrono::milliseconds(TitleConstants::retire_idle_ms)) {
+      entry->title->Stop();
+      entry->stopping = true;
+    }
+    // the ABR loop has exited, so destroying the title does not block
+    if (entry->stopping && entry->title->stopped()) {
+      ABRCC_LOG(INFO) << "[Titles] unloading " << it->first;
+      it = retired.erase(it);
+    } else {
+      ++it;
+    }
+  }
+}
+
+}
@@ -0,0 +1,103 @@
+#ifndef ABRCC_SERVICE_TITLE_H_
+#define ABRCC_SERVICE_TITLE_H_
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "net/abrcc/dash_title.h"
+
+#include "base/memory/weak_ptr.h"
+#include "base/threading/thread.h"
+
+namespace quic {
+
+namespace TitleConstants {
+  // admin endpoint rescanning the titles directory; as directories starting with
+  // a dot are not titles, it can not shadow one
+  const std::string reload_path = "/.titles/reload";
+  // configuration file of a title within its directory
+  const std::string config_file = "config.json";
+  // a removed title is unloaded after not being requested for `retire_idle_ms`
+  const int retire_idle_ms = 60000;
+  // retired titles are checked at most every `collect_period_ms`
+  const int collect_period_ms = 1000;
+}
+
+// Catalog of the titles served from a directory: the title <name> is configured by
+// `<titles_path>/<name>/config.json` and served under the paths "/<name>/...".
+//
+// Titles are loaded lazily, on their first request: the title is built and its
+// files read on a loader thread, while its requests are answered as unavailable,
+// then it is started on the network thread. A title whose configuration can not be
+// parsed is skipped until the next reload. Reload rescans the directory and
+// swaps the set of titles at once: new titles become available and removed titles
+// are retired. A retired title still serves its ongoing sessions, but does not start
+// new ones(see DashTitle::IsEntryPath); it is unloaded once idle.
+//
+// All the methods have to be called on the network thread.
+class TitleService {
+ public:
+  TitleService(
+    const std::string& titles_path,
+    const std::string& abr_type,
+    const std::string& site,
+    const std::string& minerva_config_path, // only used by Minerva
+    const std::string& pensieve_model_path, // only used by Pensieve
+    const SegmentCacheConfig& segment_cache
+  );
+  TitleService(const TitleService&) = delete;
+  TitleService& operator=(const TitleService&) = delete;
+  ~TitleService();
+
+  // Rescans the titles directory and returns the names of the available titles.
+  std::vector<std::string> Reload();
+
+  // Returns the title serving `path` and sets `rest` to the path within the title.
+  // Returns nullptr if no title serves the path, or if the title is still being
+  // loaded, in which case `loading` is set.
+  DashTitle* Resolve(const std::string& path, std::string* rest, bool* loading = nullptr);
+
+  // Forwards the closing of a stream to the loaded titles.
+  void CloseStream(QuicSimpleServerBackend::RequestHandler* quic_stream);
+ private:
+  struct Entry {
+    std::string config_path;
+    std::unique_ptr<DashTitle> title;
+    std::chrono::steady_clock::time_point last_request;
+    bool stopping;
+    bool loading;
+  };
+
+  // Starts loading the title `name` on the loader thread.
+  void Load(const std::string& name, Entry* entry);
+  // Starts the loaded title, unless it was removed meanwhile.
+  void OnLoaded(const std::string& name, std::unique_ptr<DashTitle> title);
+
+  // Returns the retired title `name` which can still serve requests, if any.
+  std::multimap<std::string, std::unique_ptr<Entry>>::iterator FindRetired(
+    const std::string& name);
+  // Stops the retired titles which became idle and unloads the stopped ones.
+  void Collect();
+
+  std::string titles_path;
+  std::string abr_type;
+  std::string site;
+  std::string minerva_config_path;
+  std::string pensieve_model_path;
+  SegmentCacheConfig segment_cache;
+
+  std::map<std::string, std::unique_ptr<Entry>> titles;
+  // a title removed and added again can be retired more than once
+  std::multimap<std::string, std::unique_ptr<Entry>> retired;
+  std::chrono::steady_clock::time_point last_collect;
+
+  std::unique_ptr<base::Thread> loader;
+  base::WeakPtrFactory<TitleService> weak_factory;
+};
+
+}
+
+#endif
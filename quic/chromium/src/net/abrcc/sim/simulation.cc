@@ -0,0 +1,319 @@
+#include "net/abrcc/sim/simulation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+#include "base/optional.h"
+#include "base/time/time.h"
+
+#include "net/abrcc/abr/abr.h"
+#include "net/abrcc/abr/abr_robust_mpc.h"
+#include "net/abrcc/cc/cc_selector.h"
+#include "net/abrcc/cc/cc_wrapper.h"
+#include "net/abrcc/service/schema.h"
+
+#include "net/third_party/quiche/src/quic/core/quic_constants.h"
+#include "net/third_party/quiche/src/quic/test_tools/quic_test_utils.h"
+#include "net/third_party/quiche/src/quic/test_tools/simulator/link.h"
+#include "net/third_party/quiche/src/quic/test_tools/simulator/quic_endpoint.h"
+#include "net/third_party/quiche/src/quic/test_tools/simulator/simulator.h"
+#include "net/third_party/quiche/src/quic/test_tools/simulator/switch.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+namespace {
+  // the server's link is not a bottleneck
+  const int server_link_factor = 10;
+
+  // the bottleneck queue holds at least a few packets
+  const int min_queue_packets = 4;
+}
+
+namespace quic {
+
+SimulationConfig::SimulationConfig()
+  : rtt(QuicTime::Delta::FromMilliseconds(40))
+  , queue(QuicTime::Delta::FromMilliseconds(40))
+  , max_buffer(QuicTime::Delta::FromSeconds(60))
+  , max_duration(QuicTime::Delta::FromSeconds(600))
+  , max_segments(0)
+  , seed(0)
+  , decision_log(nullptr) {}
+
+SimulationResult::SimulationResult()
+  : segments(0)
+  , qoe(0)
+  , vmaf_qoe(0)
+  , average_bitrate(0)
+  , rebuffer(0)
+  , utilization(0)
+  , switches(0)
+  , decisions(0)
+  , decision_cpu_mean(0)
+  , decision_cpu_max(0)
+  , virtual_time(0) {}
+
+// CPU time of the calling thread(us); the wall time if it is not supported.
+static double cpuTime() {
+  if (base::ThreadTicks::IsSupported()) {
+    return (base::ThreadTicks::Now() - base::ThreadTicks()).InMicrosecondsF();
+  }
+  return (base::TimeTicks::Now() - base::TimeTicks()).InMicrosecondsF();
+}
+
+AbrSimulation::AbrSimulation(
+  const std::shared_ptr<DashBackendConfig>& config,
+  const BandwidthTrace* trace,
+  const SimulationConfig& simulation_config
+) : config(config), trace(trace), simulation_config(simulation_config)
+  , catalog(VideoCatalog::ForConfig(config.get())) {
+  // the qualities are indexed as by SegmentProgressAbr
+  total_segments = std::min(config->segments, catalog->segments());
+  if (simulation_config.max_segments > 0) {
+    total_segments = std::min(total_segments, simulation_config.max_segments);
+  }
+}
+
+AbrSimulation::~AbrSimulation() {}
+
+int AbrSimulation::segmentSize(int index, int quality) const {
+  return catalog->size(quality, index - 1);
+}
+
+double AbrSimulation::segmentVmaf(int index, int quality) const {
+  return catalog->vmaf(quality, index - 1);
+}
+
+double AbrSimulation::segmentDuration(int index) const {
+  if (index < catalog->segments()) {
+    return 1000 * (catalog->startTime(0, index) - catalog->startTime(0, index - 1));
+  }
+  if (index > 1) {
+    return 1000 * (catalog->startTime(0, index - 1) - catalog->startTime(0, index - 2));
+  }
+  return SimulationConstants::default_segment_length_ms;
+}
+
+SimulationResult AbrSimulation::Run() {
+  SimulationResult result;
+  if (catalog->qualities() == 0 || total_segments <= 0) {
+    return result;
+  }
+
+  // RandomAbr and WorthedAbr draw from rand()
+  srand(simulation_config.seed);
+  simulator::Simulator simulator;
+  test::SimpleRandom random;
+  random.set_seed(simulation_config.seed);
+  simulator.set_random_generator(&random);
+  CCSelector::GetInstance()->setCongestionControlType(simulation_config.cc_type);
+
+  QuicBandwidth max_bandwidth = QuicBandwidth::Zero();
+  for (const auto& point : trace->points()) {
+    max_bandwidth = std::max(max_bandwidth, point.bandwidth);
+  }
+  QuicByteCount queue_capacity = std::max(
+    trace->meanBandwidth().ToBytesPerPeriod(simulation_config.queue),
+    QuicByteCount(min_queue_packets * kMaxOutgoingPacketSize));
+  simulator::Switch network_switch(&simulator, "Switch", 8, queue_capacity);
+
+  simulator::QuicEndpoint client(&simulator, "Client", "Server", Perspective::IS_CLIENT,
+                                 test::TestConnectionId(42));
+  simulator::QuicEndpoint server(&simulator, "Server", "Client", Perspective::IS_SERVER,
+                                 test::TestConnectionId(42));
+
+  // the bottleneck is the link between the switch and the client
+  QuicTime::Delta link_delay = simulation_config.rtt * 0.25;
+  simulator::SymmetricLink server_link(&server, network_switch.port(1),
+                                       max_bandwidth * server_link_factor, link_delay);
+  simulator::SymmetricLink client_link(&client, network_switch.port(2),
+                                       trace->points().front().bandwidth, link_delay);
+  TraceDrivenLink trace_link(&simulator, "Trace", &client_link, trace);
+
+  std::unique_ptr<AbrInterface> abr(getAbr(
+    simulation_config.abr_type, config,
+    simulation_config.minerva_config_path,
+    simulation_config.pensieve_model_path));
+
+  // the ABR steers the server's sender, as in the dash_server
+  abr_schema::Session session;
+  session.interfaces = static_cast<const CCWrapper*>(
+    server.connection()->sent_packet_manager().GetSendAlgorithm())->interfaces();
+  abr->registerSession(session);
+
+  // the inputs of the Python baselines, for the decision log
+  PlayerTracker tracker;
+  int last_logged = 0;
+
+  const QuicTime start = simulator.GetClock()->Now();
+  const QuicTime::Delta step = QuicTime::Delta::FromMilliseconds(
+    SimulationConstants::step_ms);
+
+  // segments are indexed from 1, as the decisions
+  std::vector<SegmentState> state(total_segments + 1);
+  std::vector<double> segment_rebuffer(total_segments + 1, 0);
+  base::Optional<abr_schema::Decision> pending;
+  int next_index = 1;
+  int downloaded = 0;
+  int reported = 0;
+  uint64_t requested = 0;
+
+  double buffer_ms = 0;
+  double player_ms = 0;
+  double stall_ms = 0;
+  double total_stall_ms = 0;
+  bool playing = false;
+
+  QuicByteCount capacity = 0;
+  double decision_cpu_total = 0;
+  int64_t next_metrics_ms = 0;
+
+  while (downloaded < total_segments &&
+         simulator.GetClock()->Now() - start < simulation_config.max_duration) {
+    int64_t now_ms = (simulator.GetClock()->Now() - start).ToMilliseconds();
+    uint64_t received = client.bytes_received();
+
+    // front-end metrics
+    if (now_ms >= next_metrics_ms) {
+      next_metrics_ms += SimulationConstants::metrics_period_ms;
+
+      abr_schema::Metrics metrics;
+      metrics.bufferLevel.push_back(std::unique_ptr<abr_schema::Value>(
+        new abr_schema::Value(int(buffer_ms), int(now_ms))));
+      metrics.playerTime.push_back(std::unique_ptr<abr_schema::Value>(
+        new abr_schema::Value(int(player_ms), int(now_ms))));
+      metrics.droppedFrames.push_back(std::unique_ptr<abr_schema::Value>(
+        new abr_schema::Value(0, int(now_ms))));
+
+      for (int index = reported + 1; index < next_index; ++index) {
+        SegmentState& segment = state[index];
+        int total = segmentSize(index, segment.quality);
+        uint64_t begin = segment.end_offset - total;
+        int loaded = received <= begin ? 0 : int(std::min(received - begin, uint64_t(total)));
+
+        std::unique_ptr<abr_schema::Segment> update(new abr_schema::Segment());
+        update->index = index;
+        update->timestamp = int(now_ms);
+        update->loaded = loaded;
+        update->total = total;
+        update->quality = segment.quality;
+        if (loaded == total) {
+          update->state = abr_schema::Segment::DOWNLOADED;
+          reported = index;
+        } else if (!segment.reported_loading) {
+          update->state = abr_schema::Segment::LOADING;
+          segment.reported_loading = true;
+        } else {
+          update->state = abr_schema::Segment::PROGRESS;
+        }
+        metrics.segments.push_back(std::move(update));
+      }
+      tracker.registerMetrics(metrics);
+      abr->registerMetrics(metrics);
+    }
+
+    // ABR loop
+    double cpu_start = cpuTime();
+    abr_schema::Decision decision = abr->decide();
+    double cpu = cpuTime() - cpu_start;
+    decision_cpu_total += cpu;
+    result.decision_cpu_max = std::max(result.decision_cpu_max, cpu);
+    result.decisions += 1;
+
+    if (simulation_config.decision_log != nullptr && !decision.noop() &&
+        decision.index > last_logged) {
+      last_logged = decision.index;
+      fprintf(simulation_config.decision_log, "%s,%s,%s,%d,%d,%d,%d,%.17g,%d\n",
+              trace->name().c_str(), simulation_config.cc_type.c_str(),
+              simulation_config.abr_type.c_str(), int(simulation_config.seed),
+              decision.index, decision.quality, tracker.bufferLevel(),
+              tracker.lastThroughput(*catalog), tracker.lastFetchTime());
+    }
+
+    if (!decision.noop() && decision.index == next_index && pending == base::nullopt) {
+      pending = decision;
+    }
+    if (pending != base::nullopt && buffer_ms < simulation_config.max_buffer.ToMilliseconds()) {
+      int quality = std::max(0, std::min(catalog->qualities() - 1, pending->quality));
+      int size = segmentSize(next_index, quality);
+      requested += size;
+      state[next_index] = SegmentState{quality, requested, false};
+      server.AddBytesToTransfer(size);
+
+      next_index += 1;
+      pending = base::nullopt;
+    }
+
+    // the capacity is only accounted for while a segment is in flight
+    if (requested > received) {
+      capacity += trace->capacity(trace_link.elapsed(), trace_link.elapsed() + step);
+    }
+    simulator.RunFor(step);
+
+    // player
+    double played = playing ? std::min(buffer_ms, double(SimulationConstants::step_ms)) : 0;
+    buffer_ms -= played;
+    player_ms += played;
+    if (playing && played < SimulationConstants::step_ms) {
+      stall_ms += SimulationConstants::step_ms - played;
+    }
+
+    received = client.bytes_received();
+    while (downloaded + 1 < next_index && received >= state[downloaded + 1].end_offset) {
+      downloaded += 1;
+      buffer_ms += segmentDuration(downloaded);
+      segment_rebuffer[downloaded] = stall_ms;
+      total_stall_ms += stall_ms;
+      stall_ms = 0;
+      playing = true;
+    }
+  }
+  total_stall_ms += stall_ms;
+
+  // QoE of the downloaded segments, as in exp/components/monitor.py
+  double qoe = 0, vmaf_qoe = 0, bitrate = 0;
+  for (int index = 1; index <= downloaded; ++index) {
+    int quality = state[index].quality;
+    double rebuffer = segment_rebuffer[index] / 1000;
+    double segment_bitrate = catalog->trackBitrate(quality);
+    double vmaf = segmentVmaf(index, quality);
+
+    double switch_bitrate = 0, switch_vmaf = 0;
+    if (index > 1) {
+      int previous = state[index - 1].quality;
+      switch_bitrate = fabs(segment_bitrate - catalog->trackBitrate(previous));
+      switch_vmaf = fabs(vmaf - segmentVmaf(index - 1, previous));
+      result.switches += previous != quality;
+    }
+
+    bitrate += segment_bitrate;
+    qoe += segment_bitrate / 1000
+      - SimulationConstants::rebuffer_penalty * rebuffer
+      - SimulationConstants::switch_penalty * switch_bitrate / 1000;
+    vmaf_qoe += vmaf
+      - SimulationConstants::vmaf_rebuffer_penalty * rebuffer
+      - SimulationConstants::vmaf_switch_penalty * switch_vmaf;
+  }
+
+  result.segments = downloaded;
+  if (downloaded > 0) {
+    result.qoe = qoe / downloaded;
+    result.vmaf_qoe = vmaf_qoe / downloaded;
+    result.average_bitrate = bitrate / downloaded;
+  }
+  result.rebuffer = total_stall_ms / 1000;
+  if (capacity > 0) {
+    result.utilization = std::min(1., 1. * client.bytes_received() / capacity);
+  }
+  if (result.decisions > 0) {
+    result.decision_cpu_mean = decision_cpu_total / result.decisions;
+  }
+  result.virtual_time = (simulator.GetClock()->Now() - start).ToMicroseconds() / 1e6;
+  return result;
+}
+
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,130 @@
+#ifndef ABRCC_SIM_SIMULATION_H_
+#define ABRCC_SIM_SIMULATION_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "net/abrcc/abr/interface.h"
+#include "net/abrcc/dash_config.h"
+#include "net/abrcc/sim/trace.h"
+#include "net/abrcc/video_catalog.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+
+namespace quic {
+
+namespace SimulationConstants {
+  // period of the player model and of the ABR loop(ms)
+  const int step_ms = 20;
+
+  // period of the front-end metrics(ms)
+  const int metrics_period_ms = 100;
+
+  // duration of the last segment(ms), if the video has a single segment
+  const int default_segment_length_ms = 4000;
+
+  // QoE penalties, as in exp/components/monitor.py
+  const double rebuffer_penalty = 4.3;
+  const double switch_penalty = 1.0;
+  const double vmaf_rebuffer_penalty = 100;
+  const double vmaf_switch_penalty = 2.5;
+}
+
+struct SimulationConfig {
+  std::string cc_type;
+  std::string abr_type;
+  std::string minerva_config_path; // only used by Minerva
+  std::string pensieve_model_path; // only used by Pensieve
+
+  QuicTime::Delta rtt;
+  // bottleneck queue, as time at the trace's mean bandwidth
+  QuicTime::Delta queue;
+  // no segment is requested while the buffer is above `max_buffer`
+  QuicTime::Delta max_buffer;
+  // the simulation stops after `max_duration` of virtual time
+  QuicTime::Delta max_duration;
+  // number of simulated segments; all the video's segments if 0
+  int max_segments;
+  uint64_t seed;
+  // if not nullptr, one CSV row per decision with the inputs of the Python
+  // baselines in `exp/abr`, as checked by `exp/abr/parity.py`
+  FILE* decision_log;
+
+  SimulationConfig();
+};
+
+struct SimulationResult {
+  int segments;
+  // mean per-segment QoE
+  double qoe;
+  double vmaf_qoe;
+  double average_bitrate; // kbps
+  double rebuffer;        // s
+  // bytes delivered over the bottleneck's capacity while a segment was in flight
+  double utilization;
+  int switches;
+
+  int decisions;
+  // CPU time of AbrInterface::decide(us)
+  double decision_cpu_mean;
+  double decision_cpu_max;
+
+  double virtual_time;    // s
+
+  SimulationResult();
+};
+
+// Trace-driven simulation of a DASH session on quiche's simulator, in virtual time.
+//
+// The server's QuicEndpoint sends the segments to the client's endpoint through a
+// bottleneck link which replays `trace`; the server's congestion control is picked
+// by the CCSelector from `cc_type`, so that the controllers sharing state with the
+// ABR(e.g. target, gap) are attached as in the dash_server. The ABR is driven by the
+// metrics of a player model which mirrors the front-end:
+//   - metrics are registered every metrics_period_ms, decisions are polled every
+//     step_ms, as by the AbrLoop
+//   - a decided segment is fetched after the previous ones, on the same stream
+//   - playback starts with the first segment and stalls on an empty buffer
+//
+// The decision log holds, per decision, the getters' values the front-end would send
+// the Python baselines(see PlayerTracker), taken before the decision as by the ABR.
+class AbrSimulation {
+ public:
+  AbrSimulation(const std::shared_ptr<DashBackendConfig>& config,
+                const BandwidthTrace* trace,
+                const SimulationConfig& simulation_config);
+  ~AbrSimulation();
+
+  SimulationResult Run();
+ private:
+  struct SegmentState {
+    int quality;
+    // offset in the stream at which the segment ends
+    uint64_t end_offset;
+    bool reported_loading;
+  };
+
+  int segmentSize(int index, int quality) const;
+  double segmentVmaf(int index, int quality) const;
+  // duration(ms) from the start times of consecutive segments
+  double segmentDuration(int index) const;
+
+  std::shared_ptr<DashBackendConfig> config;
+  const BandwidthTrace* trace;
+  SimulationConfig simulation_config;
+
+  // segment information per quality, indexed as the ABR's decisions
+  std::shared_ptr<const VideoCatalog> catalog;
+  int total_segments;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
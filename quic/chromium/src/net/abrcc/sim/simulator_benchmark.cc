@@ -0,0 +1,230 @@
+// Trace-driven benchmark of the congestion controls and ABRs on quiche's simulator.
+//
+// Every combination of trace, CC, ABR and seed runs an AbrSimulation in virtual
+// time, so that hundreds of sessions take seconds. One CSV row is printed per run;
+// the wall time of the whole benchmark is printed to stderr.
+//
+// Runs share the process, hence the state of its singletons(e.g. the CCSelector);
+// they are executed in a fixed order, such that the benchmark is deterministic for
+// a seed, with the exception of Minerva, which updates on wall-clock time.
+//
+// Usage: abrcc_simulator_benchmark --video_config=<config.json>
+//          --traces=exp/network_traces/bus.txt,exp/network_traces/car.txt
+//          --cc_types=bbr,target --abr_types=bb,target [options] > results.csv
+//
+// With --decision_log, the decisions of robustmpc and pensieve can be checked against
+// the Python baselines: python3 -m abr.parity <decision_log> --video <title>, run
+// from the folder `exp`.
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "base/json/json_reader.h"
+#include "base/json/json_value_converter.h"
+#include "base/strings/string_split.h"
+
+#include "net/abrcc/dash_config.h"
+#include "net/abrcc/sim/simulation.h"
+#include "net/abrcc/structs/bandwidth_trace.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_flags.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_system_event_loop.h"
+
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    video_config,
+    "",
+    "Specifies the path to the JSON configuration of the video, "
+    "as used by the dash_server.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    traces,
+    "",
+    "Comma-separated paths of the bandwidth traces, in the "
+    "format of exp/network_traces.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    cc_types,
+    "bbr",
+    "Comma-separated congestion control types.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    abr_types,
+    "bb",
+    "Comma-separated abr types.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    minerva_config_path,
+    "",
+    "Specifies the path to the directory of Minerva configuration "
+    "paths.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    pensieve_model_path,
+    "",
+    "Specifies the path to the Pensieve actor weights exported "
+    "by exp/abr/export_pensieve.py.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              rtt_ms,
+                              40,
+                              "Round-trip propagation delay(ms).");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              queue_ms,
+                              40,
+                              "Bottleneck queue, as time at the trace's "
+                              "mean bandwidth(ms).");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              max_buffer_ms,
+                              60000,
+                              "Player buffer above which no segment "
+                              "is requested(ms).");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              max_duration_s,
+                              600,
+                              "Virtual time after which a run stops(s).");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              max_segments,
+                              0,
+                              "Number of segments per run; all if 0.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              seed,
+                              0,
+                              "Seed of the first run.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(int32_t,
+                              seeds,
+                              1,
+                              "Runs per trace, CC and ABR, with "
+                              "consecutive seeds.");
+DEFINE_QUIC_COMMAND_LINE_FLAG(
+    std::string,
+    decision_log,
+    "",
+    "Specifies a CSV file to which every decision is written with the "
+    "inputs of the Python baselines, for exp/abr/parity.py.");
+
+namespace {
+
+std::vector<std::string> split(const std::string& value) {
+  return base::SplitString(value, ",", base::TRIM_WHITESPACE,
+                           base::SPLIT_WANT_NONEMPTY);
+}
+
+std::shared_ptr<quic::DashBackendConfig> load_config(const std::string& path) {
+  std::ifstream stream(path);
+  if (!stream.is_open()) {
+    return nullptr;
+  }
+  std::stringstream buffer;
+  buffer << stream.rdbuf();
+
+  base::Optional<base::Value> value = base::JSONReader::Read(buffer.str());
+  if (!value) {
+    return nullptr;
+  }
+  auto config = std::shared_ptr<quic::DashBackendConfig>(new quic::DashBackendConfig());
+  base::JSONValueConverter<quic::DashBackendConfig> converter;
+  if (!converter.Convert(*value, config.get())) {
+    return nullptr;
+  }
+  return config;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+  QuicSystemEventLoop event_loop("abrcc_simulator_benchmark");
+  const char* usage = "Usage: abrcc_simulator_benchmark [options]";
+  std::vector<std::string> non_option_args =
+      quic::QuicParseCommandLineFlags(usage, argc, argv);
+  if (!non_option_args.empty()) {
+    quic::QuicPrintCommandLineFlagHelp(usage);
+    exit(0);
+  }
+
+  auto config = load_config(GetQuicFlag(FLAGS_video_config));
+  if (config == nullptr) {
+    fprintf(stderr, "can not read video config: %s\n",
+            GetQuicFlag(FLAGS_video_config).c_str());
+    return 1;
+  }
+
+  std::vector<std::unique_ptr<quic::BandwidthTrace>> traces;
+  for (const auto& path : split(GetQuicFlag(FLAGS_traces))) {
+    auto trace = quic::BandwidthTrace::FromFile(path);
+    if (trace == nullptr) {
+      fprintf(stderr, "can not read trace: %s\n", path.c_str());
+      return 1;
+    }
+    traces.push_back(std::move(trace));
+  }
+
+  quic::SimulationConfig simulation_config;
+  simulation_config.minerva_config_path = GetQuicFlag(FLAGS_minerva_config_path);
+  simulation_config.pensieve_model_path = GetQuicFlag(FLAGS_pensieve_model_path);
+  simulation_config.rtt = quic::QuicTime::Delta::FromMilliseconds(GetQuicFlag(FLAGS_rtt_ms));
+  simulation_config.queue = quic::QuicTime::Delta::FromMilliseconds(GetQuicFlag(FLAGS_queue_ms));
+  simulation_config.max_buffer =
+    quic::QuicTime::Delta::FromMilliseconds(GetQuicFlag(FLAGS_max_buffer_ms));
+  simulation_config.max_duration =
+    quic::QuicTime::Delta::FromSeconds(GetQuicFlag(FLAGS_max_duration_s));
+  simulation_config.max_segments = GetQuicFlag(FLAGS_max_segments);
+
+  std::unique_ptr<FILE, int (*)(FILE*)> decision_log(nullptr, &fclose);
+  if (!GetQuicFlag(FLAGS_decision_log).empty()) {
+    decision_log.reset(fopen(GetQuicFlag(FLAGS_decision_log).c_str(), "w"));
+    if (decision_log == nullptr) {
+      fprintf(stderr, "can not create decision log: %s\n",
+              GetQuicFlag(FLAGS_decision_log).c_str());
+      return 1;
+    }
+    fprintf(decision_log.get(), "trace,cc,abr,seed,index,quality,buffer_ms,"
+            "bandwidth_kbps,last_fetch_time_ms\n");
+    simulation_config.decision_log = decision_log.get();
+  }
+
+  printf("trace,cc,abr,seed,segments,qoe,vmaf_qoe,avg_bitrate,rebuffer_s,utilization,"
+         "switches,decisions,decision_cpu_us_mean,decision_cpu_us_max,virtual_s,wall_ms\n");
+
+  auto benchmark_start = std::chrono::steady_clock::now();
+  int runs = 0;
+  for (const auto& trace : traces) {
+    for (const auto& cc_type : split(GetQuicFlag(FLAGS_cc_types))) {
+      for (const auto& abr_type : split(GetQuicFlag(FLAGS_abr_types))) {
+        for (int i = 0; i < GetQuicFlag(FLAGS_seeds); ++i) {
+          simulation_config.cc_type = cc_type;
+          simulation_config.abr_type = abr_type;
+          simulation_config.seed = GetQuicFlag(FLAGS_seed) + i;
+
+          auto start = std::chrono::steady_clock::now();
+          quic::AbrSimulation simulation(config, trace.get(), simulation_config);
+          quic::SimulationResult result = simulation.Run();
+          auto end = std::chrono::steady_clock::now();
+
+          printf("%s,%s,%s,%d,%d,%.3f,%.3f,%.1f,%.3f,%.3f,%d,%d,%.2f,%.2f,%.3f,%.1f\n",
+                 trace->name().c_str(), cc_type.c_str(), abr_type.c_str(),
+                 int(simulation_config.seed), result.segments, result.qoe,
+                 result.vmaf_qoe, result.average_bitrate, result.rebuffer,
+                 result.utilization, result.switches, result.decisions,
+                 result.decision_cpu_mean, result.decision_cpu_max,
+                 result.virtual_time,
+                 std::chrono::duration<double, std::milli>(end - start).count());
+          fflush(stdout);
+          runs += 1;
+        }
+      }
+    }
+  }
+  auto benchmark_end = std::chrono::steady_clock::now();
+  fprintf(stderr, "%d runs in %.2f s\n", runs,
+          std::chrono::duration<double>(benchmark_end - benchmark_start).count());
+  return 0;
+}
+
+#pragma GCC diagnostic pop
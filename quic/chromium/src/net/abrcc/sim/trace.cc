@@ -0,0 +1,45 @@
+#include "net/abrcc/sim/trace.h"
+
+#include "net/third_party/quiche/src/quic/test_tools/simulator/simulator.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+namespace quic {
+
+TraceDrivenLink::TraceDrivenLink(simulator::Simulator* simulator,
+                                 std::string name,
+                                 simulator::SymmetricLink* link,
+                                 const BandwidthTrace* trace)
+  : Actor(simulator, name)
+  , link(link)
+  , trace(trace)
+  , start(clock_->Now())
+  , next_point(0)
+  , period_index(0) {
+  Act();
+}
+
+TraceDrivenLink::~TraceDrivenLink() {}
+
+void TraceDrivenLink::Act() {
+  const auto& points = trace->points();
+  link->set_bandwidth(points[next_point].bandwidth);
+
+  next_point += 1;
+  if (next_point == points.size()) {
+    next_point = 0;
+    period_index += 1;
+  }
+  Schedule(start
+    + QuicTime::Delta::FromMicroseconds(period_index * trace->period().ToMicroseconds())
+    + points[next_point].time);
+}
+
+QuicTime::Delta TraceDrivenLink::elapsed() const {
+  return clock_->Now() - start;
+}
+
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,43 @@
+#ifndef ABRCC_SIM_TRACE_H_
+#define ABRCC_SIM_TRACE_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <string>
+
+#include "net/abrcc/structs/bandwidth_trace.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+#include "net/third_party/quiche/src/quic/test_tools/simulator/actor.h"
+#include "net/third_party/quiche/src/quic/test_tools/simulator/link.h"
+
+namespace quic {
+
+// Replays a BandwidthTrace on a link by updating its bandwidth at every point of
+// the trace, starting at the moment the link is created.
+class TraceDrivenLink : public simulator::Actor {
+ public:
+  TraceDrivenLink(simulator::Simulator* simulator,
+                  std::string name,
+                  simulator::SymmetricLink* link,
+                  const BandwidthTrace* trace);
+  ~TraceDrivenLink() override;
+
+  void Act() override;
+
+  // Time since the trace started.
+  QuicTime::Delta elapsed() const;
+ private:
+  simulator::SymmetricLink* link;
+  const BandwidthTrace* trace;
+  QuicTime start;
+  // index of the next point and the number of periods already replayed
+  size_t next_point;
+  int64_t period_index;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
@@ -4,17 +4,17 @@ namespace structs {
 
 template <typename T>
 MovingAverage<T>::MovingAverage(int size) 
-  : _size(size)
-  , samples(std::deque<T>()) {}
+  : samples(size) {}
 
 template <typename T>
 MovingAverage<T>::~MovingAverage() {}
 
 template <typename T>
 void MovingAverage<T>::sample(T sample) {
-  if (int(samples.size()) == _size) {
-    pop(samples.front());
+  if (samples.full()) {
+    T oldest = samples.front();
     samples.pop_front();
+    pop(oldest);
   }
   samples.push_back(sample);
   push(sample);
@@ -30,6 +30,11 @@ bool MovingAverage<T>::empty() const {
   return samples.empty(); 
 }
 
+template <typename T>
+bool MovingAverage<T>::full() const {
+  return samples.full();
+}
+
 template <typename T>
 int MovingAverage<T>::size() const {
   return samples.size(); 
@@ -52,21 +57,21 @@ template class MovingAverage<float>;
 template <typename T>
 SimpleMovingAverage<T>::SimpleMovingAverage(int size) 
   : MovingAverage<T>(size)
-  , total(0) {}
+  , total(size) {}
 
 template <typename T>
 void SimpleMovingAverage<T>::push(T value) {
-  total += value;
+  total.push(value);
 }
 
 template <typename T>
 void SimpleMovingAverage<T>::pop(T value) {
-  total -= value;
+  total.pop(value);
 }
 
 template <typename T>
 double SimpleMovingAverage<T>::value() const {
-  return total / this->size(); 
+  return total.sum() / this->size(); 
 }
 
 template class SimpleMovingAverage<long long>;
@@ -78,21 +83,21 @@ template class SimpleMovingAverage<float>;
 template <typename T>
 WilderEMA<T>::WilderEMA(int size) 
   : MovingAverage<T>(size)
-  , m(1. / double(size))
-  , ema(0) {}
+  , ema(size) {}
 
 template <typename T>
 void WilderEMA<T>::push(T value) {
-  ema = m * value + (1 - m) * ema;
+  ema.push(value);
 }
 
 template <typename T>
 void WilderEMA<T>::pop(T value) {
+  ema.pop(value);
 }
 
 template <typename T>
 double WilderEMA<T>::value() const {
-  return ema; 
+  return ema.ema(); 
 }
 
 template class WilderEMA<long long>;
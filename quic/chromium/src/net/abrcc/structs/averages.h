@@ -1,10 +1,15 @@
 #ifndef _STRUCTURES_AVERAGES_H_
 #define _STRUCTURES_AVERAGES_H_
 
-#include <queue>
+#include "net/abrcc/structs/incremental.h"
+#include "net/abrcc/structs/ring_buffer.h"
 
 namespace structs { 
 
+// Polymorphic moving average over a window of the last `size` samples. The window
+// is a fixed-capacity ring buffer; the derived classes keep their statistics
+// up to date incrementally through the `push` and `pop` hooks, using the policies
+// from `structs/incremental.h`.
 template <typename T>
 class MovingAverage {
  public:
@@ -13,6 +18,7 @@ class MovingAverage {
 
   void sample(T sample);
   bool empty() const;
+  bool full() const;
   int size() const;
   T last() const;
 
@@ -24,8 +30,7 @@ class MovingAverage {
   virtual void pop(T sample) = 0;
 
  private:
-  int _size;
-  std::deque<T> samples;
+  RingBuffer<T> samples;
 };
 
 template <typename T>
@@ -38,7 +43,7 @@ class SimpleMovingAverage : public MovingAverage<T> {
   void push(T sample) override;
   void pop(T sample) override;
 
-  double total;
+  WindowSum<T> total;
 };
 
 
@@ -52,8 +57,7 @@ class WilderEMA : public MovingAverage<T> {
   void push(T sample) override;
   void pop(T sample) override;
 
-  double m;
-  double ema;
+  WilderSmoothing<T> ema;
 };
 
 }
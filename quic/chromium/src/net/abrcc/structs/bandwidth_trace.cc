@@ -0,0 +1,158 @@
+#include "net/abrcc/structs/bandwidth_trace.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+#include "base/logging.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+namespace quic {
+
+std::unique_ptr<BandwidthTrace> BandwidthTrace::FromFile(const std::string& path) {
+  std::ifstream stream(path);
+  if (!stream.is_open()) {
+    return nullptr;
+  }
+
+  std::vector<Point> points;
+  std::vector<int64_t> timestamps;
+  std::string line;
+  while (std::getline(stream, line)) {
+    std::istringstream fields(line);
+    double time, bandwidth_mbps;
+    if (!(fields >> time)) {
+      continue;
+    }
+    if (!(fields >> bandwidth_mbps)) {
+      // Mahimahi delivery opportunity
+      timestamps.push_back(int64_t(time));
+      continue;
+    }
+    int64_t kbps = std::max(
+      int64_t(bandwidth_mbps * 1000), int64_t(TraceConstants::min_bandwidth_kbps));
+    points.push_back(Point{
+      QuicTime::Delta::FromMicroseconds(int64_t(time * 1e6)),
+      QuicBandwidth::FromKBitsPerSecond(kbps),
+    });
+  }
+  if (points.empty() && !timestamps.empty()) {
+    points = FromMahimahi(timestamps);
+  }
+  if (points.empty()) {
+    return nullptr;
+  }
+
+  std::string name = path.substr(path.find_last_of("/") + 1);
+  return std::unique_ptr<BandwidthTrace>(new BandwidthTrace(name, std::move(points)));
+}
+
+std::vector<BandwidthTrace::Point> BandwidthTrace::FromMahimahi(
+  const std::vector<int64_t>& timestamps
+) {
+  const int bin = TraceConstants::mahimahi_bin_ms;
+  int64_t bins = *std::max_element(timestamps.begin(), timestamps.end()) / bin + 1;
+  std::vector<int64_t> opportunities(bins, 0);
+  for (auto timestamp : timestamps) {
+    opportunities[std::max(int64_t(0), timestamp) / bin] += 1;
+  }
+
+  std::vector<Point> points;
+  for (int64_t i = 0; i < bins; ++i) {
+    QuicBandwidth bandwidth = QuicBandwidth::FromBytesAndTimeDelta(
+      opportunities[i] * TraceConstants::mahimahi_packet_size,
+      QuicTime::Delta::FromMilliseconds(bin));
+    points.push_back(Point{
+      QuicTime::Delta::FromMilliseconds(i * bin),
+      std::max(bandwidth, QuicBandwidth::FromKBitsPerSecond(TraceConstants::min_bandwidth_kbps)),
+    });
+  }
+  return points;
+}
+
+BandwidthTrace::BandwidthTrace(const std::string& name, std::vector<Point> points)
+  : name_(name)
+  , points_(std::move(points))
+  , period_(QuicTime::Delta::Zero()) {
+  DCHECK(!points_.empty());
+
+  // the trace starts at its first point
+  QuicTime::Delta offset = points_.front().time;
+  for (auto& point : points_) {
+    point.time = point.time - offset;
+  }
+
+  if (points_.size() == 1) {
+    period_ = QuicTime::Delta::FromSeconds(1);
+  } else {
+    size_t last = points_.size() - 1;
+    period_ = points_[last].time + (points_[last].time - points_[last - 1].time);
+  }
+  if (period_ <= points_.back().time) {
+    // duplicated timestamps at the end of the trace
+    period_ = points_.back().time + QuicTime::Delta::FromSeconds(1);
+  }
+
+  prefix.push_back(0);
+  for (size_t i = 0; i < points_.size(); ++i) {
+    QuicTime::Delta end = i + 1 < points_.size() ? points_[i + 1].time : period_;
+    prefix.push_back(prefix.back() + points_[i].bandwidth.ToBytesPerPeriod(end - points_[i].time));
+  }
+}
+
+const std::string& BandwidthTrace::name() const {
+  return name_;
+}
+
+const std::vector<BandwidthTrace::Point>& BandwidthTrace::points() const {
+  return points_;
+}
+
+QuicTime::Delta BandwidthTrace::period() const {
+  return period_;
+}
+
+static size_t pointAt(const std::vector<BandwidthTrace::Point>& points,
+                      QuicTime::Delta time) {
+  auto it = std::upper_bound(points.begin(), points.end(), time,
+    [](QuicTime::Delta t, const BandwidthTrace::Point& point) { return t < point.time; });
+  return it == points.begin() ? 0 : size_t(it - points.begin()) - 1;
+}
+
+QuicBandwidth BandwidthTrace::meanBandwidth() const {
+  return QuicBandwidth::FromBytesAndTimeDelta(prefix.back(), period_);
+}
+
+QuicByteCount BandwidthTrace::capacityUntil(QuicTime::Delta time) const {
+  int64_t periods = time.ToMicroseconds() / period_.ToMicroseconds();
+  QuicTime::Delta remainder = QuicTime::Delta::FromMicroseconds(
+    time.ToMicroseconds() % period_.ToMicroseconds());
+  size_t i = pointAt(points_, remainder);
+  return periods * prefix.back() + prefix[i]
+    + points_[i].bandwidth.ToBytesPerPeriod(remainder - points_[i].time);
+}
+
+QuicByteCount BandwidthTrace::capacity(QuicTime::Delta start, QuicTime::Delta end) const {
+  if (end <= start) {
+    return 0;
+  }
+  return capacityUntil(end) - capacityUntil(start);
+}
+
+QuicTime::Delta BandwidthTrace::deliveryTime(QuicTime::Delta start,
+                                             QuicByteCount bytes) const {
+  QuicByteCount target = capacityUntil(start) + bytes;
+  int64_t periods = target / prefix.back();
+  QuicByteCount remainder = target - periods * prefix.back();
+
+  // last point reached with at most `remainder` bytes delivered
+  size_t i = std::upper_bound(prefix.begin(), prefix.end() - 1, remainder) - prefix.begin() - 1;
+  return QuicTime::Delta::FromMicroseconds(periods * period_.ToMicroseconds())
+    + points_[i].time + points_[i].bandwidth.TransferTime(remainder - prefix[i]);
+}
+
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,71 @@
+#ifndef ABRCC_STRUCTS_BANDWIDTH_TRACE_H_
+#define ABRCC_STRUCTS_BANDWIDTH_TRACE_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "net/third_party/quiche/src/quic/core/quic_bandwidth.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+
+namespace quic {
+
+namespace TraceConstants {
+  // links with no bandwidth never deliver the queued packets, so the points of
+  // a trace are clamped to a minimum bandwidth(kbps)
+  const int min_bandwidth_kbps = 10;
+
+  // Mahimahi traces deliver packets of mahimahi_packet_size; the delivery
+  // opportunities are averaged over bins of mahimahi_bin_ms
+  const int mahimahi_packet_size = 1500;
+  const int mahimahi_bin_ms = 100;
+}
+
+// Time-varying bandwidth, read from either:
+//   - the format of `exp/network_traces`: one point per line, `<time(s)> <bandwidth(Mbps)>`
+//   - the Mahimahi format: one delivery opportunity per line, `<time(ms)>`
+// Each point holds until the next one; the trace loops, the last point holding as
+// long as the gap before it.
+class BandwidthTrace {
+ public:
+  struct Point {
+    QuicTime::Delta time;
+    QuicBandwidth bandwidth;
+  };
+
+  // Returns nullptr if the file can not be read or holds no points.
+  static std::unique_ptr<BandwidthTrace> FromFile(const std::string& path);
+  BandwidthTrace(const std::string& name, std::vector<Point> points);
+
+  const std::string& name() const;
+  const std::vector<Point>& points() const;
+  QuicTime::Delta period() const;
+
+  QuicBandwidth meanBandwidth() const;
+
+  // Bytes the trace can deliver in [start, end).
+  QuicByteCount capacity(QuicTime::Delta start, QuicTime::Delta end) const;
+
+  // Time at which `bytes` sent from `start` are delivered.
+  QuicTime::Delta deliveryTime(QuicTime::Delta start, QuicByteCount bytes) const;
+ private:
+  static std::vector<Point> FromMahimahi(const std::vector<int64_t>& timestamps);
+
+  // Bytes the trace can deliver in [0, time).
+  QuicByteCount capacityUntil(QuicTime::Delta time) const;
+
+  std::string name_;
+  std::vector<Point> points_;
+  QuicTime::Delta period_;
+  // capacity until each point, within a period
+  std::vector<QuicByteCount> prefix;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
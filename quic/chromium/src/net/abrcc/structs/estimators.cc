@@ -1,7 +1,5 @@
 #include "net/abrcc/structs/estimators.h"
 
-#include <iostream>
-
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wc++17-extensions"
 
@@ -11,24 +9,19 @@ template <typename T>
 PIDEstimator<T>::PIDEstimator(int size, float p, float i, float d) 
   : MovingAverage<T>(size)
   , p(p), i(i), d(d)
-  , total(0)
-  , ctr(0)
-  , st(std::multiset<double>{}) 
-  , pos(std::map<double, int>{}){}
+  , total(size)
+  , extremes(size) {}
 
 template <typename T>
 void PIDEstimator<T>::push(T value) {
-  last = value;
-  total += value;
-  
-  st.insert(static_cast<double>(value));
-  pos[value] = ++ctr;
+  total.push(value);
+  extremes.push(value);
 }
 
 template <typename T>
 void PIDEstimator<T>::pop(T value) {
-  total -= value;
-  st.erase(st.find(static_cast<double>(value)));
+  total.pop(value);
+  extremes.pop(value);
 }
 
 template <typename T>
@@ -42,19 +35,17 @@ double PIDEstimator<T>::value() const {
 
 template <typename T>
 double PIDEstimator<T>::proportional() const {
-  return last;
+  return this->last();
 }
 
 template <typename T>
 double PIDEstimator<T>::integral() const {
-  return total / this->size();
+  return total.sum() / this->size();
 }
 
 template <typename T>
 double PIDEstimator<T>::derivative() const {
-  double mx = *(st.rbegin());
-  double mn = *(st.begin());
-  return pos.find(mx)->second > pos.find(mn)->second ? mx - mn : mn - mx;
+  return extremes.trend();
 }
 
 
@@ -69,54 +60,37 @@ LineFitEstimator<T>::LineFitEstimator(int size, T time_delta, int projection_siz
   : MovingAverage<T>(size)
   , projection_size(projection_size)
   , time_delta(static_cast<double>(time_delta))
-  , last_time(0)
-  , points(std::deque<std::pair<double, double>>{})
-  , final_point_estimate(new WilderEMA<double>(size)) 
+  , points(size)
+  , final_point_estimate(size) 
   { }
 
 template <typename T>
 void LineFitEstimator<T>::push(T value) {
-  points.push_back(std::make_pair(static_cast<double>(value), last_time)); 
-  
-  final_point_estimate->sample(value);
-  last_time += time_delta; 
+  points.push(value);
+  final_point_estimate.push(value);
 }
 
 template <typename T>
 void LineFitEstimator<T>::pop(T value) {
-  points.pop_front();
+  points.pop(value);
 }
 
 template <typename T>
 double LineFitEstimator<T>::value() const {
-  if (int(points.size()) != this->size()) {
-    return final_point_estimate->value();
+  if (!this->full()) {
+    return final_point_estimate.ema();
   }
-  
+
   double m = lsm_slope();
   double future_dist = time_delta * projection_size;
 
-  return final_point_estimate->value() + future_dist * m; 
+  return final_point_estimate.ema() + future_dist * m; 
 }
 
 template <typename T> 
 double LineFitEstimator<T>::lsm_slope() const {
-  double avg_x = 0;
-  double avg_y = 0;
-  for (auto &[x, y] : points) {
-    avg_x += x;
-    avg_y += y;
-  }
-  avg_x /= points.size();
-  avg_y /= points.size();
-
-  double num = 0;
-  double den = 0;
-  for (auto &[x, y] : points) {
-    num += (x - avg_x) * (y - avg_y);  
-    den += (x - avg_x) * (x - avg_x);
-  }
-  return num / den;
+  // the timestamps are the window positions scaled by `time_delta`
+  return time_delta * points.slope();
 }
 
 
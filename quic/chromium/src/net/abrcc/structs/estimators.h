@@ -2,13 +2,13 @@
 #define _STRUCTURES_ESTIMATORS_H_
 
 #include "net/abrcc/structs/averages.h"
-
-#include <set>
-#include <map>
-#include <queue>
+#include "net/abrcc/structs/incremental.h"
 
 namespace structs {
 
+// PID-style estimator: weighted combination of the last sample(proportional), the
+// window average(integral) and the window's max-min difference, signed by whether
+// the maximum is more recent than the minimum(derivative).
 template <typename T>
 class PIDEstimator : public MovingAverage<T> {
  public:
@@ -24,14 +24,15 @@ class PIDEstimator : public MovingAverage<T> {
   void pop(T sample) override;
   
   float p, i, d;
-  double total, last;
-  int ctr;
 
-  std::multiset<double> st;
-  std::map<double, int> pos;
+  WindowSum<T> total;
+  WindowExtremes<T> extremes;
 };
 
 
+// Projects the EMA of the samples `projection_size` time steps ahead, using the
+// slope of the least squares fit between the samples and their timestamps, which
+// are spaced by `time_delta`.
 template <typename T>
 class LineFitEstimator : public MovingAverage<T> {
  public:
@@ -44,9 +45,8 @@ class LineFitEstimator : public MovingAverage<T> {
 
   int projection_size;
   double time_delta;
-  double last_time;
-  std::deque<std::pair<double, double> > points;
-  std::unique_ptr<MovingAverage<double> > final_point_estimate;  
+  RollingLeastSquares<T> points;
+  WilderSmoothing<double> final_point_estimate;
 
   double lsm_slope() const;
 };
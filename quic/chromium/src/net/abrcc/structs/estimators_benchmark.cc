@@ -0,0 +1,218 @@
+// Micro-benchmarks for the estimators in `abrcc/structs`.
+//
+// Each estimator is compared against a reference implementation that recomputes
+// its statistics over the whole window on every query, as the estimators did before
+// the incremental rewrite. Both are fed the same pseudo-random bandwidth trace(kbps)
+// and queried after every sample, which is the access pattern of the ABR and CC
+// loops. The maximum absolute difference between the two is reported alongside the
+// time per sample.
+//
+// Usage: abrcc_estimators_benchmark [samples] [window]
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include "net/abrcc/structs/averages.h"
+#include "net/abrcc/structs/estimators.h"
+#include "net/abrcc/structs/incremental.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <random>
+#include <vector>
+
+namespace {
+
+// Reference implementations: full recomputation over a std::deque window.
+class ReferenceWindow {
+ public:
+  ReferenceWindow(int size) : size(size) {}
+
+  void sample(double value) {
+    if (int(samples.size()) == size) {
+      samples.pop_front();
+    }
+    samples.push_back(value);
+  }
+
+  double average() const {
+    double total = 0;
+    for (auto x : samples) {
+      total += x;
+    }
+    return total / samples.size();
+  }
+
+  double trend() const {
+    // latest occurrence of the minimum and maximum
+    int mn = 0, mx = 0;
+    for (int i = 0; i < int(samples.size()); ++i) {
+      if (samples[i] <= samples[mn]) mn = i;
+      if (samples[i] >= samples[mx]) mx = i;
+    }
+    double diff = samples[mx] - samples[mn];
+    return mx > mn ? diff : -diff;
+  }
+
+  double slope() const {
+    double avg_x = 0, avg_k = 0;
+    for (int k = 0; k < int(samples.size()); ++k) {
+      avg_x += samples[k];
+      avg_k += k;
+    }
+    avg_x /= samples.size();
+    avg_k /= samples.size();
+
+    double num = 0, den = 0;
+    for (int k = 0; k < int(samples.size()); ++k) {
+      num += (samples[k] - avg_x) * (k - avg_k);
+      den += (samples[k] - avg_x) * (samples[k] - avg_x);
+    }
+    return num / den;
+  }
+ private:
+  int size;
+  std::deque<double> samples;
+};
+
+std::vector<double> bandwidth_trace(int samples) {
+  std::mt19937 generator(42);
+  std::normal_distribution<double> noise(0, 300);
+  std::vector<double> trace;
+  double bandwidth = 3000;
+  for (int i = 0; i < samples; ++i) {
+    bandwidth = std::max(100., bandwidth + noise(generator));
+    trace.push_back(std::round(bandwidth));
+  }
+  return trace;
+}
+
+// Runs `step` for every sample of the trace and returns the time per sample in ns.
+double measure(const std::vector<double>& trace, const std::function<double(double)>& step,
+               double* checksum) {
+  auto start = std::chrono::steady_clock::now();
+  double total = 0;
+  for (auto x : trace) {
+    total += step(x);
+  }
+  auto end = std::chrono::steady_clock::now();
+  *checksum = total;
+  return 1. * std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()
+         / trace.size();
+}
+
+void report(const char* name, double ns, double reference_ns, double max_diff) {
+  printf("%-28s %10.1f ns/sample %10.1f ns/sample(reference) %8.2fx  max diff %.3g\n",
+         name, ns, reference_ns, reference_ns / ns, max_diff);
+}
+
+}
+
+int main(int argc, char** argv) {
+  int samples = argc > 1 ? atoi(argv[1]) : 1000000;
+  int window = argc > 2 ? atoi(argv[2]) : 10;
+  auto trace = bandwidth_trace(samples);
+  double checksum;
+
+  printf("samples: %d, window: %d\n", samples, window);
+
+  // moving average
+  {
+    structs::SimpleMovingAverage<double> average(window);
+    ReferenceWindow reference(window);
+    double max_diff = 0;
+    double ns = measure(trace, [&](double x) {
+      average.sample(x);
+      return average.value();
+    }, &checksum);
+    double reference_ns = measure(trace, [&](double x) {
+      reference.sample(x);
+      return reference.average();
+    }, &checksum);
+
+    structs::SimpleMovingAverage<double> check(window);
+    ReferenceWindow check_reference(window);
+    for (auto x : trace) {
+      check.sample(x);
+      check_reference.sample(x);
+      max_diff = std::max(max_diff, fabs(check.value() - check_reference.average()));
+    }
+    report("SimpleMovingAverage", ns, reference_ns, max_diff);
+  }
+
+  // windowed min/max trend
+  {
+    structs::IncrementalEstimator<double, structs::WindowExtremes<double>> extremes(window);
+    ReferenceWindow reference(window);
+    double max_diff = 0;
+    double ns = measure(trace, [&](double x) {
+      extremes.sample(x);
+      return extremes.trend();
+    }, &checksum);
+    double reference_ns = measure(trace, [&](double x) {
+      reference.sample(x);
+      return reference.trend();
+    }, &checksum);
+
+    structs::IncrementalEstimator<double, structs::WindowExtremes<double>> check(window);
+    ReferenceWindow check_reference(window);
+    for (auto x : trace) {
+      check.sample(x);
+      check_reference.sample(x);
+      max_diff = std::max(max_diff, fabs(check.trend() - check_reference.trend()));
+    }
+    report("WindowExtremes", ns, reference_ns, max_diff);
+  }
+
+  // rolling least squares
+  {
+    structs::IncrementalEstimator<double, structs::RollingLeastSquares<double>> fit(window);
+    ReferenceWindow reference(window);
+    double max_diff = 0;
+    double ns = measure(trace, [&](double x) {
+      fit.sample(x);
+      return fit.full() ? fit.slope() : 0;
+    }, &checksum);
+    double reference_ns = measure(trace, [&](double x) {
+      reference.sample(x);
+      return reference.slope();
+    }, &checksum);
+
+    structs::IncrementalEstimator<double, structs::RollingLeastSquares<double>> check(window);
+    ReferenceWindow check_reference(window);
+    for (auto x : trace) {
+      check.sample(x);
+      check_reference.sample(x);
+      if (check.full()) {
+        double expected = check_reference.slope();
+        max_diff = std::max(max_diff, fabs(check.slope() - expected) / std::max(1e-12, fabs(expected)));
+      }
+    }
+    report("RollingLeastSquares(rel)", ns, reference_ns, max_diff);
+  }
+
+  // estimators used by the ABR and CC loops
+  {
+    structs::PIDEstimator<double> pid(window, 1, 3, 1);
+    double ns = measure(trace, [&](double x) {
+      pid.sample(x);
+      return pid.value();
+    }, &checksum);
+    structs::LineFitEstimator<double> line_fit(window, 1, 3);
+    double line_fit_ns = measure(trace, [&](double x) {
+      line_fit.sample(x);
+      return line_fit.value();
+    }, &checksum);
+    printf("%-28s %10.1f ns/sample\n", "PIDEstimator", ns);
+    printf("%-28s %10.1f ns/sample\n", "LineFitEstimator", line_fit_ns);
+  }
+
+  return 0;
+}
+
+#pragma GCC diagnostic pop
@@ -0,0 +1,182 @@
+#ifndef _STRUCTURES_INCREMENTAL_H_
+#define _STRUCTURES_INCREMENTAL_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include "net/abrcc/structs/monotonic_window.h"
+#include "net/abrcc/structs/ring_buffer.h"
+
+namespace structs {
+
+// Incremental estimators over a sliding window of samples.
+//
+// An estimator is composed at compile time out of policies. Each policy is constructed
+// with the window size and exposes the hooks:
+//   - push(sample): called after `sample` entered the window
+//   - pop(sample): called after `sample`(the oldest one) left the window
+// Policies that do not need the window size or a hook's sample leave the parameter
+// unnamed. All the policies below update in amortized O(1) per sample. Policies are combined by
+// inheritance, so their accessors are available directly on the estimator, e.g.
+//   IncrementalEstimator<double, WindowSum<double>, WindowExtremes<double>>
+
+
+// Running sum of the samples in the window.
+template <typename T>
+class WindowSum {
+ public:
+  explicit WindowSum(int) : total(0) {}
+
+  void push(const T& sample) { total += sample; }
+  void pop(const T& sample) { total -= sample; }
+
+  double sum() const { return total; }
+ private:
+  double total;
+};
+
+// Wilder's exponential moving average with smoothing factor 1 / size. Samples leaving
+// the window are ignored, as their weight has already decayed.
+template <typename T>
+class WilderSmoothing {
+ public:
+  explicit WilderSmoothing(int size) : m(1. / double(size)), value(0) {}
+
+  void push(const T& sample) { value = m * sample + (1 - m) * value; }
+  void pop(const T&) {}
+
+  double ema() const { return value; }
+ private:
+  double m;
+  double value;
+};
+
+// Rolling least squares between the samples x and their positions k in the window
+// (0 for the oldest sample). The positions are re-based whenever a sample leaves the
+// window, so the sums stay bounded over arbitrarily long sessions. The sums are exact
+// as long as the samples are integral and their squares fit a double's mantissa;
+// otherwise the rounding errors of the updates accumulate, so the sums are recomputed
+// from the window after every `size` evictions.
+//
+// The slope is computed from the raw sums rather than from the centered samples, so
+// it matches a full refit of the window only up to rounding.
+template <typename T>
+class RollingLeastSquares {
+ public:
+  explicit RollingLeastSquares(int size)
+    : xs(size), evictions(0), n(0), sx(0), sxx(0), sxk(0) {}
+
+  void push(const T& sample) {
+    double x = static_cast<double>(sample);
+    xs.push_back(x);
+    sx += x;
+    sxx += x * x;
+    sxk += n * x;
+    ++n;
+  }
+
+  void pop(const T& sample) {
+    double x = static_cast<double>(sample);
+    xs.pop_front();
+    sx -= x;
+    sxx -= x * x;
+    // the popped sample was at position 0; shift all positions by -1
+    sxk -= sx;
+    --n;
+
+    if (++evictions == xs.capacity()) {
+      recompute();
+    }
+  }
+
+  // Slope of the least squares fit of the positions as a function of the samples,
+  // i.e. cov(x, k) / var(x); 0 while the samples do not vary.
+  double slope() const {
+    if (n < 2) {
+      return 0;
+    }
+    double sk = 0.5 * n * (n - 1);
+    double cov = sxk - sx * sk / n;
+    double var = sxx - sx * sx / n;
+    if (var <= 0) {
+      return 0;
+    }
+    return cov / var;
+  }
+ private:
+  void recompute() {
+    evictions = 0;
+    sx = sxx = sxk = 0;
+    for (int k = 0; k < xs.size(); ++k) {
+      sx += xs[k];
+      sxx += xs[k] * xs[k];
+      sxk += k * xs[k];
+    }
+  }
+
+  // copy of the window, for the recomputations
+  RingBuffer<double> xs;
+  int evictions;
+  long long n;
+  double sx, sxx, sxk;
+};
+
+// Windowed minimum and maximum, together with the signed distance between them: the
+// distance is positive if the maximum is more recent than the minimum. Ties are
+// resolved towards the latest sample.
+template <typename T>
+class WindowExtremes {
+ public:
+  explicit WindowExtremes(int size) : mn(size), mx(size) {}
+
+  void push(const T& sample) {
+    mn.push(sample);
+    mx.push(sample);
+  }
+  void pop(const T&) {}
+
+  T min() const { return mn.best(); }
+  T max() const { return mx.best(); }
+  double trend() const {
+    double diff = static_cast<double>(mx.best()) - static_cast<double>(mn.best());
+    return mx.best_index() > mn.best_index() ? diff : -diff;
+  }
+ private:
+  WindowedMin<T, TiePolicy::LATEST> mn;
+  WindowedMax<T, TiePolicy::LATEST> mx;
+};
+
+
+// Fixed-capacity window of samples that dispatches every update to its policies.
+template <typename T, typename... Policies>
+class IncrementalEstimator : public Policies... {
+ public:
+  explicit IncrementalEstimator(int size)
+    : Policies(size)...
+    , samples(size) {}
+
+  void sample(const T& value) {
+    if (samples.full()) {
+      T oldest = samples.front();
+      samples.pop_front();
+      (Policies::pop(oldest), ...);
+    }
+    samples.push_back(value);
+    (Policies::push(value), ...);
+  }
+
+  bool empty() const { return samples.empty(); }
+  bool full() const { return samples.full(); }
+  int size() const { return samples.size(); }
+  int capacity() const { return samples.capacity(); }
+  T last() const { return samples.back(); }
+  const RingBuffer<T>& window() const { return samples; }
+ private:
+  RingBuffer<T> samples;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
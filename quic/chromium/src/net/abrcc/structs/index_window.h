@@ -0,0 +1,65 @@
+#ifndef _STRUCTURES_INDEX_WINDOW_H_
+#define _STRUCTURES_INDEX_WINDOW_H_
+
+#include <climits>
+#include <vector>
+
+namespace structs {
+
+// Dense map from increasing indices(e.g. segment indices) to values, holding a
+// window of the last `capacity` indices. Index i lives in slot i % capacity, so a
+// lookup is an array access and the storage never grows: writing an index evicts
+// the index `capacity` apart that shared its slot.
+//
+// Lookups of indices that were never written or were evicted behave as for an
+// absent key of a map: `find` returns nullptr and operator[] default-constructs.
+template <typename T>
+class IndexWindow {
+ public:
+  explicit IndexWindow(int capacity)
+    : slots(capacity > 0 ? capacity : 1) {}
+
+  T* find(int index) {
+    Slot& slot = slots[wrap(index)];
+    return slot.index == index ? &slot.value : nullptr;
+  }
+
+  const T* find(int index) const {
+    const Slot& slot = slots[wrap(index)];
+    return slot.index == index ? &slot.value : nullptr;
+  }
+
+  bool contains(int index) const {
+    return find(index) != nullptr;
+  }
+
+  T& operator[](int index) {
+    Slot& slot = slots[wrap(index)];
+    if (slot.index != index) {
+      slot.index = index;
+      slot.value = T();
+    }
+    return slot.value;
+  }
+
+  int capacity() const { return int(slots.size()); }
+
+ private:
+  struct Slot {
+    Slot() : index(INT_MIN), value() {}
+
+    int index;
+    T value;
+  };
+
+  int wrap(int index) const {
+    int slot = index % capacity();
+    return slot < 0 ? slot + capacity() : slot;
+  }
+
+  std::vector<Slot> slots;
+};
+
+}
+
+#endif
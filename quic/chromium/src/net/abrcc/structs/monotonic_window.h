@@ -0,0 +1,82 @@
+#ifndef _STRUCTURES_MONOTONIC_WINDOW_H_
+#define _STRUCTURES_MONOTONIC_WINDOW_H_
+
+#include "net/abrcc/structs/ring_buffer.h"
+
+#include <functional>
+
+namespace structs {
+
+// Which sample is reported when several samples in the window share the best value.
+enum class TiePolicy {
+  EARLIEST, LATEST,
+};
+
+// Windowed extremum over the last `size` samples, maintained as a monotonic deque:
+// each push is amortized O(1) and the best value and its index are available in O(1).
+// Samples are indexed by a counter that increases with every push, so the position
+// of the best sample can be compared against other windows fed in lockstep.
+//
+// With `Compare` = std::less the window tracks the minimum, with std::greater the maximum.
+template <typename T, typename Compare = std::less<T>, TiePolicy tie = TiePolicy::EARLIEST>
+class MonotonicWindow {
+ public:
+  explicit MonotonicWindow(int size)
+    : window(size)
+    , next_index(0)
+    , entries(size + 1) {}
+
+  void push(const T& value) {
+    while (!entries.empty() && dominated(entries.back().value, value)) {
+      entries.pop_back();
+    }
+    entries.push_back(Entry{next_index, value});
+    ++next_index;
+
+    while (entries.front().index + window < next_index) {
+      entries.pop_front();
+    }
+  }
+
+  void clear() {
+    entries.clear();
+    next_index = 0;
+  }
+
+  const T& best() const { return entries.front().value; }
+  long long best_index() const { return entries.front().index; }
+
+  bool empty() const { return entries.empty(); }
+  int size() const { return window; }
+  long long count() const { return next_index; }
+
+ private:
+  struct Entry {
+    long long index;
+    T value;
+  };
+
+  // An older sample can never become the best again once a newer sample is better
+  // (or equal, when ties are resolved towards the latest sample).
+  bool dominated(const T& older, const T& newer) const {
+    if (tie == TiePolicy::EARLIEST) {
+      return compare(newer, older);
+    }
+    return !compare(older, newer);
+  }
+
+  int window;
+  long long next_index;
+  Compare compare;
+  RingBuffer<Entry> entries;
+};
+
+template <typename T, TiePolicy tie = TiePolicy::EARLIEST>
+using WindowedMin = MonotonicWindow<T, std::less<T>, tie>;
+
+template <typename T, TiePolicy tie = TiePolicy::EARLIEST>
+using WindowedMax = MonotonicWindow<T, std::greater<T>, tie>;
+
+}
+
+#endif
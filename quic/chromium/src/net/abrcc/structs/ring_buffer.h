@@ -0,0 +1,67 @@
+#ifndef _STRUCTURES_RING_BUFFER_H_
+#define _STRUCTURES_RING_BUFFER_H_
+
+#include <vector>
+
+namespace structs {
+
+// Fixed-capacity circular buffer. The storage is allocated once at construction,
+// so pushing and popping at both ends never allocates. Elements are indexed from
+// the oldest(0) to the newest(size() - 1). Pushing into a full buffer drops the
+// oldest element.
+template <typename T>
+class RingBuffer {
+ public:
+  explicit RingBuffer(int capacity)
+    : data(capacity > 0 ? capacity : 1)
+    , head(0)
+    , count(0) {}
+
+  void push_back(const T& value) {
+    if (full()) {
+      pop_front();
+    }
+    data[wrap(head + count)] = value;
+    ++count;
+  }
+
+  void pop_front() {
+    head = wrap(head + 1);
+    --count;
+  }
+
+  void pop_back() {
+    --count;
+  }
+
+  void clear() {
+    head = 0;
+    count = 0;
+  }
+
+  T& front() { return data[head]; }
+  const T& front() const { return data[head]; }
+  T& back() { return data[wrap(head + count - 1)]; }
+  const T& back() const { return data[wrap(head + count - 1)]; }
+
+  T& operator[](int index) { return data[wrap(head + index)]; }
+  const T& operator[](int index) const { return data[wrap(head + index)]; }
+
+  int size() const { return count; }
+  int capacity() const { return int(data.size()); }
+  bool empty() const { return count == 0; }
+  bool full() const { return count == capacity(); }
+
+ private:
+  int wrap(int index) const {
+    return index >= capacity() ? index - capacity() : index;
+  }
+
+  std::vector<T> data;
+  int head;
+  int count;
+};
+
+}
+
+#endif
@@ -0,0 +1,85 @@
+#ifndef ABRCC_TELEMETRY_RECORD_H_
+#define ABRCC_TELEMETRY_RECORD_H_
+
+#include <cstdint>
+
+namespace quic {
+
+namespace TelemetryConstants {
+  // value of the fields that are not filled in by a record's kind
+  const int NOT_PRESENT = -1;
+}
+
+// Fixed-size binary telemetry record. The same layout is used in memory and on disk,
+// hence the fixed width fields laid out without implicit padding. Fields:
+//   - timestamp: monotonic time at which the record was taken(us)
+//   - stream: the stream(connection or ABR loop) that produced the record
+//   - kind: Kind of the record; determines which of the fields below are present
+//   - mode: Mode bit flags of the sender
+//   - cc_type: the sender's CongestionControlType
+//   - pacing_gain: pacing rate over bandwidth estimate
+//   - bandwidth: the sender's bandwidth estimate(kbps)
+//   - target_rate: target rate set by the ABR through the BbrInterface(kbps)
+//   - min_rtt: minimum RTT(us)
+//   - cwnd: congestion window(bytes)
+//   - bytes_in_flight: bytes in flight before the congestion event
+//   - index, quality: ABR decision for a segment or aborted segment index
+//   - buffer_level: front-end buffer level(ms)
+//   - player_timestamp: front-end timestamp of the metric or decision(ms)
+struct TelemetryRecord {
+  // Telemetry files end at the first record of kind NONE, as the files are grown
+  // in zero-filled chunks.
+  enum Kind : uint8_t {
+    NONE = 0, CONGESTION_EVENT = 1, BUFFER_LEVEL = 2, DECISION = 3, ABORT = 4,
+    // state of a shadow sender, with the fields of a CONGESTION_EVENT; recorded
+    // right after the primary's CONGESTION_EVENT it diverges from
+    SHADOW_EVENT = 5,
+  };
+
+  enum Mode : uint8_t {
+    SLOW_START = 1 << 0, RECOVERY = 1 << 1,
+  };
+
+  int64_t timestamp;
+  int32_t stream;
+  uint8_t kind;
+  uint8_t mode;
+  uint16_t cc_type;
+  float pacing_gain;
+  int32_t bandwidth;
+  int32_t target_rate;
+  int32_t min_rtt;
+  int64_t cwnd;
+  int64_t bytes_in_flight;
+  int32_t index;
+  int32_t quality;
+  int32_t buffer_level;
+  int32_t player_timestamp;
+
+  // Creates a record of `kind` with all the optional fields NOT_PRESENT.
+  static TelemetryRecord Make(Kind kind) {
+    TelemetryRecord record;
+    record.timestamp = 0;
+    record.stream = TelemetryConstants::NOT_PRESENT;
+    record.kind = kind;
+    record.mode = 0;
+    record.cc_type = 0;
+    record.pacing_gain = 0;
+    record.bandwidth = TelemetryConstants::NOT_PRESENT;
+    record.target_rate = TelemetryConstants::NOT_PRESENT;
+    record.min_rtt = TelemetryConstants::NOT_PRESENT;
+    record.cwnd = TelemetryConstants::NOT_PRESENT;
+    record.bytes_in_flight = TelemetryConstants::NOT_PRESENT;
+    record.index = TelemetryConstants::NOT_PRESENT;
+    record.quality = TelemetryConstants::NOT_PRESENT;
+    record.buffer_level = TelemetryConstants::NOT_PRESENT;
+    record.player_timestamp = TelemetryConstants::NOT_PRESENT;
+    return record;
+  }
+};
+
+static_assert(sizeof(TelemetryRecord) == 64, "TelemetryRecord must be 64 bytes");
+
+}
+
+#endif
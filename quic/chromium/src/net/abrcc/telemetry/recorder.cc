@@ -0,0 +1,268 @@
+#include "net/abrcc/telemetry/recorder.h"
+#include "net/abrcc/cc/singleton.h"
+
+#include <chrono>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "base/bind.h"
+#include "base/time/time.h"
+
+#include "net/abrcc/logging/log.h"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wunused-private-field"
+
+namespace quic {
+
+// Single-producer/single-consumer ring of records: the producer is the owning thread,
+// while the consumer is the flusher.
+class TelemetryRecorder::ThreadBuffer {
+ public:
+  explicit ThreadBuffer(int capacity)
+    : records(capacity), mask(capacity - 1), tail(0), head(0) {}
+
+  bool push(const TelemetryRecord& record) {
+    uint64_t current_tail = tail.load(std::memory_order_relaxed);
+    uint64_t current_head = head.load(std::memory_order_acquire);
+    if (current_tail - current_head == records.size()) {
+      return false;
+    }
+    records[current_tail & mask] = record;
+    tail.store(current_tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  template <typename Consumer>
+  void drain(const Consumer& consumer) {
+    uint64_t current_head = head.load(std::memory_order_relaxed);
+    uint64_t current_tail = tail.load(std::memory_order_acquire);
+    for (uint64_t i = current_head; i != current_tail; ++i) {
+      consumer(records[i & mask]);
+    }
+    head.store(current_tail, std::memory_order_release);
+  }
+ private:
+  std::vector<TelemetryRecord> records;
+  uint64_t mask;
+
+  char padding0[64];
+  std::atomic<uint64_t> tail;
+  char padding1[64];
+  std::atomic<uint64_t> head;
+  char padding2[64];
+};
+
+// The mmap'd file of a stream; `records` maps `capacity` records, out of which
+// the first `size` are written.
+struct TelemetryRecorder::StreamFile {
+  int fd;
+  TelemetryRecord* records;
+  size_t capacity;
+  size_t size;
+};
+
+namespace {
+  static_assert((TelemetryRecorderConstants::thread_capacity
+                & (TelemetryRecorderConstants::thread_capacity - 1)) == 0,
+                "thread_capacity must be a power of 2");
+
+  // Maps the first `capacity` records of the file; returns false on failure.
+  bool map_file(int fd, size_t capacity, TelemetryRecord** records) {
+    size_t length = capacity * sizeof(TelemetryRecord);
+    if (ftruncate(fd, length) != 0) {
+      return false;
+    }
+    void* address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (address == MAP_FAILED) {
+      return false;
+    }
+    *records = reinterpret_cast<TelemetryRecord*>(address);
+    return true;
+  }
+}
+
+TelemetryRecorder* TelemetryRecorder::GetInstance() {
+  return GET_SINGLETON(TelemetryRecorder);
+}
+
+TelemetryRecorder::TelemetryRecorder()
+  : enabled_(false)
+  , next_stream_(0)
+  , dropped_(0) {}
+TelemetryRecorder::~TelemetryRecorder() {}
+
+void TelemetryRecorder::Start(const std::string& directory) {
+  if (enabled_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  this->directory = directory;
+
+  std::unique_ptr<base::Thread> flusher(new base::Thread("telemetry"));
+  CHECK(flusher->Start());
+  flusher->task_runner()->PostTask(FROM_HERE, base::BindOnce(&FlushLoop, this));
+  thread = std::move(flusher);
+
+  enabled_.store(true, std::memory_order_release);
+}
+
+bool TelemetryRecorder::enabled() const {
+  return enabled_.load(std::memory_order_relaxed);
+}
+
+int TelemetryRecorder::OpenStream(const std::string& name) {
+  if (!enabled()) {
+    return TelemetryConstants::NOT_PRESENT;
+  }
+  int stream = next_stream_.fetch_add(1, std::memory_order_relaxed);
+  QuicWriterMutexLock lock(&streams_mutex_);
+  names[stream] = name;
+  return stream;
+}
+
+void TelemetryRecorder::CloseStream(int stream) {
+  if (stream == TelemetryConstants::NOT_PRESENT) {
+    return;
+  }
+  QuicWriterMutexLock lock(&streams_mutex_);
+  closed.push_back(stream);
+}
+
+void TelemetryRecorder::Record(int stream, TelemetryRecord record) {
+  if (stream == TelemetryConstants::NOT_PRESENT) {
+    return;
+  }
+  record.stream = stream;
+  record.timestamp = (base::TimeTicks::Now() - base::TimeTicks()).InMicroseconds();
+  if (!GetThreadBuffer()->push(record)) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+int64_t TelemetryRecorder::dropped() const {
+  return dropped_.load(std::memory_order_relaxed);
+}
+
+TelemetryRecorder::ThreadBuffer* TelemetryRecorder::GetThreadBuffer() {
+  // the recorder is a per-process singleton, so a single thread-local slot suffices
+  static thread_local ThreadBuffer* buffer = nullptr;
+  if (buffer == nullptr) {
+    buffer = new ThreadBuffer(TelemetryRecorderConstants::thread_capacity);
+
+    QuicWriterMutexLock lock(&buffers_mutex_);
+    buffers.push_back(std::unique_ptr<ThreadBuffer>(buffer));
+  }
+  return buffer;
+}
+
+void TelemetryRecorder::FlushLoop(TelemetryRecorder* recorder) {
+  while (true) {
+    recorder->Flush();
+    std::this_thread::sleep_for(
+      std::chrono::milliseconds(TelemetryRecorderConstants::flush_period));
+  }
+}
+
+void TelemetryRecorder::Flush() {
+  // the streams are snapshotted before draining, so that all the records taken
+  // before a stream was closed are written before its file is closed
+  std::vector<int> to_close;
+  {
+    QuicWriterMutexLock lock(&streams_mutex_);
+    to_close.swap(closed);
+  }
+
+  std::vector<ThreadBuffer*> current;
+  {
+    QuicReaderMutexLock lock(&buffers_mutex_);
+    for (auto& buffer : buffers) {
+      current.push_back(buffer.get());
+    }
+  }
+  for (auto* buffer : current) {
+    buffer->drain([this](const TelemetryRecord& record) { Write(record); });
+  }
+
+  for (int stream : to_close) {
+    CloseFile(stream);
+  }
+}
+
+void TelemetryRecorder::Write(const TelemetryRecord& record) {
+  auto it = files.find(record.stream);
+  if (it == files.end()) {
+    std::string name;
+    {
+      QuicReaderMutexLock lock(&streams_mutex_);
+      auto name_it = names.find(record.stream);
+      if (name_it == names.end()) {
+        // the stream was already closed
+        return;
+      }
+      name = name_it->second;
+    }
+
+    std::unique_ptr<StreamFile> file(new StreamFile{-1, nullptr, 0, 0});
+    std::string path = directory + "/" + name + "." + std::to_string(record.stream) + ".bin";
+    file->fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (file->fd < 0) {
+      ABRCC_LOG(WARNING) << "Telemetry: could not open " << path;
+    } else if (map_file(file->fd, TelemetryRecorderConstants::file_chunk, &file->records)) {
+      file->capacity = TelemetryRecorderConstants::file_chunk;
+    } else {
+      ABRCC_LOG(WARNING) << "Telemetry: could not map " << path;
+    }
+    it = files.emplace(record.stream, std::move(file)).first;
+  }
+
+  // files that could not be opened or grown drop their records
+  StreamFile* file = it->second.get();
+  if (file->records == nullptr) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+  if (file->size == file->capacity) {
+    munmap(file->records, file->capacity * sizeof(TelemetryRecord));
+    file->records = nullptr;
+    size_t capacity = file->capacity + TelemetryRecorderConstants::file_chunk;
+    if (!map_file(file->fd, capacity, &file->records)) {
+      ABRCC_LOG(WARNING) << "Telemetry: could not grow stream " << record.stream;
+      file->records = nullptr;
+      dropped_.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+    file->capacity = capacity;
+  }
+  file->records[file->size++] = record;
+}
+
+void TelemetryRecorder::CloseFile(int stream) {
+  auto it = files.find(stream);
+  if (it != files.end()) {
+    StreamFile* file = it->second.get();
+    if (file->records != nullptr) {
+      munmap(file->records, file->capacity * sizeof(TelemetryRecord));
+    }
+    if (file->fd >= 0) {
+      if (ftruncate(file->fd, file->size * sizeof(TelemetryRecord)) != 0) {
+        ABRCC_LOG(WARNING) << "Telemetry: could not truncate stream " << stream;
+      }
+      close(file->fd);
+    }
+    files.erase(it);
+  }
+
+  QuicWriterMutexLock lock(&streams_mutex_);
+  names.erase(stream);
+}
+
+}
+
+#pragma GCC diagnostic pop
+#pragma GCC diagnostic pop
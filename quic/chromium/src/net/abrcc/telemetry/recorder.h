@@ -0,0 +1,96 @@
+#ifndef ABRCC_TELEMETRY_RECORDER_H_
+#define ABRCC_TELEMETRY_RECORDER_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <atomic>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/threading/thread.h"
+
+#include "net/abrcc/telemetry/record.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_mutex.h"
+
+namespace quic {
+
+namespace TelemetryRecorderConstants {
+  // records buffered per thread between two consecutive flushes
+  const int thread_capacity = 1 << 12;
+
+  // records by which a stream's file is grown
+  const int file_chunk = 1 << 14;
+
+  // period of the flusher(ms)
+  const int flush_period = 10;
+}
+
+// Per-process recorder of TelemetryRecords.
+//
+// Producers(the network thread for the congestion controllers and the ABR loops) write
+// records into a lock-free ring owned by their thread; a background flusher drains
+// the rings and appends each record to the mmap'd file of its stream, named
+// `<directory>/<name>.<stream>.bin`. Recording never blocks: a record pushed into a
+// full ring is dropped and counted.
+//
+// The recorder is a no-op until Start is called, so the producers only pay for a
+// relaxed atomic load when the telemetry is disabled.
+class TelemetryRecorder {
+ public:
+  virtual ~TelemetryRecorder();
+  static TelemetryRecorder* GetInstance();
+
+  // Starts the flusher writing the stream files under `directory`.
+  void Start(const std::string& directory);
+  bool enabled() const;
+
+  // Registers a new stream; returns NOT_PRESENT if the recorder is disabled.
+  int OpenStream(const std::string& name);
+  // The stream's file is truncated to its records once all the records taken
+  // before closing are flushed.
+  void CloseStream(int stream);
+
+  // Timestamps and records `record` on behalf of `stream`.
+  void Record(int stream, TelemetryRecord record);
+
+  int64_t dropped() const;
+ private:
+  TelemetryRecorder();
+
+  class ThreadBuffer;
+  struct StreamFile;
+
+  ThreadBuffer* GetThreadBuffer();
+  void Flush();
+  void Write(const TelemetryRecord& record);
+  void CloseFile(int stream);
+
+  static void FlushLoop(TelemetryRecorder* recorder);
+
+  std::atomic<bool> enabled_;
+  std::atomic<int> next_stream_;
+  std::atomic<int64_t> dropped_;
+  std::string directory;
+
+  // per-thread rings; registered once by every producer thread
+  std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+  mutable QuicMutex buffers_mutex_;
+
+  // stream names are registered by the producers; the files are only touched
+  // by the flusher
+  std::unordered_map<int, std::string> names;
+  std::vector<int> closed;
+  mutable QuicMutex streams_mutex_;
+  std::unordered_map<int, std::unique_ptr<StreamFile>> files;
+
+  std::unique_ptr<base::Thread> thread;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
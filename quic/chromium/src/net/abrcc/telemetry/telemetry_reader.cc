@@ -0,0 +1,104 @@
+// Converts the binary telemetry files written by the TelemetryRecorder into CSV,
+// one row per record, as consumed by `exp/components/plots.py`. The fields that are
+// not present for a record's kind are left empty.
+//
+// Usage: abrcc_telemetry_reader <file.bin> [<file.bin>...] > telemetry.csv
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include "net/abrcc/telemetry/record.h"
+
+#include <cstdio>
+#include <string>
+
+namespace {
+
+using quic::TelemetryRecord;
+
+const char* kind_name(uint8_t kind) {
+  switch (kind) {
+    case TelemetryRecord::CONGESTION_EVENT:
+      return "congestion_event";
+    case TelemetryRecord::BUFFER_LEVEL:
+      return "buffer_level";
+    case TelemetryRecord::DECISION:
+      return "decision";
+    case TelemetryRecord::ABORT:
+      return "abort";
+    case TelemetryRecord::SHADOW_EVENT:
+      return "shadow_event";
+    default:
+      return "unknown";
+  }
+}
+
+std::string field(int64_t value) {
+  if (value == quic::TelemetryConstants::NOT_PRESENT) {
+    return "";
+  }
+  return std::to_string(value);
+}
+
+// Returns the number of records read from `path`, or -1 on failure.
+long long convert(const char* path) {
+  FILE* file = fopen(path, "rb");
+  if (file == nullptr) {
+    return -1;
+  }
+
+  long long count = 0;
+  TelemetryRecord record;
+  while (fread(&record, sizeof(record), 1, file) == 1) {
+    // files of streams that were not closed end in zero-filled records
+    if (record.kind == TelemetryRecord::NONE) {
+      break;
+    }
+
+    bool congestion_event = record.kind == TelemetryRecord::CONGESTION_EVENT
+                         || record.kind == TelemetryRecord::SHADOW_EVENT;
+    printf("%d,%lld,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s,%s\n",
+      record.stream,
+      static_cast<long long>(record.timestamp),
+      kind_name(record.kind),
+      congestion_event ? std::to_string(record.cc_type).c_str() : "",
+      congestion_event ? std::to_string((record.mode & TelemetryRecord::SLOW_START) != 0).c_str() : "",
+      congestion_event ? std::to_string((record.mode & TelemetryRecord::RECOVERY) != 0).c_str() : "",
+      congestion_event ? std::to_string(record.pacing_gain).c_str() : "",
+      field(record.bandwidth).c_str(),
+      field(record.target_rate).c_str(),
+      field(record.min_rtt).c_str(),
+      field(record.cwnd).c_str(),
+      field(record.bytes_in_flight).c_str(),
+      field(record.index).c_str(),
+      field(record.quality).c_str(),
+      field(record.buffer_level).c_str(),
+      field(record.player_timestamp).c_str());
+    ++count;
+  }
+  fclose(file);
+  return count;
+}
+
+}
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    fprintf(stderr, "Usage: %s <file.bin> [<file.bin>...]\n", argv[0]);
+    return 1;
+  }
+
+  printf("stream,timestamp,kind,cc_type,slow_start,recovery,pacing_gain,bandwidth,"
+         "target_rate,min_rtt,cwnd,bytes_in_flight,index,quality,buffer_level,"
+         "player_timestamp\n");
+  int status = 0;
+  for (int i = 1; i < argc; ++i) {
+    if (convert(argv[i]) < 0) {
+      fprintf(stderr, "Could not read %s\n", argv[i]);
+      status = 1;
+    }
+  }
+  return status;
+}
+
+#pragma GCC diagnostic pop
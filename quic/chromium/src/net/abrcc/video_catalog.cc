@@ -0,0 +1,101 @@
+#include "net/abrcc/video_catalog.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+namespace quic {
+
+VideoCatalog::VideoCatalog(int qualities, int segments)
+  : qualities_(qualities)
+  , segments_(segments)
+  , stride((segments + VideoCatalogConstants::row_multiple - 1)
+           / VideoCatalogConstants::row_multiple * VideoCatalogConstants::row_multiple)
+  , size_(NewColumn<int>())
+  , kbits_(NewColumn<double>())
+  , vmaf_(NewColumn<double>())
+  , start_time_(NewColumn<double>())
+  , duration_ms_(NewColumn<int>()) {}
+VideoCatalog::~VideoCatalog() {}
+
+std::shared_ptr<VideoCatalog> VideoCatalog::Clone() const {
+  std::shared_ptr<VideoCatalog> catalog(new VideoCatalog(qualities_, segments_));
+  catalog->bitrates_ = bitrates_;
+  catalog->track_bitrates_ = track_bitrates_;
+  CopyColumn(size_, &catalog->size_);
+  CopyColumn(kbits_, &catalog->kbits_);
+  CopyColumn(vmaf_, &catalog->vmaf_);
+  CopyColumn(start_time_, &catalog->start_time_);
+  CopyColumn(duration_ms_, &catalog->duration_ms_);
+  return catalog;
+}
+
+template <typename T>
+void VideoCatalog::CopyColumn(const Column<T>& from, Column<T>* to) const {
+  size_t length = size_t(qualities_) * stride;
+  std::copy(from.get(), from.get() + length, to->get());
+}
+
+template <typename T>
+VideoCatalog::Column<T> VideoCatalog::NewColumn() const {
+  size_t bytes = std::max(size_t(qualities_) * stride, size_t(1)) * sizeof(T);
+  T* column = static_cast<T*>(base::AlignedAlloc(bytes, VideoCatalogConstants::alignment));
+  std::fill(column, column + bytes / sizeof(T), T());
+  return Column<T>(column);
+}
+
+std::shared_ptr<const VideoCatalog> VideoCatalog::Build(const DashBackendConfig& config) {
+  // tracks by quality index, as the resource of quality i is "/video<i>"
+  std::unordered_map<std::string, const VideoConfig*> resources;
+  for (auto &video_config : config.video_configs) {
+    resources.emplace(video_config->resource, video_config.get());
+  }
+  std::vector<const VideoConfig*> tracks;
+  for (int i = 0; i < int(config.video_configs.size()); ++i) {
+    auto track = resources.find("/video" + std::to_string(i));
+    if (track != resources.end()) {
+      tracks.push_back(track->second);
+    }
+  }
+
+  int segments = tracks.empty() ? 0 : int(tracks[0]->video_info.size());
+  for (auto track : tracks) {
+    segments = std::min(segments, int(track->video_info.size()));
+  }
+
+  std::shared_ptr<VideoCatalog> catalog(new VideoCatalog(int(tracks.size()), segments));
+  for (auto &video_config : config.video_configs) {
+    catalog->bitrates_.push_back(video_config->quality);
+  }
+  std::sort(catalog->bitrates_.begin(), catalog->bitrates_.end());
+
+  for (int quality = 0; quality < int(tracks.size()); ++quality) {
+    catalog->track_bitrates_.push_back(tracks[quality]->quality);
+
+    const auto& info = tracks[quality]->video_info;
+    for (int index = 0; index < segments; ++index) {
+      int at = catalog->at(quality, index);
+      catalog->size_.get()[at] = info[index]->size;
+      catalog->kbits_.get()[at] = 8. * info[index]->size / 1000.;
+      catalog->vmaf_.get()[at] = info[index]->vmaf;
+      catalog->start_time_.get()[at] = info[index]->start_time;
+
+      int ref_index = std::min(index, segments - 2);
+      if (ref_index >= 0) {
+        catalog->duration_ms_.get()[at] = int(1000. *
+          (info[ref_index + 1]->start_time - info[ref_index]->start_time));
+      }
+    }
+  }
+  return catalog;
+}
+
+std::shared_ptr<const VideoCatalog> VideoCatalog::ForConfig(DashBackendConfig* config) {
+  QuicWriterMutexLock lock(&config->lazy_mutex);
+  if (config->catalog == nullptr) {
+    config->catalog = Build(*config);
+  }
+  return config->catalog;
+}
+
+}
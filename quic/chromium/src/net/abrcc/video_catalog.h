@@ -0,0 +1,110 @@
+#ifndef ABRCC_VIDEO_CATALOG_H_
+#define ABRCC_VIDEO_CATALOG_H_
+
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wc++17-extensions"
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "base/memory/aligned_memory.h"
+#include "net/abrcc/dash_config.h"
+
+namespace quic {
+
+namespace VideoCatalogConstants {
+  // every row of a column starts on a cache line
+  const size_t alignment = 64;
+  // a row is padded to a multiple of `row_multiple` segments, such that the rows of
+  // both the 4 and the 8 byte columns stay aligned
+  const int row_multiple = 16;
+}
+
+// Immutable segment metadata of one title, shared by all the ABR sessions of the
+// title. It is built once from the DashBackendConfig and is read-only afterwards,
+// so it can be used from any thread.
+//
+// The metadata is stored as structure-of-arrays: one column per field, one row per
+// quality, such that the DP kernels iterating over segments of a quality read
+// contiguous memory. Besides the configuration's fields, the catalog precomputes:
+//   - kbits: the size of a segment in kbit, such that its download time(s) at a
+//            bandwidth of B kbps is kbits / B
+//   - duration_ms: the length(ms) of a segment from the start times of the segment
+//                  and its successor; the last segment takes the length of the one
+//                  before
+//
+// Qualities are indexed by the resources "/video<quality>": trackBitrate(quality) is
+// the bitrate(kbps) of a quality's track, while bitrates() are all the bitrates of
+// the configuration in increasing order. Segments are indexed from 0 and all the
+// qualities have segments() segments: longer tracks are truncated.
+//
+// For segments missing from the configuration, SegmentPredictor::Snapshot builds
+// catalogs of the same shape holding predicted values.
+class VideoCatalog {
+ public:
+  static std::shared_ptr<const VideoCatalog> Build(const DashBackendConfig& config);
+  // Returns the catalog of `config`, building it on first use; thread-safe.
+  static std::shared_ptr<const VideoCatalog> ForConfig(DashBackendConfig* config);
+
+  VideoCatalog(const VideoCatalog&) = delete;
+  VideoCatalog& operator=(const VideoCatalog&) = delete;
+  ~VideoCatalog();
+
+  int qualities() const { return qualities_; }
+  int segments() const { return segments_; }
+  const std::vector<int>& bitrates() const { return bitrates_; }
+  int trackBitrate(int quality) const { return track_bitrates_[quality]; }
+
+  // segments past the last read the last, segments before the first read the first
+  int size(int quality, int index) const { return size_.get()[clamped(quality, index)]; }
+  double kbits(int quality, int index) const { return kbits_.get()[clamped(quality, index)]; }
+  double vmaf(int quality, int index) const { return vmaf_.get()[clamped(quality, index)]; }
+  double startTime(int quality, int index) const {
+    return start_time_.get()[clamped(quality, index)];
+  }
+  int durationMs(int quality, int index) const {
+    return duration_ms_.get()[clamped(quality, index)];
+  }
+
+  // rows of a quality, holding segments() values
+  const double* kbitsRow(int quality) const { return kbits_.get() + at(quality, 0); }
+  const double* vmafRow(int quality) const { return vmaf_.get() + at(quality, 0); }
+ private:
+  // builds the catalogs of predicted segments
+  friend class SegmentPredictor;
+
+  template <typename T>
+  using Column = std::unique_ptr<T, base::AlignedFreeDeleter>;
+
+  VideoCatalog(int qualities, int segments);
+  // copy of the catalog, for a snapshot updating only some of its segments
+  std::shared_ptr<VideoCatalog> Clone() const;
+
+  template <typename T>
+  Column<T> NewColumn() const;
+  template <typename T>
+  void CopyColumn(const Column<T>& from, Column<T>* to) const;
+  int at(int quality, int index) const { return quality * stride + index; }
+  int clamped(int quality, int index) const {
+    return at(quality, std::max(0, std::min(index, segments_ - 1)));
+  }
+
+  int qualities_;
+  int segments_;
+  int stride;
+  std::vector<int> bitrates_;
+  std::vector<int> track_bitrates_;
+
+  Column<int> size_;
+  Column<double> kbits_;
+  Column<double> vmaf_;
+  Column<double> start_time_;
+  Column<int> duration_ms_;
+};
+
+}
+
+#pragma GCC diagnostic pop
+
+#endif
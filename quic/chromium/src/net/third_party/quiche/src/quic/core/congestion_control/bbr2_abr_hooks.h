@@ -0,0 +1,47 @@
+// Copyright 2019 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CONGESTION_CONTROL_BBR2_ABR_HOOKS_H_
+#define QUICHE_QUIC_CORE_CONGESTION_CONTROL_BBR2_ABR_HOOKS_H_
+
+#include "net/third_party/quiche/src/quic/core/congestion_control/bandwidth_sampler.h"
+#include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_misc.h"
+#include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_probe_bw.h"
+#include "net/third_party/quiche/src/quic/core/quic_bandwidth.h"
+#include "net/third_party/quiche/src/quic/core/quic_time.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Hooks through which the application(e.g. an ABR algorithm) steers a
+// Bbr2Sender. The hooks refine the BBRv2 model instead of replacing it: the
+// cwnd stays subject to inflight_hi and inflight_lo, so the sender keeps
+// BBRv2's loss responsiveness. All hooks are called on the network thread.
+class QUIC_EXPORT_PRIVATE Bbr2AbrHooks {
+ public:
+  virtual ~Bbr2AbrHooks() {}
+
+  // Returns the pacing gain of PROBE_BW's |phase|, given the default one.
+  virtual float PacingGainForPhase(Bbr2ProbeBwMode::CyclePhase phase,
+                                   float default_gain) = 0;
+
+  // Returns the bandwidth from which the pacing rate and the cwnd are
+  // computed; without hooks, this is |model|'s BandwidthEstimate().
+  virtual QuicBandwidth TargetBandwidth(const Bbr2NetworkModel& model) = 0;
+
+  // Called for each valid bandwidth sample of an ack event.
+  virtual void OnBandwidthSample(QuicTime event_time,
+                                 const BandwidthSample& sample,
+                                 QuicByteCount bytes_acked) = 0;
+
+  // Called after the sender's pacing rate and cwnd were updated for a
+  // congestion event.
+  virtual void OnCongestionEventFinish(
+      const Bbr2CongestionEvent& congestion_event,
+      const Bbr2NetworkModel& model) = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CONGESTION_CONTROL_BBR2_ABR_HOOKS_H_
@@ -5,6 +5,7 @@
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_misc.h"
 
 #include "net/third_party/quiche/src/quic/core/congestion_control/bandwidth_sampler.h"
+#include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_abr_hooks.h"
 #include "net/third_party/quiche/src/quic/core/quic_bandwidth.h"
 #include "net/third_party/quiche/src/quic/core/quic_time.h"
 #include "net/third_party/quiche/src/quic/core/quic_types.h"
@@ -123,6 +124,11 @@ void Bbr2NetworkModel::OnCongestionEventStart(
       continue;
     }
 
+    if (abr_hooks_ != nullptr) {
+      abr_hooks_->OnBandwidthSample(event_time, bandwidth_sample,
+                                    packet.bytes_acked);
+    }
+
     congestion_event->last_sample_is_app_limited =
         bandwidth_sample.state_at_send.is_app_limited;
     if (!bandwidth_sample.rtt.IsZero()) {
@@ -272,6 +272,8 @@ struct QUIC_EXPORT_PRIVATE Bbr2CongestionEvent {
 QUIC_EXPORT_PRIVATE const SendTimeState& SendStateOfLargestPacket(
     const Bbr2CongestionEvent& congestion_event);
 
+class Bbr2AbrHooks;
+
 // Bbr2NetworkModel takes low level congestion signals(packets sent/acked/lost)
 // as input and produces BBRv2 model parameters like inflight_(hi|lo),
 // bandwidth_(hi|lo), bandwidth and rtt estimates, etc.
@@ -404,6 +406,9 @@ class QUIC_EXPORT_PRIVATE Bbr2NetworkModel {
   float pacing_gain() const { return pacing_gain_; }
   void set_pacing_gain(float pacing_gain) { pacing_gain_ = pacing_gain; }
 
+  // |hooks| are notified of every valid bandwidth sample; may be nullptr.
+  void set_abr_hooks(Bbr2AbrHooks* hooks) { abr_hooks_ = hooks; }
+
  private:
   const Bbr2Params& Params() const { return *params_; }
   const Bbr2Params* const params_;
@@ -433,6 +438,9 @@ class QUIC_EXPORT_PRIVATE Bbr2NetworkModel {
 
   float cwnd_gain_;
   float pacing_gain_;
+
+  // Not owned.
+  Bbr2AbrHooks* abr_hooks_ = nullptr;
 };
 
 enum class Bbr2Mode : uint8_t {
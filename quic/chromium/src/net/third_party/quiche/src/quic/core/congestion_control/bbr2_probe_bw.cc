@@ -4,6 +4,7 @@
 
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_probe_bw.h"
 
+#include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_abr_hooks.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_misc.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_sender.h"
 #include "net/third_party/quiche/src/quic/core/quic_bandwidth.h"
@@ -525,13 +526,18 @@ const Bbr2Params& Bbr2ProbeBwMode::Params() const {
 
 float Bbr2ProbeBwMode::PacingGainForPhase(
     Bbr2ProbeBwMode::CyclePhase phase) const {
+  float gain = Params().probe_bw_default_pacing_gain;
   if (phase == Bbr2ProbeBwMode::CyclePhase::PROBE_UP) {
-    return Params().probe_bw_probe_up_pacing_gain;
+    gain = Params().probe_bw_probe_up_pacing_gain;
+  } else if (phase == Bbr2ProbeBwMode::CyclePhase::PROBE_DOWN) {
+    gain = Params().probe_bw_probe_down_pacing_gain;
   }
-  if (phase == Bbr2ProbeBwMode::CyclePhase::PROBE_DOWN) {
-    return Params().probe_bw_probe_down_pacing_gain;
+
+  Bbr2AbrHooks* hooks = sender_->abr_hooks();
+  if (hooks != nullptr) {
+    return hooks->PacingGainForPhase(phase, gain);
   }
-  return Params().probe_bw_default_pacing_gain;
+  return gain;
 }
 
 }  // namespace quic
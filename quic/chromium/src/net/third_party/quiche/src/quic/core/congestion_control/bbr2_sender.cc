@@ -80,7 +80,8 @@ Bbr2Sender::Bbr2Sender(QuicTime now,
       probe_bw_(this, &model_),
       probe_rtt_(this, &model_),
       flexible_app_limited_(false),
-      last_sample_is_app_limited_(false) {
+      last_sample_is_app_limited_(false),
+      abr_hooks_(nullptr) {
   QUIC_DVLOG(2) << this << " Initializing Bbr2Sender. mode:" << mode_
                 << ", PacingRate:" << pacing_rate_ << ", Cwnd:" << cwnd_
                 << ", CwndLimits:" << cwnd_limits() << "  @ " << now;
@@ -94,6 +95,11 @@ void Bbr2Sender::SetFromConfig(const QuicConfig& config,
   }
 }
 
+void Bbr2Sender::SetAbrHooks(std::unique_ptr<Bbr2AbrHooks> hooks) {
+  abr_hooks_ = std::move(hooks);
+  model_.set_abr_hooks(abr_hooks_.get());
+}
+
 Limits<QuicByteCount> Bbr2Sender::GetCwndLimitsByMode() const {
   switch (mode_) {
     case Bbr2Mode::STARTUP:
@@ -187,6 +193,10 @@ void Bbr2Sender::OnCongestionEvent(bool /*rtt_updated*/,
                                  congestion_event);
   last_sample_is_app_limited_ = congestion_event.last_sample_is_app_limited;
 
+  if (abr_hooks_ != nullptr) {
+    abr_hooks_->OnCongestionEventFinish(congestion_event, model_);
+  }
+
   QUIC_DVLOG(3)
       << this << " END CongestionEvent(acked:" << acked_packets
       << ", lost:" << lost_packets.size() << ") "
@@ -221,7 +231,7 @@ void Bbr2Sender::UpdatePacingRate(QuicByteCount bytes_acked) {
     return;
   }
 
-  QuicBandwidth target_rate = model_.pacing_gain() * model_.BandwidthEstimate();
+  QuicBandwidth target_rate = model_.pacing_gain() * TargetBandwidth();
   if (startup_.FullBandwidthReached()) {
     pacing_rate_ = target_rate;
     return;
@@ -261,8 +271,14 @@ void Bbr2Sender::UpdateCongestionWindow(QuicByteCount bytes_acked) {
 }
 
 QuicByteCount Bbr2Sender::GetTargetCongestionWindow(float gain) const {
-  return std::max(model_.BDP(model_.BandwidthEstimate(), gain),
-                  cwnd_limits().Min());
+  return std::max(model_.BDP(TargetBandwidth(), gain), cwnd_limits().Min());
+}
+
+QuicBandwidth Bbr2Sender::TargetBandwidth() const {
+  if (abr_hooks_ != nullptr) {
+    return abr_hooks_->TargetBandwidth(model_);
+  }
+  return model_.BandwidthEstimate();
 }
 
 void Bbr2Sender::OnPacketSent(QuicTime sent_time,
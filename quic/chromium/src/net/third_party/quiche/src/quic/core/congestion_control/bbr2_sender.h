@@ -6,8 +6,10 @@
 #define QUICHE_QUIC_CORE_CONGESTION_CONTROL_BBR2_SENDER_H_
 
 #include <cstdint>
+#include <memory>
 
 #include "net/third_party/quiche/src/quic/core/congestion_control/bandwidth_sampler.h"
+#include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_abr_hooks.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_drain.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_misc.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_probe_bw.h"
@@ -95,6 +97,10 @@ class QUIC_EXPORT_PRIVATE Bbr2Sender final : public SendAlgorithmInterface {
     return cwnd_limits().Min();
   }
 
+  // Lets |hooks| steer the sender; see Bbr2AbrHooks.
+  void SetAbrHooks(std::unique_ptr<Bbr2AbrHooks> hooks);
+  Bbr2AbrHooks* abr_hooks() const { return abr_hooks_.get(); }
+
   struct QUIC_EXPORT_PRIVATE DebugState {
     Bbr2Mode mode;
 
@@ -127,6 +133,9 @@ class QUIC_EXPORT_PRIVATE Bbr2Sender final : public SendAlgorithmInterface {
   void UpdateCongestionWindow(QuicByteCount bytes_acked);
   QuicByteCount GetTargetCongestionWindow(float gain) const;
 
+  // The bandwidth estimate, as adjusted by the ABR hooks.
+  QuicBandwidth TargetBandwidth() const;
+
   // Helper function for BBR2_MODE_DISPATCH.
   Bbr2ProbeRttMode& probe_rtt_or_die() {
     DCHECK_EQ(mode_, Bbr2Mode::PROBE_RTT);
@@ -180,6 +189,8 @@ class QUIC_EXPORT_PRIVATE Bbr2Sender final : public SendAlgorithmInterface {
   // Debug only.
   bool last_sample_is_app_limited_;
 
+  std::unique_ptr<Bbr2AbrHooks> abr_hooks_;
+
   friend class Bbr2StartupMode;
   friend class Bbr2DrainMode;
   friend class Bbr2ProbeBwMode;
@@ -6,11 +6,15 @@
 
 #include "net/abrcc/cc/cc_wrapper.h"
 #include "net/abrcc/cc/cc_selector.h"
+#include "net/abrcc/cc/connection_interfaces.h"
 #include "net/abrcc/cc/bbr_adapter.h"
+#include "net/abrcc/cc/bbr2_abr.h"
 #include "net/abrcc/cc/target.h"
 #include "net/abrcc/cc/gap.h"
 #include "net/abrcc/cc/minerva.h"
+#include "net/abrcc/cc/pcc_vivace.h"
 
+#include "net/third_party/quiche/src/quic/core/congestion_control/bbr2_sender.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/bbr_sender.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/tcp_cubic_sender_bytes.h"
 #include "net/third_party/quiche/src/quic/core/quic_packets.h"
@@ -19,49 +23,56 @@
 #include "net/third_party/quiche/src/quic/platform/api/quic_fallthrough.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_flag_utils.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_flags.h"
-#include "net/third_party/quiche/src/quic/platform/api/quic_pcc_sender.h"
 
 namespace quic {
 
 class RttStats;
 
-// Factory for send side congestion control algorithm.
-SendAlgorithmInterface* SendAlgorithmInterface::Create(
+namespace {
+
+// abrcc: builds the bare sender of `congestion_control_type`, attached to the ABR
+// interfaces of `interfaces`.
+SendAlgorithmInterface* NewSender(
     const QuicClock* clock,
     const RttStats* rtt_stats,
     const QuicUnackedPacketMap* unacked_packets,
     CongestionControlType congestion_control_type,
     QuicRandom* random,
     QuicConnectionStats* stats,
-    QuicPacketCount initial_congestion_window) {
-  QuicPacketCount max_congestion_window =
-      GetQuicFlag(FLAGS_quic_max_congestion_window);
-  congestion_control_type = kBBR;
-  
-  auto *selector = CCSelector::GetInstance();
-  congestion_control_type = selector->getCongestionControlType();
-  
-  QUIC_LOG(WARNING) << "CC " << congestion_control_type;
+    QuicPacketCount initial_congestion_window,
+    QuicPacketCount max_congestion_window,
+    ConnectionInterfaces* interfaces) {
   SendAlgorithmInterface* instance = nullptr;
   switch (congestion_control_type) {
     case kAbbr:
       QUIC_LOG(WARNING) << "Using Adapter BBR";
       instance = new BbrAdapter(clock->ApproximateNow(), rtt_stats, unacked_packets,
                            initial_congestion_window, max_congestion_window,
-                           random, stats);
+                           random, stats, interfaces->adapter());
       break;
     case kTarget:
       QUIC_LOG(WARNING) << "Using Target CC";
       instance = new BbrTarget(clock->ApproximateNow(), rtt_stats, unacked_packets,
                            initial_congestion_window, max_congestion_window,
-                           random, stats);
+                           random, stats, interfaces->target());
       break;
     case kGap:
       QUIC_LOG(WARNING) << "Using Gap CC";
       instance = new BbrGap(clock->ApproximateNow(), rtt_stats, unacked_packets,
                            initial_congestion_window, max_congestion_window,
-                           random, stats);
+                           random, stats, interfaces->gap());
+      break;
+    case kBbr2Target:
+    case kBbr2Gap: {
+      QUIC_LOG(WARNING) << "Using BBRv2 with ABR hooks";
+      auto *sender = new Bbr2Sender(clock->ApproximateNow(), rtt_stats,
+                                    unacked_packets, initial_congestion_window,
+                                    max_congestion_window, random, stats);
+      sender->SetAbrHooks(std::unique_ptr<Bbr2AbrHooks>(
+          new Bbr2Abr(congestion_control_type, interfaces)));
+      instance = sender;
       break;
+    }
     case kGoogCC:  
     case kBBR:
       QUIC_LOG(WARNING) << "Using BBR";
@@ -77,9 +88,9 @@ SendAlgorithmInterface* SendAlgorithmInterface::Create(
       break;
     case kPCC:
       QUIC_LOG(WARNING) << "Using PCC";
-      instance = CreatePccSender(clock, rtt_stats, unacked_packets, random, stats,
-                               initial_congestion_window,
-                               max_congestion_window);
+      instance = new PccVivace(clock->ApproximateNow(), rtt_stats, unacked_packets,
+                               initial_congestion_window, max_congestion_window,
+                               random, stats, interfaces->target());
       break;
     case kCubicBytes:
       QUIC_LOG(WARNING) << "Using Cubic";
@@ -90,7 +101,8 @@ SendAlgorithmInterface* SendAlgorithmInterface::Create(
     case kMinervaBytes:
       QUIC_LOG(WARNING) << "Using Minerva";
       instance = new TcpMinervaSenderBytes(
-          rtt_stats, initial_congestion_window, max_congestion_window, stats);
+          rtt_stats, initial_congestion_window, max_congestion_window, stats,
+          interfaces->minerva());
       break;
     case kRenoBytes:
       QUIC_LOG(WARNING) << "Using Reno";
@@ -99,8 +111,61 @@ SendAlgorithmInterface* SendAlgorithmInterface::Create(
                                      max_congestion_window, stats);
       break;
   }
+  return instance;
+}
+
+}  // namespace
+
+// Factory for send side congestion control algorithm.
+SendAlgorithmInterface* SendAlgorithmInterface::Create(
+    const QuicClock* clock,
+    const RttStats* rtt_stats,
+    const QuicUnackedPacketMap* unacked_packets,
+    CongestionControlType congestion_control_type,
+    QuicRandom* random,
+    QuicConnectionStats* stats,
+    QuicPacketCount initial_congestion_window) {
+  auto *selector = CCSelector::GetInstance();
+  return CreateForConnection(clock, rtt_stats, unacked_packets,
+                             selector->getCongestionControlType(), random,
+                             stats, initial_congestion_window);
+}
+
+SendAlgorithmInterface* SendAlgorithmInterface::CreateForConnection(
+    const QuicClock* clock,
+    const RttStats* rtt_stats,
+    const QuicUnackedPacketMap* unacked_packets,
+    CongestionControlType congestion_control_type,
+    QuicRandom* random,
+    QuicConnectionStats* stats,
+    QuicPacketCount initial_congestion_window) {
+  QuicPacketCount max_congestion_window =
+      GetQuicFlag(FLAGS_quic_max_congestion_window);
+  auto *selector = CCSelector::GetInstance();
+  
+  QUIC_LOG(WARNING) << "CC " << congestion_control_type;
+  // abrcc: the connection's ABR interfaces, bound by its ABR through the wrapper
+  auto interfaces = std::make_shared<ConnectionInterfaces>();
+  SendAlgorithmInterface* instance = NewSender(
+      clock, rtt_stats, unacked_packets, congestion_control_type, random, stats,
+      initial_congestion_window, max_congestion_window, interfaces.get());
   selector->setSendAlgorithmInterface(instance);
-  return new CCWrapper(instance);
+  auto* wrapper = new CCWrapper(instance, rtt_stats, congestion_control_type,
+                                interfaces);
+
+  // abrcc: shadows see the connection's events without controlling it; each one
+  // gets interfaces of its own, which no ABR reads
+  for (CongestionControlType shadow_type :
+       selector->getShadowCongestionControlTypes(congestion_control_type)) {
+    QUIC_LOG(WARNING) << "Shadow CC " << shadow_type;
+    auto shadow_interfaces = std::make_shared<ConnectionInterfaces>();
+    wrapper->AddShadow(
+        NewSender(clock, rtt_stats, unacked_packets, shadow_type, random,
+                  wrapper->shadow_stats(), initial_congestion_window,
+                  max_congestion_window, shadow_interfaces.get()),
+        shadow_type, shadow_interfaces);
+  }
+  return wrapper;
 }
 
 }  // namespace quic
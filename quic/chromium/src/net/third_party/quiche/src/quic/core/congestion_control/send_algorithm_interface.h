@@ -21,6 +21,7 @@
 #include "net/third_party/quiche/src/quic/core/quic_unacked_packet_map.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_clock.h"
 #include "net/third_party/quiche/src/quic/platform/api/quic_export.h"
+#include "net/third_party/quiche/src/quic/platform/api/quic_socket_address.h"
 
 namespace quic {
 
@@ -74,6 +75,17 @@ class QUIC_EXPORT_PRIVATE SendAlgorithmInterface {
       QuicConnectionStats* stats,
       QuicPacketCount initial_congestion_window);
 
+  // abrcc: creates a sender of `type` for a single connection; unlike Create, the
+  // type is not overridden by the CCSelector's process-wide type.
+  static SendAlgorithmInterface* CreateForConnection(
+      const QuicClock* clock,
+      const RttStats* rtt_stats,
+      const QuicUnackedPacketMap* unacked_packets,
+      CongestionControlType type,
+      QuicRandom* random,
+      QuicConnectionStats* stats,
+      QuicPacketCount initial_congestion_window);
+
   virtual ~SendAlgorithmInterface() {}
 
   virtual void SetFromConfig(const QuicConfig& config,
@@ -111,6 +123,26 @@ class QUIC_EXPORT_PRIVATE SendAlgorithmInterface {
   // Called when connection migrates and cwnd needs to be reset.
   virtual void OnConnectionMigration() = 0;
 
+  // abrcc: called with the peer's address once the connection is configured and
+  // after each migration, such that senders can be coupled per client.
+  virtual void SetPeerAddress(const QuicSocketAddress& /*peer_address*/) {}
+
+  // abrcc: called once the RTT stats took the sample |send_delta|, acked after
+  // |ack_delay| at the peer, such that the sender's inputs can be captured.
+  virtual void OnRttUpdated(QuicTime::Delta /*send_delta*/,
+                            QuicTime::Delta /*ack_delay*/,
+                            QuicTime /*now*/) {}
+
+  // abrcc: called when the application starts or ends a burst of data(e.g. a
+  // video segment), such that samples taken while the application is idle
+  // between bursts can be told apart from the ones of a full pipe.
+  virtual void OnApplicationBurst(bool /*started*/) {}
+
+  // abrcc: called on a sender replaced by another before being destroyed(e.g.
+  // by a connection option), such that it can drop the telemetry and captures it
+  // opened for a connection it never controlled.
+  virtual void OnReplaced() {}
+
   // Make decision on whether the sender can send right now.  Note that even
   // when this method returns true, the sending can be delayed due to pacing.
   virtual bool CanSend(QuicByteCount bytes_in_flight) = 0;
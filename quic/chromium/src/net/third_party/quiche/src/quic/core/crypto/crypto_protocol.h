@@ -29,8 +29,18 @@ typedef std::string ServerConfigID;
 // The following tags have been deprecated and should not be reused:
 // "1CON", "BBQ4", "NCON", "RCID", "SREJ", "TBKP", "TB10"
 
-// abrcc
-const QuicTag kDMY = TAG('K', 'D', 'M', 'Y'); // Dummy ABRCC
+// abrcc: per-connection congestion control; overrides the server's --cc_type
+const QuicTag kACBB = TAG('A', 'C', 'B', 'B');   // BBR
+const QuicTag kACB2 = TAG('A', 'C', 'B', '2');   // BBRv2
+const QuicTag kACAB = TAG('A', 'C', 'A', 'B');   // Adapter BBR
+const QuicTag kACTG = TAG('A', 'C', 'T', 'G');   // Target CC
+const QuicTag kACGP = TAG('A', 'C', 'G', 'P');   // Gap CC
+const QuicTag kACT2 = TAG('A', 'C', 'T', '2');   // Target hooks on BBRv2
+const QuicTag kACG2 = TAG('A', 'C', 'G', '2');   // Gap hooks on BBRv2
+const QuicTag kACMN = TAG('A', 'C', 'M', 'N');   // Minerva
+const QuicTag kACPC = TAG('A', 'C', 'P', 'C');   // PCC
+const QuicTag kACCU = TAG('A', 'C', 'C', 'U');   // Cubic
+const QuicTag kACRN = TAG('A', 'C', 'R', 'N');   // Reno
 
 // clang-format off
 const QuicTag kCHLO = TAG('C', 'H', 'L', 'O');   // Client hello
@@ -30,6 +30,7 @@ QuicServerSessionBase::QuicServerSessionBase(
       compressed_certs_cache_(compressed_certs_cache),
       helper_(helper),
       bandwidth_resumption_enabled_(false),
+      bandwidth_resumed_(false),
       bandwidth_estimate_sent_to_client_(QuicBandwidth::Zero()),
       last_scup_time_(QuicTime::Zero()) {}
 
@@ -75,6 +76,7 @@ void QuicServerSessionBase::OnConfigNegotiated() {
       if (seconds_since_estimate <= kNumSecondsPerHour) {
         connection()->ResumeConnectionState(*cached_network_params,
                                             max_bandwidth_resumption);
+        bandwidth_resumed_ = true;
       }
     }
   }
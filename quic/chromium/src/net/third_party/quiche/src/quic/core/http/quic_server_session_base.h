@@ -68,6 +68,13 @@ class QUIC_EXPORT_PRIVATE QuicServerSessionBase : public QuicSpdySession {
     serving_region_ = serving_region;
   }
 
+  // abrcc: the cached network parameters the connection's sender was resumed
+  // from, or nullptr if the connection started without a previous estimate.
+  const CachedNetworkParameters* resumed_network_params() const {
+    return bandwidth_resumed_ ? crypto_stream_->PreviousCachedNetworkParams()
+                              : nullptr;
+  }
+
  protected:
   // QuicSession methods(override them with return type of QuicSpdyStream*):
   QuicCryptoServerStreamBase* GetMutableCryptoStream() override;
@@ -113,6 +120,10 @@ class QUIC_EXPORT_PRIVATE QuicServerSessionBase : public QuicSpdySession {
   // Whether bandwidth resumption is enabled for this connection.
   bool bandwidth_resumption_enabled_;
 
+  // abrcc: whether the sender was resumed from the client's cached network
+  // parameters.
+  bool bandwidth_resumed_;
+
   // The most recent bandwidth estimate sent to the client.
   QuicBandwidth bandwidth_estimate_sent_to_client_;
 
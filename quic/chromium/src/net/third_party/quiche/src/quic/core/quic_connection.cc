@@ -419,6 +419,8 @@ void QuicConnection::SetFromConfig(const QuicConfig& config) {
   }
 
   sent_packet_manager_.SetFromConfig(config);
+  // abrcc: the send algorithm is settled once the config is applied
+  sent_packet_manager_.SetPeerAddress(effective_peer_address_);
   if (config.HasReceivedBytesForConnectionId() &&
       can_truncate_connection_ids_) {
     packet_creator_.SetServerConnectionIdLength(
@@ -3662,6 +3664,7 @@ void QuicConnection::StartEffectivePeerMigration(AddressChangeType type) {
 void QuicConnection::OnConnectionMigration(AddressChangeType addr_change_type) {
   visitor_->OnConnectionMigration(addr_change_type);
   sent_packet_manager_.OnConnectionMigration(addr_change_type);
+  sent_packet_manager_.SetPeerAddress(effective_peer_address_);
 }
 
 bool QuicConnection::IsCurrentPacketConnectivityProbing() const {
@@ -7,6 +7,7 @@
 #include <algorithm>
 #include <string>
 
+#include "net/abrcc/cc/cc_selector.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/general_loss_algorithm.h"
 #include "net/third_party/quiche/src/quic/core/congestion_control/pacing_sender.h"
 #include "net/third_party/quiche/src/quic/core/crypto/crypto_protocol.h"
@@ -118,13 +119,7 @@ QuicSentPacketManager::~QuicSentPacketManager() {}
 
 void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
   const Perspective perspective = unacked_packets_.perspective();
-  
-  // [TODO] AbrCC -- seam for CC
-  // printf("kDMY receive\n");
-  // send_algorithm_.reset(SendAlgorithmInterface::Create(
-  //  clock_, &rtt_stats_, kDMY, stats_, initial_congestion_window_));
 
-  
   if (config.HasReceivedInitialRoundTripTimeUs() &&
       config.ReceivedInitialRoundTripTimeUs() > 0) {
     if (!config.HasClientSentConnectionOption(kNRTT, perspective)) {
@@ -219,6 +214,15 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
     SetSendAlgorithm(kPCC);
   }
 
+  // abrcc: per-connection congestion control requested by the client
+  auto requested_type =
+      CCSelector::getRequestedCongestionControlType(config, perspective);
+  if (requested_type != base::nullopt) {
+    SetSendAlgorithm(SendAlgorithmInterface::CreateForConnection(
+        clock_, &rtt_stats_, &unacked_packets_, requested_type.value(), random_,
+        stats_, initial_congestion_window_));
+  }
+
   // Initial window.
   if (GetQuicReloadableFlag(quic_unified_iw_options)) {
     if (config.HasClientRequestedIndependentOption(kIW03, perspective)) {
@@ -918,6 +922,8 @@ bool QuicSentPacketManager::MaybeUpdateRTT(QuicPacketNumber largest_acked,
 
   QuicTime::Delta send_delta = ack_receive_time - transmission_info.sent_time;
   rtt_stats_.UpdateRtt(send_delta, ack_delay_time, ack_receive_time);
+  // abrcc: lets the send algorithm capture the sample
+  send_algorithm_->OnRttUpdated(send_delta, ack_delay_time, ack_receive_time);
 
   return true;
 }
@@ -1109,6 +1115,10 @@ void QuicSentPacketManager::SetSendAlgorithm(
 
 void QuicSentPacketManager::SetSendAlgorithm(
     SendAlgorithmInterface* send_algorithm) {
+  if (send_algorithm_ != nullptr) {
+    // abrcc: lets the replaced sender drop what it opened for the connection
+    send_algorithm_->OnReplaced();
+  }
   send_algorithm_.reset(send_algorithm);
   pacing_sender_.set_sender(send_algorithm);
 }
@@ -1126,6 +1136,15 @@ void QuicSentPacketManager::OnConnectionMigration(AddressChangeType type) {
   send_algorithm_->OnConnectionMigration();
 }
 
+void QuicSentPacketManager::SetPeerAddress(
+    const QuicSocketAddress& peer_address) {
+  send_algorithm_->SetPeerAddress(peer_address);
+}
+
+void QuicSentPacketManager::OnApplicationBurst(bool started) {
+  send_algorithm_->OnApplicationBurst(started);
+}
+
 void QuicSentPacketManager::OnAckFrameStart(QuicPacketNumber largest_acked,
                                             QuicTime::Delta ack_delay_time,
                                             QuicTime ack_receive_time) {
@@ -286,6 +286,13 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // Called when peer address changes and the connection migrates.
   void OnConnectionMigration(AddressChangeType type);
 
+  // abrcc: forwards the peer's address to the send algorithm.
+  void SetPeerAddress(const QuicSocketAddress& peer_address);
+
+  // abrcc: forwards the start or end of an application burst to the send
+  // algorithm.
+  void OnApplicationBurst(bool started);
+
   // Called when an ack frame is initially parsed.
   void OnAckFrameStart(QuicPacketNumber largest_acked,
                        QuicTime::Delta ack_delay_time,
@@ -397,7 +397,9 @@ enum CongestionControlType {
   kBBRv2,
   kAbbr,
   kTarget,
-  kGap
+  kGap,
+  kBbr2Target,
+  kBbr2Gap
 };
 
 enum LossDetectionType : uint8_t {
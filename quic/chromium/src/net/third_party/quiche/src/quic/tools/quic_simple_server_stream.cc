@@ -171,6 +171,22 @@ std::string QuicSimpleServerStream::peer_host() const {
   return spdy_session()->peer_address().host().ToString();
 }
 
+void QuicSimpleServerStream::OnApplicationBurst(bool started) {
+  spdy_session()->connection()->sent_packet_manager().OnApplicationBurst(
+      started);
+}
+
+const CachedNetworkParameters* QuicSimpleServerStream::ResumedNetworkParams()
+    const {
+  // the simple server's streams belong to QuicSimpleServerSessions
+  return static_cast<const QuicServerSessionBase*>(spdy_session())
+      ->resumed_network_params();
+}
+
+const SendAlgorithmInterface* QuicSimpleServerStream::SendAlgorithm() const {
+  return spdy_session()->connection()->sent_packet_manager().GetSendAlgorithm();
+}
+
 void QuicSimpleServerStream::OnResponseBackendComplete(
     const QuicBackendResponse* response,
     std::list<QuicBackendResponse::ServerPushInfo> resources) {
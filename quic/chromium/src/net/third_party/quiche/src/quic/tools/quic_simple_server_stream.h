@@ -14,6 +14,8 @@
 
 namespace quic {
 
+class CachedNetworkParameters;
+
 // All this does right now is aggregate data, and on fin, send an HTTP
 // response.
 class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
@@ -61,6 +63,24 @@ class QuicSimpleServerStream : public QuicSpdyServerStreamBase,
       const QuicBackendResponse* response,
       std::list<QuicBackendResponse::ServerPushInfo> resources) override;
 
+  // Notifies |ack_listener| of the acked and retransmitted body bytes of the
+  // response. Must be called before the response is sent.
+  void SetResponseAckListener(
+      QuicReferenceCountedPointer<QuicAckListenerInterface> ack_listener) {
+    set_ack_listener(std::move(ack_listener));
+  }
+
+  // Signals the start or the end of the response's burst to the connection's
+  // sender.
+  void OnApplicationBurst(bool started);
+
+  // Cached network parameters the connection's sender was resumed from, or
+  // nullptr if the connection started cold.
+  const CachedNetworkParameters* ResumedNetworkParams() const;
+
+  // The connection's sender; abrcc's senders are all wrapped in a CCWrapper.
+  const SendAlgorithmInterface* SendAlgorithm() const;
+
  protected:
   // Sends a basic 200 response using SendHeaders for the headers and WriteData
   // for the body.
@@ -117,13 +117,24 @@ bool QuicSimpleServer::Listen(const IPEndPoint& address) {
       quic_simple_server_backend_, quic::kQuicDefaultConnectionIdLength));
   QuicSimpleServerPacketWriter* writer =
       new QuicSimpleServerPacketWriter(socket_.get(), dispatcher_.get());
-  dispatcher_->InitializeWithWriter(writer);
+  if (writer_wrapper_) {
+    writer_wrapper_->set_writer(writer);
+    dispatcher_->InitializeWithWriter(writer_wrapper_.release());
+  } else {
+    dispatcher_->InitializeWithWriter(writer);
+  }
 
   StartReading();
 
   return true;
 }
 
+void QuicSimpleServer::SetPacketWriterWrapper(
+    std::unique_ptr<quic::QuicPacketWriterWrapper> writer_wrapper) {
+  DCHECK(!dispatcher_);
+  writer_wrapper_ = std::move(writer_wrapper);
+}
+
 void QuicSimpleServer::Shutdown() {
   // Before we shut down the epoll server, give all active sessions a chance to
   // notify clients that they're closing.
@@ -18,6 +18,7 @@
 #include "net/quic/quic_chromium_connection_helper.h"
 #include "net/third_party/quiche/src/quic/core/crypto/quic_crypto_server_config.h"
 #include "net/third_party/quiche/src/quic/core/quic_config.h"
+#include "net/third_party/quiche/src/quic/core/quic_packet_writer_wrapper.h"
 #include "net/third_party/quiche/src/quic/core/quic_version_manager.h"
 #include "net/third_party/quiche/src/quic/tools/quic_simple_server_backend.h"
 #include "net/third_party/quiche/src/quic/tools/quic_spdy_server_base.h"
@@ -55,6 +56,11 @@ class QuicSimpleServer : public quic::QuicSpdyServerBase {
   // Start listening on the specified address. Returns true on success.
   bool Listen(const IPEndPoint& address);
 
+  // Wraps the writer of the server's socket, e.g. to emulate a network link.
+  // Must be called before listening.
+  void SetPacketWriterWrapper(
+      std::unique_ptr<quic::QuicPacketWriterWrapper> writer_wrapper);
+
   // Server deletion is imminent. Start cleaning up.
   void Shutdown();
 
@@ -93,6 +99,10 @@ class QuicSimpleServer : public quic::QuicSpdyServerBase {
   // Listening socket. Also used for outbound client communication.
   std::unique_ptr<UDPServerSocket> socket_;
 
+  // Wrapper of the socket's writer, if any. Owned by dispatcher_ once
+  // listening.
+  std::unique_ptr<quic::QuicPacketWriterWrapper> writer_wrapper_;
+
   // config_ contains non-crypto parameters that are negotiated in the crypto
   // handshake.
   quic::QuicConfig config_;
@@ -22,6 +22,23 @@ DASH_COMPRESS=""
 VERBOSE=""
 CC="bbr"
 ABR="bb"
+TELEMETRY=""
+COUPLED_CC="false"
+COUPLED_CC_BOARD=""
+CC_CAPTURE=""
+SHADOW_CC=""
+TITLES=""
+SEGMENT_CACHE=""
+ORIGIN=""
+CONTROL_PORT="0"
+CONTROL_ORIGINS=""
+BANDWIDTH_RESUMPTION="false"
+QUIC_OPTIONS=""
+EMULATION_TRACE=""
+EMULATION_DELAY="0"
+EMULATION_QUEUE_BYTES="65536"
+EMULATION_QUEUE="droptail"
+EMULATION_LOSS="0"
 
 function build {
     log "Building $1"
@@ -63,6 +80,9 @@ function build_dash_client_npm {
     if [ ! -z $PORT ]; then 
         DASH_ARGS="${DASH_ARGS} quic-port=${PORT}"
     fi
+    if [ "$CONTROL_PORT" != "0" ]; then 
+        DASH_ARGS="${DASH_ARGS} control-port=${CONTROL_PORT}"
+    fi
     run_cmd npm run build $DASH_ARGS $SITE
     if [ ! -z $DASH_COMPRESS ]; then 
         run_cmd npm run build:compress
@@ -92,6 +112,23 @@ function quic_server {
     run_cmd $OUT_DIR/dash_server \
         $VERBOSE \
         --minerva_config_path=$DIR/minerva_pq_configs \
+        --pensieve_model_path=$DIR/../exp/abr/results/pretrain_linear_reward.txt \
+        --telemetry_path=$TELEMETRY \
+        --coupled_cc=$COUPLED_CC \
+        --coupled_cc_board=$COUPLED_CC_BOARD \
+        --cc_capture_path=$CC_CAPTURE \
+        --shadow_cc=$SHADOW_CC \
+        --titles_path=$TITLES \
+        --segment_cache_path=$SEGMENT_CACHE \
+        --origin_url=$ORIGIN \
+        --control_port=$CONTROL_PORT \
+        --control_origins=$CONTROL_ORIGINS \
+        --bandwidth_resumption=$BANDWIDTH_RESUMPTION \
+        --emulation_trace=$EMULATION_TRACE \
+        --emulation_delay_ms=$EMULATION_DELAY \
+        --emulation_queue_bytes=$EMULATION_QUEUE_BYTES \
+        --emulation_queue=$EMULATION_QUEUE \
+        --emulation_loss=$EMULATION_LOSS \
         --quic_config_path=$DIR/sites/$VIDEO/config.json \
         --cc_type=$CC \
         --abr_type=$ABR \
@@ -110,6 +147,7 @@ function quic_chrome {
             --user-data-dir=/tmp/$PROFILE \
             --no-proxy-server \
             --enable-quic \
+            $QUIC_OPTIONS \
             --origin-to-force-quic-on=$SITE:$PORT \
             --autoplay-policy=no-user-gesture-required \
             --ignore-certificate-errors \
@@ -125,6 +163,7 @@ function quic_chrome {
             --user-data-dir=/tmp/$PROFILE \
             --no-proxy-server \
             --enable-quic \
+            $QUIC_OPTIONS \
             --origin-to-force-quic-on=$SITE:$PORT \
             --autoplay-policy=no-user-gesture-required \
             --ignore-certificate-errors \
@@ -149,9 +188,25 @@ function usage() {
     printf "\t %- 30s %s\n" "-b | --build" "Build quic client and server."
     printf "\t %- 30s %s\n" "-vid | --video" "Specify name of video to be served."
     printf "\t %- 30s %s\n" "--chrome" "Run a quic client in Chrome."
-    printf "\t %- 30s %s\n" "--cc [congestion-control]" "Select congestion control from [bbr, abbr, xbbr, pcc, cubic, reno, target, gap]."
-    printf "\t %- 30s %s\n" "--abr [server-abr-type]" "Select server-side abor from [bb, random, worthed, target, target2, target3, gap, remote]."
+    printf "\t %- 30s %s\n" "--cc [congestion-control]" "Select congestion control from [bbr, abbr, xbbr, pcc, cubic, reno, target, gap, bbr2target, bbr2gap]."
+    printf "\t %- 30s %s\n" "--connection-cc [congestion-control]" "Request a congestion control for Chrome's connection from [bbr, bbr2, abbr, target, gap, bbr2target, bbr2gap, minerva, pcc, cubic, reno]; if the server's ABR does not read the requested control, the connection is served by the control's own ABR(e.g. target2 for target, gap for gap)."
+    printf "\t %- 30s %s\n" "--abr [server-abr-type]" "Select server-side abor from [bb, random, worthed, target, target2, target3, gap, remote, robustmpc, pensieve]."
     printf "\t %- 30s %s\n" "--port [int]" "Change the port. (default 6121)"
+    printf "\t %- 30s %s\n" "--telemetry [dir]" "Record binary CC and ABR telemetry into a directory."
+    printf "\t %- 30s %s\n" "--coupled-cc" "Couple the congestion control of the connections to the same client subnet, across all the coupled servers of the host."
+    printf "\t %- 30s %s\n" "--cc-capture [dir]" "Capture the inputs of every connection's congestion control into a directory, for abrcc_cc_replay."
+    printf "\t %- 30s %s\n" "--shadow-cc [types]" "Run comma-separated congestion controls in shadow of the primary, recording their estimates into the telemetry."
+    printf "\t %- 30s %s\n" "--titles [dir]" "Serve every title <name>/config.json of a directory under /<name>/, rescanned on /.titles/reload from the server's host."
+    printf "\t %- 30s %s\n" "--segment-cache [dir]" "Keep segments in a persistent on-disk cache, warming only part of them into memory."
+    printf "\t %- 30s %s\n" "--origin [url]" "Run as an edge cache, fetching the segments missing from memory and the segment cache from an HTTP origin."
+    printf "\t %- 30s %s\n" "--control-port [int]" "Accept QuicTransport control channels carrying metrics and decisions on a port, which the player opens. (default 0: disabled)"
+    printf "\t %- 30s %s\n" "--control-origins [origins]" "Comma-separated origins of the pages allowed to open control channels. (default: the server's own)"
+    printf "\t %- 30s %s\n" "--bandwidth-resumption" "Resume returning clients' connections and start quality from their previous connection's estimates."
+    printf "\t %- 30s %s\n" "--emulate [trace]" "Emulate the server's egress link in-process from a bandwidth trace(no tc or root needed)."
+    printf "\t %- 30s %s\n" "--emulate-delay [ms]" "One-way delay of the emulated link. (default 0)"
+    printf "\t %- 30s %s\n" "--emulate-queue [bytes]" "Queue capacity of the emulated link. (default 65536)"
+    printf "\t %- 30s %s\n" "--emulate-aqm [queue]" "Queue discipline of the emulated link from [droptail, red]."
+    printf "\t %- 30s %s\n" "--emulate-loss [rate]" "Random loss rate of the emulated link. (default 0)"
     printf "\t %- 30s %s\n" "--profile [str]" "Change the chrome profile name to run."
     printf "\t %- 30s %s\n" "(-mp | --metrics-port) [int]" "Change the to which chrome talks to. (default 8080)"
     printf "\t %- 30s %s\n" "--site [url]" "Change the site serverd. (default www.example.org)"
@@ -205,12 +260,33 @@ function parse_command_line_options() {
                     CC=$1
                 elif [ $1 == "gap" ]; then 
                     CC=$1
+                elif [ $1 == "bbr2target" ]; then 
+                    CC=$1
+                elif [ $1 == "bbr2gap" ]; then 
+                    CC=$1
                 elif [ $1 == "minerva" ]; then 
                     CC=$1
                 else
                     echo "Congestion control $1 not recognized."
                 fi
                 ;;
+            --connection-cc)
+                shift
+                case $1 in
+                    bbr) QUIC_OPTIONS="--quic-connection-options=ACBB" ;;
+                    bbr2) QUIC_OPTIONS="--quic-connection-options=ACB2" ;;
+                    abbr) QUIC_OPTIONS="--quic-connection-options=ACAB" ;;
+                    target) QUIC_OPTIONS="--quic-connection-options=ACTG" ;;
+                    gap) QUIC_OPTIONS="--quic-connection-options=ACGP" ;;
+                    bbr2target) QUIC_OPTIONS="--quic-connection-options=ACT2" ;;
+                    bbr2gap) QUIC_OPTIONS="--quic-connection-options=ACG2" ;;
+                    minerva) QUIC_OPTIONS="--quic-connection-options=ACMN" ;;
+                    pcc) QUIC_OPTIONS="--quic-connection-options=ACPC" ;;
+                    cubic) QUIC_OPTIONS="--quic-connection-options=ACCU" ;;
+                    reno) QUIC_OPTIONS="--quic-connection-options=ACRN" ;;
+                    *) echo "Congestion control $1 not recognized." ;;
+                esac
+                ;;
             --abr)
                 shift
                 if [ $1 == "bb" ]; then
@@ -233,6 +309,10 @@ function parse_command_line_options() {
                     ABR=$1
                 elif [ $1 == "minervann" ]; then 
                     ABR=$1
+                elif [ $1 == "robustmpc" ]; then 
+                    ABR=$1
+                elif [ $1 == "pensieve" ]; then 
+                    ABR=$1
                 else
                     echo "Abr $1 not recognized."
                 fi
@@ -253,6 +333,65 @@ function parse_command_line_options() {
                 shift
                 SITE=$1
                 ;;
+            --telemetry)
+                shift
+                TELEMETRY=$1
+                ;;
+            --coupled-cc)
+                COUPLED_CC="true"
+                COUPLED_CC_BOARD="/dev/shm/abrcc_shared_bottleneck"
+                ;;
+            --cc-capture)
+                shift
+                CC_CAPTURE=$1
+                ;;
+            --shadow-cc)
+                shift
+                SHADOW_CC=$1
+                ;;
+            --titles)
+                shift
+                TITLES=$1
+                ;;
+            --segment-cache)
+                shift
+                SEGMENT_CACHE=$1
+                ;;
+            --origin)
+                shift
+                ORIGIN=$1
+                ;;
+            --control-port)
+                shift
+                CONTROL_PORT=$1
+                ;;
+            --control-origins)
+                shift
+                CONTROL_ORIGINS=$1
+                ;;
+            --bandwidth-resumption)
+                BANDWIDTH_RESUMPTION="true"
+                ;;
+            --emulate)
+                shift
+                EMULATION_TRACE=$1
+                ;;
+            --emulate-delay)
+                shift
+                EMULATION_DELAY=$1
+                ;;
+            --emulate-queue)
+                shift
+                EMULATION_QUEUE_BYTES=$1
+                ;;
+            --emulate-aqm)
+                shift
+                EMULATION_QUEUE=$1
+                ;;
+            --emulate-loss)
+                shift
+                EMULATION_LOSS=$1
+                ;;
             --reset)
                 RESET="yes"
                 ;;